@@ -0,0 +1,28 @@
+local dispatcherProfile = TalkAction("/profiler")
+
+function dispatcherProfile.onSay(player, words, param)
+	-- create log
+	logCommand(player, words, param)
+
+	if param == "dump" then
+		local path = Game.dumpDispatcherProfile("dispatcher_profile_" .. os.date("%Y%m%d_%H%M%S") .. ".txt")
+		if path then
+			player:sendTextMessage(MESSAGE_ADMINISTRATOR, "Dispatcher profile saved to " .. path .. ".")
+		else
+			player:sendTextMessage(MESSAGE_ADMINISTRATOR, "Failed to save the dispatcher profile.")
+		end
+	elseif param == "reset" then
+		Game.resetDispatcherProfile()
+		player:sendTextMessage(MESSAGE_ADMINISTRATOR, "Dispatcher profile reset.")
+	elseif param == "on" or param == "off" then
+		Game.setDispatcherProfiling(param == "on")
+		player:sendTextMessage(MESSAGE_ADMINISTRATOR, "Dispatcher profiling is now " .. param .. ".")
+	else
+		player:showTextDialog(2019, Game.getDispatcherProfile(15))
+	end
+	return true
+end
+
+dispatcherProfile:separator(" ")
+dispatcherProfile:groupType("god")
+dispatcherProfile:register()
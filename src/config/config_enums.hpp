@@ -41,12 +41,17 @@ enum ConfigKey_t : uint16_t {
 	CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES,
 	CLASSIC_ATTACK_SPEED,
 	CLEAN_PROTECTION_ZONES,
+	COALESCE_CREATURE_UPDATES,
 	COMBAT_CHAIN_DELAY,
 	COMBAT_CHAIN_SKILL_FORMULA_AXE,
 	COMBAT_CHAIN_SKILL_FORMULA_CLUB,
 	COMBAT_CHAIN_SKILL_FORMULA_SWORD,
 	COMBAT_CHAIN_TARGETS,
+	COMPRESSION_BACKEND,
+	COMPRESSION_BULK_LEVEL,
+	COMPRESSION_BULK_SIZE,
 	COMPRESSION_LEVEL,
+	COMPRESSION_MIN_SIZE,
 	CONVERT_UNSAFE_SCRIPTS,
 	CORE_DIRECTORY,
 	CRITICALCHANCE,
@@ -143,6 +148,8 @@ enum ConfigKey_t : uint16_t {
 	MAP_AUTHOR,
 	MAP_DOWNLOAD_URL,
 	MAP_NAME,
+	MAP_SNAPSHOT,
+	MAP_TILE_EVICTION_TIME,
 	MARKET_OFFER_DURATION,
 	MARKET_REFRESH_PRICES,
 	MARKET_PREMIUM,
@@ -178,6 +185,7 @@ enum ConfigKey_t : uint16_t {
 	MYSQL_PASS,
 	MYSQL_SOCK,
 	MYSQL_USER,
+	NETWORK_THREADS,
 	OLD_PROTOCOL,
 	ONE_PLAYER_ON_ACCOUNT,
 	ONLY_INVITED_CAN_MOVE_HOUSE_ITEMS,
@@ -196,6 +204,8 @@ enum ConfigKey_t : uint16_t {
 	PARTY_LIST_MAX_DISTANCE,
 	PARTY_SHARE_LOOT_BOOSTS_DIMINISHING_FACTOR,
 	PARTY_SHARE_LOOT_BOOSTS,
+	PATHFINDING_MAX_EXPANDED_NODES,
+	PATHFINDING_MAX_NODES,
 	PREMIUM_DEPOT_LIMIT,
 	PREY_BONUS_REROLL_PRICE,
 	PREY_BONUS_TIME,
@@ -1003,7 +1003,8 @@ void Creature::goToFollowCreature() {
 	}
 
 	if (listDir.empty()) {
-		hasFollowPath = getPathTo(followCreature->getPosition(), listDir, fpp);
+		// Monsters chasing the same creature walk down one shared flow field
+		hasFollowPath = g_game().map.getFollowPath(getCreature(), followCreature, listDir, fpp) || getPathTo(followCreature->getPosition(), listDir, fpp);
 	}
 
 	startAutoWalk(listDir);
@@ -142,8 +142,8 @@ bool Player::isPushable() {
 	return Creature::isPushable();
 }
 
-std::shared_ptr<Task> Player::createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context) {
-	return std::make_shared<Task>(std::move(f), context, delay);
+std::shared_ptr<Task> Player::createPlayerTask(uint32_t delay, TaskFunction f, std::string_view context) {
+	return ScheduledTaskPool::makeShared(std::move(f), context, delay);
 }
 
 uint32_t Player::playerFirstID = 0x10000000;
@@ -7856,6 +7856,12 @@ void Player::sendNetworkMessage(NetworkMessage &message) const {
 	}
 }
 
+void Player::sendBroadcast(BroadcastMessage &message, uint8_t variant /* = 0*/) const {
+	if (client) {
+		client->sendBroadcast(message, variant);
+	}
+}
+
 void Player::receivePing() {
 	lastPong = OTSYS_TIME();
 }
@@ -8077,9 +8083,9 @@ void Player::sendCreatureAppear(const std::shared_ptr<Creature> &creature, const
 	}
 }
 
-void Player::sendCreatureMove(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport) const {
+void Player::sendCreatureMove(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport, BroadcastMessage* step /* = nullptr*/) const {
 	if (client) {
-		client->sendMoveCreature(creature, newPos, newStackPos, oldPos, oldStackPos, teleport);
+		client->sendMoveCreature(creature, newPos, newStackPos, oldPos, oldStackPos, teleport, step);
 	}
 }
 
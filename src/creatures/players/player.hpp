@@ -28,9 +28,11 @@
 #include "creatures/players/components/player_vip.hpp"
 #include "creatures/players/components/wheel/wheel_gems.hpp"
 #include "creatures/players/components/player_attached_effects.hpp"
+#include "game/scheduling/task_function.hpp"
 
 class House;
 class NetworkMessage;
+class BroadcastMessage;
 class Weapon;
 class ProtocolGame;
 class Party;
@@ -177,7 +179,7 @@ public:
 		return static_self_cast<Player>();
 	}
 
-	static std::shared_ptr<Task> createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context);
+	static std::shared_ptr<Task> createPlayerTask(uint32_t delay, TaskFunction f, std::string_view context);
 
 	void setID() override;
 
@@ -802,7 +804,7 @@ public:
 	void sendChannelMessage(const std::string &author, const std::string &text, SpeakClasses type, uint16_t channel) const;
 	void sendChannelEvent(uint16_t channelId, const std::string &playerName, ChannelEvent_t channelEvent) const;
 	void sendCreatureAppear(const std::shared_ptr<Creature> &creature, const Position &pos, bool isLogin);
-	void sendCreatureMove(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport) const;
+	void sendCreatureMove(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport, BroadcastMessage* step = nullptr) const;
 	void sendCreatureTurn(const std::shared_ptr<Creature> &creature);
 	void sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos = nullptr) const;
 	void sendCreatureReload(const std::shared_ptr<Creature> &creature) const;
@@ -979,6 +981,8 @@ public:
 	void sendEnterWorld() const;
 	void sendFightModes() const;
 	void sendNetworkMessage(NetworkMessage &message) const;
+	// Same bytes for every spectator, encoded once per protocol variant
+	void sendBroadcast(BroadcastMessage &message, uint8_t variant = 0) const;
 
 	void receivePing();
 
@@ -42,6 +42,7 @@
 #include "items/containers/rewards/rewardchest.hpp"
 #include "items/items.hpp"
 #include "items/items_classification.hpp"
+#include "lib/metrics/metrics.hpp"
 #include "lua/callbacks/event_callback.hpp"
 #include "lua/callbacks/events_callbacks.hpp"
 #include "lua/creature/actions.hpp"
@@ -51,6 +52,8 @@
 #include "lua/global/globalevent.hpp"
 #include "lua/scripts/lua_environment.hpp"
 #include "map/spectators.hpp"
+#include "server/network/message/broadcastmessage.hpp"
+#include "server/network/message/compression.hpp"
 #include "server/network/protocol/protocollogin.hpp"
 #include "server/network/protocol/protocolstatus.hpp"
 #include "server/network/protocol/protocolgame.hpp"
@@ -555,6 +558,11 @@ void Game::start(ServiceManager* manager) {
 	g_dispatcher().cycleEvent(
 		EVENT_LUA_GARBAGE_COLLECTION, [this] { g_luaEnvironment().collectGarbage(); }, "Calling GC"
 	);
+	if (const auto tileEvictionTime = g_configManager().getNumber(MAP_TILE_EVICTION_TIME); tileEvictionTime > 0) {
+		g_dispatcher().cycleEvent(
+			EVENT_MAP_TILE_EVICTION_INTERVAL, [this, tileEvictionTime] { map.evictIdleTiles(static_cast<int64_t>(tileEvictionTime) * 1000); }, "Map::evictIdleTiles"
+		);
+	}
 	auto marketItemsPriceIntervalMinutes = g_configManager().getNumber(MARKET_REFRESH_PRICES);
 	if (marketItemsPriceIntervalMinutes > 0) {
 		auto marketItemsPriceIntervalMS = marketItemsPriceIntervalMinutes * 60000;
@@ -569,6 +577,9 @@ void Game::start(ServiceManager* manager) {
 	g_dispatcher().cycleEvent(
 		UPDATE_PLAYERS_ONLINE_DB, [this] { updatePlayersOnline(); }, "Game::updatePlayersOnline"
 	);
+	g_dispatcher().cycleEvent(
+		EVENT_METRICS_INTERVAL, [this] { publishMetrics(); }, "Game::publishMetrics"
+	);
 }
 
 GameState_t Game::getGameState() const {
@@ -1252,6 +1263,7 @@ bool Game::removeCreature(const std::shared_ptr<Creature> &creature, bool isLogo
 	creature->setRemoved();
 
 	removeCreatureCheck(creature);
+	map.removeFlowField(creature->getID());
 
 	for (const auto &summon : creature->getSummons()) {
 		summon->setSkillLoss(false);
@@ -6504,7 +6516,7 @@ void Game::playerSpeakToNpc(const std::shared_ptr<Player> &player, const std::st
 	player->updateUIExhausted();
 }
 
-std::shared_ptr<Task> Game::createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context) const {
+std::shared_ptr<Task> Game::createPlayerTask(uint32_t delay, TaskFunction f, std::string_view context) const {
 	return Player::createPlayerTask(delay, std::move(f), context);
 }
 
@@ -6562,10 +6574,13 @@ bool Game::internalCreatureSay(const std::shared_ptr<Creature> &creature, SpeakC
 	}
 
 	// Send to client
+	BroadcastMessage message([&](NetworkMessage &msg, bool oldProtocol, uint8_t) {
+		ProtocolGame::AddCreatureSay(msg, creature, type, text, *pos, oldProtocol);
+	});
 	for (const auto &spectator : spectators) {
 		if (const auto &tmpPlayer = spectator->getPlayer()) {
 			if (!ghostMode || tmpPlayer->canSeeCreature(creature)) {
-				tmpPlayer->sendCreatureSay(creature, type, text, pos);
+				tmpPlayer->sendBroadcast(message);
 			}
 		}
 	}
@@ -8195,9 +8210,12 @@ void Game::addCreatureHealth(const CreatureVector &spectators, const std::shared
 			}
 		}
 	}
+	BroadcastMessage message([&target](NetworkMessage &msg, bool, uint8_t) {
+		ProtocolGame::AddCreatureHealth(msg, target);
+	});
 	for (const auto &spectator : spectators) {
 		if (const auto &tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendCreatureHealth(target);
+			tmpPlayer->sendBroadcast(message);
 		}
 	}
 }
@@ -8225,9 +8243,12 @@ void Game::addMagicEffect(const Position &pos, uint16_t effect) {
 }
 
 void Game::addMagicEffect(const CreatureVector &spectators, const Position &pos, uint16_t effect) {
+	BroadcastMessage message([&pos, effect](NetworkMessage &msg, bool oldProtocol, uint8_t) {
+		ProtocolGame::AddMagicEffect(msg, pos, effect, oldProtocol);
+	});
 	for (const auto &spectator : spectators) {
-		if (const auto &tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendMagicEffect(pos, effect);
+		if (const auto &tmpPlayer = spectator->getPlayer(); tmpPlayer && tmpPlayer->canSee(pos)) {
+			tmpPlayer->sendBroadcast(message);
 		}
 	}
 }
@@ -8251,9 +8272,12 @@ void Game::addDistanceEffect(const Position &fromPos, const Position &toPos, uin
 }
 
 void Game::addDistanceEffect(const CreatureVector &spectators, const Position &fromPos, const Position &toPos, uint16_t effect) {
+	BroadcastMessage message([&fromPos, &toPos, effect](NetworkMessage &msg, bool oldProtocol, uint8_t) {
+		ProtocolGame::AddDistanceShoot(msg, fromPos, toPos, effect, oldProtocol);
+	});
 	for (const auto &spectator : spectators) {
 		if (const auto &tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendDistanceShoot(fromPos, toPos, effect);
+			tmpPlayer->sendBroadcast(message);
 		}
 	}
 }
@@ -11152,6 +11176,35 @@ void Game::updatePlayersOnline() const {
 	}
 }
 
+void Game::publishMetrics() {
+	const auto spectatorsStats = Spectators::getCacheStats();
+	g_metrics().addCounter("spectators_cache_hits", static_cast<double>(spectatorsStats.hits - publishedSpectatorsStats.hits));
+	g_metrics().addCounter("spectators_cache_misses", static_cast<double>(spectatorsStats.misses - publishedSpectatorsStats.misses));
+	g_metrics().addCounter("spectators_cache_evictions", static_cast<double>(spectatorsStats.evictions - publishedSpectatorsStats.evictions));
+	g_metrics().addUpDownCounter("spectators_cache_entries", static_cast<int>(spectatorsStats.entries) - static_cast<int>(publishedSpectatorsStats.entries));
+
+	const auto lookups = spectatorsStats.hits - publishedSpectatorsStats.hits + spectatorsStats.misses - publishedSpectatorsStats.misses;
+	if (lookups > 0) {
+		g_logger().debug("[{}] spectators cache: {:.1f}% hits, {} entries, {} evicted", __FUNCTION__, (spectatorsStats.hits - publishedSpectatorsStats.hits) * 100.0 / lookups, spectatorsStats.entries, spectatorsStats.evictions - publishedSpectatorsStats.evictions);
+	}
+	publishedSpectatorsStats = spectatorsStats;
+
+	const auto compressionStats = Compressor::getStats();
+	const auto bytesIn = compressionStats.bytesIn - publishedCompressionStats.bytesIn;
+	const auto bytesOut = compressionStats.bytesOut - publishedCompressionStats.bytesOut;
+	const auto compressionMs = static_cast<double>(compressionStats.nanoseconds - publishedCompressionStats.nanoseconds) / 1'000'000.0;
+	g_metrics().addCounter("compression_messages", static_cast<double>(compressionStats.compressed - publishedCompressionStats.compressed), { { "result", "compressed" } });
+	g_metrics().addCounter("compression_messages", static_cast<double>(compressionStats.skipped - publishedCompressionStats.skipped), { { "result", "skipped" } });
+	g_metrics().addCounter("compression_bytes_in", static_cast<double>(bytesIn));
+	g_metrics().addCounter("compression_bytes_out", static_cast<double>(bytesOut));
+	g_metrics().addCounter("compression_cpu_ms", compressionMs);
+
+	if (bytesIn > 0) {
+		g_logger().debug("[{}] compression: {:.1f}% of {} bytes sent, {:.1f} ms spent", __FUNCTION__, bytesOut * 100.0 / bytesIn, bytesIn, compressionMs);
+	}
+	publishedCompressionStats = compressionStats;
+}
+
 void Game::sendAttachedEffect(const std::shared_ptr<Creature> &creature, uint16_t effectId) {
 	auto spectators = Spectators().find<Player>(creature->getPosition(), true);
 	for (const auto &spectator : spectators) {
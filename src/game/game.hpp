@@ -16,8 +16,11 @@
 #include "creatures/players/grouping/groups.hpp"
 #include "lua/creature/raids.hpp"
 #include "map/map.hpp"
+#include "map/spectators.hpp"
 #include "modal_window/modal_window.hpp"
 #include "movement/position.hpp"
+#include "scheduling/task_function.hpp"
+#include "server/network/message/compression.hpp"
 
 // Forward declaration for protobuf class
 namespace Canary {
@@ -67,6 +70,8 @@ static constexpr int32_t EVENT_DECAYINTERVAL = 250;
 static constexpr int32_t EVENT_DECAY_BUCKETS = 4;
 static constexpr int32_t EVENT_FORGEABLEMONSTERCHECKINTERVAL = 300000;
 static constexpr int32_t EVENT_LUA_GARBAGE_COLLECTION = 60000 * 10; // 10min
+static constexpr int32_t EVENT_MAP_TILE_EVICTION_INTERVAL = 1000;
+static constexpr int32_t EVENT_METRICS_INTERVAL = 60000; // 1min
 
 static constexpr std::chrono::minutes CACHE_EXPIRATION_TIME { 10 }; // 10min
 static constexpr std::chrono::minutes HIGHSCORE_CACHE_EXPIRATION_TIME { 10 }; // 10min
@@ -731,7 +736,7 @@ private:
 	bool playerYell(const std::shared_ptr<Player> &player, const std::string &text);
 	bool playerSpeakTo(const std::shared_ptr<Player> &player, SpeakClasses type, const std::string &receiver, const std::string &text);
 	void playerSpeakToNpc(const std::shared_ptr<Player> &player, const std::string &text);
-	std::shared_ptr<Task> createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context) const;
+	std::shared_ptr<Task> createPlayerTask(uint32_t delay, TaskFunction f, std::string_view context) const;
 
 	/**
 	 * @brief Finds the next available sub-container within a container.
@@ -944,6 +949,11 @@ private:
 	std::string generateHighscoreOrGetCachedQueryForOurRank(const std::string &categoryName, uint8_t entriesPerPage, uint32_t playerGUID, uint32_t vocation);
 
 	void updatePlayersOnline() const;
+
+	// Adds what the caches and the compressors counted since the last call to the metrics
+	void publishMetrics();
+	SpectatorsCacheStats publishedSpectatorsStats;
+	CompressionStats publishedCompressionStats;
 };
 
 constexpr auto g_game = Game::getInstance;
@@ -28,15 +28,26 @@ void Dispatcher::init() {
 	threadPool.detach_task([this, dispatcherStarted]() mutable {
 		std::unique_lock asyncLock(dummyMutex);
 
+		dispatcherThreadId = ThreadPool::getThreadId();
+		scheduledTasks.reset(OTSYS_TIME());
+
 		dispatcherStarted->set_value();
 
 		while (!threadPool.isStopped()) {
 			UPDATE_OTSYS_TIME();
+			const bool profiling = profiler.isEnabled();
+			if (profiling) {
+				profiler.beginTick();
+			}
 
 			executeEvents();
 			executeScheduledEvents();
 			mergeEvents();
 
+			if (profiling) {
+				profiler.endTick();
+			}
+
 			if (!hasPendingTasks) {
 				signalSchedule.wait_for(asyncLock, timeUntilNextScheduledTask());
 			}
@@ -48,6 +59,21 @@ void Dispatcher::init() {
 	}
 }
 
+bool Dispatcher::executeTask(const Task &task) {
+	if (!profiler.isEnabled()) {
+		return task.execute();
+	}
+
+	const auto start = TaskProfiler::now();
+	if (!task.execute()) {
+		return false;
+	}
+
+	// Tasks queued before profiling was enabled have no ready time
+	profiler.record(task.getContext(), task.readyAt != 0 ? start - task.readyAt : 0, TaskProfiler::now() - start);
+	return true;
+}
+
 void Dispatcher::executeSerialEvents(const uint8_t groupId) {
 	auto &tasks = m_tasks[groupId];
 	if (tasks.empty()) {
@@ -59,7 +85,7 @@ void Dispatcher::executeSerialEvents(const uint8_t groupId) {
 
 	for (const auto &task : tasks) {
 		dispacherContext.taskName = task.getContext();
-		if (task.execute()) {
+		if (executeTask(task)) {
 			++dispatcherCycle;
 		}
 	}
@@ -74,51 +100,117 @@ void Dispatcher::executeParallelEvents(const uint8_t groupId) {
 		return;
 	}
 
-	asyncWait(tasks.size(), [groupId, &tasks](size_t i) {
-		dispacherContext.type = DispatcherType::AsyncEvent;
-		dispacherContext.group = static_cast<TaskGroup>(groupId);
-		tasks[i].execute();
+	asyncWait(
+		tasks.size(), [this, groupId, &tasks](size_t i) {
+			dispacherContext.type = DispatcherType::AsyncEvent;
+			dispacherContext.group = static_cast<TaskGroup>(groupId);
+			executeTask(tasks[i]);
 
-		dispacherContext.reset();
-	});
+			dispacherContext.reset();
+		},
+		static_cast<TaskGroup>(groupId)
+	);
 
 	tasks.clear();
 }
 
-void Dispatcher::asyncWait(size_t requestSize, std::function<void(size_t i)> &&f) {
+void Dispatcher::asyncWait(size_t requestSize, std::function<void(size_t i)> &&f, TaskGroup group) {
 	if (requestSize == 0) {
 		return;
 	}
 
+	using namespace std::chrono;
+	static constexpr uint64_t TARGET_CHUNK_COST = 50'000; // 50µs of work per chunk
+	static constexpr uint64_t MIN_PARALLEL_COST = 100'000; // cheaper loops run inline
+
+	auto &stats = parallelStats[static_cast<uint8_t>(group)];
+	const auto itemCost = std::max<uint64_t>(stats.itemCost.load(std::memory_order_relaxed), 1);
+	const auto participants = std::min<size_t>(threadPool.get_thread_count(), requestSize);
+
+	const auto updateItemCost = [&stats](uint64_t elapsed, size_t items) {
+		const auto cost = elapsed / items;
+		const auto average = stats.itemCost.load(std::memory_order_relaxed);
+		stats.itemCost.store(average == 0 ? cost : (average * 7 + cost) / 8, std::memory_order_relaxed);
+	};
+
 	// This prevents an async call from running inside another async call.
-	if (asyncWaitDisabled) {
+	if (asyncWaitDisabled || participants <= 1 || itemCost * requestSize < MIN_PARALLEL_COST) {
+		const auto start = steady_clock::now();
 		for (uint_fast64_t i = 0; i < requestSize; ++i) {
 			f(i);
 		}
+
+		if (!asyncWaitDisabled) {
+			updateItemCost(duration_cast<nanoseconds>(steady_clock::now() - start).count(), requestSize);
+		}
 		return;
 	}
 
-	const auto &partitions = generatePartition(requestSize);
-	const auto pSize = partitions.size();
+	// Shared with the helpers, a helper that starts late only finds empty ranges
+	struct ParallelLoop {
+		ParallelLoop(size_t participants, size_t size, uint32_t chunk, std::function<void(size_t i)> &f) :
+			ranges(participants, static_cast<uint32_t>(size)), remaining(static_cast<int64_t>(size)), chunk(chunk), f(f) { }
+
+		WorkStealingRanges ranges;
+		std::atomic_int64_t remaining;
+		std::atomic_uint64_t busyTime = 0;
+		const uint32_t chunk;
+		std::function<void(size_t i)> &f;
+	};
+
+	const auto perParticipant = requestSize / participants;
+	const auto chunk = static_cast<uint32_t>(std::clamp<uint64_t>(TARGET_CHUNK_COST / itemCost, 1, std::max<uint64_t>(perParticipant / 4, 1)));
+	const auto loop = std::make_shared<ParallelLoop>(participants, requestSize, chunk, f);
+
+	const auto work = [&stats](ParallelLoop &loop, size_t participant) {
+		uint64_t idleTime = 0;
+		uint32_t begin, end;
+
+		while (true) {
+			while (loop.ranges.pop(participant, loop.chunk, begin, end)) {
+				const auto chunkStart = steady_clock::now();
+				for (uint_fast32_t i = begin; i < end; ++i) {
+					loop.f(i);
+				}
+				loop.busyTime.fetch_add(duration_cast<nanoseconds>(steady_clock::now() - chunkStart).count(), std::memory_order_relaxed);
+
+				const auto executed = static_cast<int64_t>(end - begin);
+				if (loop.remaining.fetch_sub(executed, std::memory_order_acq_rel) == executed) {
+					loop.remaining.notify_all();
+				}
+			}
 
-	BS::multi_future<void> retFuture;
+			const auto idleStart = steady_clock::now();
+			const bool stolen = loop.ranges.steal(participant);
+			idleTime += duration_cast<nanoseconds>(steady_clock::now() - idleStart).count();
+			if (!stolen) {
+				break;
+			}
+			stats.steals.fetch_add(1, std::memory_order_relaxed);
+		}
 
-	if (pSize > 1) {
-		asyncWaitDisabled = true;
-		const auto min = partitions[1].first;
-		const auto max = partitions[partitions.size() - 1].second;
-		retFuture = threadPool.submit_loop(min, max, [&f](const unsigned int i) { f(i); });
-	}
+		stats.idleTime.fetch_add(idleTime, std::memory_order_relaxed);
+	};
 
-	const auto &[min, max] = partitions[0];
-	for (uint_fast64_t i = min; i < max; ++i) {
-		f(i);
+	asyncWaitDisabled = true;
+	for (size_t participant = 1; participant < participants; ++participant) {
+		threadPool.detach_task([loop, participant, work] {
+			work(*loop, participant);
+		});
 	}
 
-	if (pSize > 1) {
-		retFuture.wait();
-		asyncWaitDisabled = false;
+	work(*loop, 0);
+
+	const auto barrierStart = steady_clock::now();
+	for (auto remaining = loop->remaining.load(std::memory_order_acquire); remaining > 0; remaining = loop->remaining.load(std::memory_order_acquire)) {
+		loop->remaining.wait(remaining, std::memory_order_acquire);
 	}
+	asyncWaitDisabled = false;
+
+	stats.barrierWait.fetch_add(duration_cast<nanoseconds>(steady_clock::now() - barrierStart).count(), std::memory_order_relaxed);
+	stats.runs.fetch_add(1, std::memory_order_relaxed);
+	stats.items.fetch_add(requestSize, std::memory_order_relaxed);
+	updateItemCost(loop->busyTime.load(std::memory_order_relaxed), requestSize);
 }
 
 void Dispatcher::executeEvents(const TaskGroup startGroup) {
@@ -136,32 +228,20 @@ void Dispatcher::executeEvents(const TaskGroup startGroup) {
 }
 
 void Dispatcher::executeScheduledEvents() {
-	auto &threadScheduledTasks = getThreadTask()->scheduledTasks;
-
-	auto it = scheduledTasks.begin();
-	while (it != scheduledTasks.end()) {
-		const auto &task = *it;
-		if (task->getTime() > OTSYS_TIME()) {
-			break;
-		}
-
+	scheduledTasks.advance(OTSYS_TIME(), [this](const std::shared_ptr<Task> &task) {
 		dispacherContext.type = task->isCycle() ? DispatcherType::CycleEvent : DispatcherType::ScheduledEvent;
 		dispacherContext.group = TaskGroup::Serial;
 		dispacherContext.taskName = task->getContext();
 
-		if (task->execute() && task->isCycle()) {
+		if (executeTask(*task) && task->isCycle() && !task->isCanceled()) {
+			// Re-arms the same task, no allocation nor merge required
 			task->updateTime();
-			threadScheduledTasks.emplace_back(task);
+			setReadyAt(*task, task->getDelay());
+			scheduledTasks.insert(task);
 		} else {
 			scheduledTasksRef.erase(task->getId());
 		}
-
-		++it;
-	}
-
-	if (it != scheduledTasks.begin()) {
-		scheduledTasks.erase(scheduledTasks.begin(), it);
-	}
+	});
 
 	dispacherContext.reset();
 
@@ -171,24 +251,20 @@ void Dispatcher::executeScheduledEvents() {
 
 void Dispatcher::__mergeEvents(const std::array<uint8_t, 2> &groups, const bool mergeScheduledEvents) {
 	for (const auto &thread : threads) {
-		std::scoped_lock lock(thread->mutex);
 		for (const auto group : groups) {
-			auto &threadTasks = thread->tasks[group];
 			auto &tasks = m_tasks[group];
-
-			if (threadTasks.size() > tasks.size()) {
-				tasks.swap(threadTasks);
-			}
-
-			if (!threadTasks.empty()) {
-				tasks.insert(tasks.end(), make_move_iterator(threadTasks.begin()), make_move_iterator(threadTasks.end()));
-				threadTasks.clear();
-			}
+			thread->tasks[group].drain([&tasks](Task &&task) {
+				tasks.emplace_back(std::move(task));
+			});
 		}
 
-		if (mergeScheduledEvents && !thread->scheduledTasks.empty()) {
-			scheduledTasks.insert(make_move_iterator(thread->scheduledTasks.begin()), make_move_iterator(thread->scheduledTasks.end()));
-			thread->scheduledTasks.clear();
+		if (mergeScheduledEvents) {
+			thread->scheduledTasks.drain([this](std::shared_ptr<Task> &&task) {
+				// Canceled before reaching the wheel, nothing to schedule
+				if (!task->isCanceled()) {
+					scheduledTasks.insert(std::move(task));
+				}
+			});
 		}
 	}
 }
@@ -214,30 +290,29 @@ std::chrono::milliseconds Dispatcher::timeUntilNextScheduledTask() const {
 		return CHRONO_MILI_MAX;
 	}
 
-	const auto &task = *scheduledTasks.begin();
-	const auto timeRemaining = std::chrono::milliseconds(task->getTime() - OTSYS_TIME());
+	const auto timeRemaining = std::chrono::milliseconds(scheduledTasks.nextExpiration() - OTSYS_TIME());
 	return std::max<std::chrono::milliseconds>(timeRemaining, CHRONO_0);
 }
 
-void Dispatcher::addEvent(std::function<void(void)> &&f, std::string_view context, uint32_t expiresAfterMs) {
+void Dispatcher::addEvent(TaskFunction &&f, std::string_view context, uint32_t expiresAfterMs) {
 	if (shuttingDown) {
 		return;
 	}
 
-	const auto &thread = getThreadTask();
-	std::scoped_lock lock(thread->mutex);
-	thread->tasks[static_cast<uint8_t>(TaskGroup::Serial)].emplace_back(expiresAfterMs, std::move(f), context);
+	Task task(expiresAfterMs, std::move(f), context);
+	setReadyAt(task);
+	getThreadTask()->tasks[static_cast<uint8_t>(TaskGroup::Serial)].push(std::move(task));
 	notify();
 }
 
-void Dispatcher::addWalkEvent(std::function<void(void)> &&f, uint32_t expiresAfterMs) {
+void Dispatcher::addWalkEvent(TaskFunction &&f, uint32_t expiresAfterMs) {
 	if (shuttingDown) {
 		return;
 	}
 
-	const auto &thread = getThreadTask();
-	std::scoped_lock lock(thread->mutex);
-	thread->tasks[static_cast<uint8_t>(TaskGroup::Walk)].emplace_back(expiresAfterMs, std::move(f), this->context().taskName);
+	Task task(expiresAfterMs, std::move(f), this->context().taskName);
+	setReadyAt(task);
+	getThreadTask()->tasks[static_cast<uint8_t>(TaskGroup::Walk)].push(std::move(task));
 	notify();
 }
 
@@ -246,25 +321,22 @@ uint64_t Dispatcher::scheduleEvent(const std::shared_ptr<Task> &task) {
 		return 0;
 	}
 
-	const auto &thread = getThreadTask();
-	std::scoped_lock lock(thread->mutex);
-
-	auto eventId = scheduledTasksRef
-					   .emplace(task->getId(), thread->scheduledTasks.emplace_back(task))
-					   .first->first;
+	setReadyAt(*task, task->getDelay());
+	const auto eventId = scheduledTasksRef.emplace(task->getId(), task).first->first;
+	getThreadTask()->scheduledTasks.push(task);
 
 	notify();
 	return eventId;
 }
 
-void Dispatcher::asyncEvent(std::function<void(void)> &&f, TaskGroup group) {
+void Dispatcher::asyncEvent(TaskFunction &&f, TaskGroup group) {
 	if (shuttingDown) {
 		return;
 	}
 
-	const auto &thread = getThreadTask();
-	std::scoped_lock lock(thread->mutex);
-	thread->tasks[static_cast<uint8_t>(group)].emplace_back(0, std::move(f), dispacherContext.taskName);
+	Task task(0, std::move(f), dispacherContext.taskName);
+	setReadyAt(task);
+	getThreadTask()->tasks[static_cast<uint8_t>(group)].push(std::move(task));
 	notify();
 }
 
@@ -272,11 +344,17 @@ void Dispatcher::stopEvent(uint64_t eventId) {
 	auto it = scheduledTasksRef.find(eventId);
 	if (it != scheduledTasksRef.end()) {
 		it->second->cancel();
+
+		// The wheel belongs to the dispatcher thread, others only flag the task as canceled
+		if (isDispatcherThread()) {
+			scheduledTasks.erase(it->second.get());
+		}
+
 		scheduledTasksRef.erase(it);
 	}
 }
 
-void Dispatcher::safeCall(std::function<void(void)> &&f) {
+void Dispatcher::safeCall(TaskFunction &&f) {
 	if (dispacherContext.isAsync()) {
 		addEvent(std::move(f), dispacherContext.taskName);
 	} else {
@@ -284,6 +362,30 @@ void Dispatcher::safeCall(std::function<void(void)> &&f) {
 	}
 }
 
+std::string Dispatcher::getProfileReport(size_t limit) const {
+	auto result = profiler.report(limit);
+	auto out = std::back_inserter(result);
+
+	static constexpr auto groupNames = std::to_array<std::string_view>({ "Walk", "WalkParallel", "Serial", "GenericParallel" });
+	fmt::format_to(out, "\nParallel groups, times in ms:\n");
+	for (uint_fast8_t groupId = 0; groupId < static_cast<uint8_t>(TaskGroup::Last); ++groupId) {
+		const auto &stats = parallelStats[groupId];
+		const auto runs = stats.runs.load(std::memory_order_relaxed);
+		if (runs == 0) {
+			continue;
+		}
+
+		fmt::format_to(
+			out, "{}: {} runs, {} items, {} steals, idle {:.2f}, barrier wait {:.2f}, item cost {:.4f}\n",
+			groupNames[groupId], runs, stats.items.load(std::memory_order_relaxed), stats.steals.load(std::memory_order_relaxed),
+			stats.idleTime.load(std::memory_order_relaxed) / 1e6, stats.barrierWait.load(std::memory_order_relaxed) / 1e6,
+			stats.itemCost.load(std::memory_order_relaxed) / 1e6
+		);
+	}
+
+	return result;
+}
+
 bool DispatcherContext::isOn() {
 	return OTSYS_TIME() != 0;
 }
@@ -10,7 +10,10 @@
 #pragma once
 
 #include "task.hpp"
+#include "task_profiler.hpp"
+#include "work_stealing.hpp"
 #include "lib/thread/thread_pool.hpp"
+#include "utils/lockfree.hpp"
 
 static constexpr uint16_t DISPATCHER_TASK_EXPIRATION = 2000;
 static constexpr uint16_t SCHEDULER_MINTICKS = 50;
@@ -69,6 +72,22 @@ private:
 	friend class Dispatcher;
 };
 
+/**
+ * Counters of the parallel loops run by Dispatcher::asyncWait, per task group.
+ * Times are in nanoseconds.
+ */
+struct ParallelGroupStats {
+	std::atomic_uint64_t runs = 0;
+	std::atomic_uint64_t items = 0;
+	std::atomic_uint64_t steals = 0;
+	// Time participants spent looking for work after their own range ran dry
+	std::atomic_uint64_t idleTime = 0;
+	// Time the dispatcher waited for the last participants to finish
+	std::atomic_uint64_t barrierWait = 0;
+	// Moving average of the cost of a single item, drives the chunk size
+	std::atomic_uint64_t itemCost = 0;
+};
+
 /**
  * Dispatcher allow you to dispatch a task async to be executed
  * in the dispatching thread. You can dispatch with an expiration
@@ -78,7 +97,8 @@ class Dispatcher {
 public:
 	explicit Dispatcher(ThreadPool &threadPool) :
 		threadPool(threadPool) {
-		threads.reserve(threadPool.get_thread_count() + 1);
+		// A slot per pool thread and the main thread, then one shared by any other thread
+		threads.reserve(threadPool.get_thread_count() + 2);
 		for (uint_fast16_t i = 0; i < threads.capacity(); ++i) {
 			threads.emplace_back(std::make_unique<ThreadTask>());
 		}
@@ -92,30 +112,31 @@ public:
 
 	static Dispatcher &getInstance();
 
-	void addEvent(std::function<void(void)> &&f, std::string_view context, uint32_t expiresAfterMs = 0);
-	void addWalkEvent(std::function<void(void)> &&f, uint32_t expiresAfterMs = 0); // No need context name
+	void addEvent(TaskFunction &&f, std::string_view context, uint32_t expiresAfterMs = 0);
+	void addWalkEvent(TaskFunction &&f, uint32_t expiresAfterMs = 0); // No need context name
 
-	uint64_t cycleEvent(uint32_t delay, std::function<void(void)> &&f, std::string_view context) {
+	uint64_t cycleEvent(uint32_t delay, TaskFunction &&f, std::string_view context) {
 		return scheduleEvent(delay, std::move(f), context, true);
 	}
 
 	uint64_t scheduleEvent(const std::shared_ptr<Task> &task);
-	uint64_t scheduleEvent(uint32_t delay, std::function<void(void)> &&f, std::string_view context) {
+	uint64_t scheduleEvent(uint32_t delay, TaskFunction &&f, std::string_view context) {
 		return scheduleEvent(delay, std::move(f), context, false);
 	}
 
-	void asyncEvent(std::function<void(void)> &&f, TaskGroup group = TaskGroup::GenericParallel);
-	void asyncWait(size_t size, std::function<void(size_t i)> &&f);
+	void asyncEvent(TaskFunction &&f, TaskGroup group = TaskGroup::GenericParallel);
+	void asyncWait(size_t size, std::function<void(size_t i)> &&f, TaskGroup group = TaskGroup::GenericParallel);
 
-	uint64_t asyncCycleEvent(uint32_t delay, std::function<void(void)> &&f, TaskGroup group = TaskGroup::GenericParallel) {
+	uint64_t asyncCycleEvent(uint32_t delay, TaskFunction &&f, TaskGroup group = TaskGroup::GenericParallel) {
+		// Every cycle dispatches the same function, so it is shared instead of copied
 		return scheduleEvent(
-			delay, [this, f = std::move(f), group] { asyncEvent([f] { f(); }, group); }, dispacherContext.taskName, true, false
+			delay, [this, f = std::make_shared<TaskFunction>(std::move(f)), group] { asyncEvent([f] { (*f)(); }, group); }, dispacherContext.taskName, true, false
 		);
 	}
 
-	uint64_t asyncScheduleEvent(uint32_t delay, std::function<void(void)> &&f, TaskGroup group = TaskGroup::GenericParallel) {
+	uint64_t asyncScheduleEvent(uint32_t delay, TaskFunction &&f, TaskGroup group = TaskGroup::GenericParallel) {
 		return scheduleEvent(
-			delay, [this, f = std::move(f), group] { asyncEvent([f] { f(); }, group); }, dispacherContext.taskName, false, false
+			delay, [this, f = std::move(f), group]() mutable { asyncEvent(std::move(f), group); }, dispacherContext.taskName, false, false
 		);
 	}
 
@@ -127,11 +148,11 @@ public:
 	 * using appropriate mechanisms (such as message queues or event loops).
 	 * If called directly from the dispatcher thread, it will execute the function immediately.
 	 *
-	 * @param action The function wrapped in a std::function<void(void)> that should be executed.
+	 * @param action The function wrapped in a TaskFunction that should be executed.
 	 *
 	 * @note This method is useful in multi-threaded applications to avoid race conditions or thread context violations.
 	 */
-	void safeCall(std::function<void(void)> &&f);
+	void safeCall(TaskFunction &&f);
 
 	[[nodiscard]] uint64_t getDispatcherCycle() const {
 		return dispatcherCycle;
@@ -139,6 +160,20 @@ public:
 
 	void stopEvent(uint64_t eventId);
 
+	const ParallelGroupStats &getParallelStats(TaskGroup group) const {
+		return parallelStats[static_cast<uint8_t>(group)];
+	}
+
+	TaskProfiler &getProfiler() {
+		return profiler;
+	}
+
+	/**
+	 * @brief Task profiler report followed by the parallel group counters.
+	 * @param limit Maximum number of task contexts listed.
+	 */
+	std::string getProfileReport(size_t limit = 30) const;
+
 	const auto &context() const {
 		return dispacherContext;
 	}
@@ -146,12 +181,18 @@ public:
 private:
 	thread_local static DispatcherContext dispacherContext;
 
+	// Threads outside the pool, such as the network shards, push into the last slot
 	const auto &getThreadTask() const {
-		return threads[ThreadPool::getThreadId()];
+		const auto id = static_cast<size_t>(ThreadPool::getThreadId());
+		return threads[std::min(id, threads.size() - 1)];
+	}
+
+	uint64_t scheduleEvent(uint32_t delay, TaskFunction &&f, std::string_view context, bool cycle, bool log = true) {
+		return scheduleEvent(ScheduledTaskPool::makeShared(std::move(f), context, delay, cycle, log));
 	}
 
-	uint64_t scheduleEvent(uint32_t delay, std::function<void(void)> &&f, std::string_view context, bool cycle, bool log = true) {
-		return scheduleEvent(std::make_shared<Task>(std::move(f), context, delay, cycle, log));
+	bool isDispatcherThread() const {
+		return ThreadPool::getThreadId() == dispatcherThreadId;
 	}
 
 	void init();
@@ -167,6 +208,15 @@ private:
 	inline void executeEvents(const TaskGroup startGroup = TaskGroup::Walk);
 	inline void executeScheduledEvents();
 
+	inline bool executeTask(const Task &task);
+
+	// The queue delay is only measured while profiling, so idle profilers cost no clock read per task
+	void setReadyAt(Task &task, uint32_t delay = 0) const {
+		if (profiler.isEnabled()) {
+			task.readyAt = TaskProfiler::now() + delay * 1000ll;
+		}
+	}
+
 	inline void executeSerialEvents(const uint8_t groupId);
 	inline void executeParallelEvents(const uint8_t groupId);
 	inline std::chrono::milliseconds timeUntilNextScheduledTask() const;
@@ -176,7 +226,15 @@ private:
 		for (uint_fast8_t i = 0; i < static_cast<uint8_t>(TaskGroup::Last); ++i) {
 			if (!m_tasks[i].empty()) {
 				hasPendingTasks = true;
-				break;
+				return;
+			}
+		}
+
+		// Drains are bounded, tasks pushed while merging wait for the next cycle
+		for (const auto &thread : threads) {
+			if (!thread->scheduledTasks.empty() || std::ranges::any_of(thread->tasks, [](const auto &tasks) { return !tasks.empty(); })) {
+				hasPendingTasks = true;
+				return;
 			}
 		}
 	}
@@ -188,22 +246,6 @@ private:
 		}
 	}
 
-	std::vector<std::pair<uint64_t, uint64_t>> generatePartition(size_t size) const {
-		if (size == 0) {
-			return {};
-		}
-
-		std::vector<std::pair<uint64_t, uint64_t>> list;
-		list.reserve(threadPool.get_thread_count());
-
-		const auto size_per_block = std::ceil(size / static_cast<float>(threadPool.get_thread_count()));
-		for (uint_fast64_t i = 0; i < size; i += size_per_block) {
-			list.emplace_back(i, std::min<uint64_t>(size, i + size_per_block));
-		}
-
-		return list;
-	}
-
 	uint_fast64_t dispatcherCycle = 0;
 
 	ThreadPool &threadPool;
@@ -213,24 +255,35 @@ private:
 
 	// Thread Events
 	struct ThreadTask {
-		ThreadTask() {
-			for (auto &task : tasks) {
-				task.reserve(2000);
-			}
-			scheduledTasks.reserve(2000);
+		// Tasks are stored inline in the rings, every thread allocates them all up front.
+		// A thread rarely queues that many in a cycle, bursts spill into the locked overflow
+		static constexpr uint32_t TASK_QUEUE_CAPACITY = 256;
+		static constexpr uint32_t SCHEDULED_QUEUE_CAPACITY = 2048;
+
+		ThreadTask() :
+			tasks(createQueues(std::make_index_sequence<static_cast<uint8_t>(TaskGroup::Last)>())) { }
+
+		// Pushed by the threads of the slot, drained by the dispatcher without locking
+		std::array<LockfreeMPSCQueue<Task>, static_cast<uint8_t>(TaskGroup::Last)> tasks;
+		LockfreeMPSCQueue<std::shared_ptr<Task>> scheduledTasks { SCHEDULED_QUEUE_CAPACITY };
+
+	private:
+		template <size_t... Groups>
+		static std::array<LockfreeMPSCQueue<Task>, sizeof...(Groups)> createQueues(std::index_sequence<Groups...>) {
+			return { LockfreeMPSCQueue<Task>((static_cast<void>(Groups), TASK_QUEUE_CAPACITY))... };
 		}
-
-		std::array<std::vector<Task>, static_cast<uint8_t>(TaskGroup::Last)> tasks;
-		std::vector<std::shared_ptr<Task>> scheduledTasks;
-		std::mutex mutex;
 	};
 
 	std::vector<std::unique_ptr<ThreadTask>> threads;
 
 	// Main Events
 	std::array<std::vector<Task>, static_cast<uint8_t>(TaskGroup::Last)> m_tasks;
-	phmap::btree_multiset<std::shared_ptr<Task>, Task::Compare> scheduledTasks {};
+	TimingWheel<Task> scheduledTasks { SCHEDULER_MINTICKS };
 	phmap::parallel_flat_hash_map_m<uint64_t, std::shared_ptr<Task>> scheduledTasksRef {};
+	int16_t dispatcherThreadId = -1;
+
+	std::array<ParallelGroupStats, static_cast<uint8_t>(TaskGroup::Last)> parallelStats {};
+	TaskProfiler profiler { std::chrono::milliseconds(SCHEDULER_MINTICKS) };
 
 	bool asyncWaitDisabled = false;
 
@@ -9,15 +9,26 @@
 
 #pragma once
 
+#include "game/scheduling/task_function.hpp"
+#include "game/scheduling/timing_wheel.hpp"
+#include "utils/object_pool.hpp"
+
 class Dispatcher;
 
 class Task {
 public:
-	Task(uint32_t expiresAfterMs, std::function<void(void)> &&f, std::string_view context);
+	// Empty task, used by the dispatcher queues, it is never executed
+	Task() = default;
+
+	/**
+	 * @param context Name of the task, it must outlive the task (callers pass string literals).
+	 */
+	Task(uint32_t expiresAfterMs, TaskFunction &&f, std::string_view context);
 
-	Task(std::function<void(void)> &&f, std::string_view context, uint32_t delay, bool cycle = false, bool log = true);
+	Task(TaskFunction &&f, std::string_view context, uint32_t delay, bool cycle = false, bool log = true);
 
-	~Task() = default;
+	Task(Task &&) noexcept = default;
+	Task &operator=(Task &&) noexcept = default;
 
 	uint64_t getId() {
 		if (id == 0) {
@@ -94,21 +105,26 @@ private:
 		return tasksContext.contains(context);
 	}
 
-	struct Compare {
-		bool operator()(const std::shared_ptr<Task> &a, const std::shared_ptr<Task> &b) const {
-			return a->getTime() < b->getTime();
-		}
-	};
-
-	std::function<void(void)> func;
-	std::string context;
+	TaskFunction func;
+	std::string_view context;
 
 	int64_t utime = 0;
 	int64_t expiration = 0;
+	// TaskProfiler clock, in microseconds, from which the task is ready to run, only set while profiling
+	int64_t readyAt = 0;
 	uint64_t id = 0;
 	uint32_t delay = 0;
 	bool cycle = false;
 	bool log = true;
 
+	TimingWheelHook<Task> timingWheelHook;
+
 	friend class Dispatcher;
+	friend class TimingWheel<Task>;
 };
+
+/**
+ * Scheduled tasks are shared, this pool recycles the task and its control block
+ * as a single allocation.
+ */
+using ScheduledTaskPool = ObjectPool<Task, 8192>;
@@ -0,0 +1,282 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "game/scheduling/task_profiler.hpp"
+
+#include "utils/tools.hpp"
+
+std::atomic_uint32_t TaskProfiler::lastInstanceId = 0;
+
+namespace {
+	// Profiler whose tick is running on this thread, set by beginTick
+	thread_local const TaskProfiler* tickProfiler = nullptr;
+
+	double toMs(uint64_t us) {
+		return static_cast<double>(us) / 1000.0;
+	}
+
+	int64_t currentMinute() {
+		return OTSYS_TIME(true) / 60'000;
+	}
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+	const auto samples = getCount();
+	if (samples == 0) {
+		return 0;
+	}
+
+	const auto target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(samples * std::clamp(percentile, 0.0, 100.0) / 100.0)), 1);
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BUCKETS; ++i) {
+		seen += buckets[i].load(std::memory_order_relaxed);
+		if (seen >= target) {
+			return std::min(bucketHighestValue(i), getMax());
+		}
+	}
+	return getMax();
+}
+
+void LatencyHistogram::reset() {
+	for (auto &bucket : buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	count.store(0, std::memory_order_relaxed);
+	total.store(0, std::memory_order_relaxed);
+	max.store(0, std::memory_order_relaxed);
+}
+
+TaskProfiler::ContextProfile &TaskProfiler::getContext(std::string_view context) {
+	// Keys are views of the profile names, so they live as long as the profiles
+	thread_local uint32_t cacheOwner = 0;
+	thread_local phmap::flat_hash_map<std::string_view, ContextProfile*> cache;
+
+	if (cacheOwner != instanceId) {
+		cache.clear();
+		cacheOwner = instanceId;
+	}
+
+	if (const auto it = cache.find(context); it != cache.end()) {
+		return *it->second;
+	}
+
+	std::scoped_lock lock(contextsMutex);
+	auto it = std::ranges::find_if(contexts, [context](const auto &profile) {
+		return profile->name == context;
+	});
+
+	if (it == contexts.end()) {
+		it = contexts.insert(contexts.end(), std::make_unique<ContextProfile>(context));
+	}
+
+	auto &profile = **it;
+	cache.emplace(profile.name, &profile);
+	return profile;
+}
+
+void TaskProfiler::record(std::string_view context, int64_t queueDelay, int64_t execution) {
+	const auto delayUs = static_cast<uint64_t>(std::max<int64_t>(queueDelay, 0));
+	const auto executionUs = static_cast<uint64_t>(std::max<int64_t>(execution, 0));
+
+	auto &profile = getContext(context);
+	profile.execution.record(executionUs);
+	profile.queueDelay.record(delayUs);
+
+	if (tickProfiler == this) {
+		++tickTasks;
+		if (executionUs > tickSlowestExecution) {
+			tickSlowestExecution = executionUs;
+			tickSlowestContext = &profile;
+		}
+	}
+
+	if (executionUs >= SLOW_TASK_MIN_US) {
+		recordSlowTask(profile, delayUs, executionUs);
+	}
+}
+
+void TaskProfiler::recordSlowTask(const ContextProfile &profile, uint64_t queueDelay, uint64_t execution) {
+	const auto minute = currentMinute();
+	if (minute == slowTaskMinute.load(std::memory_order_acquire) && execution <= slowTaskThreshold.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	std::scoped_lock lock(slowTasksMutex);
+	auto &window = slowTaskWindows[static_cast<size_t>(minute) % SLOW_TASK_MINUTES];
+	if (window.minute != minute) {
+		window = SlowTaskWindow { .minute = minute };
+		slowTaskThreshold.store(SLOW_TASK_MIN_US, std::memory_order_relaxed);
+		slowTaskMinute.store(minute, std::memory_order_release);
+	}
+
+	const SlowTask task { profile.name, OTSYS_TIME(true), execution, queueDelay };
+	if (window.size < window.tasks.size()) {
+		window.tasks[window.size++] = task;
+	} else {
+		// Replaces the fastest of the slow tasks
+		auto fastest = std::ranges::min_element(window.tasks, {}, &SlowTask::execution);
+		if (fastest->execution >= execution) {
+			return;
+		}
+		*fastest = task;
+	}
+
+	if (window.size == window.tasks.size()) {
+		slowTaskThreshold.store(std::ranges::min_element(window.tasks, {}, &SlowTask::execution)->execution, std::memory_order_relaxed);
+	}
+}
+
+void TaskProfiler::beginTick() {
+	tickProfiler = this;
+	tickStart = now();
+	tickTasks = 0;
+	tickSlowestContext = nullptr;
+	tickSlowestExecution = 0;
+}
+
+void TaskProfiler::endTick() {
+	tickProfiler = nullptr;
+
+	const auto end = now();
+	const auto duration = static_cast<uint64_t>(end - tickStart);
+	ticks.fetch_add(1, std::memory_order_relaxed);
+	tickDuration.record(duration);
+
+	if (duration <= tickBudget) {
+		return;
+	}
+
+	overrunCount.fetch_add(1, std::memory_order_relaxed);
+	const std::string_view slowestContext = tickSlowestContext ? std::string_view { tickSlowestContext->name } : std::string_view { "none" };
+
+	{
+		std::scoped_lock lock(overrunsMutex);
+		overruns[overrunsHead++ % overruns.size()] = { OTSYS_TIME(true), duration, tickTasks, slowestContext, tickSlowestExecution };
+	}
+
+	// At most one warning per second, a sustained overload would flood the log otherwise
+	if (end - lastOverrunLog < 1'000'000) {
+		++suppressedOverruns;
+		return;
+	}
+
+	g_logger().warn(
+		"[{}] Dispatcher tick took {:.2f} ms (budget {:.2f} ms), {} tasks, slowest: '{}' ({:.2f} ms){}",
+		__FUNCTION__, toMs(duration), toMs(tickBudget), tickTasks, slowestContext, toMs(tickSlowestExecution),
+		suppressedOverruns > 0 ? fmt::format(", {} overruns not logged", suppressedOverruns) : ""
+	);
+	lastOverrunLog = end;
+	suppressedOverruns = 0;
+}
+
+std::string TaskProfiler::report(size_t limit) const {
+	std::vector<const ContextProfile*> profiles;
+	{
+		std::scoped_lock lock(contextsMutex);
+		profiles.reserve(contexts.size());
+		for (const auto &profile : contexts) {
+			profiles.emplace_back(profile.get());
+		}
+	}
+
+	std::ranges::sort(profiles, std::greater {}, [](const ContextProfile* profile) {
+		return profile->execution.getTotal();
+	});
+
+	std::string result;
+	auto out = std::back_inserter(result);
+
+	fmt::format_to(
+		out, "Dispatcher profile of the last {} seconds, times in ms\n", (now() - startedAt.load(std::memory_order_relaxed)) / 1'000'000
+	);
+	fmt::format_to(
+		out, "Ticks: {}, over budget ({:.0f} ms): {}, p50 {:.2f}, p99 {:.2f}, max {:.2f}\n\n",
+		ticks.load(std::memory_order_relaxed), toMs(tickBudget), overrunCount.load(std::memory_order_relaxed),
+		toMs(tickDuration.getPercentile(50)), toMs(tickDuration.getPercentile(99)), toMs(tickDuration.getMax())
+	);
+
+	fmt::format_to(out, "Contexts by total execution time:\n");
+	for (const auto* profile : profiles | std::views::take(limit)) {
+		const auto &execution = profile->execution;
+		const auto &delay = profile->queueDelay;
+		if (execution.getCount() == 0) {
+			break;
+		}
+
+		fmt::format_to(
+			out, "{}: {} runs, total {:.2f}, exec avg {:.3f} p50 {:.3f} p99 {:.3f} max {:.3f}, delay p50 {:.3f} p99 {:.3f} max {:.3f}\n",
+			profile->name, execution.getCount(), toMs(execution.getTotal()),
+			toMs(execution.getAverage()), toMs(execution.getPercentile(50)), toMs(execution.getPercentile(99)), toMs(execution.getMax()),
+			toMs(delay.getPercentile(50)), toMs(delay.getPercentile(99)), toMs(delay.getMax())
+		);
+	}
+
+	{
+		std::scoped_lock lock(slowTasksMutex);
+		auto windows = slowTaskWindows;
+		std::ranges::sort(windows, std::greater {}, &SlowTaskWindow::minute);
+
+		fmt::format_to(out, "\nSlowest tasks per minute:\n");
+		for (auto &window : windows) {
+			if (window.size == 0) {
+				continue;
+			}
+
+			const auto tasks = std::span(window.tasks).first(window.size);
+			std::ranges::sort(tasks, std::greater {}, &SlowTask::execution);
+			fmt::format_to(out, "[{}]\n", formatDate(window.minute * 60));
+			for (const auto &task : tasks) {
+				fmt::format_to(out, "  {}: exec {:.2f}, delay {:.2f}\n", task.context, toMs(task.execution), toMs(task.queueDelay));
+			}
+		}
+	}
+
+	{
+		std::scoped_lock lock(overrunsMutex);
+		fmt::format_to(out, "\nLast ticks over budget:\n");
+		const auto stored = std::min(overrunsHead, overruns.size());
+		for (size_t i = 1; i <= stored; ++i) {
+			const auto &overrun = overruns[(overrunsHead - i) % overruns.size()];
+			fmt::format_to(
+				out, "[{}] {:.2f} ms, {} tasks, slowest '{}' {:.2f} ms\n",
+				formatDate(overrun.time / 1000), toMs(overrun.duration), overrun.tasks, overrun.slowestContext, toMs(overrun.slowestExecution)
+			);
+		}
+	}
+
+	return result;
+}
+
+void TaskProfiler::reset() {
+	{
+		std::scoped_lock lock(contextsMutex);
+		for (const auto &profile : contexts) {
+			profile->execution.reset();
+			profile->queueDelay.reset();
+		}
+	}
+
+	{
+		std::scoped_lock lock(slowTasksMutex);
+		slowTaskWindows = {};
+		slowTaskMinute.store(-1, std::memory_order_release);
+		slowTaskThreshold.store(SLOW_TASK_MIN_US, std::memory_order_relaxed);
+	}
+
+	{
+		std::scoped_lock lock(overrunsMutex);
+		overruns = {};
+		overrunsHead = 0;
+	}
+
+	ticks.store(0, std::memory_order_relaxed);
+	overrunCount.store(0, std::memory_order_relaxed);
+	tickDuration.reset();
+	startedAt.store(now(), std::memory_order_relaxed);
+}
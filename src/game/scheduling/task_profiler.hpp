@@ -0,0 +1,243 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Lock-free log-linear histogram of durations in microseconds (HDR style).
+ *
+ * Every power of two is split in 8 linear sub-buckets, so any recorded value is
+ * reported with less than 12.5% error, from 1 µs up to ~71 minutes.
+ * Recording is a few relaxed atomic increments, safe from any thread.
+ */
+class LatencyHistogram {
+public:
+	static constexpr uint8_t SUB_BUCKET_BITS = 3;
+	static constexpr uint64_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+	static constexpr uint64_t MAX_VALUE = std::numeric_limits<uint32_t>::max();
+	static constexpr size_t BUCKETS = (32 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+	void record(uint64_t value) {
+		value = std::min(value, MAX_VALUE);
+		buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		total.fetch_add(value, std::memory_order_relaxed);
+
+		auto currentMax = max.load(std::memory_order_relaxed);
+		while (value > currentMax && !max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) { }
+	}
+
+	/**
+	 * @param percentile Between 0 and 100.
+	 * @return The highest value of the bucket holding the percentile, capped by the max recorded value.
+	 */
+	[[nodiscard]] uint64_t getPercentile(double percentile) const;
+
+	[[nodiscard]] uint64_t getCount() const {
+		return count.load(std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] uint64_t getTotal() const {
+		return total.load(std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] uint64_t getMax() const {
+		return max.load(std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] uint64_t getAverage() const {
+		const auto samples = getCount();
+		return samples == 0 ? 0 : getTotal() / samples;
+	}
+
+	void reset();
+
+	static constexpr size_t bucketIndex(uint64_t value) {
+		if (value < SUB_BUCKETS) {
+			return value;
+		}
+
+		const auto magnitude = static_cast<uint64_t>(std::bit_width(value)) - 1;
+		const auto shift = magnitude - SUB_BUCKET_BITS;
+		const auto subBucket = (value >> shift) & (SUB_BUCKETS - 1);
+		return (shift + 1) * SUB_BUCKETS + subBucket;
+	}
+
+	static constexpr uint64_t bucketHighestValue(size_t index) {
+		if (index < SUB_BUCKETS) {
+			return index;
+		}
+
+		const auto shift = index / SUB_BUCKETS - 1;
+		const auto subBucket = index % SUB_BUCKETS;
+		return ((SUB_BUCKETS + subBucket + 1) << shift) - 1;
+	}
+
+private:
+	std::array<std::atomic_uint64_t, BUCKETS> buckets {};
+	std::atomic_uint64_t count = 0;
+	std::atomic_uint64_t total = 0;
+	std::atomic_uint64_t max = 0;
+};
+
+/**
+ * @brief Opt-in profiler of the tasks executed by the Dispatcher.
+ *
+ * Off by default, it is turned on and off at runtime with
+ * Game.setDispatcherProfiling. While off, the dispatcher reads no clock and
+ * records nothing. While on, it keeps, per task context, histograms of the execution time and of the queue
+ * delay (from the moment a task is ready to run until it starts), the slowest
+ * tasks of the last minutes and the dispatcher ticks that ran over budget.
+ *
+ * Recording never blocks: contexts are resolved through a thread local cache
+ * and histograms are atomic. A lock is only taken the first time a thread sees
+ * a context, or when a task is slow enough to enter the slow task log.
+ */
+class TaskProfiler {
+public:
+	static constexpr size_t SLOW_TASKS_PER_MINUTE = 10;
+	static constexpr size_t SLOW_TASK_MINUTES = 15;
+	static constexpr size_t TICK_OVERRUNS = 32;
+	// Tasks faster than this never enter the slow task log
+	static constexpr uint64_t SLOW_TASK_MIN_US = 1'000;
+
+	struct ContextProfile {
+		explicit ContextProfile(std::string_view name) :
+			name(name) { }
+
+		const std::string name;
+		LatencyHistogram execution;
+		LatencyHistogram queueDelay;
+	};
+
+	struct SlowTask {
+		std::string_view context;
+		int64_t time = 0;
+		uint64_t execution = 0;
+		uint64_t queueDelay = 0;
+	};
+
+	struct TickOverrun {
+		int64_t time = 0;
+		uint64_t duration = 0;
+		uint32_t tasks = 0;
+		std::string_view slowestContext;
+		uint64_t slowestExecution = 0;
+	};
+
+	explicit TaskProfiler(std::chrono::milliseconds tickBudget) :
+		tickBudget(std::chrono::duration_cast<std::chrono::microseconds>(tickBudget).count()), instanceId(++lastInstanceId) { }
+
+	// Ensures that we don't accidentally copy it
+	TaskProfiler(const TaskProfiler &) = delete;
+	TaskProfiler &operator=(const TaskProfiler &) = delete;
+
+	/**
+	 * @return Monotonic time in microseconds, the clock used by every timestamp given to the profiler.
+	 */
+	static int64_t now() {
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	[[nodiscard]] bool isEnabled() const {
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	void setEnabled(bool value) {
+		enabled.store(value, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Records an executed task, from any thread.
+	 * @param queueDelay Microseconds the task waited after being ready to run.
+	 * @param execution Microseconds the task took to execute.
+	 */
+	void record(std::string_view context, int64_t queueDelay, int64_t execution);
+
+	/**
+	 * @brief Marks the start of a dispatcher tick, must be called by the dispatcher thread.
+	 */
+	void beginTick();
+
+	/**
+	 * @brief Closes the current tick and logs it when it ran over budget.
+	 */
+	void endTick();
+
+	/**
+	 * @brief Human readable report of the contexts with the highest total execution time,
+	 * the slow task log and the recent tick overruns.
+	 * @param limit Maximum number of contexts listed.
+	 */
+	[[nodiscard]] std::string report(size_t limit) const;
+
+	/**
+	 * @brief Clears every histogram, the slow task log and the tick overruns.
+	 * Known contexts are kept, so cached lookups stay valid.
+	 */
+	void reset();
+
+private:
+	struct SlowTaskWindow {
+		int64_t minute = -1;
+		std::array<SlowTask, SLOW_TASKS_PER_MINUTE> tasks {};
+		size_t size = 0;
+	};
+
+	ContextProfile &getContext(std::string_view context);
+	void recordSlowTask(const ContextProfile &profile, uint64_t queueDelay, uint64_t execution);
+
+	static std::atomic_uint32_t lastInstanceId;
+
+	// Off by default, enabled on demand through Game.setDispatcherProfiling
+	std::atomic_bool enabled = false;
+	const uint64_t tickBudget;
+
+	// Profiles are never removed, cached pointers stay valid for the whole run
+	mutable std::mutex contextsMutex;
+	std::vector<std::unique_ptr<ContextProfile>> contexts;
+	// Identifies this profiler in the thread local caches
+	const uint32_t instanceId;
+
+	// Slow task log, one window per minute
+	mutable std::mutex slowTasksMutex;
+	std::array<SlowTaskWindow, SLOW_TASK_MINUTES> slowTaskWindows {};
+	std::atomic_int64_t slowTaskMinute = -1;
+	std::atomic_uint64_t slowTaskThreshold = SLOW_TASK_MIN_US;
+
+	// Current tick, only touched by the dispatcher thread
+	int64_t tickStart = 0;
+	uint32_t tickTasks = 0;
+	const ContextProfile* tickSlowestContext = nullptr;
+	uint64_t tickSlowestExecution = 0;
+	int64_t lastOverrunLog = 0;
+	uint32_t suppressedOverruns = 0;
+
+	mutable std::mutex overrunsMutex;
+	std::array<TickOverrun, TICK_OVERRUNS> overruns {};
+	size_t overrunsHead = 0;
+	std::atomic_uint64_t ticks = 0;
+	std::atomic_uint64_t overrunCount = 0;
+	LatencyHistogram tickDuration;
+
+	std::atomic_int64_t startedAt = now();
+};
@@ -0,0 +1,353 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Intrusive links used by TimingWheel.
+ *
+ * Any type scheduled in a TimingWheel must expose a member named
+ * `timingWheelHook` of this type and a `getTime()` method returning the
+ * absolute expiration time in milliseconds.
+ */
+template <typename T>
+struct TimingWheelHook {
+	static constexpr uint16_t NOT_LINKED = std::numeric_limits<uint16_t>::max();
+
+	[[nodiscard]] bool isLinked() const {
+		return bucket != NOT_LINKED;
+	}
+
+	// Owning reference, held while the node sits in a wheel slot.
+	std::shared_ptr<T> self;
+	T* prev = nullptr;
+	T* next = nullptr;
+	uint64_t sequence = 0;
+	uint16_t bucket = NOT_LINKED;
+};
+
+/**
+ * @brief Hierarchical timing wheel with O(1) insert and erase.
+ *
+ * Time is split into ticks of `tickMs` milliseconds. Four levels of 64 slots
+ * cover ~9.7 days with 50 ms ticks; later nodes are parked in the last level and
+ * re-cascaded until they fit. Nodes whose tick is reached are moved to a small
+ * ready heap ordered by their exact time, so sub-tick ordering is preserved.
+ *
+ * The wheel is not thread-safe, it must only be touched by its owner thread.
+ */
+template <typename T>
+class TimingWheel {
+public:
+	explicit TimingWheel(int64_t tickMs) :
+		tickMs(tickMs) { }
+
+	~TimingWheel() {
+		clear();
+	}
+
+	// Ensures that we don't accidentally copy it
+	TimingWheel(const TimingWheel &) = delete;
+	TimingWheel &operator=(const TimingWheel &) = delete;
+
+	/**
+	 * @brief Aligns an empty wheel to the given time.
+	 * @param now Current time in milliseconds.
+	 */
+	void reset(int64_t now) {
+		clear();
+		wheelTick = now / tickMs;
+	}
+
+	void insert(std::shared_ptr<T> node) {
+		if (!node || node->timingWheelHook.isLinked()) {
+			return;
+		}
+
+		++count;
+		place(std::move(node));
+	}
+
+	/**
+	 * @brief Removes a node before it expires.
+	 * @return false if the node was not scheduled in this wheel.
+	 */
+	bool erase(T* node) {
+		auto &hook = node->timingWheelHook;
+		if (!hook.isLinked()) {
+			return false;
+		}
+
+		--count;
+		if (hook.bucket == READY_BUCKET) {
+			// The heap entry keeps the node alive and is discarded when popped
+			hook.bucket = TimingWheelHook<T>::NOT_LINKED;
+			return true;
+		}
+
+		// Holds the wheel's reference so the node outlives its own unlinking
+		const auto owner = unlink(node);
+		return true;
+	}
+
+	/**
+	 * @brief Expires every node with time <= now, in time order.
+	 *
+	 * The callback may insert or erase nodes, nodes inserted while advancing are
+	 * only expired on the next call.
+	 */
+	template <typename F>
+	void advance(int64_t now, F &&f) {
+		const auto nowTick = now / tickMs;
+		if (linked == 0) {
+			wheelTick = std::max(wheelTick, nowTick + 1);
+		}
+
+		while (wheelTick <= nowTick) {
+			if ((wheelTick & SLOT_MASK) != 0 && occupied[0] == 0) {
+				// Nothing can expire until the next cascade boundary
+				wheelTick = std::min((wheelTick | SLOT_MASK) + 1, nowTick + 1);
+				continue;
+			}
+			processTick();
+		}
+
+		// Anything pushed after this point was inserted by the callback
+		const auto sequenceLimit = nextSequence;
+		while (!ready.empty()) {
+			const auto &top = ready.front();
+			const auto &hook = top.node->timingWheelHook;
+			const bool stale = hook.bucket != READY_BUCKET || hook.sequence != top.sequence;
+			if (!stale && (top.time > now || top.sequence >= sequenceLimit)) {
+				break;
+			}
+
+			std::ranges::pop_heap(ready, ReadyCompare {});
+			auto node = std::move(ready.back().node);
+			ready.pop_back();
+
+			if (stale) {
+				continue;
+			}
+
+			node->timingWheelHook.bucket = TimingWheelHook<T>::NOT_LINKED;
+			--count;
+			f(node);
+		}
+	}
+
+	/**
+	 * @return The earliest time a node may expire, or int64_t max if empty.
+	 * It may be earlier than the real expiration, never later.
+	 */
+	[[nodiscard]] int64_t nextExpiration() const {
+		int64_t next = std::numeric_limits<int64_t>::max();
+		if (!ready.empty()) {
+			next = ready.front().time;
+		}
+
+		if (linked == 0) {
+			return next;
+		}
+
+		int64_t tick = std::numeric_limits<int64_t>::max();
+		if (occupied[0] != 0) {
+			const auto rotated = std::rotr(occupied[0], static_cast<int>(wheelTick & SLOT_MASK));
+			tick = wheelTick + std::countr_zero(rotated);
+		}
+
+		if ((occupied[1] | occupied[2] | occupied[3]) != 0) {
+			tick = std::min(tick, (wheelTick + SLOT_MASK) & ~SLOT_MASK);
+		}
+
+		return std::min(next, tick * tickMs);
+	}
+
+	[[nodiscard]] size_t size() const {
+		return count;
+	}
+
+	[[nodiscard]] bool empty() const {
+		return count == 0;
+	}
+
+	void clear() {
+		for (size_t bucket = 0; bucket < slots.size(); ++bucket) {
+			while (slots[bucket].head) {
+				// Keeps the task alive until the slot head has been advanced past it
+				const auto owner = unlink(slots[bucket].head);
+			}
+		}
+
+		for (auto &entry : ready) {
+			if (entry.node->timingWheelHook.sequence == entry.sequence) {
+				entry.node->timingWheelHook.bucket = TimingWheelHook<T>::NOT_LINKED;
+			}
+		}
+
+		ready.clear();
+		count = 0;
+	}
+
+private:
+	static constexpr uint8_t LEVELS = 4;
+	static constexpr uint8_t SLOT_BITS = 6;
+	static constexpr int64_t SLOTS = 1 << SLOT_BITS;
+	static constexpr int64_t SLOT_MASK = SLOTS - 1;
+	static constexpr int64_t MAX_DELTA = int64_t { 1 } << (SLOT_BITS * LEVELS);
+	static constexpr uint16_t READY_BUCKET = LEVELS * SLOTS;
+
+	struct Slot {
+		T* head = nullptr;
+		T* tail = nullptr;
+	};
+
+	struct ReadyEntry {
+		int64_t time;
+		uint64_t sequence;
+		std::shared_ptr<T> node;
+	};
+
+	// Min-heap on (time, sequence), so equal times keep insertion order
+	struct ReadyCompare {
+		bool operator()(const ReadyEntry &a, const ReadyEntry &b) const {
+			return a.time != b.time ? a.time > b.time : a.sequence > b.sequence;
+		}
+	};
+
+	void place(std::shared_ptr<T> &&node) {
+		auto tick = node->getTime() / tickMs;
+		if (wheelTick < 0) {
+			wheelTick = tick;
+		}
+
+		if (tick < wheelTick) {
+			pushReady(std::move(node));
+			return;
+		}
+
+		auto delta = tick - wheelTick;
+		if (delta >= MAX_DELTA) {
+			// Parked in the last level, it is placed again when that slot cascades
+			tick = wheelTick + MAX_DELTA - 1;
+			delta = MAX_DELTA - 1;
+		}
+
+		uint8_t level = 0;
+		while (delta >= (int64_t { 1 } << (SLOT_BITS * (level + 1)))) {
+			++level;
+		}
+
+		const auto index = (tick >> (SLOT_BITS * level)) & SLOT_MASK;
+		link(std::move(node), static_cast<uint16_t>(level * SLOTS + index));
+	}
+
+	void link(std::shared_ptr<T> &&node, uint16_t bucket) {
+		auto &slot = slots[bucket];
+		auto* raw = node.get();
+		auto &hook = raw->timingWheelHook;
+
+		hook.self = std::move(node);
+		hook.bucket = bucket;
+		hook.next = nullptr;
+		hook.prev = slot.tail;
+
+		if (slot.tail) {
+			slot.tail->timingWheelHook.next = raw;
+		} else {
+			slot.head = raw;
+			occupied[bucket / SLOTS] |= uint64_t { 1 } << (bucket % SLOTS);
+		}
+
+		slot.tail = raw;
+		++linked;
+	}
+
+	std::shared_ptr<T> unlink(T* node) {
+		auto &hook = node->timingWheelHook;
+		auto &slot = slots[hook.bucket];
+
+		if (hook.prev) {
+			hook.prev->timingWheelHook.next = hook.next;
+		} else {
+			slot.head = hook.next;
+		}
+
+		if (hook.next) {
+			hook.next->timingWheelHook.prev = hook.prev;
+		} else {
+			slot.tail = hook.prev;
+		}
+
+		if (!slot.head) {
+			occupied[hook.bucket / SLOTS] &= ~(uint64_t { 1 } << (hook.bucket % SLOTS));
+		}
+
+		hook.prev = nullptr;
+		hook.next = nullptr;
+		hook.bucket = TimingWheelHook<T>::NOT_LINKED;
+		--linked;
+		return std::move(hook.self);
+	}
+
+	void pushReady(std::shared_ptr<T> &&node) {
+		auto &hook = node->timingWheelHook;
+		hook.bucket = READY_BUCKET;
+		hook.sequence = nextSequence++;
+
+		const auto time = node->getTime();
+		ready.emplace_back(time, hook.sequence, std::move(node));
+		std::ranges::push_heap(ready, ReadyCompare {});
+	}
+
+	void cascade(uint8_t level, int64_t index) {
+		const auto bucket = static_cast<uint16_t>(level * SLOTS + index);
+		while (slots[bucket].head) {
+			place(unlink(slots[bucket].head));
+		}
+	}
+
+	void processTick() {
+		const auto tick = wheelTick;
+		if ((tick & SLOT_MASK) == 0) {
+			for (uint8_t level = LEVELS - 1; level > 0; --level) {
+				// A level only cascades when all the levels below it wrapped around
+				const auto lowerMask = (int64_t { 1 } << (SLOT_BITS * level)) - 1;
+				if ((tick & lowerMask) == 0) {
+					cascade(level, (tick >> (SLOT_BITS * level)) & SLOT_MASK);
+				}
+			}
+		}
+
+		const auto bucket = static_cast<uint16_t>(tick & SLOT_MASK);
+		while (slots[bucket].head) {
+			pushReady(unlink(slots[bucket].head));
+		}
+
+		++wheelTick;
+	}
+
+	std::array<Slot, LEVELS * SLOTS> slots {};
+	std::array<uint64_t, LEVELS> occupied {};
+	std::vector<ReadyEntry> ready;
+
+	int64_t tickMs;
+	int64_t wheelTick = -1;
+	uint64_t nextSequence = 0;
+	size_t linked = 0;
+	size_t count = 0;
+};
@@ -0,0 +1,109 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Index ranges shared by the participants of a parallel loop.
+ *
+ * Every participant owns a [begin, end) range packed in a single atomic word.
+ * The owner takes chunks from the front of its range and, once it runs dry,
+ * steals the back half of another participant's range. A slow item only delays
+ * the participant running it, the rest of the work migrates to whoever is free.
+ */
+class WorkStealingRanges {
+public:
+	WorkStealingRanges(size_t participants, uint32_t size) :
+		count(participants), ranges(std::make_unique<Range[]>(participants)) {
+		const auto perParticipant = size / participants;
+		const auto extra = size % participants;
+
+		uint32_t begin = 0;
+		for (size_t i = 0; i < participants; ++i) {
+			const auto end = static_cast<uint32_t>(begin + perParticipant + (i < extra ? 1 : 0));
+			ranges[i].bounds.store(pack(begin, end), std::memory_order_relaxed);
+			begin = end;
+		}
+	}
+
+	// Ensures that we don't accidentally copy it
+	WorkStealingRanges(const WorkStealingRanges &) = delete;
+	WorkStealingRanges &operator=(const WorkStealingRanges &) = delete;
+
+	/**
+	 * @brief Takes up to `chunk` indexes from the front of the participant's own range.
+	 * @return false if the range is empty.
+	 */
+	bool pop(size_t participant, uint32_t chunk, uint32_t &begin, uint32_t &end) {
+		auto &bounds = ranges[participant].bounds;
+		auto current = bounds.load(std::memory_order_acquire);
+		while (true) {
+			const auto [first, last] = unpack(current);
+			if (first >= last) {
+				return false;
+			}
+
+			const auto next = std::min(last, first + chunk);
+			if (bounds.compare_exchange_weak(current, pack(next, last), std::memory_order_acq_rel)) {
+				begin = first;
+				end = next;
+				return true;
+			}
+		}
+	}
+
+	/**
+	 * @brief Moves the back half of the first non-empty victim range into the thief's range.
+	 *
+	 * The thief's own range must be empty.
+	 * @return false if every range is empty, meaning there is nothing left to run.
+	 */
+	bool steal(size_t thief) {
+		for (size_t offset = 1; offset < count; ++offset) {
+			auto &bounds = ranges[(thief + offset) % count].bounds;
+			auto current = bounds.load(std::memory_order_acquire);
+			while (true) {
+				const auto [first, last] = unpack(current);
+				if (first >= last) {
+					break;
+				}
+
+				const auto middle = first + (last - first) / 2;
+				if (bounds.compare_exchange_weak(current, pack(first, middle), std::memory_order_acq_rel)) {
+					ranges[thief].bounds.store(pack(middle, last), std::memory_order_release);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+private:
+	static constexpr uint64_t pack(uint32_t begin, uint32_t end) {
+		return (static_cast<uint64_t>(begin) << 32) | end;
+	}
+
+	static constexpr std::pair<uint32_t, uint32_t> unpack(uint64_t bounds) {
+		return { static_cast<uint32_t>(bounds >> 32), static_cast<uint32_t>(bounds) };
+	}
+
+	// One cache line per participant, so owners popping don't contend with each other
+	struct alignas(64) Range {
+		std::atomic_uint64_t bounds { 0 };
+	};
+
+	size_t count;
+	std::unique_ptr<Range[]> ranges;
+};
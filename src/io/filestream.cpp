@@ -150,6 +150,31 @@ bool FileStream::startNode(uint8_t type) {
 	return false;
 }
 
+bool FileStream::skipNode() {
+	uint32_t depth = 1;
+	while (m_pos < m_data.size()) {
+		switch (m_data[m_pos++]) {
+			case OTB::Node::ESCAPE:
+				++m_pos;
+				break;
+			case OTB::Node::START:
+				++depth;
+				break;
+			case OTB::Node::END:
+				if (--depth == 0) {
+					--m_nodes;
+					return true;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	g_logger().error("[FileStream::skipNode] - Node is not closed");
+	return false;
+}
+
 bool FileStream::endNode() {
 	if (getU8() == OTB::Node::END) {
 		--m_nodes;
@@ -27,6 +27,10 @@ public:
 
 	bool startNode(uint8_t type = 0);
 	bool endNode();
+	/**
+	 * @brief Moves past the end of the node opened by the last startNode, children included, without decoding it.
+	 */
+	bool skipNode();
 	bool isProp(uint8_t prop, bool toNext = true);
 
 	uint8_t getU8();
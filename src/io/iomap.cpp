@@ -12,6 +12,8 @@
 #include "game/movement/teleport.hpp"
 #include "game/game.hpp"
 #include "io/filestream.hpp"
+#include "io/iomap_snapshot.hpp"
+#include "lib/thread/thread_pool.hpp"
 
 /*
     OTBM_ROOTV1
@@ -37,7 +39,7 @@
     |--- OTBM_ITEM_DEF (not implemented)
 */
 
-void IOMap::loadMap(Map* map, const Position &pos) {
+void IOMap::loadMap(Map* map, const Position &pos, uint32_t threads, MapSnapshotWriter* snapshot) {
 	Benchmark bm_mapLoad;
 
 	const auto &fileByte = mio::mmap_source(map->path.string());
@@ -68,7 +70,22 @@ void IOMap::loadMap(Map* map, const Position &pos) {
 
 	if (stream.startNode(OTBM_MAP_DATA)) {
 		parseMapDataAttributes(stream, map);
-		parseTileArea(stream, *map, pos);
+
+		Benchmark bm_phase;
+		const auto &areas = indexTileAreas(stream);
+		const auto scanTime = bm_phase.duration();
+
+		bm_phase.start();
+		auto buffers = parseTileAreas(*map, begin, areas, pos, threads);
+		const auto decodeTime = bm_phase.duration();
+
+		bm_phase.start();
+		for (auto &buffer : buffers) {
+			mergeTileArea(*map, buffer, snapshot);
+		}
+		const auto mergeTime = bm_phase.duration();
+
+		g_logger().debug("Map tile areas: {} indexed in {} ms, decoded in {} ms, merged in {} ms", areas.size(), scanTime, decodeTime, mergeTime);
 		stream.endNode();
 	}
 
@@ -116,8 +133,104 @@ void IOMap::parseMapDataAttributes(FileStream &stream, Map* map) {
 	}
 }
 
-void IOMap::parseTileArea(FileStream &stream, Map &map, const Position &pos) {
-	while (stream.startNode(OTBM_TILE_AREA)) {
+std::vector<IOMap::NodeRange> IOMap::indexTileAreas(FileStream &stream) {
+	std::vector<NodeRange> areas;
+	while (true) {
+		const auto start = stream.tell();
+		if (!stream.startNode(OTBM_TILE_AREA)) {
+			break;
+		}
+
+		if (!stream.skipNode()) {
+			throw IOMapException("Could not end node.");
+		}
+		areas.emplace_back(start, stream.tell());
+	}
+	return areas;
+}
+
+std::vector<IOMap::TileAreaBuffer> IOMap::parseTileAreas(const Map &map, const char* data, const std::vector<NodeRange> &areas, const Position &pos, uint32_t threads) {
+	std::vector<TileAreaBuffer> buffers(areas.size());
+	if (threads == 0) {
+		threads = g_threadPool().get_thread_count();
+	}
+	threads = std::clamp<uint32_t>(threads, 1, std::max<size_t>(areas.size(), 1));
+
+	// Areas are small and uneven, workers pull them one by one
+	std::atomic_size_t nextArea = 0;
+	const auto decode = [&] {
+		for (size_t i = nextArea++; i < areas.size(); i = nextArea++) {
+			const auto &[start, end] = areas[i];
+			FileStream stream { data + start, data + end };
+			parseTileArea(stream, map, pos, buffers[i]);
+		}
+	};
+
+	std::vector<std::future<void>> workers;
+	workers.reserve(threads - 1);
+	for (uint32_t i = 1; i < threads; ++i) {
+		workers.emplace_back(g_threadPool().submit_task(decode));
+	}
+
+	// The calling thread decodes too, so a single thread never touches the pool
+	std::exception_ptr error;
+	try {
+		decode();
+	} catch (...) {
+		error = std::current_exception();
+		nextArea = areas.size();
+	}
+
+	for (auto &worker : workers) {
+		try {
+			worker.get();
+		} catch (...) {
+			if (!error) {
+				error = std::current_exception();
+			}
+		}
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+	return buffers;
+}
+
+void IOMap::mergeTileArea(Map &map, TileAreaBuffer &buffer, MapSnapshotWriter* snapshot) {
+	for (auto &[x, y, z, tile] : buffer.tiles) {
+		if (tile->isHouse()) {
+			if (!map.houses.addHouse(tile->houseId)) {
+				throw IOMapException(fmt::format("[x:{}, y:{}, z:{}] Could not create house id: {}", x, y, z, tile->houseId));
+			}
+
+			if (snapshot) {
+				snapshot->addHouse(tile->houseId);
+			}
+		}
+
+		if (tile->isEmpty(true)) {
+			continue;
+		}
+
+		map.setBasicTile(x, y, z, tile);
+		if (snapshot) {
+			snapshot->addTile(x, y, z, tile);
+		}
+	}
+
+	for (const auto &[zoneId, position] : buffer.zones) {
+		Zone::getZone(zoneId)->addPosition(position);
+		if (snapshot) {
+			snapshot->addZonePosition(zoneId, position);
+		}
+	}
+
+	buffer = {};
+}
+
+void IOMap::parseTileArea(FileStream &stream, const Map &map, const Position &pos, TileAreaBuffer &buffer) {
+	if (stream.startNode(OTBM_TILE_AREA)) {
 		const uint16_t base_x = stream.getU16();
 		const uint16_t base_y = stream.getU16();
 		const uint8_t base_z = stream.getU8();
@@ -137,11 +250,9 @@ void IOMap::parseTileArea(FileStream &stream, Map &map, const Position &pos) {
 			const uint16_t y = base_y + tileCoordsY + pos.y;
 			const auto z = static_cast<uint8_t>(base_z + pos.z);
 
+			// Houses are created when the buffer is merged
 			if (tileType == OTBM_HOUSETILE) {
 				tile->houseId = stream.getU32();
-				if (!map.houses.addHouse(tile->houseId)) {
-					throw IOMapException(fmt::format("[x:{}, y:{}, z:{}] Could not create house id: {}", x, y, z, tile->houseId));
-				}
 			}
 
 			if (stream.isProp(OTBM_ATTR_TILE_FLAGS)) {
@@ -213,8 +324,7 @@ void IOMap::parseTileArea(FileStream &stream, Map &map, const Position &pos) {
 							if (!zoneId) {
 								throw IOMapException(fmt::format("[x:{}, y:{}, z:{}] Invalid zone id.", x, y, z));
 							}
-							auto zone = Zone::getZone(zoneId);
-							zone->addPosition(Position(x, y, z));
+							buffer.zones.emplace_back(zoneId, Position(x, y, z));
 						}
 					} break;
 					default:
@@ -230,11 +340,7 @@ void IOMap::parseTileArea(FileStream &stream, Map &map, const Position &pos) {
 				throw IOMapException(fmt::format("[x:{}, y:{}, z:{}] Could not end node.", x, y, z));
 			}
 
-			if (tile->isEmpty(true)) {
-				continue;
-			}
-
-			map.setBasicTile(x, y, z, tile);
+			buffer.tiles.push_back({ x, y, z, tile });
 		}
 
 		if (!stream.endNode()) {
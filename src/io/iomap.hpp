@@ -20,9 +20,17 @@
 #include "creatures/npcs/spawns/spawn_npc.hpp"
 #include "game/zones/zone.hpp"
 
+class MapSnapshotWriter;
+
 class IOMap {
 public:
-	static void loadMap(Map* map, const Position &pos = Position());
+	/**
+	 * Load an OTBM map
+	 * \param pos Offset added to every tile position
+	 * \param threads Threads decoding the tile areas, 0 uses every thread of the pool
+	 * \param snapshot Receives the decoded tiles when a snapshot of the map is being built
+	 */
+	static void loadMap(Map* map, const Position &pos = Position(), uint32_t threads = 0, MapSnapshotWriter* snapshot = nullptr);
 
 	/**
 	 * Load main map monsters
@@ -150,10 +158,39 @@ public:
 	}
 
 private:
+	// Byte offsets of a node in the stream, from its start marker to past its end marker
+	using NodeRange = std::pair<uint32_t, uint32_t>;
+
+	// Tiles decoded from one tile area, in file order, waiting to be merged into the map
+	struct TileAreaBuffer {
+		struct DecodedTile {
+			uint16_t x;
+			uint16_t y;
+			uint8_t z;
+			std::shared_ptr<BasicTile> tile;
+		};
+
+		std::vector<DecodedTile> tiles;
+		std::vector<std::pair<uint16_t, Position>> zones;
+	};
+
 	static void parseMapDataAttributes(FileStream &stream, Map* map);
 	static void parseWaypoints(FileStream &stream, Map &map);
 	static void parseTowns(FileStream &stream, Map &map);
-	static void parseTileArea(FileStream &stream, Map &map, const Position &pos);
+
+	/**
+	 * Scans the tile area nodes without decoding them.
+	 */
+	static std::vector<NodeRange> indexTileAreas(FileStream &stream);
+	/**
+	 * Decodes the indexed tile areas in parallel, only touching thread safe state of the map.
+	 */
+	static std::vector<TileAreaBuffer> parseTileAreas(const Map &map, const char* data, const std::vector<NodeRange> &areas, const Position &pos, uint32_t threads);
+	static void parseTileArea(FileStream &stream, const Map &map, const Position &pos, TileAreaBuffer &buffer);
+	/**
+	 * Creates the houses, stores the tiles and registers the zones of a decoded area.
+	 */
+	static void mergeTileArea(Map &map, TileAreaBuffer &buffer, MapSnapshotWriter* snapshot);
 };
 
 class IOMapException : public std::exception {
@@ -0,0 +1,551 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "io/iomap_snapshot.hpp"
+
+#include "config/configmanager.hpp"
+#include "game/zones/zone.hpp"
+#include "io/iomap.hpp"
+#include "utils/adler32.hpp"
+#include "utils/hash.hpp"
+
+namespace {
+	constexpr std::array<char, 4> MAGIC = { 'C', 'M', 'S', 'N' };
+	constexpr uint64_t SECTION_ALIGNMENT = 8;
+
+#pragma pack(1)
+	// Offset from the start of the file and number of records
+	struct Section {
+		uint64_t offset = 0;
+		uint32_t count = 0;
+	};
+
+	// Offset from the start of the strings section
+	struct StringRef {
+		uint32_t offset = 0;
+		uint32_t length = 0;
+	};
+
+	struct Header {
+		std::array<char, 4> magic = MAGIC;
+		uint32_t version = IOMapSnapshot::VERSION;
+		uint64_t sourceHash = 0;
+		uint16_t width = 0;
+		uint16_t height = 0;
+		StringRef monsterFile;
+		StringRef npcFile;
+		StringRef houseFile;
+		StringRef zonesFile;
+		Section items;
+		Section itemChildren;
+		Section tiles;
+		Section tileItems;
+		Section cells;
+		Section houses;
+		Section zones;
+		Section towns;
+		Section waypoints;
+		Section strings;
+	};
+
+	// Children are stored before their parent, so they always have a lower index
+	struct ItemRecord {
+		uint16_t id;
+		uint16_t charges;
+		uint16_t actionId;
+		uint16_t uniqueId;
+		uint16_t destX;
+		uint16_t destY;
+		uint16_t doorOrDepotId;
+		uint8_t destZ;
+		StringRef text;
+		uint32_t firstChild;
+		uint32_t childCount;
+	};
+
+	struct TileRecord {
+		uint32_t flags;
+		uint32_t houseId;
+		uint8_t type;
+		uint8_t isStatic;
+		// Item index + 1, 0 for none
+		uint32_t ground;
+		uint32_t firstItem;
+		uint32_t itemCount;
+	};
+
+	struct CellRecord {
+		uint16_t x;
+		uint16_t y;
+		uint8_t z;
+		uint32_t tile;
+	};
+
+	struct ZoneRecord {
+		uint16_t zoneId;
+		uint16_t x;
+		uint16_t y;
+		uint8_t z;
+	};
+
+	struct TownRecord {
+		uint32_t id;
+		uint16_t x;
+		uint16_t y;
+		uint8_t z;
+		StringRef name;
+	};
+
+	struct WaypointRecord {
+		StringRef name;
+		uint16_t x;
+		uint16_t y;
+		uint8_t z;
+	};
+#pragma pack()
+
+	class StringTable {
+	public:
+		StringRef add(std::string_view value) {
+			const StringRef ref { static_cast<uint32_t>(data.size()), static_cast<uint32_t>(value.size()) };
+			data.append(value);
+			return ref;
+		}
+
+		const std::string &getData() const {
+			return data;
+		}
+
+	private:
+		std::string data;
+	};
+
+	// Read only view of a mapped snapshot, every access is bounds checked once by validate()
+	class SnapshotView {
+	public:
+		explicit SnapshotView(const mio::mmap_source &file) :
+			file(file) {
+			if (file.size() >= sizeof(Header)) {
+				std::memcpy(&header, file.data(), sizeof(Header));
+			}
+		}
+
+		const Header &getHeader() const {
+			return header;
+		}
+
+		template <typename T>
+		std::span<const T> get(const Section &section) const {
+			return { reinterpret_cast<const T*>(file.data() + section.offset), section.count };
+		}
+
+		std::string_view getString(const StringRef &ref) const {
+			return { file.data() + header.strings.offset + ref.offset, ref.length };
+		}
+
+		bool validate() const {
+			if (file.size() < sizeof(Header)) {
+				return false;
+			}
+
+			const auto sectionsValid = fits<ItemRecord>(header.items) && fits<uint32_t>(header.itemChildren) && fits<TileRecord>(header.tiles)
+				&& fits<uint32_t>(header.tileItems) && fits<CellRecord>(header.cells) && fits<uint32_t>(header.houses) && fits<ZoneRecord>(header.zones)
+				&& fits<TownRecord>(header.towns) && fits<WaypointRecord>(header.waypoints) && fits<char>(header.strings);
+			if (!sectionsValid) {
+				return false;
+			}
+
+			for (const auto &ref : { header.monsterFile, header.npcFile, header.houseFile, header.zonesFile }) {
+				if (!fits(ref)) {
+					return false;
+				}
+			}
+
+			const auto items = get<ItemRecord>(header.items);
+			for (uint32_t i = 0; i < items.size(); ++i) {
+				const auto &item = items[i];
+				if (!fits(item.text) || !fitsRange(item.firstChild, item.childCount, header.itemChildren.count)) {
+					return false;
+				}
+
+				for (const auto child : get<uint32_t>(header.itemChildren).subspan(item.firstChild, item.childCount)) {
+					if (child >= i) {
+						return false;
+					}
+				}
+			}
+
+			const auto tileItems = get<uint32_t>(header.tileItems);
+			if (std::ranges::any_of(tileItems, [this](uint32_t item) { return item >= header.items.count; })) {
+				return false;
+			}
+
+			for (const auto &tile : get<TileRecord>(header.tiles)) {
+				if (tile.ground > header.items.count || !fitsRange(tile.firstItem, tile.itemCount, header.tileItems.count)) {
+					return false;
+				}
+			}
+
+			const auto cellsValid = std::ranges::all_of(get<CellRecord>(header.cells), [this](const CellRecord &cell) {
+				return cell.tile < header.tiles.count && cell.z < MAP_MAX_LAYERS;
+			});
+			const auto townsValid = std::ranges::all_of(get<TownRecord>(header.towns), [this](const TownRecord &town) {
+				return fits(town.name);
+			});
+			const auto waypointsValid = std::ranges::all_of(get<WaypointRecord>(header.waypoints), [this](const WaypointRecord &waypoint) {
+				return fits(waypoint.name);
+			});
+			return cellsValid && townsValid && waypointsValid;
+		}
+
+	private:
+		template <typename T>
+		bool fits(const Section &section) const {
+			return section.offset <= file.size() && section.count <= (file.size() - section.offset) / sizeof(T);
+		}
+
+		bool fits(const StringRef &ref) const {
+			return fitsRange(ref.offset, ref.length, header.strings.count);
+		}
+
+		static bool fitsRange(uint64_t first, uint64_t count, uint64_t size) {
+			return first <= size && count <= size - first;
+		}
+
+		const mio::mmap_source &file;
+		Header header {};
+	};
+
+	void hashFile(size_t &h, const std::filesystem::path &path) {
+		if (!std::filesystem::exists(path) || std::filesystem::file_size(path) == 0) {
+			stdext::hash_combine(h, uint64_t { 0 });
+			return;
+		}
+
+		// The key is stored in the snapshot, it must not depend on the standard library the server was built with
+		const mio::mmap_source file(path.string());
+		stdext::hash_combine(h, static_cast<uint64_t>(file.size()));
+		stdext::hash_combine(h, Adler32::checksum(reinterpret_cast<const uint8_t*>(file.data()), file.size()));
+	}
+}
+
+void MapSnapshotWriter::addTile(uint16_t x, uint16_t y, uint8_t z, const std::shared_ptr<BasicTile> &tile) {
+	auto [it, inserted] = tileIndexes.try_emplace(tile->hash(), static_cast<uint32_t>(tiles.size()));
+	if (inserted) {
+		tiles.emplace_back(tile);
+		if (tile->ground) {
+			addItem(tile->ground);
+		}
+		for (const auto &item : tile->items) {
+			addItem(item);
+		}
+	}
+	cells.push_back({ x, y, z, it->second });
+}
+
+void MapSnapshotWriter::addHouse(uint32_t houseId) {
+	if (houseIds.emplace(houseId).second) {
+		houses.emplace_back(houseId);
+	}
+}
+
+void MapSnapshotWriter::addZonePosition(uint16_t zoneId, const Position &position) {
+	zones.push_back({ zoneId, position });
+}
+
+uint32_t MapSnapshotWriter::addItem(const std::shared_ptr<BasicItem> &item) {
+	if (const auto it = itemIndexes.find(item.get()); it != itemIndexes.end()) {
+		return it->second;
+	}
+
+	for (const auto &child : item->items) {
+		addItem(child);
+	}
+
+	const auto index = static_cast<uint32_t>(items.size());
+	items.emplace_back(item);
+	itemIndexes.emplace(item.get(), index);
+	return index;
+}
+
+bool MapSnapshotWriter::save(const Map &map, const std::filesystem::path &path, uint64_t sourceHash) const {
+	Header header;
+	header.sourceHash = sourceHash;
+	header.width = static_cast<uint16_t>(map.width);
+	header.height = static_cast<uint16_t>(map.height);
+
+	StringTable strings;
+	header.monsterFile = strings.add(map.monsterfile);
+	header.npcFile = strings.add(map.npcfile);
+	header.houseFile = strings.add(map.housefile);
+	header.zonesFile = strings.add(map.zonesfile);
+
+	std::vector<ItemRecord> itemRecords;
+	std::vector<uint32_t> itemChildren;
+	itemRecords.reserve(items.size());
+	for (const auto &item : items) {
+		const auto firstChild = static_cast<uint32_t>(itemChildren.size());
+		for (const auto &child : item->items) {
+			itemChildren.emplace_back(itemIndexes.at(child.get()));
+		}
+
+		itemRecords.push_back({
+			item->id,
+			item->charges,
+			item->actionId,
+			item->uniqueId,
+			item->destX,
+			item->destY,
+			item->doorOrDepotId,
+			item->destZ,
+			strings.add(item->text),
+			firstChild,
+			static_cast<uint32_t>(item->items.size()),
+		});
+	}
+
+	std::vector<TileRecord> tileRecords;
+	std::vector<uint32_t> tileItems;
+	tileRecords.reserve(tiles.size());
+	for (const auto &tile : tiles) {
+		const auto firstItem = static_cast<uint32_t>(tileItems.size());
+		for (const auto &item : tile->items) {
+			tileItems.emplace_back(itemIndexes.at(item.get()));
+		}
+
+		tileRecords.push_back({
+			tile->flags,
+			tile->houseId,
+			tile->type,
+			static_cast<uint8_t>(tile->isStatic),
+			tile->ground ? itemIndexes.at(tile->ground.get()) + 1 : 0,
+			firstItem,
+			static_cast<uint32_t>(tile->items.size()),
+		});
+	}
+
+	std::vector<CellRecord> cellRecords;
+	cellRecords.reserve(cells.size());
+	for (const auto &[x, y, z, tile] : cells) {
+		cellRecords.push_back({ x, y, z, tile });
+	}
+
+	std::vector<ZoneRecord> zoneRecords;
+	zoneRecords.reserve(zones.size());
+	for (const auto &[zoneId, position] : zones) {
+		zoneRecords.push_back({ zoneId, position.x, position.y, position.z });
+	}
+
+	std::vector<TownRecord> townRecords;
+	for (const auto &[townId, town] : map.towns.getTowns()) {
+		const auto &temple = town->getTemplePosition();
+		townRecords.push_back({ townId, temple.x, temple.y, temple.z, strings.add(town->getName()) });
+	}
+
+	std::vector<WaypointRecord> waypointRecords;
+	for (const auto &[name, position] : map.waypoints) {
+		waypointRecords.push_back({ strings.add(name), position.x, position.y, position.z });
+	}
+
+	// Sections follow the header in this order, aligned so records can be read in place
+	uint64_t offset = sizeof(Header);
+	const auto place = [&offset]<typename T>(Section &section, const std::vector<T> &records) {
+		offset = (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+		section = { offset, static_cast<uint32_t>(records.size()) };
+		offset += records.size() * sizeof(T);
+	};
+	place(header.items, itemRecords);
+	place(header.itemChildren, itemChildren);
+	place(header.tiles, tileRecords);
+	place(header.tileItems, tileItems);
+	place(header.cells, cellRecords);
+	place(header.houses, houses);
+	place(header.zones, zoneRecords);
+	place(header.towns, townRecords);
+	place(header.waypoints, waypointRecords);
+	header.strings = { offset, static_cast<uint32_t>(strings.getData().size()) };
+
+	// Written aside and renamed, a crash never leaves a truncated snapshot behind
+	auto temporaryPath = path;
+	temporaryPath += ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			g_logger().warn("[{}] - Could not write map snapshot {}", __FUNCTION__, temporaryPath.string());
+			return false;
+		}
+
+		uint64_t written = sizeof(Header);
+		const auto write = [&file, &written]<typename T>(const Section &section, const std::vector<T> &records) {
+			static constexpr std::array<char, SECTION_ALIGNMENT> padding {};
+			file.write(padding.data(), static_cast<std::streamsize>(section.offset - written));
+			file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(T)));
+			written = section.offset + records.size() * sizeof(T);
+		};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		write(header.items, itemRecords);
+		write(header.itemChildren, itemChildren);
+		write(header.tiles, tileRecords);
+		write(header.tileItems, tileItems);
+		write(header.cells, cellRecords);
+		write(header.houses, houses);
+		write(header.zones, zoneRecords);
+		write(header.towns, townRecords);
+		write(header.waypoints, waypointRecords);
+		file.write(strings.getData().data(), static_cast<std::streamsize>(strings.getData().size()));
+
+		if (!file) {
+			g_logger().warn("[{}] - Could not write map snapshot {}", __FUNCTION__, temporaryPath.string());
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error) {
+		g_logger().warn("[{}] - Could not replace map snapshot {}: {}", __FUNCTION__, path.string(), error.message());
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
+
+void IOMapSnapshot::loadMap(Map* map, const std::string &identifier) {
+	try {
+		map->path = identifier;
+
+		Benchmark bm_snapshot;
+		const auto sourceHash = hashSources(identifier);
+		const auto snapshotPath = getSnapshotPath(identifier);
+		if (load(map, snapshotPath, sourceHash)) {
+			g_logger().info("Map loaded from snapshot {} in {} milliseconds", snapshotPath.filename().string(), bm_snapshot.duration());
+			return;
+		}
+
+		MapSnapshotWriter snapshot;
+		IOMap::loadMap(map, Position(), 0, &snapshot);
+
+		bm_snapshot.start();
+		if (snapshot.save(*map, snapshotPath, sourceHash)) {
+			g_logger().info("Map snapshot {} written in {} milliseconds", snapshotPath.filename().string(), bm_snapshot.duration());
+		}
+	} catch (const std::exception &e) {
+		g_logger().warn("[IOMapSnapshot::loadMap] - The map in folder {} is missing or corrupted: {}", identifier, e.what());
+	}
+}
+
+uint64_t IOMapSnapshot::hashSources(const std::filesystem::path &mapPath) {
+	// The item definitions decide where map items go, the snapshot depends on them as well
+	const auto &coreDirectory = g_configManager().getString(CORE_DIRECTORY);
+
+	size_t h = 0;
+	stdext::hash_combine(h, VERSION);
+	hashFile(h, mapPath);
+	hashFile(h, coreDirectory + "/items/appearances.dat");
+	hashFile(h, coreDirectory + "/items/items.xml");
+	return h;
+}
+
+bool IOMapSnapshot::load(Map* map, const std::filesystem::path &path, uint64_t sourceHash) {
+	if (!std::filesystem::exists(path)) {
+		return false;
+	}
+
+	std::error_code error;
+	mio::mmap_source file;
+	file.map(path.string(), error);
+	if (error) {
+		g_logger().warn("[{}] - Could not map snapshot {}: {}", __FUNCTION__, path.string(), error.message());
+		return false;
+	}
+
+	const SnapshotView snapshot(file);
+	const auto &header = snapshot.getHeader();
+	if (header.magic != MAGIC || header.version != VERSION || header.sourceHash != sourceHash) {
+		g_logger().info("Map snapshot {} is outdated, loading the map file", path.filename().string());
+		return false;
+	}
+
+	// Nothing is touched before the whole file is known to be sound
+	if (!snapshot.validate()) {
+		g_logger().warn("[{}] - Map snapshot {} is corrupted, loading the map file", __FUNCTION__, path.string());
+		return false;
+	}
+
+	const auto itemChildren = snapshot.get<uint32_t>(header.itemChildren);
+	std::vector<std::shared_ptr<BasicItem>> items;
+	items.reserve(header.items.count);
+	for (const auto &record : snapshot.get<ItemRecord>(header.items)) {
+		auto &item = items.emplace_back(std::make_shared<BasicItem>());
+		item->id = record.id;
+		item->charges = record.charges;
+		item->actionId = record.actionId;
+		item->uniqueId = record.uniqueId;
+		item->destX = record.destX;
+		item->destY = record.destY;
+		item->destZ = record.destZ;
+		item->doorOrDepotId = record.doorOrDepotId;
+		item->text = snapshot.getString(record.text);
+
+		item->items.reserve(record.childCount);
+		for (const auto child : itemChildren.subspan(record.firstChild, record.childCount)) {
+			item->items.emplace_back(items[child]);
+		}
+	}
+
+	const auto tileItems = snapshot.get<uint32_t>(header.tileItems);
+	std::vector<BasicTileHandle> tiles;
+	tiles.reserve(header.tiles.count);
+	for (const auto &record : snapshot.get<TileRecord>(header.tiles)) {
+		const auto tile = std::make_shared<BasicTile>();
+		tile->flags = record.flags;
+		tile->houseId = record.houseId;
+		tile->type = record.type;
+		tile->isStatic = record.isStatic != 0;
+		tile->ground = record.ground != 0 ? items[record.ground - 1] : nullptr;
+
+		tile->items.reserve(record.itemCount);
+		for (const auto item : tileItems.subspan(record.firstItem, record.itemCount)) {
+			tile->items.emplace_back(items[item]);
+		}
+		tiles.emplace_back(map->addBasicTile(tile));
+	}
+
+	for (const auto houseId : snapshot.get<uint32_t>(header.houses)) {
+		map->houses.addHouse(houseId);
+	}
+
+	for (const auto &cell : snapshot.get<CellRecord>(header.cells)) {
+		map->setBasicTile(cell.x, cell.y, cell.z, tiles[cell.tile]);
+	}
+
+	for (const auto &zone : snapshot.get<ZoneRecord>(header.zones)) {
+		Zone::getZone(zone.zoneId)->addPosition(Position(zone.x, zone.y, zone.z));
+	}
+
+	for (const auto &record : snapshot.get<TownRecord>(header.towns)) {
+		const auto &town = map->towns.getOrCreateTown(record.id);
+		town->setName(std::string(snapshot.getString(record.name)));
+		town->setTemplePos(Position(record.x, record.y, record.z));
+	}
+
+	for (const auto &record : snapshot.get<WaypointRecord>(header.waypoints)) {
+		map->waypoints[std::string(snapshot.getString(record.name))] = Position(record.x, record.y, record.z);
+	}
+
+	map->width = header.width;
+	map->height = header.height;
+	map->monsterfile = snapshot.getString(header.monsterFile);
+	map->npcfile = snapshot.getString(header.npcFile);
+	map->housefile = snapshot.getString(header.houseFile);
+	map->zonesfile = snapshot.getString(header.zonesFile);
+
+	map->flush();
+	return true;
+}
@@ -0,0 +1,91 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "map/map.hpp"
+
+/**
+ * Collects what IOMap decodes from an OTBM file, to be written as a snapshot.
+ * Templates are deduplicated the same way MapCache does.
+ */
+class MapSnapshotWriter {
+public:
+	void addTile(uint16_t x, uint16_t y, uint8_t z, const std::shared_ptr<BasicTile> &tile);
+	void addHouse(uint32_t houseId);
+	void addZonePosition(uint16_t zoneId, const Position &position);
+
+	/**
+	 * Writes the snapshot with the towns, waypoints and files of the map, replacing the previous one at once.
+	 */
+	bool save(const Map &map, const std::filesystem::path &path, uint64_t sourceHash) const;
+
+private:
+	uint32_t addItem(const std::shared_ptr<BasicItem> &item);
+
+	struct Cell {
+		uint16_t x;
+		uint16_t y;
+		uint8_t z;
+		uint32_t tile;
+	};
+
+	struct ZonePosition {
+		uint16_t zoneId;
+		Position position;
+	};
+
+	std::vector<std::shared_ptr<BasicItem>> items;
+	phmap::flat_hash_map<const BasicItem*, uint32_t> itemIndexes;
+	std::vector<std::shared_ptr<BasicTile>> tiles;
+	phmap::flat_hash_map<size_t, uint32_t> tileIndexes;
+	std::vector<Cell> cells;
+	// Houses are created for every house tile, even the empty ones that are not stored
+	std::vector<uint32_t> houses;
+	phmap::flat_hash_set<uint32_t> houseIds;
+	std::vector<ZonePosition> zones;
+};
+
+/**
+ * Precompiled copy of the main map, mapped at startup instead of parsing the OTBM file.
+ *
+ * The snapshot holds the deduplicated BasicTile and BasicItem graph, every cell
+ * pointing at its template, the zone positions, houses, towns and waypoints.
+ * Item types and spawns are not part of it, they are still loaded from their own files.
+ * Records are packed and reference each other by index or by offset from the
+ * start of their section, they are read in place from the mapping while the
+ * BasicTile and BasicItem objects are rebuilt from them.
+ *
+ * It is keyed by a hash of the OTBM file and of the item definitions used to
+ * decode it, any change to them rebuilds the snapshot on the next boot.
+ */
+class IOMapSnapshot {
+public:
+	static constexpr uint32_t VERSION = 1;
+
+	/**
+	 * Loads the map from its snapshot, or from the OTBM file when the snapshot is missing or stale, then writes a new snapshot.
+	 * \param identifier Path of the OTBM file.
+	 */
+	static void loadMap(Map* map, const std::string &identifier);
+
+	/**
+	 * \returns The hash of the OTBM file and of the item definitions.
+	 */
+	static uint64_t hashSources(const std::filesystem::path &mapPath);
+
+	/**
+	 * \returns true if the snapshot matched the sources and was loaded into the map.
+	 */
+	static bool load(Map* map, const std::filesystem::path &path, uint64_t sourceHash);
+
+	static std::filesystem::path getSnapshotPath(const std::filesystem::path &mapPath) {
+		return std::filesystem::path(mapPath).replace_extension(".snapshot");
+	}
+};
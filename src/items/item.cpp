@@ -484,6 +484,18 @@ std::shared_ptr<Tile> Item::getTile() {
 	return std::dynamic_pointer_cast<Tile>(cylinder);
 }
 
+void Item::setParent(std::weak_ptr<Cylinder> cylinder) {
+	m_parent = std::move(cylinder);
+	const auto &parent = m_parent.lock();
+	parentIsTile = parent && dynamic_cast<Tile*>(parent.get());
+}
+
+void Item::updateParentItemVersion() const {
+	if (const auto &parent = m_parent.lock()) {
+		static_cast<Tile*>(parent.get())->updateItemVersion();
+	}
+}
+
 bool Item::isRemoved() {
 	auto parent = getParent();
 	if (parent) {
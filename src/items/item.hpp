@@ -57,12 +57,14 @@ public:
 	void removeAttribute(ItemAttribute_t type) const {
 		if (attributePtr) {
 			attributePtr->removeAttribute(type);
+			onAttributeChange();
 		}
 	}
 
 	template <typename GenericAttribute>
 	void setAttribute(ItemAttribute_t type, GenericAttribute genericAttribute) {
 		initAttributePtr()->setAttribute(type, genericAttribute);
+		onAttributeChange();
 	}
 
 	bool isAttributeInteger(ItemAttribute_t type) const {
@@ -86,10 +88,12 @@ public:
 	template <typename GenericType>
 	void setCustomAttribute(const std::string &key, GenericType value) {
 		initAttributePtr()->setCustomAttribute(key, value);
+		onAttributeChange();
 	}
 
 	void addCustomAttribute(const std::string &key, const CustomAttribute &customAttribute) {
 		initAttributePtr()->addCustomAttribute(key, customAttribute);
+		onAttributeChange();
 	}
 
 	bool hasCustomAttribute() const {
@@ -97,11 +101,12 @@ public:
 	}
 
 	bool removeCustomAttribute(const std::string &attributeName) const {
-		if (!attributePtr) {
+		if (!attributePtr || !attributePtr->removeCustomAttribute(attributeName)) {
 			return false;
 		}
 
-		return attributePtr->removeCustomAttribute(attributeName);
+		onAttributeChange();
+		return true;
 	}
 
 	uint16_t getCharges() const {
@@ -197,6 +202,9 @@ protected:
 	}
 
 private:
+	// Lets the tile holding the item know that clients see it differently
+	void onAttributeChange() const;
+
 	std::unique_ptr<ItemAttribute> attributePtr;
 
 	friend class Item;
@@ -584,6 +592,7 @@ public:
 	}
 	void setItemCount(uint8_t n) {
 		count = n;
+		updateTileItemVersion();
 	}
 
 	static uint32_t countByType(const std::shared_ptr<Item> &item, int32_t subType) {
@@ -643,16 +652,23 @@ public:
 	std::shared_ptr<Cylinder> getParent() override {
 		return m_parent.lock();
 	}
-	void setParent(std::weak_ptr<Cylinder> cylinder) override {
-		m_parent = cylinder;
-	}
+	void setParent(std::weak_ptr<Cylinder> cylinder) override;
 	void resetParent() {
 		m_parent.reset();
+		parentIsTile = false;
 	}
 	std::shared_ptr<Cylinder> getTopParent();
 	std::shared_ptr<Tile> getTile() override;
 	bool isRemoved() override;
 
+	// Bumps the item version of the tile the item lies on, if any, once clients see it differently
+	void updateTileItemVersion() const {
+		// Items in containers and inventories are not part of map descriptions
+		if (parentIsTile) {
+			updateParentItemVersion();
+		}
+	}
+
 	bool isInsideDepot(bool includeInbox = false);
 
 	/**
@@ -739,15 +755,23 @@ protected:
 	bool isLootTrackeable = false;
 	bool decayDisabled = false;
 	bool m_hasActor = false;
+	// Set with the parent, so attribute changes don't look up its type
+	bool parentIsTile = false;
 
 private:
 	// Don't add variables here, use the ItemAttribute class.
 	std::string getWeightDescription(uint32_t weight) const;
+	void updateParentItemVersion() const;
 
 	friend class Decay;
 	friend class MapCache;
 };
 
+inline void ItemProperties::onAttributeChange() const {
+	// Items are the only ItemProperties
+	static_cast<const Item*>(this)->updateTileItemVersion();
+}
+
 using ItemList = std::list<std::shared_ptr<Item>>;
 using ItemDeque = std::deque<std::shared_ptr<Item>>;
 using StashContainerList = std::vector<std::pair<std::shared_ptr<Item>, uint32_t>>;
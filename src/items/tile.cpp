@@ -22,6 +22,7 @@
 #include "items/trashholder.hpp"
 #include "lua/creature/movement.hpp"
 #include "map/spectators.hpp"
+#include "map/utils/mapsector.hpp"
 #include "utils/tools.hpp"
 #include "game/scheduling/dispatcher.hpp"
 
@@ -374,6 +375,8 @@ void Tile::onAddTileItem(const std::shared_ptr<Item> &item) {
 		return;
 	}
 
+	updateItemVersion();
+
 	if ((item->hasProperty(CONST_PROP_MOVABLE) || item->getContainer()) || (item->isWrapable() && !item->hasProperty(CONST_PROP_MOVABLE) && !item->hasProperty(CONST_PROP_BLOCKPATH))) {
 		const auto it = g_game().browseFields.find(static_self_cast<Tile>());
 		if (it != g_game().browseFields.end()) {
@@ -452,6 +455,8 @@ void Tile::onUpdateTileItem(const std::shared_ptr<Item> &oldItem, const ItemType
 		return;
 	}
 
+	updateItemVersion();
+
 	if ((newItem->hasProperty(CONST_PROP_MOVABLE) || newItem->getContainer()) || (newItem->isWrapable() && newItem->hasProperty(CONST_PROP_MOVABLE) && !oldItem->hasProperty(CONST_PROP_BLOCKPATH))) {
 		const auto it = g_game().browseFields.find(getTile());
 		if (it != g_game().browseFields.end()) {
@@ -499,6 +504,8 @@ void Tile::onRemoveTileItem(const CreatureVector &spectators, const std::vector<
 		return;
 	}
 
+	updateItemVersion();
+
 	if ((item->hasProperty(CONST_PROP_MOVABLE) || item->getContainer()) || (item->isWrapable() && !item->hasProperty(CONST_PROP_MOVABLE) && !item->hasProperty(CONST_PROP_BLOCKPATH))) {
 		const auto it = g_game().browseFields.find(getTile());
 		if (it != g_game().browseFields.end()) {
@@ -1025,7 +1032,7 @@ void Tile::addThing(int32_t, const std::shared_ptr<Thing> &thing) {
 
 	const auto &creature = thing->getCreature();
 	if (creature) {
-		Spectators::clearCache();
+		updateSectorCreatures();
 		creature->setParent(static_self_cast<Tile>());
 
 		CreatureVector* creatures = makeCreatures();
@@ -1047,6 +1054,7 @@ void Tile::addThing(int32_t, const std::shared_ptr<Thing> &thing) {
 		if (itemType.isGroundTile()) {
 			if (ground == nullptr) {
 				ground = item;
+				updateBlocks();
 				onAddTileItem(item);
 			} else {
 				const ItemType &oldType = Item::items[ground->getID()];
@@ -1241,7 +1249,7 @@ void Tile::removeThing(const std::shared_ptr<Thing> &thing, uint32_t count) {
 		if (creatures) {
 			const auto it = std::ranges::find(*creatures, thing);
 			if (it != creatures->end()) {
-				Spectators::clearCache();
+				updateSectorCreatures();
 				creatures->erase(it);
 			}
 		}
@@ -1261,6 +1269,7 @@ void Tile::removeThing(const std::shared_ptr<Thing> &thing, uint32_t count) {
 	if (item == ground) {
 		ground->resetParent();
 		ground = nullptr;
+		updateBlocks();
 
 		const auto spectators = Spectators().find<Creature>(getPosition(), true);
 		onRemoveTileItem(spectators.data(), std::vector<int32_t>(spectators.size(), 0), item);
@@ -1324,6 +1333,9 @@ void Tile::removeCreature(const std::shared_ptr<Creature> &creature) {
 		return;
 	}
 
+	if (creature->getPlayer()) {
+		Spectators::updateSubscriptions(creature, &tilePos, nullptr);
+	}
 	g_game().map.getMapSector(tilePos.x, tilePos.y)->removeCreature(creature);
 	removeThing(creature, 0);
 }
@@ -1647,7 +1659,7 @@ void Tile::internalAddThing(uint32_t, const std::shared_ptr<Thing> &thing) {
 
 	const auto &creature = thing->getCreature();
 	if (creature) {
-		Spectators::clearCache();
+		updateSectorCreatures();
 
 		CreatureVector* creatures = makeCreatures();
 		creatures->insert(creatures->begin(), creature);
@@ -1657,6 +1669,8 @@ void Tile::internalAddThing(uint32_t, const std::shared_ptr<Thing> &thing) {
 			return;
 		}
 
+		updateItemVersion();
+
 		const ItemType &itemType = Item::items[item->getID()];
 		if (itemType.isGroundTile()) {
 			if (ground == nullptr) {
@@ -1694,6 +1708,8 @@ void Tile::internalAddThing(uint32_t, const std::shared_ptr<Thing> &thing) {
 }
 
 void Tile::updateTileFlags(const std::shared_ptr<Item> &item) {
+	// Attributes were changed in place
+	updateItemVersion();
 	resetTileFlags(item);
 	setTileFlags(item);
 }
@@ -1783,6 +1799,8 @@ void Tile::setTileFlags(const std::shared_ptr<Item> &item) {
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		setFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	updateBlocks();
 }
 
 void Tile::resetTileFlags(const std::shared_ptr<Item> &item) {
@@ -1864,6 +1882,49 @@ void Tile::resetTileFlags(const std::shared_ptr<Item> &item) {
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		resetFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	updateBlocks();
+}
+
+void Tile::setMapFloor(Floor* floor) {
+	mapFloor = floor;
+	blocks = getBlocks();
+	if (mapFloor) {
+		mapFloor->setBlocks(tilePos.x, tilePos.y, blocks);
+	}
+}
+
+uint8_t Tile::getBlocks() const {
+	uint8_t result = ground ? TILE_BLOCK_NONE : TILE_BLOCK_EMPTY;
+	if (hasFlag(TILESTATE_IMMOVABLEBLOCKSOLID)) {
+		result |= TILE_BLOCK_SOLID;
+	}
+	if (hasFlag(TILESTATE_FLOORCHANGE | TILESTATE_TELEPORT)) {
+		result |= TILE_BLOCK_PATH;
+	}
+	if (hasFlag(TILESTATE_BLOCKPROJECTILE)) {
+		result |= TILE_BLOCK_PROJECTILE;
+	}
+	return result;
+}
+
+void Tile::updateBlocks() {
+	if (!mapFloor) {
+		return;
+	}
+
+	const auto newBlocks = getBlocks();
+	if (newBlocks != blocks) {
+		blocks = newBlocks;
+		mapFloor->setBlocks(tilePos.x, tilePos.y, blocks);
+	}
+}
+
+// Spectator lists cached around the sector are dropped on their next lookup
+void Tile::updateSectorCreatures() const {
+	if (const auto sector = g_game().map.getMapSector(tilePos.x, tilePos.y)) {
+		sector->updateCreatureVersion();
+	}
 }
 
 bool Tile::isMovableBlocking() const {
@@ -22,6 +22,8 @@ class Zone;
 class Cylinder;
 class Item;
 class ItemType;
+struct Floor;
+struct TileDescriptionCache;
 
 using CreatureVector = std::vector<std::shared_ptr<Creature>>;
 using ItemVector = std::vector<std::shared_ptr<Item>>;
@@ -179,6 +181,15 @@ public:
 	void addZone(const std::shared_ptr<Zone> &zone);
 	void clearZones();
 
+	/**
+	 * Attaches the tile to the map floor whose block bitmaps it keeps up to date, nullptr once it left the map.
+	 */
+	void setMapFloor(Floor* floor);
+	/**
+	 * \returns The TileBlock_t flags of the tile.
+	 */
+	uint8_t getBlocks() const;
+
 	auto getZones() const {
 		return zones;
 	}
@@ -250,6 +261,7 @@ public:
 		return ground;
 	}
 	void setGround(const std::shared_ptr<Item> &item) {
+		updateItemVersion();
 		if (ground) {
 			resetTileFlags(ground);
 		}
@@ -259,6 +271,23 @@ public:
 		}
 	}
 
+	/**
+	 * \returns A stamp bumped whenever an item is added, removed or changes the way clients see it.
+	 */
+	uint32_t getItemVersion() const {
+		return itemVersion;
+	}
+	void updateItemVersion() {
+		++itemVersion;
+	}
+
+	/**
+	 * Items as the game protocol last wrote them, see TileDescriptionCache.
+	 */
+	std::shared_ptr<TileDescriptionCache> &getDescriptionCache() {
+		return descriptionCache;
+	}
+
 	// This method maintains safety in asynchronous calls, avoiding competition between threads.
 	void safeCall(std::function<void(void)> &&action) const;
 
@@ -270,6 +299,8 @@ private:
 
 	void setTileFlags(const std::shared_ptr<Item> &item);
 	void resetTileFlags(const std::shared_ptr<Item> &item);
+	void updateBlocks();
+	void updateSectorCreatures() const;
 	bool hasHarmfulField() const;
 	ReturnValue checkNpcCanWalkIntoTile() const;
 
@@ -278,6 +309,13 @@ protected:
 	Position tilePos;
 	uint32_t flags = 0;
 	std::unordered_set<std::shared_ptr<Zone>> zones {};
+
+	Floor* mapFloor = nullptr;
+	// Last blocks written to mapFloor
+	uint8_t blocks = 0;
+
+	uint32_t itemVersion = 0;
+	std::shared_ptr<TileDescriptionCache> descriptionCache;
 };
 
 // Used for walkable tiles, where there is high likeliness of
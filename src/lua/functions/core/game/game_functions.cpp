@@ -9,6 +9,7 @@
 
 #include "lua/functions/core/game/game_functions.hpp"
 
+#include "config/configmanager.hpp"
 #include "core.hpp"
 #include "creatures/monsters/monster.hpp"
 #include "creatures/monsters/monsters.hpp"
@@ -112,6 +113,11 @@ void GameFunctions::init(lua_State* L) {
 
 	Lua::registerMethod(L, "Game", "getMonstersByRace", GameFunctions::luaGameGetMonstersByRace);
 	Lua::registerMethod(L, "Game", "getMonstersByBestiaryStars", GameFunctions::luaGameGetMonstersByBestiaryStars);
+
+	Lua::registerMethod(L, "Game", "getDispatcherProfile", GameFunctions::luaGameGetDispatcherProfile);
+	Lua::registerMethod(L, "Game", "dumpDispatcherProfile", GameFunctions::luaGameDumpDispatcherProfile);
+	Lua::registerMethod(L, "Game", "resetDispatcherProfile", GameFunctions::luaGameResetDispatcherProfile);
+	Lua::registerMethod(L, "Game", "setDispatcherProfiling", GameFunctions::luaGameSetDispatcherProfiling);
 }
 
 // Game
@@ -1086,3 +1092,55 @@ int GameFunctions::luaGameGetMonstersByBestiaryStars(lua_State* L) {
 	}
 	return 1;
 }
+
+int GameFunctions::luaGameGetDispatcherProfile(lua_State* L) {
+	// Game.getDispatcherProfile([limit = 30])
+	Lua::pushString(L, g_dispatcher().getProfileReport(Lua::getNumber<size_t>(L, 1, 30)));
+	return 1;
+}
+
+int GameFunctions::luaGameDumpDispatcherProfile(lua_State* L) {
+	// Game.dumpDispatcherProfile(fileName[, limit = 30])
+	// Only a file name is accepted, reports are always written to the logs directory
+	const std::filesystem::path fileName = Lua::getString(L, 1);
+	if (fileName.empty() || fileName != fileName.filename() || fileName == "." || fileName == "..") {
+		Lua::reportErrorFunc(fmt::format("Invalid file name '{}' to dump the dispatcher profile", fileName.string()));
+		Lua::pushBoolean(L, false);
+		return 1;
+	}
+
+	const auto directory = std::filesystem::path(g_configManager().getString(CORE_DIRECTORY)) / "logs";
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	const auto path = directory / fileName;
+	std::ofstream file(path);
+	if (!file) {
+		Lua::reportErrorFunc(fmt::format("Failed to open '{}' to dump the dispatcher profile", path.string()));
+		Lua::pushBoolean(L, false);
+		return 1;
+	}
+
+	file << g_dispatcher().getProfileReport(Lua::getNumber<size_t>(L, 2, 30));
+	if (!file.good()) {
+		Lua::pushBoolean(L, false);
+		return 1;
+	}
+
+	Lua::pushString(L, path.string());
+	return 1;
+}
+
+int GameFunctions::luaGameResetDispatcherProfile(lua_State* L) {
+	// Game.resetDispatcherProfile()
+	g_dispatcher().getProfiler().reset();
+	Lua::pushBoolean(L, true);
+	return 1;
+}
+
+int GameFunctions::luaGameSetDispatcherProfiling(lua_State* L) {
+	// Game.setDispatcherProfiling(enabled)
+	g_dispatcher().getProfiler().setEnabled(Lua::getBoolean(L, 1));
+	Lua::pushBoolean(L, true);
+	return 1;
+}
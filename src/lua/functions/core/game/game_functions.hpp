@@ -94,4 +94,9 @@ private:
 
 	static int luaGameGetMonstersByRace(lua_State* L);
 	static int luaGameGetMonstersByBestiaryStars(lua_State* L);
+
+	static int luaGameGetDispatcherProfile(lua_State* L);
+	static int luaGameDumpDispatcherProfile(lua_State* L);
+	static int luaGameResetDispatcherProfile(lua_State* L);
+	static int luaGameSetDispatcherProfiling(lua_State* L);
 };
@@ -1026,7 +1026,7 @@ int CreatureFunctions::luaCreatureGetPathTo(lua_State* L) {
 	fpp.maxSearchDist = Lua::getNumber<int32_t>(L, 7, fpp.maxSearchDist);
 
 	std::vector<Direction> dirList;
-	if (creature->getPathTo(position, dirList, fpp)) {
+	if (creature->getPathTo(position, dirList, fpp) || g_game().map.getRoute(creature->getPosition(), position, dirList, fpp)) {
 		lua_newtable(L);
 
 		int index = 0;
@@ -123,7 +123,7 @@ int PositionFunctions::luaPositionGetPathTo(lua_State* L) {
 	fpp.maxSearchDist = Lua::getNumber<int32_t>(L, 7, fpp.maxSearchDist);
 
 	std::vector<Direction> dirList;
-	if (g_game().map.getPathMatching(pos, dirList, FrozenPathingConditionCall(position), fpp)) {
+	if (g_game().map.getPathMatching(pos, dirList, FrozenPathingConditionCall(position), fpp) || g_game().map.getRoute(pos, position, dirList, fpp)) {
 		lua_newtable(L);
 
 		int index = 0;
@@ -15,16 +15,19 @@
 #include "game/scheduling/dispatcher.hpp"
 #include "game/zones/zone.hpp"
 #include "io/iomap.hpp"
+#include "io/iomap_snapshot.hpp"
 #include "io/iomapserialize.hpp"
 #include "lua/callbacks/event_callback.hpp"
 #include "lua/callbacks/events_callbacks.hpp"
 #include "map/spectators.hpp"
+#include "server/network/message/broadcastmessage.hpp"
+#include "server/network/protocol/protocolgame.hpp"
 #include "utils/astarnodes.hpp"
 
-void Map::load(const std::string &identifier, const Position &pos) {
+void Map::load(const std::string &identifier, const Position &pos, uint32_t threads) {
 	try {
 		path = identifier;
-		IOMap::loadMap(this, pos);
+		IOMap::loadMap(this, pos, threads);
 	} catch (const std::exception &e) {
 		g_logger().warn("[Map::load] - The map in folder {} is missing or corrupted", identifier);
 	}
@@ -51,8 +54,12 @@ void Map::loadMap(const std::string &identifier, bool mainMap /*= false*/, bool
 		}
 	}
 
-	// Load the map
-	load(identifier, pos);
+	// Load the map, the main map goes through its snapshot when enabled
+	if (mainMap && g_configManager().getBoolean(MAP_SNAPSHOT)) {
+		IOMapSnapshot::loadMap(this, identifier);
+	} else {
+		load(identifier, pos);
+	}
 
 	// Only create items from lua functions if is loading main map
 	// It needs to be after the load map to ensure the map already exists before creating the items
@@ -60,6 +67,15 @@ void Map::loadMap(const std::string &identifier, bool mainMap /*= false*/, bool
 		// Create items from lua scripts per position
 		// Example: ActionFunctions::luaActionPosition
 		g_game().createLuaItemsOnMap();
+
+		// Nothing else reads the map during startup, replaced tile slots can be recycled
+		reclaimTiles();
+
+		const auto stats = getMemoryStats();
+		g_logger().info(
+			"Map storage: {} sectors, {} floors, {} tiles, {} cached tiles from {} templates, index {:.2f} MB, arenas {:.2f} MB",
+			stats.sectors, stats.floors, stats.tiles, stats.cachedTiles, stats.basicTiles, stats.sectorBytes / 1048576.0, stats.arenaBytes / 1048576.0
+		);
 	}
 
 	if (loadMonsters) {
@@ -164,18 +180,17 @@ std::shared_ptr<Tile> Map::getLoadedTile(uint16_t x, uint16_t y, uint8_t z) {
 		return nullptr;
 	}
 
-	const auto &leaf = getMapSector(x, y);
+	const auto leaf = getMapSector(x, y);
 	if (!leaf) {
 		return nullptr;
 	}
 
-	const auto &floor = leaf->getFloor(z);
+	const auto floor = leaf->getFloor(z);
 	if (!floor) {
 		return nullptr;
 	}
 
-	const auto &tile = floor->getTile(x, y);
-	return tile;
+	return getFloorTile(floor, x, y);
 }
 
 std::shared_ptr<Tile> Map::getTile(uint16_t x, uint16_t y, uint8_t z) {
@@ -188,12 +203,12 @@ std::shared_ptr<Tile> Map::getTile(uint16_t x, uint16_t y, uint8_t z) {
 		return nullptr;
 	}
 
-	const auto &sector = getMapSector(x, y);
+	const auto sector = getMapSector(x, y);
 	if (!sector) {
 		return nullptr;
 	}
 
-	const auto &floor = sector->getFloor(z);
+	const auto floor = sector->getFloor(z);
 	if (!floor) {
 		return nullptr;
 	}
@@ -220,11 +235,14 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, const std::shared_ptr<Tile>
 		return;
 	}
 
-	if (const auto &sector = getMapSector(x, y)) {
-		sector->createFloor(z)->setTile(x, y, newTile);
-	} else {
-		getBestMapSector(x, y)->createFloor(z)->setTile(x, y, newTile);
+	auto sector = getMapSector(x, y);
+	if (!sector) {
+		sector = getBestMapSector(x, y);
 	}
+
+	const auto floor = sector->createFloor(z);
+	std::scoped_lock lock(floor->getMutex());
+	setFloorTile(floor, x, y, newTile);
 }
 
 bool Map::placeCreature(const Position &centerPos, const std::shared_ptr<Creature> &creature, bool extendedPos /* = false*/, bool forceLogin /* = false*/) {
@@ -322,6 +340,9 @@ bool Map::placeCreature(const Position &centerPos, const std::shared_ptr<Creatur
 
 		const Position &dest = toCylinder->getPosition();
 		getMapSector(dest.x, dest.y)->addCreature(creature);
+		if (creature->getPlayer()) {
+			Spectators::updateSubscriptions(creature, nullptr, &dest);
+		}
 	}
 	return true;
 }
@@ -404,6 +425,9 @@ void Map::moveCreature(const std::shared_ptr<Creature> &creature, const std::sha
 
 	// add the creature
 	newTile->addThing(creature);
+	if (creature->getPlayer()) {
+		Spectators::updateSubscriptions(creature, &oldPos, &newPos);
+	}
 
 	if (!teleport) {
 		if (oldPos.y > newPos.y) {
@@ -419,14 +443,17 @@ void Map::moveCreature(const std::shared_ptr<Creature> &creature, const std::sha
 		}
 	}
 
-	// send to client
+	// send to client, the plain step is the same for everyone with the same old stackpos
+	BroadcastMessage step([&oldPos, &newPos](NetworkMessage &msg, bool, uint8_t oldStackPos) {
+		ProtocolGame::AddCreatureStep(msg, oldPos, oldStackPos, newPos);
+	});
 	size_t i = 0;
 	for (const auto &spectator : playersSpectators) {
 		// Use the correct stackpos
 		const int32_t stackpos = oldStackPosVector[i++];
 		if (stackpos != -1) {
 			const auto &player = spectator->getPlayer();
-			player->sendCreatureMove(creature, newPos, newTile->getStackposOfCreature(player, creature), oldPos, stackpos, teleport);
+			player->sendCreatureMove(creature, newPos, newTile->getStackposOfCreature(player, creature), oldPos, stackpos, teleport, &step);
 		}
 	}
 
@@ -494,15 +521,11 @@ bool Map::checkSightLine(Position start, Position destination) {
 	int32_t distanceY = Position::getDistanceY(start, destination);
 
 	if (start.y == destination.y) {
-		// Horizontal line
-		const uint16_t delta = start.x < destination.x ? 0x0001 : 0xFFFF;
-		while (--distanceX > 0) {
-			start.x += delta;
-
-			const auto &tile = getTile(start.x, start.y, start.z);
-			if (tile && tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
-				return false;
-			}
+		// Horizontal line, the cells between both ends are tested a sector row at a time
+		if (distanceX > 1) {
+			const uint16_t fromX = std::min(start.x, destination.x) + 1;
+			const uint16_t toX = std::max(start.x, destination.x) - 1;
+			return !isBlockingRow(fromX, toX, start.y, start.z, TILE_BLOCK_PROJECTILE);
 		}
 	} else if (start.x == destination.x) {
 		// Vertical line
@@ -510,8 +533,7 @@ bool Map::checkSightLine(Position start, Position destination) {
 		while (--distanceY > 0) {
 			start.y += delta;
 
-			const auto &tile = getTile(start.x, start.y, start.z);
-			if (tile && tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
+			if (isBlocking(start.x, start.y, start.z, TILE_BLOCK_PROJECTILE)) {
 				return false;
 			}
 		}
@@ -543,8 +565,7 @@ bool Map::checkSightLine(Position start, Position destination) {
 					xIncrease = deltaX;
 				}
 
-				const auto &tile = getTile(start.x + xIncrease, start.y + deltaY, start.z);
-				if (tile && tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
+				if (isBlocking(start.x + xIncrease, start.y + deltaY, start.z, TILE_BLOCK_PROJECTILE)) {
 					if (Position::areInRange<1, 1>(start, destination)) {
 						return true;
 					}
@@ -574,8 +595,7 @@ bool Map::checkSightLine(Position start, Position destination) {
 					yIncrease = deltaY;
 				}
 
-				const auto &tile = getTile(start.x + deltaX, start.y + yIncrease, start.z);
-				if (tile && tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
+				if (isBlocking(start.x + deltaX, start.y + yIncrease, start.z, TILE_BLOCK_PROJECTILE)) {
 					if (Position::areInRange<1, 1>(start, destination)) {
 						return true;
 					}
@@ -645,6 +665,13 @@ std::shared_ptr<Tile> Map::canWalkTo(const std::shared_ptr<Creature> &creature,
 		return nullptr;
 	}
 
+	// Rejects from the bitmaps before the tile is created, players still push through safe magic walls
+	if (creature->getPosition() != pos) {
+		if (isBlocking(pos.x, pos.y, pos.z, TILE_BLOCK_PATH) || (!creature->getPlayer() && isBlocking(pos.x, pos.y, pos.z, TILE_BLOCK_SOLID))) {
+			return nullptr;
+		}
+	}
+
 	const auto &tile = getTile(pos.x, pos.y, pos.z);
 	if (creature->getTile() != tile) {
 		if (!tile || tile->queryAdd(0, creature, 1, FLAG_PATHFINDING | FLAG_IGNOREFIELDDAMAGE) != RETURNVALUE_NOERROR) {
@@ -676,7 +703,8 @@ bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, const Posit
 	Position pos = withoutCreature ? _targetPos : creature->getPosition();
 	Position endPos;
 
-	AStarNodes nodes(pos.x, pos.y, AStarNodes::getTileWalkCost(creature, getTile(pos.x, pos.y, pos.z)));
+	const auto nodes = AStarNodes::acquire(pos.x, pos.y, AStarNodes::getTileWalkCost(creature, getTile(pos.x, pos.y, pos.z)), g_configManager().getNumber(PATHFINDING_MAX_NODES));
+	const auto maxExpandedNodes = g_configManager().getNumber(PATHFINDING_MAX_EXPANDED_NODES);
 
 	int32_t bestMatch = 0;
 
@@ -690,7 +718,7 @@ bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, const Posit
 
 	const AStarNode* found = nullptr;
 	do {
-		AStarNode* n = nodes.getBestNode();
+		AStarNode* n = nodes->getBestNode();
 		if (!n) {
 			if (found) {
 				break;
@@ -752,7 +780,7 @@ bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, const Posit
 			pos.y = y + *neighbors++;
 
 			int_fast32_t extraCost;
-			AStarNode* neighborNode = nodes.getNodeByPosition(pos.x, pos.y);
+			AStarNode* neighborNode = nodes->getNodeByPosition(pos.x, pos.y);
 			if (neighborNode) {
 				extraCost = neighborNode->c;
 			} else {
@@ -773,12 +801,12 @@ bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, const Posit
 				}
 				neighborNode->f = newf;
 				neighborNode->parent = n;
-				nodes.openNode(neighborNode);
+				nodes->openNode(neighborNode);
 			} else {
 				// Does not exist in the open/closed list, create a new node
 				const int_fast32_t dX = std::abs(targetPos.getX() - pos.getX());
 				const int_fast32_t dY = std::abs(targetPos.getY() - pos.getY());
-				if (!nodes.createOpenNode(n, pos.x, pos.y, newf, ((dX - sX) << 3) + ((dY - sY) << 3) + (std::max(dX, dY) << 3), extraCost)) {
+				if (!nodes->createOpenNode(n, pos.x, pos.y, newf, ((dX - sX) << 3) + ((dY - sY) << 3) + (std::max(dX, dY) << 3), extraCost)) {
 					if (found) {
 						break;
 					}
@@ -786,8 +814,8 @@ bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, const Posit
 				}
 			}
 		}
-		nodes.closeNode(n);
-	} while (nodes.getClosedNodes() < 100);
+		nodes->closeNode(n);
+	} while (nodes->getClosedNodes() < maxExpandedNodes);
 	if (!found) {
 		return false;
 	}
@@ -834,6 +862,66 @@ bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, const Posit
 	return true;
 }
 
+bool Map::getFollowPath(const std::shared_ptr<Creature> &creature, const std::shared_ptr<Creature> &target, std::vector<Direction> &dirList, const FindPathParams &fpp) {
+	// The field leads next to the target, monsters keeping any other distance search on their own
+	if (!creature->getMonster() || fpp.keepDistance || fpp.maxTargetDist > 1 || creature->getPosition().z != target->getPosition().z) {
+		return false;
+	}
+
+	const auto &field = flowFields.get(*this, target);
+	const auto startSize = dirList.size();
+	if (!field || !field->getPath(*this, creature, dirList)) {
+		return false;
+	}
+
+	// The field knows nothing of sight or of the side to end on, its end has to be one the A* search would accept
+	const auto &startPos = creature->getPosition();
+	Position endPos = startPos;
+	for (auto it = dirList.begin() + startSize; it != dirList.end(); ++it) {
+		endPos = getNextPosition(*it, endPos);
+	}
+
+	int32_t bestMatchDist = 0;
+	if (!FrozenPathingConditionCall(target->getPosition())(startPos, endPos, fpp, bestMatchDist)) {
+		dirList.resize(startSize);
+		return false;
+	}
+	return true;
+}
+
+bool Map::getRoute(const Position &startPos, const Position &targetPos, std::vector<Direction> &dirList, const FindPathParams &fpp) {
+	// A bounded search keeps its bound
+	if (fpp.maxSearchDist != 0) {
+		return false;
+	}
+
+	std::vector<Direction> route;
+	if (!routeGraph.getPath(*this, startPos, targetPos, route)) {
+		return false;
+	}
+
+	// Stops at the first step in range of the target, as the A* search does
+	const auto minTargetDist = std::max<int32_t>(fpp.minTargetDist, 0);
+	const auto maxTargetDist = std::max<int32_t>(fpp.maxTargetDist, minTargetDist);
+	const auto inRange = [&targetPos, minTargetDist, maxTargetDist](const Position &pos) {
+		const auto distance = Position::getDiagonalDistance(pos, targetPos);
+		return distance >= minTargetDist && distance <= maxTargetDist;
+	};
+
+	Position pos = startPos;
+	size_t steps = 0;
+	while (!inRange(pos)) {
+		// The route only closes in on the target, it can't get back away from it
+		if (steps == route.size()) {
+			return false;
+		}
+		pos = getNextPosition(route[steps++], pos);
+	}
+
+	dirList.insert(dirList.end(), route.begin(), route.begin() + steps);
+	return true;
+}
+
 bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, std::vector<Direction> &dirList, const FrozenPathingConditionCall &pathCondition, const FindPathParams &fpp) {
 	return getPathMatching(creature, creature->getPosition(), dirList, pathCondition, fpp);
 }
@@ -842,7 +930,8 @@ bool Map::getPathMatchingCond(const std::shared_ptr<Creature> &creature, const P
 	Position pos = creature->getPosition();
 	Position endPos;
 
-	AStarNodes nodes(pos.x, pos.y, AStarNodes::getTileWalkCost(creature, getTile(pos.x, pos.y, pos.z)));
+	const auto nodes = AStarNodes::acquire(pos.x, pos.y, AStarNodes::getTileWalkCost(creature, getTile(pos.x, pos.y, pos.z)), g_configManager().getNumber(PATHFINDING_MAX_NODES));
+	const auto maxExpandedNodes = g_configManager().getNumber(PATHFINDING_MAX_EXPANDED_NODES);
 
 	int32_t bestMatch = 0;
 
@@ -870,7 +959,7 @@ bool Map::getPathMatchingCond(const std::shared_ptr<Creature> &creature, const P
 
 	const AStarNode* found = nullptr;
 	do {
-		AStarNode* n = nodes.getBestNode();
+		AStarNode* n = nodes->getBestNode();
 		if (!n) {
 			if (found) {
 				break;
@@ -939,7 +1028,7 @@ bool Map::getPathMatchingCond(const std::shared_ptr<Creature> &creature, const P
 			}
 
 			int_fast32_t extraCost;
-			AStarNode* neighborNode = nodes.getNodeByPosition(pos.x, pos.y);
+			AStarNode* neighborNode = nodes->getNodeByPosition(pos.x, pos.y);
 			if (neighborNode) {
 				extraCost = neighborNode->c;
 			} else {
@@ -960,12 +1049,12 @@ bool Map::getPathMatchingCond(const std::shared_ptr<Creature> &creature, const P
 				}
 				neighborNode->f = newf;
 				neighborNode->parent = n;
-				nodes.openNode(neighborNode);
+				nodes->openNode(neighborNode);
 			} else {
 				// Does not exist in the open/closed list, create a new node
 				const int_fast32_t dX = std::abs(targetPos.getX() - pos.getX());
 				const int_fast32_t dY = std::abs(targetPos.getY() - pos.getY());
-				if (!nodes.createOpenNode(n, pos.x, pos.y, newf, ((dX - sX) << 3) + ((dY - sY) << 3) + (std::max(dX, dY) << 3), extraCost)) {
+				if (!nodes->createOpenNode(n, pos.x, pos.y, newf, ((dX - sX) << 3) + ((dY - sY) << 3) + (std::max(dX, dY) << 3), extraCost)) {
 					if (found) {
 						break;
 					}
@@ -973,8 +1062,8 @@ bool Map::getPathMatchingCond(const std::shared_ptr<Creature> &creature, const P
 				}
 			}
 		}
-		nodes.closeNode(n);
-	} while (fpp.maxSearchDist != 0 || nodes.getClosedNodes() < 100);
+		nodes->closeNode(n);
+	} while (fpp.maxSearchDist != 0 || nodes->getClosedNodes() < maxExpandedNodes);
 
 	if (!found) {
 		return false;
@@ -10,6 +10,8 @@
 #pragma once
 
 #include "mapcache.hpp"
+#include "map/utils/flowfield.hpp"
+#include "map/utils/routegraph.hpp"
 #include "map/town.hpp"
 #include "map/house/house.hpp"
 #include "creatures/monsters/spawns/spawn_monster.hpp"
@@ -39,9 +41,9 @@ public:
 
 	/**
 	 * Load a map.
-	 * \returns true if the map was loaded successfully
+	 * \param threads Threads decoding the map, 0 uses every thread of the pool
 	 */
-	void load(const std::string &identifier, const Position &pos = Position());
+	void load(const std::string &identifier, const Position &pos = Position(), uint32_t threads = 0);
 	/**
 	 * Load the main map
 	 * \param identifier Is the main map name (name of file .otbm)
@@ -130,6 +132,23 @@ public:
 		return getPathMatching(nullptr, startPos, dirList, pathCondition, fpp);
 	}
 
+	/**
+	 * Path of a monster next to the creature it chases, read from the flow field shared by everyone chasing it.
+	 * Its end is checked like getPathMatching checks it, sight and distance included.
+	 * \returns false if the field can not be used, the follower searches with getPathMatching.
+	 */
+	bool getFollowPath(const std::shared_ptr<Creature> &creature, const std::shared_ptr<Creature> &target, std::vector<Direction> &dirList, const FindPathParams &fpp);
+	void removeFlowField(uint32_t creatureId) {
+		flowFields.erase(creatureId);
+	}
+
+	/**
+	 * Long route through the sector graph, for the scripted walks the A* search can not reach.
+	 * Only walls, floor changes and teleports are avoided, the walker checks everything else step by step.
+	 * \returns false if the search is bounded by fpp.maxSearchDist, there is no route or no step of it is within fpp.minTargetDist and fpp.maxTargetDist of the target.
+	 */
+	bool getRoute(const Position &startPos, const Position &targetPos, std::vector<Direction> &dirList, const FindPathParams &fpp);
+
 	std::map<std::string, Position> waypoints;
 
 	// Storage made by "loadFromXML" of houses, monsters and npcs for main map
@@ -162,7 +181,12 @@ private:
 	uint32_t width = 0;
 	uint32_t height = 0;
 
+	FlowFields flowFields;
+	RouteGraph routeGraph;
+
 	friend class Game;
 	friend class IOMap;
+	friend class IOMapSnapshot;
+	friend class MapSnapshotWriter;
 	friend class MapCache;
 };
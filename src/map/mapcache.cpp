@@ -17,25 +17,98 @@
 #include "items/containers/depot/depotlocker.hpp"
 #include "items/item.hpp"
 #include "map/map.hpp"
+#include "map/spectators.hpp"
 #include "utils/hash.hpp"
+#include "utils/tools.hpp"
 
-static phmap::flat_hash_map<size_t, std::shared_ptr<BasicItem>> items;
-static phmap::flat_hash_map<size_t, std::shared_ptr<BasicTile>> tiles;
+// Shared by the threads decoding the map, each submap has its own lock
+static phmap::parallel_flat_hash_map_m<size_t, std::shared_ptr<BasicItem>> items;
 
 std::shared_ptr<BasicItem> static_tryGetItemFromCache(const std::shared_ptr<BasicItem> &ref) {
-	return ref ? items.try_emplace(ref->hash(), ref).first->second : nullptr;
+	if (!ref) {
+		return nullptr;
+	}
+
+	auto cached = ref;
+	items.try_emplace_l(ref->hash(), [&cached](const auto &entry) { cached = entry.second; }, ref);
+	return cached;
 }
 
-std::shared_ptr<BasicTile> static_tryGetTileFromCache(const std::shared_ptr<BasicTile> &ref) {
-	return ref ? tiles.try_emplace(ref->hash(), ref).first->second : nullptr;
+namespace {
+	// Hashes everything a map item can carry, an item changed since it was created no longer matches
+	void hashItem(const std::shared_ptr<Item> &item, size_t &h) {
+		const auto &teleport = item->getTeleport();
+		const auto destination = teleport ? teleport->getDestPos() : Position();
+		const auto &container = item->getContainer();
+		const auto depotLocker = container ? container->getDepotLocker() : nullptr;
+
+		const std::array<uint32_t, 11> arr = {
+			item->getID(),
+			item->getSubType(),
+			item->getAttribute<uint16_t>(ItemAttribute_t::ACTIONID),
+			item->getAttribute<uint16_t>(ItemAttribute_t::UNIQUEID),
+			item->getAttribute<uint32_t>(ItemAttribute_t::DOORID),
+			destination.x,
+			destination.y,
+			destination.z,
+			depotLocker ? depotLocker->getDepotId() : 0u,
+			static_cast<uint32_t>(item->getDecaying()),
+			item->hasCustomAttribute(),
+		};
+		for (const auto v : arr) {
+			stdext::hash_combine(h, v);
+		}
+
+		stdext::hash_combine(h, item->getAttribute<std::string>(ItemAttribute_t::TEXT));
+
+		if (container) {
+			stdext::hash_combine(h, container->size());
+			for (const auto &inside : container->getItemList()) {
+				hashItem(inside, h);
+			}
+		}
+	}
+
+	size_t fingerprintTile(const std::shared_ptr<Tile> &tile) {
+		size_t h = 0;
+		if (const auto &ground = tile->getGround()) {
+			hashItem(ground, h);
+		}
+
+		if (const auto itemList = tile->getItemList()) {
+			stdext::hash_combine(h, itemList->size());
+			for (const auto &item : *itemList) {
+				hashItem(item, h);
+			}
+		}
+		return h;
+	}
+
+	// Something other than its parent holds the item: a decay list, a unique id, a script...
+	bool isItemReferenced(const std::shared_ptr<Item> &item) {
+		if (item.use_count() > 1) {
+			return true;
+		}
+
+		const auto &container = item->getContainer();
+		return container && std::ranges::any_of(container->getItemList(), isItemReferenced);
+	}
 }
 
-void MapCache::flush() const {
+MapCache::~MapCache() {
+	for (auto &page : sectorPages) {
+		delete page.load(std::memory_order_relaxed);
+	}
+}
+
+void MapCache::flush() {
 	items.clear();
-	tiles.clear();
+
+	std::scoped_lock lock(basicTileHandlesMutex);
+	basicTileHandles.clear();
 }
 
-void MapCache::parseItemAttr(const std::shared_ptr<BasicItem> &BasicItem, const std::shared_ptr<Item> &item) const {
+void MapCache::parseItemAttr(const std::shared_ptr<BasicItem> &BasicItem, const std::shared_ptr<Item> &item, UniqueIdList &uniqueIds) const {
 	if (BasicItem->charges > 0) {
 		item->setSubType(BasicItem->charges);
 	}
@@ -44,8 +117,9 @@ void MapCache::parseItemAttr(const std::shared_ptr<BasicItem> &BasicItem, const
 		item->setAttribute(ItemAttribute_t::ACTIONID, BasicItem->actionId);
 	}
 
+	// Registered once the tile holding the item is stored
 	if (BasicItem->uniqueId > 0) {
-		item->addUniqueId(BasicItem->uniqueId);
+		uniqueIds.emplace_back(item, BasicItem->uniqueId);
 	}
 
 	if (item->getTeleport() && (BasicItem->destX != 0 || BasicItem->destY != 0 || BasicItem->destZ != 0)) {
@@ -69,17 +143,17 @@ void MapCache::parseItemAttr(const std::shared_ptr<BasicItem> &BasicItem, const
 	    item->setAttribute(ItemAttribute_t::DESCRIPTION, STRING_CACHE[BasicItem.description]);*/
 }
 
-std::shared_ptr<Item> MapCache::createItem(const std::shared_ptr<BasicItem> &BasicItem, Position position) {
+std::shared_ptr<Item> MapCache::createItem(const std::shared_ptr<BasicItem> &BasicItem, Position position, UniqueIdList &uniqueIds, DecayingItemList &decayingItems) {
 	const auto &item = Item::CreateItem(BasicItem->id, position);
 	if (!item) {
 		return nullptr;
 	}
 
-	parseItemAttr(BasicItem, item);
+	parseItemAttr(BasicItem, item, uniqueIds);
 
 	if (item->getContainer() && !BasicItem->items.empty()) {
 		for (const auto &BasicItemInside : BasicItem->items) {
-			if (auto itemInsede = createItem(BasicItemInside, position)) {
+			if (auto itemInsede = createItem(BasicItemInside, position, uniqueIds, decayingItems)) {
 				item->getContainer()->addItem(itemInsede);
 				item->getContainer()->updateItemWeight(itemInsede->getWeight());
 			}
@@ -90,46 +164,45 @@ std::shared_ptr<Item> MapCache::createItem(const std::shared_ptr<BasicItem> &Bas
 		item->setItemCount(1);
 	}
 
+	item->loadedFromMap = true;
+	// Started once the tile holding the item is stored, decay is disabled after that
 	if (item->canDecay()) {
-		item->startDecaying();
+		decayingItems.emplace_back(item);
+	} else {
+		item->decayDisabled = Item::items[item->getID()].decayTo != -1;
 	}
-	item->loadedFromMap = true;
-	item->decayDisabled = Item::items[item->getID()].decayTo != -1;
 
 	return item;
 }
 
-std::shared_ptr<Tile> MapCache::getOrCreateTileFromCache(const std::shared_ptr<Floor> &floor, uint16_t x, uint16_t y) {
-	const auto &cachedTile = floor->getTileCache(x, y);
-	const auto oldTile = floor->getTile(x, y);
-	if (!cachedTile) {
-		return oldTile;
-	}
+std::shared_ptr<Tile> MapCache::getOrCreateTileFromCache(Floor* floor, uint16_t x, uint16_t y) {
+	auto cachedHandle = floor->getTileCache(x, y);
+	if (cachedHandle == BasicTileArena::NONE) {
+		if (auto tile = getFloorTile(floor, x, y)) {
+			return tile;
+		}
 
-	std::unique_lock l(floor->getMutex());
+		// An eviction sets the cache before clearing the tile, so a missing tile with no cache is really empty
+		cachedHandle = floor->getTileCache(x, y);
+		if (cachedHandle == BasicTileArena::NONE) {
+			return nullptr;
+		}
+	}
 
+	const auto &cachedTile = basicTileArena.get(cachedHandle);
 	const uint8_t z = floor->getZ();
 	const auto map = static_cast<Map*>(this);
 
-	std::vector<std::shared_ptr<Creature>> oldCreatureList;
-	if (oldTile) {
-		if (CreatureVector* creatures = oldTile->getCreatures()) {
-			for (const auto &creature : *creatures) {
-				oldCreatureList.emplace_back(creature);
-			}
-		}
-	}
-
+	// The tile is built without the floor lock, nothing outside of it knows about it until it is stored
 	std::shared_ptr<Tile> tile = nullptr;
+	UniqueIdList uniqueIds;
+	DecayingItemList decayingItems;
 
 	auto pos = Position(x, y, z);
 
 	if (cachedTile->isHouse()) {
 		if (const auto &house = map->houses.getHouse(cachedTile->houseId)) {
 			tile = std::make_shared<HouseTile>(pos, house);
-			tile->safeCall([tile] {
-				tile->getHouse()->addTile(tile->static_self_cast<HouseTile>());
-			});
 		} else {
 			g_logger().error("[{}] house not found for houseId {}", std::source_location::current().function_name(), cachedTile->houseId);
 		}
@@ -140,15 +213,51 @@ std::shared_ptr<Tile> MapCache::getOrCreateTileFromCache(const std::shared_ptr<F
 	}
 
 	if (cachedTile->ground != nullptr) {
-		tile->internalAddThing(createItem(cachedTile->ground, pos));
+		tile->internalAddThing(createItem(cachedTile->ground, pos, uniqueIds, decayingItems));
 	}
 
 	for (const auto &BasicItemd : cachedTile->items) {
-		tile->internalAddThing(createItem(BasicItemd, pos));
+		tile->internalAddThing(createItem(BasicItemd, pos, uniqueIds, decayingItems));
 	}
 
 	tile->setFlag(static_cast<TileFlags_t>(cachedTile->flags));
 
+	std::unique_lock l(floor->getMutex());
+
+	// Another thread may have stored the tile while this one was building it, the copy is dropped
+	if (const auto currentHandle = floor->getTileCache(x, y); currentHandle != cachedHandle) {
+		if (currentHandle == BasicTileArena::NONE) {
+			return getFloorTile(floor, x, y);
+		}
+
+		l.unlock();
+		return getOrCreateTileFromCache(floor, x, y);
+	}
+
+	for (const auto &[item, uniqueId] : uniqueIds) {
+		item->addUniqueId(uniqueId);
+	}
+
+	for (const auto &item : decayingItems) {
+		item->startDecaying();
+		item->decayDisabled = Item::items[item->getID()].decayTo != -1;
+	}
+
+	if (tile->getHouse()) {
+		tile->safeCall([tile] {
+			tile->getHouse()->addTile(tile->static_self_cast<HouseTile>());
+		});
+	}
+
+	std::vector<std::shared_ptr<Creature>> oldCreatureList;
+	if (const auto oldTile = getFloorTile(floor, x, y)) {
+		if (CreatureVector* creatures = oldTile->getCreatures()) {
+			for (const auto &creature : *creatures) {
+				oldCreatureList.emplace_back(creature);
+			}
+		}
+	}
+
 	tile->safeCall([tile, pos, movedOldCreatureList = std::move(oldCreatureList)]() {
 		for (const auto &creature : movedOldCreatureList) {
 			tile->internalAddThing(creature);
@@ -159,41 +268,158 @@ std::shared_ptr<Tile> MapCache::getOrCreateTileFromCache(const std::shared_ptr<F
 		}
 	});
 
-	floor->setTile(x, y, tile);
+	// Creatures and zones don't change the contents, the fingerprint can be taken before they are added
+	setFloorTile(floor, x, y, tile, cachedHandle, fingerprintTile(tile));
 
 	// Remove Tile from cache
-	floor->setTileCache(x, y, nullptr);
+	floor->setTileCache(x, y, BasicTileArena::NONE);
 
 	return tile;
 }
 
+void MapCache::setFloorTile(Floor* floor, uint16_t x, uint16_t y, const std::shared_ptr<Tile> &tile, BasicTileHandle origin, size_t fingerprint) {
+	const auto handle = tile ? tileArena.allocate({ tile, origin, fingerprint }) : TileArena::NONE;
+	if (tile && handle == TileArena::NONE) {
+		g_logger().error("[{}] tile arena is full, can't store tile {}", __FUNCTION__, Position(x, y, floor->getZ()).toString());
+		return;
+	}
+
+	// Readers may still hold the old handle, its slot is recycled once their guards are gone
+	const auto oldHandle = floor->getTile(x, y);
+	if (oldHandle != TileArena::NONE) {
+		if (const auto &oldTile = tileArena.get(oldHandle).tile; oldTile && oldTile != tile) {
+			oldTile->setMapFloor(nullptr);
+		}
+	}
+	floor->setTile(x, y, handle);
+	tileArena.release(oldHandle);
+
+	// The tile keeps its cell of the block bitmaps up to date from now on
+	if (tile) {
+		tile->setMapFloor(floor);
+	} else {
+		const auto cachedHandle = floor->getTileCache(x, y);
+		floor->setBlocks(x, y, cachedHandle != BasicTileArena::NONE ? getBlocks(*basicTileArena.get(cachedHandle)) : TILE_BLOCK_EMPTY);
+	}
+}
+
 void MapCache::setBasicTile(uint16_t x, uint16_t y, uint8_t z, const std::shared_ptr<BasicTile> &newTile) {
+	setBasicTile(x, y, z, newTile ? addBasicTile(newTile) : BasicTileArena::NONE);
+}
+
+BasicTileHandle MapCache::addBasicTile(const std::shared_ptr<BasicTile> &newTile) {
+	std::scoped_lock lock(basicTileHandlesMutex);
+	auto [it, inserted] = basicTileHandles.try_emplace(newTile->hash(), BasicTileArena::NONE);
+	if (inserted) {
+		it->second = basicTileArena.allocate(newTile);
+	}
+	return it->second;
+}
+
+void MapCache::setBasicTile(uint16_t x, uint16_t y, uint8_t z, BasicTileHandle handle) {
 	if (z >= MAP_MAX_LAYERS) {
 		g_logger().error("Attempt to set tile on invalid coordinate: {}", Position(x, y, z).toString());
 		return;
 	}
 
-	const auto &tile = static_tryGetTileFromCache(newTile);
-	if (const auto sector = getMapSector(x, y)) {
-		sector->createFloor(z)->setTileCache(x, y, tile);
-	} else {
-		getBestMapSector(x, y)->createFloor(z)->setTileCache(x, y, tile);
+	auto sector = getMapSector(x, y);
+	if (!sector) {
+		sector = getBestMapSector(x, y);
+	}
+
+	const auto floor = sector->createFloor(z);
+	std::scoped_lock lock(floor->getMutex());
+	floor->setTileCache(x, y, handle);
+
+	// A created tile owns the cell bits
+	if (floor->getTile(x, y) == TileArena::NONE) {
+		floor->setBlocks(x, y, handle != BasicTileArena::NONE ? getBlocks(*basicTileArena.get(handle)) : TILE_BLOCK_EMPTY);
 	}
 }
 
+uint8_t MapCache::getBlocks(const BasicTile &basicTile) {
+	if (!basicTile.ground) {
+		return TILE_BLOCK_EMPTY;
+	}
+
+	// Same properties Tile::setTileFlags reads from the created items
+	uint8_t blocks = TILE_BLOCK_NONE;
+	const auto addItem = [&blocks](const BasicItem &item) {
+		const ItemType &it = Item::items[item.id];
+		if (it.blockSolid && (!it.movable || item.uniqueId != 0 || item.actionId == IMMOVABLE_ACTION_ID)) {
+			blocks |= TILE_BLOCK_SOLID;
+		}
+		if (it.floorChange != 0 || it.isTeleport()) {
+			blocks |= TILE_BLOCK_PATH;
+		}
+		if (it.blockProjectile) {
+			blocks |= TILE_BLOCK_PROJECTILE;
+		}
+	};
+
+	addItem(*basicTile.ground);
+	for (const auto &item : basicTile.items) {
+		addItem(*item);
+	}
+	return blocks;
+}
+
+bool MapCache::isBlockingRow(uint16_t fromX, uint16_t toX, uint16_t y, uint8_t z, TileBlock_t block) const {
+	if (fromX > toX) {
+		std::swap(fromX, toX);
+	}
+
+	// One word per sector crossed
+	for (uint32_t x = fromX; x <= toX;) {
+		const uint32_t sectorEnd = std::min<uint32_t>(x | SECTOR_MASK, toX);
+		const auto sector = getMapSector(x, y);
+		const auto floor = sector && z < MAP_MAX_LAYERS ? sector->getFloor(z) : nullptr;
+		if (!floor) {
+			if (TILE_BLOCK_EMPTY & block) {
+				return true;
+			}
+		} else {
+			const uint64_t mask = ((uint64_t(1) << (sectorEnd - x + 1)) - 1) << (x & SECTOR_MASK);
+			if (floor->getBlockingRow(y, block) & mask) {
+				return true;
+			}
+		}
+		x = sectorEnd + 1;
+	}
+	return false;
+}
+
 std::shared_ptr<BasicItem> MapCache::tryReplaceItemFromCache(const std::shared_ptr<BasicItem> &ref) const {
 	return static_tryGetItemFromCache(ref);
 }
 
 MapSector* MapCache::createMapSector(const uint32_t x, const uint32_t y) {
-	const uint32_t index = x / SECTOR_SIZE | y / SECTOR_SIZE << 16;
-	const auto it = mapSectors.find(index);
-	if (it != mapSectors.end()) {
-		return &it->second;
+	const uint32_t sectorX = x / SECTOR_SIZE;
+	const uint32_t sectorY = y / SECTOR_SIZE;
+	if (sectorX >= SECTOR_GRID_SIZE || sectorY >= SECTOR_GRID_SIZE) {
+		g_logger().error("Attempt to create sector on invalid coordinate: {}, {}", x, y);
+		return nullptr;
+	}
+
+	std::scoped_lock lock(sectorsMutex);
+	auto &page = sectorPages[pageIndex(sectorX, sectorY)];
+	if (!page.load(std::memory_order_relaxed)) {
+		page.store(new SectorPage(), std::memory_order_release);
+	}
+
+	auto &slot = page.load(std::memory_order_relaxed)->sectors[sectorIndex(sectorX, sectorY)];
+	if (const auto sector = slot.load(std::memory_order_relaxed)) {
+		return sector;
 	}
 
 	MapSector::newSector = true;
-	return &mapSectors[index];
+	auto* sector = &sectors.emplace_back();
+	sector->sectorX = static_cast<uint16_t>(sectorX);
+	sector->sectorY = static_cast<uint16_t>(sectorY);
+	// A sector nobody visited yet only becomes idle after a full idle time
+	sector->lastPlayerVisit = OTSYS_TIME(true);
+	slot.store(sector, std::memory_order_release);
+	return sector;
 }
 
 MapSector* MapCache::getBestMapSector(uint32_t x, uint32_t y) {
@@ -220,11 +446,171 @@ MapSector* MapCache::getBestMapSector(uint32_t x, uint32_t y) {
 		if (const auto eastSector = getMapSector(x + SECTOR_SIZE, y)) {
 			sector->sectorE = eastSector;
 		}
+
+		subscribePlayers(sector);
 	}
 
 	return sector;
 }
 
+void MapCache::subscribePlayers(MapSector* sector) const {
+	// Players subscribe to the sectors around them as they move, the ones already around missed this one
+	const int32_t startX = sector->sectorX * SECTOR_SIZE;
+	const int32_t startY = sector->sectorY * SECTOR_SIZE;
+	const int32_t rangeX = MAP_MAX_VIEW_PORT_X + MAP_INIT_SURFACE_LAYER;
+	const int32_t rangeY = MAP_MAX_VIEW_PORT_Y + MAP_INIT_SURFACE_LAYER;
+	const int32_t x1 = std::max<int32_t>(0, startX - rangeX);
+	const int32_t y1 = std::max<int32_t>(0, startY - rangeY);
+	const int32_t x2 = std::min<int32_t>(0xFFFF, startX + SECTOR_SIZE - 1 + rangeX);
+	const int32_t y2 = std::min<int32_t>(0xFFFF, startY + SECTOR_SIZE - 1 + rangeY);
+
+	std::vector<std::shared_ptr<Creature>> players;
+	for (int32_t ny = y1 - (y1 & SECTOR_MASK); ny <= y2; ny += SECTOR_SIZE) {
+		for (int32_t nx = x1 - (x1 & SECTOR_MASK); nx <= x2; nx += SECTOR_SIZE) {
+			const auto neighbor = getMapSector(nx, ny);
+			if (!neighbor || neighbor == sector) {
+				continue;
+			}
+
+			for (const auto &player : neighbor->player_list) {
+				if (Spectators::isSubscribed(player->getPosition(), startX, startY)) {
+					players.emplace_back(player);
+				}
+			}
+		}
+	}
+	Spectators::subscribe(*sector, players);
+}
+
+MapMemoryStats MapCache::getMemoryStats() const {
+	MapMemoryStats stats;
+	stats.sectorBytes = sizeof(sectorPages);
+
+	{
+		std::scoped_lock lock(sectorsMutex);
+		for (const auto &page : sectorPages) {
+			if (page.load(std::memory_order_relaxed)) {
+				stats.sectorBytes += sizeof(SectorPage);
+			}
+		}
+
+		stats.sectors = sectors.size();
+		stats.sectorBytes += sectors.size() * sizeof(MapSector);
+		for (const auto &sector : sectors) {
+			for (uint8_t z = 0; z < MAP_MAX_LAYERS; ++z) {
+				const auto floor = sector.getFloor(z);
+				if (!floor) {
+					continue;
+				}
+
+				++stats.floors;
+				stats.sectorBytes += sizeof(Floor);
+				for (uint16_t y = 0; y < SECTOR_SIZE; ++y) {
+					for (uint16_t x = 0; x < SECTOR_SIZE; ++x) {
+						if (floor->getTileCache(x, y) != BasicTileArena::NONE) {
+							++stats.cachedTiles;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	stats.tiles = tileArena.size();
+	stats.basicTiles = basicTileArena.size();
+	stats.arenaBytes = tileArena.memoryUsage() + basicTileArena.memoryUsage();
+	return stats;
+}
+
+size_t MapCache::evictIdleTiles(int64_t idleTime) {
+	// Slots released by earlier evictions are recycled once the readers that saw them are gone
+	tileArena.collect();
+
+	const auto now = OTSYS_TIME();
+	size_t evicted = 0;
+
+	std::scoped_lock lock(sectorsMutex);
+	if (sectors.empty()) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < std::min(EVICTION_SECTORS_PER_CALL, sectors.size()); ++i) {
+		auto &sector = sectors[evictionCursor++ % sectors.size()];
+		if (!isSectorIdle(sector, now, idleTime)) {
+			continue;
+		}
+
+		for (uint8_t z = 0; z < MAP_MAX_LAYERS; ++z) {
+			if (const auto floor = sector.getFloor(z)) {
+				evicted += evictFloorTiles(floor);
+			}
+		}
+	}
+	evictionCursor %= sectors.size();
+
+	return evicted;
+}
+
+bool MapCache::isSectorIdle(const MapSector &sector, int64_t now, int64_t idleTime) const {
+	if (!sector.creature_list.empty()) {
+		return false;
+	}
+
+	// Players see up to 9 tiles away, so the neighbour sectors count as well
+	for (int32_t dy = -1; dy <= 1; ++dy) {
+		for (int32_t dx = -1; dx <= 1; ++dx) {
+			const int32_t sectorX = sector.sectorX + dx;
+			const int32_t sectorY = sector.sectorY + dy;
+			if (sectorX < 0 || sectorY < 0) {
+				continue;
+			}
+
+			const auto neighbour = getMapSector(sectorX * SECTOR_SIZE, sectorY * SECTOR_SIZE);
+			if (neighbour && (!neighbour->player_list.empty() || now - neighbour->getLastPlayerVisit() < idleTime)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+size_t MapCache::evictFloorTiles(Floor* floor) {
+	size_t evicted = 0;
+
+	std::scoped_lock lock(floor->getMutex());
+	for (uint16_t y = 0; y < SECTOR_SIZE; ++y) {
+		for (uint16_t x = 0; x < SECTOR_SIZE; ++x) {
+			const auto handle = floor->getTile(x, y);
+			if (handle == TileArena::NONE || floor->getTileCache(x, y) != BasicTileArena::NONE) {
+				continue;
+			}
+
+			const auto &[tile, origin, fingerprint] = tileArena.get(handle);
+			// Only the arena may hold the tile, anything else would keep using a detached copy
+			if (origin == BasicTileArena::NONE || tile.use_count() > 1 || tile->getCreatureCount() > 0 || tile->getHouse()) {
+				continue;
+			}
+
+			// getGround returns a copy, which is one more reference
+			const auto ground = tile->getGround();
+			const auto itemList = tile->getItemList();
+			if ((ground && ground.use_count() > 2) || (itemList && std::ranges::any_of(*itemList, isItemReferenced))) {
+				continue;
+			}
+
+			if (fingerprintTile(tile) != fingerprint) {
+				continue;
+			}
+
+			// The cache goes first, readers that miss the tile then find the cache
+			floor->setTileCache(x, y, origin);
+			setFloorTile(floor, x, y, nullptr);
+			++evicted;
+		}
+	}
+	return evicted;
+}
+
 void BasicTile::hash(size_t &h) const {
 	const std::array<uint32_t, 4> arr = { flags, houseId, type, isStatic };
 	for (const auto v : arr) {
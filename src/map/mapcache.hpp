@@ -10,6 +10,7 @@
 #pragma once
 
 #include "items/items_definitions.hpp"
+#include "utils/handle_arena.hpp"
 #include "utils/mapsector.hpp"
 
 class Map;
@@ -79,15 +80,40 @@ private:
 
 #pragma pack()
 
+/**
+ * Memory used by the map storage, see MapCache::getMemoryStats.
+ */
+struct MapMemoryStats {
+	size_t sectors = 0;
+	size_t floors = 0;
+	// Tiles materialized as Tile objects
+	size_t tiles = 0;
+	// Cells still only backed by a BasicTile template
+	size_t cachedTiles = 0;
+	// Distinct BasicTile templates
+	size_t basicTiles = 0;
+	// Sector page table, sectors and floors
+	size_t sectorBytes = 0;
+	// Tile and BasicTile handle arenas, without the objects they point to
+	size_t arenaBytes = 0;
+};
+
 class MapCache {
 public:
-	virtual ~MapCache() = default;
+	virtual ~MapCache();
 
 	void setBasicTile(uint16_t x, uint16_t y, uint8_t z, const std::shared_ptr<BasicTile> &BasicTile);
+	void setBasicTile(uint16_t x, uint16_t y, uint8_t z, BasicTileHandle handle);
+
+	/**
+	 * Registers a BasicTile template, identical templates share the same handle.
+	 * \returns The handle to give to setBasicTile.
+	 */
+	BasicTileHandle addBasicTile(const std::shared_ptr<BasicTile> &BasicTile);
 
 	std::shared_ptr<BasicItem> tryReplaceItemFromCache(const std::shared_ptr<BasicItem> &ref) const;
 
-	void flush() const;
+	void flush();
 
 	/**
 	 * Creates a map sector.
@@ -97,25 +123,143 @@ public:
 	MapSector* getBestMapSector(uint32_t x, uint32_t y);
 
 	/**
-	 * Gets a map sector.
+	 * Gets a map sector, without locking.
 	 * \returns A pointer to that map sector.
 	 */
-	MapSector* getMapSector(const uint32_t x, const uint32_t y) {
-		const auto it = mapSectors.find(x / SECTOR_SIZE | y / SECTOR_SIZE << 16);
-		return it != mapSectors.end() ? &it->second : nullptr;
+	MapSector* getMapSector(const uint32_t x, const uint32_t y) const {
+		const uint32_t sectorX = x / SECTOR_SIZE;
+		const uint32_t sectorY = y / SECTOR_SIZE;
+		if (sectorX >= SECTOR_GRID_SIZE || sectorY >= SECTOR_GRID_SIZE) {
+			return nullptr;
+		}
+
+		const auto page = sectorPages[pageIndex(sectorX, sectorY)].load(std::memory_order_acquire);
+		return page ? page->sectors[sectorIndex(sectorX, sectorY)].load(std::memory_order_acquire) : nullptr;
+	}
+
+	/**
+	 * Tests a cell in the block bitmaps without touching its tile.
+	 * Cells of floors that were never stored block like a missing tile.
+	 */
+	bool isBlocking(uint16_t x, uint16_t y, uint8_t z, TileBlock_t block) const {
+		const auto sector = getMapSector(x, y);
+		const auto floor = sector && z < MAP_MAX_LAYERS ? sector->getFloor(z) : nullptr;
+		return floor ? floor->isBlocking(x, y, block) : (TILE_BLOCK_EMPTY & block) != 0;
 	}
 
-	const MapSector* getMapSector(const uint32_t x, const uint32_t y) const {
-		const auto it = mapSectors.find(x / SECTOR_SIZE | y / SECTOR_SIZE << 16);
-		return it != mapSectors.end() ? &it->second : nullptr;
+	/**
+	 * \returns Floor::getWalkVersion of the floor holding the cell, 0 if it was never stored.
+	 */
+	uint32_t getWalkVersion(uint16_t x, uint16_t y, uint8_t z) const {
+		const auto sector = getMapSector(x, y);
+		const auto floor = sector && z < MAP_MAX_LAYERS ? sector->getFloor(z) : nullptr;
+		return floor ? floor->getWalkVersion() : 0;
 	}
 
+	/**
+	 * \returns true if any cell of the row from fromX to toX, both included, blocks.
+	 */
+	bool isBlockingRow(uint16_t fromX, uint16_t toX, uint16_t y, uint8_t z, TileBlock_t block) const;
+
+	/**
+	 * \returns What the tile created from the template will block.
+	 */
+	static uint8_t getBlocks(const BasicTile &basicTile);
+
+	/**
+	 * Counts the sectors, floors and tiles stored and the memory used to index them.
+	 */
+	MapMemoryStats getMemoryStats() const;
+
+	/**
+	 * Drops tiles back to the BasicTile they were created from, when nothing changed
+	 * them and no player has been around their sector for idleTime.
+	 * Each call scans the next EVICTION_SECTORS_PER_CALL sectors, wrapping around.
+	 * Must be called from the dispatcher thread.
+	 * \param idleTime Milliseconds without players in the sector or its neighbours.
+	 * \returns The number of evicted tiles.
+	 */
+	size_t evictIdleTiles(int64_t idleTime);
+
+	static constexpr size_t EVICTION_SECTORS_PER_CALL = 256;
+
 protected:
-	std::shared_ptr<Tile> getOrCreateTileFromCache(const std::shared_ptr<Floor> &floor, uint16_t x, uint16_t y);
+	std::shared_ptr<Tile> getOrCreateTileFromCache(Floor* floor, uint16_t x, uint16_t y);
+
+	std::shared_ptr<Tile> getFloorTile(const Floor* floor, uint16_t x, uint16_t y) const {
+		// The slot can't be recycled while the tile is copied out of it
+		TileArena::ReadGuard guard;
+		const auto handle = floor->getTile(x, y);
+		return handle != TileArena::NONE ? tileArena.get(handle).tile : nullptr;
+	}
+
+	/**
+	 * Stores a tile, the caller must hold the floor mutex.
+	 * \param origin The BasicTile the tile was created from, only such tiles can be evicted.
+	 * \param fingerprint Hash of the tile contents right after it was created.
+	 */
+	void setFloorTile(Floor* floor, uint16_t x, uint16_t y, const std::shared_ptr<Tile> &tile, BasicTileHandle origin = 0, size_t fingerprint = 0);
 
-	std::unordered_map<uint32_t, MapSector> mapSectors;
+	/**
+	 * Recycles the arena slots of replaced tiles.
+	 * Must only be called while no other thread can be reading the map.
+	 */
+	void reclaimTiles() {
+		tileArena.reclaim();
+	}
 
 private:
-	void parseItemAttr(const std::shared_ptr<BasicItem> &BasicItem, const std::shared_ptr<Item> &item) const;
-	std::shared_ptr<Item> createItem(const std::shared_ptr<BasicItem> &BasicItem, Position position);
+	struct TileSlot {
+		std::shared_ptr<Tile> tile;
+		BasicTileHandle origin = 0;
+		size_t fingerprint = 0;
+	};
+
+	using TileArena = HandleArena<TileSlot>;
+	using BasicTileArena = HandleArena<std::shared_ptr<BasicTile>>;
+
+	// Sectors are indexed by (x / SECTOR_SIZE, y / SECTOR_SIZE) in a two level page table
+	static constexpr uint32_t SECTOR_GRID_SIZE = (std::numeric_limits<uint16_t>::max() + 1) / SECTOR_SIZE;
+	static constexpr uint32_t SECTOR_PAGE_BITS = 6;
+	static constexpr uint32_t SECTOR_PAGE_SIZE = 1 << SECTOR_PAGE_BITS;
+	static constexpr uint32_t SECTOR_PAGE_MASK = SECTOR_PAGE_SIZE - 1;
+	static constexpr uint32_t SECTOR_PAGES_PER_ROW = SECTOR_GRID_SIZE / SECTOR_PAGE_SIZE;
+
+	struct alignas(64) SectorPage {
+		std::array<std::atomic<MapSector*>, SECTOR_PAGE_SIZE * SECTOR_PAGE_SIZE> sectors {};
+	};
+
+	static constexpr uint32_t pageIndex(uint32_t sectorX, uint32_t sectorY) {
+		return (sectorY >> SECTOR_PAGE_BITS) * SECTOR_PAGES_PER_ROW + (sectorX >> SECTOR_PAGE_BITS);
+	}
+
+	static constexpr uint32_t sectorIndex(uint32_t sectorX, uint32_t sectorY) {
+		return (sectorY & SECTOR_PAGE_MASK) * SECTOR_PAGE_SIZE + (sectorX & SECTOR_PAGE_MASK);
+	}
+
+	// Pages and sectors are only added, readers load them without locking
+	std::array<std::atomic<SectorPage*>, SECTOR_PAGES_PER_ROW * SECTOR_PAGES_PER_ROW> sectorPages {};
+	std::deque<MapSector> sectors;
+	mutable std::mutex sectorsMutex;
+
+	TileArena tileArena;
+	BasicTileArena basicTileArena;
+	// Deduplicates BasicTile templates by hash while a map is loading, cleared by flush
+	phmap::flat_hash_map<size_t, BasicTileHandle> basicTileHandles;
+	std::mutex basicTileHandlesMutex;
+
+	size_t evictionCursor = 0;
+
+	bool isSectorIdle(const MapSector &sector, int64_t now, int64_t idleTime) const;
+	size_t evictFloorTiles(Floor* floor);
+	// Adds the players around a new sector to its subscribers
+	void subscribePlayers(MapSector* sector) const;
+
+	// Items of a tile being built and the unique ids to register once it is stored
+	using UniqueIdList = std::vector<std::pair<std::shared_ptr<Item>, uint16_t>>;
+	// Items of a tile being built that start decaying once it is stored
+	using DecayingItemList = std::vector<std::shared_ptr<Item>>;
+
+	void parseItemAttr(const std::shared_ptr<BasicItem> &BasicItem, const std::shared_ptr<Item> &item, UniqueIdList &uniqueIds) const;
+	std::shared_ptr<Item> createItem(const std::shared_ptr<BasicItem> &BasicItem, Position position, UniqueIdList &uniqueIds, DecayingItemList &decayingItems);
 };
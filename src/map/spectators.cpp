@@ -13,34 +13,100 @@
 #include "game/game.hpp"
 
 phmap::flat_hash_map<Position, SpectatorsCache> Spectators::spectatorsCache;
+std::deque<Position> Spectators::cacheOrder;
+std::atomic<uint64_t> Spectators::cacheHits = 0;
+std::atomic<uint64_t> Spectators::cacheMisses = 0;
+std::atomic<uint64_t> Spectators::cacheEvictions = 0;
 
 void Spectators::clearCache() {
 	spectatorsCache.clear();
+	cacheOrder.clear();
 }
 
-Spectators Spectators::insert(const std::shared_ptr<Creature> &creature) {
+void Spectators::evictCacheEntry() {
+	// Every referenced entry goes back once, one full round at most
+	while (!cacheOrder.empty()) {
+		const auto pos = cacheOrder.front();
+		cacheOrder.pop_front();
+
+		const auto it = spectatorsCache.find(pos);
+		if (it == spectatorsCache.end()) {
+			continue;
+		}
+
+		if (it->second.referenced) {
+			it->second.referenced = false;
+			cacheOrder.push_back(pos);
+			continue;
+		}
+
+		spectatorsCache.erase(it);
+		cacheEvictions.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+}
+
+Spectators &Spectators::insert(const std::shared_ptr<Creature> &creature) {
 	if (creature) {
-		creatures.emplace_back(creature);
+		own().emplace_back(creature);
 	}
 	return *this;
 }
 
-Spectators Spectators::insertAll(const CreatureVector &list) {
-	if (!list.empty()) {
-		const bool hasValue = !creatures.empty();
+Spectators &Spectators::insertAll(const CreatureVector &list) {
+	if (list.empty()) {
+		return *this;
+	}
 
-		creatures.insert(creatures.end(), list.begin(), list.end());
+	if (empty()) {
+		borrowed.reset();
+		creatures = list;
+		return *this;
+	}
+
+	// Remove duplicate, ids are unique among the creatures on the map
+	thread_local phmap::flat_hash_set<uint32_t> ids;
+	auto &result = own();
+	ids.clear();
+	for (const auto &creature : result) {
+		ids.emplace(creature->getID());
+	}
 
-		// Remove duplicate
-		if (hasValue) {
-			std::unordered_set uset(creatures.begin(), creatures.end());
-			creatures.clear();
-			creatures.insert(creatures.end(), uset.begin(), uset.end());
+	result.reserve(result.size() + list.size());
+	for (const auto &creature : list) {
+		if (ids.emplace(creature->getID()).second) {
+			result.emplace_back(creature);
 		}
 	}
 	return *this;
 }
 
+void Spectators::append(CreatureVector &&list) {
+	if (empty()) {
+		borrowed.reset();
+		creatures = std::move(list);
+	} else {
+		insertAll(list);
+	}
+}
+
+void Spectators::borrow(const std::shared_ptr<const CreatureVector> &list) {
+	if (empty()) {
+		creatures.clear();
+		borrowed = list;
+	} else {
+		insertAll(*list);
+	}
+}
+
+CreatureVector &Spectators::own() {
+	if (borrowed) {
+		creatures.assign(borrowed->begin(), borrowed->end());
+		borrowed.reset();
+	}
+	return creatures;
+}
+
 bool Spectators::checkCache(const SpectatorsCache::FloorData &specData, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, const Position &centerPos, bool checkDistance, bool multifloor, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY) {
 	const auto &list = multifloor || !specData.floor ? specData.multiFloor : specData.floor;
 
@@ -55,48 +121,61 @@ bool Spectators::checkCache(const SpectatorsCache::FloorData &specData, bool onl
 
 	if (checkDistance) {
 		CreatureVector spectators;
-		spectators.reserve(creatures.size());
+		spectators.reserve(list->size());
 		for (const auto &creature : *list) {
 			const auto &specPos = creature->getPosition();
-			if ((centerPos.x - specPos.x >= minRangeX
-			     && centerPos.y - specPos.y >= minRangeY
-			     && centerPos.x - specPos.x <= maxRangeX
-			     && centerPos.y - specPos.y <= maxRangeY
-			     && (multifloor || specPos.z == centerPos.z)
-			     && ((onlyPlayers && creature->getPlayer())
-			         || (onlyMonsters && creature->getMonster())
-			         || (onlyNpcs && creature->getNpc())))
-			    || (!onlyPlayers && !onlyMonsters && !onlyNpcs)) {
+			if (centerPos.x - specPos.x >= minRangeX
+			    && centerPos.y - specPos.y >= minRangeY
+			    && centerPos.x - specPos.x <= maxRangeX
+			    && centerPos.y - specPos.y <= maxRangeY
+			    && (multifloor || specPos.z == centerPos.z)
+			    && ((onlyPlayers && creature->getPlayer())
+			        || (onlyMonsters && creature->getMonster())
+			        || (onlyNpcs && creature->getNpc())
+			        || (!onlyPlayers && !onlyMonsters && !onlyNpcs))) {
 				spectators.emplace_back(creature);
 			}
 		}
-		insertAll(spectators);
+		append(std::move(spectators));
 	} else {
-		insertAll(*list);
+		borrow(list);
 	}
 
 	return true;
 }
 
-CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifloor, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY) {
-	uint8_t minRangeZ = centerPos.z;
-	uint8_t maxRangeZ = centerPos.z;
-
-	if (multifloor) {
-		if (centerPos.z > MAP_INIT_SURFACE_LAYER) {
-			minRangeZ = static_cast<uint8_t>(std::max<int8_t>(centerPos.z - MAP_LAYER_VIEW_LIMIT, 0u));
-			maxRangeZ = static_cast<uint8_t>(std::min<int8_t>(centerPos.z + MAP_LAYER_VIEW_LIMIT, MAP_MAX_LAYERS - 1));
-		} else if (centerPos.z == MAP_INIT_SURFACE_LAYER - 1) {
-			minRangeZ = 0;
-			maxRangeZ = (MAP_INIT_SURFACE_LAYER - 1) + MAP_LAYER_VIEW_LIMIT;
-		} else if (centerPos.z == MAP_INIT_SURFACE_LAYER) {
-			minRangeZ = 0;
-			maxRangeZ = MAP_INIT_SURFACE_LAYER + MAP_LAYER_VIEW_LIMIT;
-		} else {
-			minRangeZ = 0;
-			maxRangeZ = MAP_INIT_SURFACE_LAYER;
-		}
+std::pair<uint8_t, uint8_t> Spectators::getFloorRange(const Position &centerPos, bool multifloor) {
+	if (!multifloor) {
+		return { centerPos.z, centerPos.z };
+	}
+
+	if (centerPos.z > MAP_INIT_SURFACE_LAYER) {
+		return {
+			static_cast<uint8_t>(std::max<int8_t>(centerPos.z - MAP_LAYER_VIEW_LIMIT, 0u)),
+			static_cast<uint8_t>(std::min<int8_t>(centerPos.z + MAP_LAYER_VIEW_LIMIT, MAP_MAX_LAYERS - 1))
+		};
+	} else if (centerPos.z == MAP_INIT_SURFACE_LAYER - 1) {
+		return { 0, (MAP_INIT_SURFACE_LAYER - 1) + MAP_LAYER_VIEW_LIMIT };
+	} else if (centerPos.z == MAP_INIT_SURFACE_LAYER) {
+		return { 0, MAP_INIT_SURFACE_LAYER + MAP_LAYER_VIEW_LIMIT };
 	}
+	return { 0, MAP_INIT_SURFACE_LAYER };
+}
+
+std::array<int32_t, 4> Spectators::getSectorArea(const Position &centerPos, uint8_t minRangeZ, uint8_t maxRangeZ, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY) {
+	const int32_t minoffset = centerPos.getZ() - maxRangeZ;
+	const int32_t x1 = std::min<int32_t>(0xFFFF, std::max<int32_t>(0, centerPos.x + minRangeX + minoffset));
+	const int32_t y1 = std::min<int32_t>(0xFFFF, std::max<int32_t>(0, centerPos.y + minRangeY + minoffset));
+
+	const int32_t maxoffset = centerPos.getZ() - minRangeZ;
+	const int32_t x2 = std::min<int32_t>(0xFFFF, std::max<int32_t>(0, centerPos.x + maxRangeX + maxoffset));
+	const int32_t y2 = std::min<int32_t>(0xFFFF, std::max<int32_t>(0, centerPos.y + maxRangeY + maxoffset));
+
+	return { x1 - (x1 & SECTOR_MASK), y1 - (y1 & SECTOR_MASK), x2 - (x2 & SECTOR_MASK), y2 - (y2 & SECTOR_MASK) };
+}
+
+CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifloor, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY) {
+	const auto [minRangeZ, maxRangeZ] = getFloorRange(centerPos, multifloor);
 
 	const int32_t min_y = centerPos.y + minRangeY;
 	const int32_t min_x = centerPos.x + minRangeX;
@@ -107,18 +186,7 @@ CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifl
 	const auto height = static_cast<uint32_t>(max_y - min_y);
 	const auto depth = static_cast<uint32_t>(maxRangeZ - minRangeZ);
 
-	const int32_t minoffset = centerPos.getZ() - maxRangeZ;
-	const int32_t x1 = std::min<int32_t>(0xFFFF, std::max<int32_t>(0, min_x + minoffset));
-	const int32_t y1 = std::min<int32_t>(0xFFFF, std::max<int32_t>(0, min_y + minoffset));
-
-	const int32_t maxoffset = centerPos.getZ() - minRangeZ;
-	const int32_t x2 = std::min<int32_t>(0xFFFF, std::max<int32_t>(0, max_x + maxoffset));
-	const int32_t y2 = std::min<int32_t>(0xFFFF, std::max<int32_t>(0, max_y + maxoffset));
-
-	const int32_t startx1 = x1 - (x1 & SECTOR_MASK);
-	const int32_t starty1 = y1 - (y1 & SECTOR_MASK);
-	const int32_t endx2 = x2 - (x2 & SECTOR_MASK);
-	const int32_t endy2 = y2 - (y2 & SECTOR_MASK);
+	const auto [startx1, starty1, endx2, endy2] = getSectorArea(centerPos, minRangeZ, maxRangeZ, minRangeX, maxRangeX, minRangeY, maxRangeY);
 
 	CreatureVector spectators;
 	spectators.reserve(std::max<uint8_t>(MAP_MAX_VIEW_PORT_X, MAP_MAX_VIEW_PORT_Y) * 2);
@@ -159,15 +227,171 @@ CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifl
 	return spectators;
 }
 
-Spectators Spectators::find(const Position &centerPos, bool multifloor, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, bool useCache) {
+bool Spectators::getSubscribers(const Position &centerPos) {
+	const MapSector* sector = g_game().map.getMapSector(centerPos.x, centerPos.y);
+	if (!sector) {
+		return false;
+	}
+
+	const auto [minRangeZ, maxRangeZ] = getFloorRange(centerPos, true);
+	const auto depth = static_cast<uint32_t>(maxRangeZ - minRangeZ);
+	const int32_t min_x = centerPos.x - MAP_MAX_VIEW_PORT_X;
+	const int32_t min_y = centerPos.y - MAP_MAX_VIEW_PORT_Y;
+
+	const auto isInView = [&centerPos, minRangeZ, depth, min_x, min_y](const std::shared_ptr<Creature> &player) {
+		const auto &cpos = player->getPosition();
+		if (static_cast<uint32_t>(static_cast<int32_t>(cpos.z) - minRangeZ) > depth) {
+			return false;
+		}
+		const int_fast16_t offsetZ = Position::getOffsetZ(centerPos, cpos);
+		return static_cast<uint32_t>(cpos.x - offsetZ - min_x) <= MAP_MAX_VIEW_PORT_X * 2 && static_cast<uint32_t>(cpos.y - offsetZ - min_y) <= MAP_MAX_VIEW_PORT_Y * 2;
+	};
+
+	const auto &list = sector->subscriber_list;
+	if (!list) {
+		return true;
+	}
+
+	// Usually every subscriber sees the position, the sector list is borrowed as it is
+	const auto inView = static_cast<size_t>(std::ranges::count_if(*list, isInView));
+	if (inView == list->size()) {
+		borrow(list);
+		return true;
+	}
+
+	CreatureVector subscribers;
+	subscribers.reserve(inView);
+	std::ranges::copy_if(*list, std::back_inserter(subscribers), isInView);
+	append(std::move(subscribers));
+	return true;
+}
+
+std::array<int32_t, 4> Spectators::getSubscriptionArea(const Position &pos) {
+	// Players below the surface see two floors up and down, on the surface
+	// they see everything above, as far as the floor offset shifts positions
+	const int32_t margin = pos.z > MAP_INIT_SURFACE_LAYER ? MAP_LAYER_VIEW_LIMIT : MAP_INIT_SURFACE_LAYER;
+	const int32_t x1 = std::max<int32_t>(0, pos.x - MAP_MAX_VIEW_PORT_X - margin);
+	const int32_t y1 = std::max<int32_t>(0, pos.y - MAP_MAX_VIEW_PORT_Y - margin);
+	const int32_t x2 = std::min<int32_t>(0xFFFF, pos.x + MAP_MAX_VIEW_PORT_X + margin);
+	const int32_t y2 = std::min<int32_t>(0xFFFF, pos.y + MAP_MAX_VIEW_PORT_Y + margin);
+	return { x1 - (x1 & SECTOR_MASK), y1 - (y1 & SECTOR_MASK), x2 - (x2 & SECTOR_MASK), y2 - (y2 & SECTOR_MASK) };
+}
+
+void Spectators::subscribe(MapSector &sector, const CreatureVector &players) {
+	if (players.empty()) {
+		return;
+	}
+
+	auto list = std::make_shared<CreatureVector>(*sector.getSubscribers());
+	list->insert(list->end(), players.begin(), players.end());
+	sector.subscriber_list = std::move(list);
+}
+
+void Spectators::unsubscribe(MapSector &sector, const std::shared_ptr<Creature> &player) {
+	const auto current = sector.getSubscribers();
+	if (std::ranges::find(*current, player) == current->end()) {
+		return;
+	}
+
+	auto list = std::make_shared<CreatureVector>();
+	list->reserve(current->size() - 1);
+	std::ranges::copy_if(*current, std::back_inserter(*list), [&player](const auto &subscriber) { return subscriber != player; });
+	sector.subscriber_list = list->empty() ? nullptr : std::move(list);
+}
+
+bool Spectators::isSubscribed(const Position &pos, int32_t sectorStartX, int32_t sectorStartY) {
+	const auto [x1, y1, x2, y2] = getSubscriptionArea(pos);
+	return sectorStartX >= x1 && sectorStartY >= y1 && sectorStartX <= x2 && sectorStartY <= y2;
+}
+
+void Spectators::updateSubscriptions(const std::shared_ptr<Creature> &player, const Position* oldPos, const Position* newPos) {
+	static constexpr std::array<int32_t, 4> NO_AREA { 0, 0, -1, -1 };
+	const auto oldArea = oldPos ? getSubscriptionArea(*oldPos) : NO_AREA;
+	const auto newArea = newPos ? getSubscriptionArea(*newPos) : NO_AREA;
+	if (oldArea == newArea) {
+		return;
+	}
+
+	const auto contains = [](const std::array<int32_t, 4> &area, int32_t x, int32_t y) {
+		return x >= area[0] && y >= area[1] && x <= area[2] && y <= area[3];
+	};
+
+	for (int32_t ny = oldArea[1]; ny <= oldArea[3]; ny += SECTOR_SIZE) {
+		for (int32_t nx = oldArea[0]; nx <= oldArea[2]; nx += SECTOR_SIZE) {
+			if (contains(newArea, nx, ny)) {
+				continue;
+			}
+
+			if (const auto sector = g_game().map.getMapSector(nx, ny)) {
+				unsubscribe(*sector, player);
+			}
+		}
+	}
+
+	for (int32_t ny = newArea[1]; ny <= newArea[3]; ny += SECTOR_SIZE) {
+		for (int32_t nx = newArea[0]; nx <= newArea[2]; nx += SECTOR_SIZE) {
+			if (contains(oldArea, nx, ny)) {
+				continue;
+			}
+
+			if (const auto sector = g_game().map.getMapSector(nx, ny)) {
+				subscribe(*sector, { player });
+			}
+		}
+	}
+}
+
+bool Spectators::isCacheValid(const SpectatorsCache &cache) {
+	return std::ranges::all_of(cache.sectors, [](const auto &entry) {
+		const auto &[sectorX, sectorY, sector, version] = entry;
+		// A sector created after the lookup was empty when it was cached
+		const auto current = sector ? sector : g_game().map.getMapSector(sectorX, sectorY);
+		return current == sector ? !sector || sector->getCreatureVersion() == version : current->getCreatureVersion() == 0;
+	});
+}
+
+void Spectators::resetCache(SpectatorsCache &cache, const Position &centerPos) {
+	cache.creatures = {};
+	cache.monsters = {};
+	cache.npcs = {};
+	cache.players = {};
+
+	// Lookups on every floor in view read the widest area, it covers all of them
+	const auto [minRangeZ, maxRangeZ] = getFloorRange(centerPos, true);
+	const auto [startx1, starty1, endx2, endy2] = getSectorArea(centerPos, minRangeZ, maxRangeZ, cache.minRangeX, cache.maxRangeX, cache.minRangeY, cache.maxRangeY);
+	cache.sectors.clear();
+	for (int32_t ny = starty1; ny <= endy2; ny += SECTOR_SIZE) {
+		for (int32_t nx = startx1; nx <= endx2; nx += SECTOR_SIZE) {
+			const auto sector = g_game().map.getMapSector(nx, ny);
+			cache.sectors.emplace_back(static_cast<uint16_t>(nx), static_cast<uint16_t>(ny), sector, sector ? sector->getCreatureVersion() : 0);
+		}
+	}
+}
+
+SpectatorsCacheStats Spectators::getCacheStats() {
+	return {
+		cacheHits.load(std::memory_order_relaxed),
+		cacheMisses.load(std::memory_order_relaxed),
+		cacheEvictions.load(std::memory_order_relaxed),
+		spectatorsCache.size(),
+	};
+}
+
+void Spectators::find(const Position &centerPos, bool multifloor, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, bool useCache) {
 	minRangeX = (minRangeX == 0 ? -MAP_MAX_VIEW_PORT_X : -minRangeX);
 	maxRangeX = (maxRangeX == 0 ? MAP_MAX_VIEW_PORT_X : maxRangeX);
 	minRangeY = (minRangeY == 0 ? -MAP_MAX_VIEW_PORT_Y : -minRangeY);
 	maxRangeY = (maxRangeY == 0 ? MAP_MAX_VIEW_PORT_Y : maxRangeY);
 
+	// Broadcasts to everyone who can see the position, the sector already knows them
+	const bool isViewport = minRangeX == -MAP_MAX_VIEW_PORT_X && maxRangeX == MAP_MAX_VIEW_PORT_X && minRangeY == -MAP_MAX_VIEW_PORT_Y && maxRangeY == MAP_MAX_VIEW_PORT_Y;
+	if (onlyPlayers && multifloor && isViewport && getSubscribers(centerPos)) {
+		return;
+	}
+
 	if (!useCache) {
-		insertAll(getSpectators(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY));
-		return *this;
+		append(getSpectators(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY));
+		return;
 	}
 
 	const auto &it = spectatorsCache.find(centerPos);
@@ -175,11 +399,15 @@ Spectators Spectators::find(const Position &centerPos, bool multifloor, bool onl
 	if (cacheFound) {
 		auto &cache = it->second;
 		if (minRangeX < cache.minRangeX || maxRangeX > cache.maxRangeX || minRangeY < cache.minRangeY || maxRangeY > cache.maxRangeY) {
-			// recache with new range
+			// recache with new range, what was cached for the smaller one is dropped
 			cache.minRangeX = minRangeX = std::min<int32_t>(minRangeX, cache.minRangeX);
 			cache.minRangeY = minRangeY = std::min<int32_t>(minRangeY, cache.minRangeY);
 			cache.maxRangeX = maxRangeX = std::max<int32_t>(maxRangeX, cache.maxRangeX);
 			cache.maxRangeY = maxRangeY = std::max<int32_t>(maxRangeY, cache.maxRangeY);
+			resetCache(cache, centerPos);
+		} else if (!isCacheValid(cache)) {
+			// A creature entered, left or moved in one of the sectors read
+			resetCache(cache, centerPos);
 		} else {
 			const bool checkDistance = minRangeX != cache.minRangeX || maxRangeX != cache.maxRangeX || minRangeY != cache.minRangeY || maxRangeY != cache.maxRangeY;
 
@@ -193,53 +421,60 @@ Spectators Spectators::find(const Position &centerPos, bool multifloor, bool onl
 
 				// check players/monsters/npcs cache
 				if (checkCache(creaturesCache, onlyPlayers, onlyMonsters, onlyNpcs, centerPos, checkDistance, multifloor, minRangeX, maxRangeX, minRangeY, maxRangeY)) {
-					return *this;
+					cache.referenced = true;
+					cacheHits.fetch_add(1, std::memory_order_relaxed);
+					return;
 				}
 
 				// if there is no players/monsters/npcs cache, look for players/monsters/npcs in the creatures cache.
 				if (checkCache(cache.creatures, onlyPlayers, onlyMonsters, onlyNpcs, centerPos, true, multifloor, minRangeX, maxRangeX, minRangeY, maxRangeY)) {
-					return *this;
+					cache.referenced = true;
+					cacheHits.fetch_add(1, std::memory_order_relaxed);
+					return;
 				}
 				// All Creatures
 			} else if (checkCache(cache.creatures, false, false, false, centerPos, checkDistance, multifloor, minRangeX, maxRangeX, minRangeY, maxRangeY)) {
-				return *this;
+				cache.referenced = true;
+				cacheHits.fetch_add(1, std::memory_order_relaxed);
+				return;
 			}
 		}
 	}
+	cacheMisses.fetch_add(1, std::memory_order_relaxed);
 
-	const auto &spectators = getSpectators(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY);
+	const auto spectators = std::make_shared<const CreatureVector>(getSpectators(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY));
+
+	// Entries are no longer dropped on every creature move, positions nobody looks at again are let go here
+	if (!cacheFound && spectatorsCache.size() >= MAX_CACHE_ENTRIES) {
+		evictCacheEntry();
+	}
 
 	// It is necessary to create the cache even if no spectators is found, so that there is no future query.
-	auto &cache = cacheFound ? it->second : spectatorsCache.emplace(centerPos, SpectatorsCache { .minRangeX = minRangeX, .maxRangeX = maxRangeX, .minRangeY = minRangeY, .maxRangeY = maxRangeY, .creatures = {}, .monsters = {}, .npcs = {}, .players = {} }).first->second;
+	auto &cache = cacheFound ? it->second : spectatorsCache.emplace(centerPos, SpectatorsCache { .minRangeX = minRangeX, .maxRangeX = maxRangeX, .minRangeY = minRangeY, .maxRangeY = maxRangeY, .creatures = {}, .monsters = {}, .npcs = {}, .players = {}, .sectors = {} }).first->second;
+	if (!cacheFound) {
+		resetCache(cache, centerPos);
+		cacheOrder.emplace_back(centerPos);
+	}
+
 	auto &creaturesCache = onlyPlayers ? cache.players
 		: onlyMonsters                 ? cache.monsters
 		: onlyNpcs                     ? cache.npcs
 									   : cache.creatures;
-	auto &creatureList = (multifloor ? creaturesCache.multiFloor : creaturesCache.floor);
-	if (creatureList) {
-		creatureList->clear();
-	} else {
-		creatureList.emplace();
+	(multifloor ? creaturesCache.multiFloor : creaturesCache.floor) = spectators;
+	if (!spectators->empty()) {
+		borrow(spectators);
 	}
-
-	if (!spectators.empty()) {
-		insertAll(spectators);
-
-		creatureList->insert(creatureList->end(), spectators.begin(), spectators.end());
-	}
-
-	return *this;
 }
 
 Spectators Spectators::excludeMaster() const {
 	auto specs = Spectators();
-	if (creatures.empty()) {
+	if (empty()) {
 		return specs;
 	}
 
-	specs.creatures.reserve(creatures.size());
+	specs.creatures.reserve(size());
 
-	for (const auto &c : creatures) {
+	for (const auto &c : data()) {
 		if (c->getMonster() != nullptr && !c->getMaster()) {
 			specs.insert(c);
 		}
@@ -250,13 +485,13 @@ Spectators Spectators::excludeMaster() const {
 
 Spectators Spectators::excludePlayerMaster() const {
 	auto specs = Spectators();
-	if (creatures.empty()) {
+	if (empty()) {
 		return specs;
 	}
 
-	specs.creatures.reserve(creatures.size());
+	specs.creatures.reserve(size());
 
-	for (const auto &c : creatures) {
+	for (const auto &c : data()) {
 		if ((c->getMonster() != nullptr && !c->getMaster()) || (!c->getMaster() || !c->getMaster()->getPlayer())) {
 			specs.insert(c);
 		}
@@ -267,9 +502,9 @@ Spectators Spectators::excludePlayerMaster() const {
 
 Spectators Spectators::filter(bool onlyPlayers, bool onlyMonsters, bool onlyNpcs) const {
 	auto specs = Spectators();
-	specs.creatures.reserve(creatures.size());
+	specs.creatures.reserve(size());
 
-	for (const auto &c : creatures) {
+	for (const auto &c : data()) {
 		if (onlyPlayers && c->getPlayer() != nullptr) {
 			specs.insert(c);
 		} else if (onlyMonsters && c->getMonster() != nullptr) {
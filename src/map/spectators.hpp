@@ -9,19 +9,23 @@
 
 #pragma once
 
+#include <deque>
+
 class Creature;
 class Player;
 class Monster;
 class Npc;
+class MapSector;
 struct Position;
 
 // Forward declaration para CreatureVector
 using CreatureVector = std::vector<std::shared_ptr<Creature>>;
 
 struct SpectatorsCache {
+	// Lists are never changed once cached, results borrow them as they are
 	struct FloorData {
-		std::optional<CreatureVector> floor;
-		std::optional<CreatureVector> multiFloor;
+		std::shared_ptr<const CreatureVector> floor;
+		std::shared_ptr<const CreatureVector> multiFloor;
 	};
 
 	int32_t minRangeX { 0 };
@@ -33,19 +37,68 @@ struct SpectatorsCache {
 	FloorData monsters;
 	FloorData npcs;
 	FloorData players;
+
+	// Sectors read by the lookups, with their creature version at the time
+	std::vector<std::tuple<uint16_t, uint16_t, const MapSector*, uint32_t>> sectors;
+
+	// Answered a lookup since the eviction last passed by, kept for another round
+	bool referenced { false };
+};
+
+struct SpectatorsCacheStats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+	size_t entries = 0;
 };
 
 class Spectators {
 public:
+	// Positions cached at once, entries are evicted one at a time past it
+	static constexpr size_t MAX_CACHE_ENTRIES = 65'536;
+
 	static void clearCache();
 
+	/**
+	 * @return Lookups answered from the cache and lookups that had to read the sectors,
+	 * entries evicted to make room, since startup, and the entries cached now.
+	 */
+	static SpectatorsCacheStats getCacheStats();
+
+	/**
+	 * Moves a player's subscriptions from the sectors seen from oldPos to the
+	 * ones seen from newPos, nullptr for none. Only sectors entering or leaving
+	 * the view are touched, nothing at all within a sector.
+	 * Like the cached lookups, subscriptions are only used on the dispatcher thread.
+	 */
+	static void updateSubscriptions(const std::shared_ptr<Creature> &player, const Position* oldPos, const Position* newPos);
+
+	/**
+	 * @return true if a player at pos is subscribed to the sector starting at sectorStartX, sectorStartY.
+	 * Sectors created after the player came by check it to subscribe the players already around.
+	 */
+	static bool isSubscribed(const Position &pos, int32_t sectorStartX, int32_t sectorStartY);
+
+	// Sector lists are replaced, a lookup still holding the previous one keeps it
+	static void subscribe(MapSector &sector, const CreatureVector &players);
+	static void unsubscribe(MapSector &sector, const std::shared_ptr<Creature> &player);
+
 	template <typename T>
 		requires std::is_base_of_v<Creature, T>
-	Spectators find(const Position &centerPos, bool multifloor = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0, bool useCache = true) {
+	Spectators &find(const Position &centerPos, bool multifloor = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0, bool useCache = true) & {
 		constexpr bool onlyPlayers = std::is_same_v<T, Player>;
 		constexpr bool onlyMonsters = std::is_same_v<T, Monster>;
 		constexpr bool onlyNpcs = std::is_same_v<T, Npc>;
-		return find(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY, useCache);
+		find(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY, useCache);
+		return *this;
+	}
+
+	// Spectators().find<T>(...) hands its lists over instead of copying them
+	template <typename T>
+		requires std::is_base_of_v<Creature, T>
+	Spectators find(const Position &centerPos, bool multifloor = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0, bool useCache = true) && {
+		find<T>(centerPos, multifloor, minRangeX, maxRangeX, minRangeY, maxRangeY, useCache);
+		return std::move(*this);
 	}
 
 	template <typename T>
@@ -60,49 +113,73 @@ public:
 	Spectators excludeMaster() const;
 	Spectators excludePlayerMaster() const;
 
-	Spectators insert(const std::shared_ptr<Creature> &creature);
-	Spectators insertAll(const CreatureVector &list);
-	Spectators join(const Spectators &anotherSpectators) {
-		return insertAll(anotherSpectators.creatures);
+	Spectators &insert(const std::shared_ptr<Creature> &creature);
+	Spectators &insertAll(const CreatureVector &list);
+	Spectators &join(const Spectators &anotherSpectators) {
+		return insertAll(anotherSpectators.data());
 	}
 
 	bool contains(const std::shared_ptr<Creature> &creature) const {
-		return std::ranges::find(creatures, creature) != creatures.end();
+		return std::ranges::find(data(), creature) != data().end();
 	}
 
 	bool erase(const std::shared_ptr<Creature> &creature) {
-		return std::erase(creatures, creature) > 0;
+		return std::erase(own(), creature) > 0;
 	}
 
 	bool empty() const noexcept {
-		return creatures.empty();
+		return data().empty();
 	}
 
 	size_t size() const noexcept {
-		return creatures.size();
+		return data().size();
 	}
 
 	auto begin() const noexcept {
-		return creatures.begin();
+		return data().begin();
 	}
 
 	auto end() const noexcept {
-		return creatures.end();
+		return data().end();
 	}
 
-	const auto &data() const noexcept {
-		return creatures;
+	const CreatureVector &data() const noexcept {
+		return borrowed ? *borrowed : creatures;
 	}
 
 private:
 	static phmap::flat_hash_map<Position, SpectatorsCache> spectatorsCache;
-
-	Spectators find(const Position &centerPos, bool multifloor = false, bool onlyPlayers = false, bool onlyMonsters = false, bool onlyNpcs = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0, bool useCache = true);
+	// Cached positions in the order they are visited for eviction
+	static std::deque<Position> cacheOrder;
+	static std::atomic<uint64_t> cacheHits;
+	static std::atomic<uint64_t> cacheMisses;
+	static std::atomic<uint64_t> cacheEvictions;
+
+	static std::pair<uint8_t, uint8_t> getFloorRange(const Position &centerPos, bool multifloor);
+	// Sector aligned startX, startY, endX and endY a lookup reads
+	static std::array<int32_t, 4> getSectorArea(const Position &centerPos, uint8_t minRangeZ, uint8_t maxRangeZ, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY);
+	// Sector aligned area of every position whose players on all floors in view include one at pos
+	static std::array<int32_t, 4> getSubscriptionArea(const Position &pos);
+	static bool isCacheValid(const SpectatorsCache &cache);
+	static void resetCache(SpectatorsCache &cache, const Position &centerPos);
+	// Drops the first entry in cacheOrder that was not referenced since it was last visited
+	static void evictCacheEntry();
+
+	void find(const Position &centerPos, bool multifloor = false, bool onlyPlayers = false, bool onlyMonsters = false, bool onlyNpcs = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0, bool useCache = true);
 	CreatureVector getSpectators(const Position &centerPos, bool multifloor = false, bool onlyPlayers = false, bool onlyMonsters = false, bool onlyNpcs = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0);
+	bool getSubscribers(const Position &centerPos);
 
 	Spectators filter(bool onlyPlayers, bool onlyMonsters, bool onlyNpcs) const;
 
+	// Takes a freshly built list, moved in when nothing was found before
+	void append(CreatureVector &&list);
+	// Takes a cached list, borrowed when nothing was found before
+	void borrow(const std::shared_ptr<const CreatureVector> &list);
+	// The list to change, copied out of the borrowed one first
+	CreatureVector &own();
+
 	bool checkCache(const SpectatorsCache::FloorData &specData, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, const Position &centerPos, bool checkDistance, bool multifloor, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY);
 
+	std::shared_ptr<const CreatureVector> borrowed;
 	CreatureVector creatures;
 };
@@ -13,213 +13,106 @@
 #include "creatures/monsters/monster.hpp"
 #include "items/tile.hpp"
 
-AStarNodes::AStarNodes(uint32_t x, uint32_t y, int_fast32_t extraCost) :
-#if defined(__AVX2__) || defined(__SSE2__)
-	nodesTable(), // 1. nodesTable
-	calculatedNodes(), // 2. calculatedNodes
-	nodes(), // 3. nodes
-	closedNodes(0), // 4. closedNodes
-	curNode(0), // 5. curNode
-	openNodes() // 6. openNodes
-#else
-	nodes(), // 1. nodes
-	nodesTable(), // 2. nodesTable
-	closedNodes(0), // 3. closedNodes
-	curNode(0), // 4. curNode
-	openNodes() // 5. openNodes
-#endif
-{
-#if defined(__AVX2__)
-	__m256i defaultCost = _mm256_set1_epi32(std::numeric_limits<int32_t>::max());
-	for (int32_t i = 0; i < MAX_NODES; i += 32) {
-		_mm256_stream_si256(reinterpret_cast<__m256i*>(&calculatedNodes[i + 0]), defaultCost);
-		_mm256_stream_si256(reinterpret_cast<__m256i*>(&calculatedNodes[i + 8]), defaultCost);
-		_mm256_stream_si256(reinterpret_cast<__m256i*>(&calculatedNodes[i + 16]), defaultCost);
-		_mm256_stream_si256(reinterpret_cast<__m256i*>(&calculatedNodes[i + 24]), defaultCost);
-	}
-	_mm_sfence();
-#elif defined(__SSE2__)
-	__m128i defaultCost = _mm_set1_epi32(std::numeric_limits<int32_t>::max());
-	for (int32_t i = 0; i < MAX_NODES; i += 16) {
-		_mm_stream_si128(reinterpret_cast<__m128i*>(&calculatedNodes[i + 0]), defaultCost);
-		_mm_stream_si128(reinterpret_cast<__m128i*>(&calculatedNodes[i + 4]), defaultCost);
-		_mm_stream_si128(reinterpret_cast<__m128i*>(&calculatedNodes[i + 8]), defaultCost);
-		_mm_stream_si128(reinterpret_cast<__m128i*>(&calculatedNodes[i + 12]), defaultCost);
-	}
-	_mm_sfence();
-#endif
-
-	curNode = 1;
-	closedNodes = 0;
-	openNodes[0] = true;
-
-	AStarNode &startNode = nodes[0];
-	startNode.parent = nullptr;
-	startNode.x = x;
-	startNode.y = y;
-	startNode.f = 0;
-	startNode.g = 0;
-	startNode.c = extraCost;
-	nodesTable[0] = (x << 16) | y;
-#if defined(__SSE2__) || defined(__AVX2__)
-	calculatedNodes[0] = 0;
-#endif
+namespace {
+	thread_local std::vector<std::unique_ptr<AStarNodes>> pool;
+	thread_local uint64_t threadClosedNodes = 0;
 }
 
-bool AStarNodes::createOpenNode(AStarNode* parent, uint32_t x, uint32_t y, int_fast32_t f, int_fast32_t heuristic, int_fast32_t extraCost) {
-	if (curNode >= MAX_NODES) {
-		return false;
-	}
-
-	const int32_t retNode = curNode++;
-	openNodes[retNode] = true;
-
-	AStarNode &node = nodes[retNode];
-	node.parent = parent;
-	node.x = x;
-	node.y = y;
-	node.f = f;
-	node.g = heuristic;
-	node.c = extraCost;
-	nodesTable[retNode] = (x << 16) | y;
-#if defined(__SSE2__)
-	calculatedNodes[retNode] = f + heuristic;
-#endif
-	return true;
+void AStarNodes::Release::operator()(AStarNodes* nodes) const {
+	threadClosedNodes += nodes->closedNodes;
+	pool.emplace_back(nodes);
 }
 
-AStarNode* AStarNodes::getBestNode() {
-// Branchless best node search
-#if defined(__AVX512F__)
-	const __m512i increment = _mm512_set1_epi32(16);
-	__m512i indices = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
-	__m512i minindices = indices;
-	__m512i minvalues = _mm512_load_si512(reinterpret_cast<const void*>(calculatedNodes));
-	for (int32_t pos = 16; pos < curNode; pos += 16) {
-		const __m512i values = _mm512_load_si512(reinterpret_cast<const void*>(&calculatedNodes[pos]));
-		indices = _mm512_add_epi32(indices, increment);
-		minindices = _mm512_mask_blend_epi32(_mm512_cmplt_epi32_mask(values, minvalues), minindices, indices);
-		minvalues = _mm512_min_epi32(minvalues, values);
+AStarNodes::Pointer AStarNodes::acquire(uint32_t x, uint32_t y, int_fast32_t extraCost, int32_t maxNodes) {
+	AStarNodes* nodes;
+	if (pool.empty()) {
+		nodes = new AStarNodes();
+	} else {
+		nodes = pool.back().release();
+		pool.pop_back();
 	}
+	nodes->reset(x, y, extraCost, std::max<int32_t>(maxNodes, 1));
+	return Pointer(nodes);
+}
 
-	alignas(64) int32_t values_array[16];
-	alignas(64) int32_t indices_array[16];
-	_mm512_store_si512(reinterpret_cast<void*>(values_array), minvalues);
-	_mm512_store_si512(reinterpret_cast<void*>(indices_array), minindices);
+void AStarNodes::reset(uint32_t x, uint32_t y, int_fast32_t extraCost, int32_t newMaxNodes) {
+	// Created nodes are referenced by pointer, the storage must not grow during the search
+	maxNodes = newMaxNodes;
+	nodes.clear();
+	nodes.reserve(maxNodes);
+	heapIndexes.clear();
+	heapIndexes.reserve(maxNodes);
+	heap.clear();
+	heap.reserve(maxNodes);
+	closedNodes = 0;
 
-	int32_t best_node = indices_array[0];
-	int32_t best_node_f = values_array[0];
-	for (int32_t i = 1; i < 16; ++i) {
-		int32_t total_cost = values_array[i];
-		best_node = (total_cost < best_node_f ? indices_array[i] : best_node);
-		best_node_f = (total_cost < best_node_f ? total_cost : best_node_f);
+	// The index is kept at most half full
+	const auto indexSize = std::bit_ceil(static_cast<uint32_t>(maxNodes) * 2);
+	if (positionIndex.size() != indexSize) {
+		positionIndex.assign(indexSize, {});
+		indexMask = indexSize - 1;
+		indexShift = 32 - std::countr_zero(indexSize);
+		search = 0;
 	}
-	return (openNodes[best_node] ? &nodes[best_node] : nullptr);
-#elif defined(__AVX2__)
-	const __m256i increment = _mm256_set1_epi32(8);
-	__m256i indices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
-	__m256i minindices = indices;
-	__m256i minvalues = _mm256_load_si256(reinterpret_cast<const __m256i*>(calculatedNodes));
-	for (int32_t pos = 8; pos < curNode; pos += 8) {
-		const __m256i values = _mm256_load_si256(reinterpret_cast<const __m256i*>(&calculatedNodes[pos]));
-		indices = _mm256_add_epi32(indices, increment);
-		minindices = _mm256_blendv_epi8(minindices, indices, _mm256_cmpgt_epi32(minvalues, values));
-		minvalues = _mm256_min_epi32(values, minvalues);
-	}
-
-	__m256i res = _mm256_min_epi32(minvalues, _mm256_shuffle_epi32(minvalues, _MM_SHUFFLE(2, 3, 0, 1))); // Calculate horizontal minimum
-	res = _mm256_min_epi32(res, _mm256_shuffle_epi32(res, _MM_SHUFFLE(0, 1, 2, 3))); // Calculate horizontal minimum
-	res = _mm256_min_epi32(res, _mm256_permutevar8x32_epi32(res, _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7))); // Calculate horizontal minimum
 
-	alignas(32) int32_t indices_array[8];
-	_mm256_store_si256(reinterpret_cast<__m256i*>(indices_array), minindices);
-
-	int32_t best_node = indices_array[(mm_ctz(_mm256_movemask_epi8(_mm256_cmpeq_epi32(minvalues, res))) >> 2)];
-	return (openNodes[best_node] ? &nodes[best_node] : nullptr);
-#elif defined(__SSE4_1__)
-	const __m128i increment = _mm_set1_epi32(4);
-	__m128i indices = _mm_setr_epi32(0, 1, 2, 3);
-	__m128i minindices = indices;
-	__m128i minvalues = _mm_load_si128(reinterpret_cast<const __m128i*>(calculatedNodes));
-	for (int32_t pos = 4; pos < curNode; pos += 4) {
-		const __m128i values = _mm_load_si128(reinterpret_cast<const __m128i*>(&calculatedNodes[pos]));
-		indices = _mm_add_epi32(indices, increment);
-		minindices = _mm_blendv_epi8(minindices, indices, _mm_cmplt_epi32(values, minvalues));
-		minvalues = _mm_min_epi32(values, minvalues);
+	if (++search == 0) {
+		positionIndex.assign(positionIndex.size(), {});
+		search = 1;
 	}
 
-	__m128i res = _mm_min_epi32(minvalues, _mm_shuffle_epi32(minvalues, _MM_SHUFFLE(2, 3, 0, 1))); // Calculate horizontal minimum
-	res = _mm_min_epi32(res, _mm_shuffle_epi32(res, _MM_SHUFFLE(0, 1, 2, 3))); // Calculate horizontal minimum
-
-	alignas(16) int32_t indices_array[4];
-	_mm_store_si128(reinterpret_cast<__m128i*>(indices_array), minindices);
-
-	int32_t best_node = indices_array[(mm_ctz(_mm_movemask_epi8(_mm_cmpeq_epi32(minvalues, res))) >> 2)];
-	return (openNodes[best_node] ? &nodes[best_node] : NULL);
-#elif defined(__SSE2__)
-	auto _mm_sse2_min_epi32 = [](const __m128i a, const __m128i b) {
-		__m128i mask = _mm_cmpgt_epi32(a, b);
-		return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a));
-	};
-
-	auto _mm_sse2_blendv_epi8 = [](const __m128i a, const __m128i b, __m128i mask) {
-		mask = _mm_cmplt_epi8(mask, _mm_setzero_si128());
-		return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b));
-	};
+	addNode(nullptr, x, y, 0, 0, extraCost);
+}
 
-	const __m128i increment = _mm_set1_epi32(4);
-	__m128i indices = _mm_setr_epi32(0, 1, 2, 3);
-	__m128i minindices = indices;
-	__m128i minvalues = _mm_load_si128(reinterpret_cast<const __m128i*>(calculatedNodes));
-	for (int32_t pos = 4; pos < curNode; pos += 4) {
-		const __m128i values = _mm_load_si128(reinterpret_cast<const __m128i*>(&calculatedNodes[pos]));
-		indices = _mm_add_epi32(indices, increment);
-		minindices = _mm_sse2_blendv_epi8(minindices, indices, _mm_cmplt_epi32(values, minvalues));
-		minvalues = _mm_sse2_min_epi32(values, minvalues);
+uint32_t AStarNodes::addNode(AStarNode* parent, uint32_t x, uint32_t y, int_fast32_t f, int_fast32_t heuristic, int_fast32_t extraCost) {
+	const auto node = static_cast<uint32_t>(nodes.size());
+	nodes.emplace_back(AStarNode { parent, f, heuristic, extraCost, static_cast<uint16_t>(x), static_cast<uint16_t>(y) });
+	heapIndexes.emplace_back(CLOSED);
+	pushHeap(node);
+
+	const uint32_t key = (x << 16) | y;
+	for (uint32_t slot = hashPosition(key);; slot = (slot + 1) & indexMask) {
+		auto &entry = positionIndex[slot];
+		if (entry.search != search) {
+			entry = { key, node, search };
+			break;
+		}
 	}
+	return node;
+}
 
-	__m128i res = _mm_sse2_min_epi32(minvalues, _mm_shuffle_epi32(minvalues, _MM_SHUFFLE(2, 3, 0, 1))); // Calculate horizontal minimum
-	res = _mm_sse2_min_epi32(res, _mm_shuffle_epi32(res, _MM_SHUFFLE(0, 1, 2, 3))); // Calculate horizontal minimum
-
-	alignas(16) int32_t indices_array[4];
-	_mm_store_si128(reinterpret_cast<__m128i*>(indices_array), minindices);
+bool AStarNodes::createOpenNode(AStarNode* parent, uint32_t x, uint32_t y, int_fast32_t f, int_fast32_t heuristic, int_fast32_t extraCost) {
+	if (static_cast<int32_t>(nodes.size()) >= maxNodes) {
+		return false;
+	}
 
-	int32_t best_node = indices_array[(mm_ctz(_mm_movemask_epi8(_mm_cmpeq_epi32(minvalues, res))) >> 2)];
-	return (openNodes[best_node] ? &nodes[best_node] : nullptr);
-#else
-	int32_t best_node_f = std::numeric_limits<int32_t>::max();
-	int32_t best_node = -1;
-	for (int32_t pos = 0; pos < curNode; ++pos) {
-		if (!openNodes[pos]) {
-			continue;
-		}
+	addNode(parent, x, y, f, heuristic, extraCost);
+	return true;
+}
 
-		int32_t total_cost = nodes[pos].f + nodes[pos].g;
-		best_node = (total_cost < best_node_f ? pos : best_node);
-		best_node_f = (total_cost < best_node_f ? total_cost : best_node_f);
-	}
-	return (best_node != -1 ? &nodes[best_node] : nullptr);
-#endif
+AStarNode* AStarNodes::getBestNode() {
+	return heap.empty() ? nullptr : &nodes[heap.front()];
 }
 
 void AStarNodes::closeNode(const AStarNode* node) {
-	const size_t index = node - nodes;
-	assert(index < MAX_NODES);
-#if defined(__SSE2__)
-	calculatedNodes[index] = std::numeric_limits<int32_t>::max();
-#endif
-	openNodes[index] = false;
+	const auto nodeIndex = static_cast<uint32_t>(node - nodes.data());
+	assert(nodeIndex < nodes.size());
+	if (heapIndexes[nodeIndex] != CLOSED) {
+		removeHeap(nodeIndex);
+	}
 	++closedNodes;
 }
 
 void AStarNodes::openNode(const AStarNode* node) {
-	const size_t index = node - nodes;
-	assert(index < MAX_NODES);
-#if defined(__SSE2__)
-	calculatedNodes[index] = nodes[index].f + nodes[index].g;
-#endif
-	closedNodes -= (openNodes[index] ? 0 : 1);
-	openNodes[index] = true;
+	const auto nodeIndex = static_cast<uint32_t>(node - nodes.data());
+	assert(nodeIndex < nodes.size());
+	const auto heapIndex = heapIndexes[nodeIndex];
+	if (heapIndex == CLOSED) {
+		--closedNodes;
+		pushHeap(nodeIndex);
+	} else {
+		// Nodes are only reopened through a cheaper parent
+		siftUp(heapIndex);
+	}
 }
 
 int32_t AStarNodes::getClosedNodes() const {
@@ -227,48 +120,91 @@ int32_t AStarNodes::getClosedNodes() const {
 }
 
 AStarNode* AStarNodes::getNodeByPosition(uint32_t x, uint32_t y) {
-	uint32_t xy = (x << 16) | y;
-#if defined(__SSE2__)
-	const __m128i key = _mm_set1_epi32(xy);
-
-	int32_t pos = 0;
-	int32_t curRound = curNode - 16;
-	for (; pos <= curRound; pos += 16) {
-		__m128i v[4];
-		v[0] = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&nodesTable[pos])), key);
-		v[1] = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&nodesTable[pos + 4])), key);
-		v[2] = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&nodesTable[pos + 8])), key);
-		v[3] = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&nodesTable[pos + 12])), key);
-		const uint32_t mask = _mm_movemask_epi8(_mm_packs_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3])));
-		if (mask != 0) {
-			return &nodes[pos + mm_ctz(mask)];
+	const uint32_t key = (x << 16) | y;
+	for (uint32_t slot = hashPosition(key);; slot = (slot + 1) & indexMask) {
+		const auto &entry = positionIndex[slot];
+		if (entry.search != search) {
+			return nullptr;
 		}
-	}
-	curRound = curNode - 8;
-	if (pos <= curRound) {
-		__m128i v[2];
-		v[0] = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&nodesTable[pos])), key);
-		v[1] = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&nodesTable[pos + 4])), key);
-		const uint32_t mask = _mm_movemask_epi8(_mm_packs_epi32(v[0], v[1]));
-		if (mask != 0) {
-			return &nodes[pos + (mm_ctz(mask) >> 1)];
+		if (entry.key == key) {
+			return &nodes[entry.node];
 		}
-		pos += 8;
 	}
-	for (; pos < curNode; ++pos) {
-		if (nodesTable[pos] == xy) {
-			return &nodes[pos];
+}
+
+uint64_t AStarNodes::getThreadClosedNodes() {
+	return threadClosedNodes;
+}
+
+bool AStarNodes::isBetter(uint32_t node, uint32_t other) const {
+	const auto &a = nodes[node];
+	const auto &b = nodes[other];
+	const auto costA = a.f + a.g;
+	const auto costB = b.f + b.g;
+	// Ties go to the oldest node, like the linear scan did
+	return costA < costB || (costA == costB && node < other);
+}
+
+void AStarNodes::pushHeap(uint32_t node) {
+	heap.emplace_back(node);
+	heapIndexes[node] = static_cast<int32_t>(heap.size() - 1);
+	siftUp(heap.size() - 1);
+}
+
+void AStarNodes::removeHeap(uint32_t node) {
+	const auto heapIndex = static_cast<size_t>(heapIndexes[node]);
+	heapIndexes[node] = CLOSED;
+
+	const auto last = heap.back();
+	heap.pop_back();
+	if (heapIndex == heap.size()) {
+		return;
+	}
+
+	setHeap(heapIndex, last);
+	if (heapIndex > 0 && isBetter(last, heap[(heapIndex - 1) / 2])) {
+		siftUp(heapIndex);
+	} else {
+		siftDown(heapIndex);
+	}
+}
+
+void AStarNodes::siftUp(size_t position) {
+	const auto node = heap[position];
+	while (position > 0) {
+		const auto parent = (position - 1) / 2;
+		if (!isBetter(node, heap[parent])) {
+			break;
 		}
+		setHeap(position, heap[parent]);
+		position = parent;
 	}
-	return nullptr;
-#else
-	for (int32_t i = 1; i < curNode; ++i) {
-		if (nodesTable[i] == xy) {
-			return &nodes[i];
+	setHeap(position, node);
+}
+
+void AStarNodes::siftDown(size_t position) {
+	const auto node = heap[position];
+	const auto size = heap.size();
+	while (true) {
+		auto child = position * 2 + 1;
+		if (child >= size) {
+			break;
+		}
+		if (child + 1 < size && isBetter(heap[child + 1], heap[child])) {
+			++child;
 		}
+		if (!isBetter(heap[child], node)) {
+			break;
+		}
+		setHeap(position, heap[child]);
+		position = child;
 	}
-	return (nodesTable[0] == xy ? &nodes[0] : nullptr); // The first node is very unlikely to be the "neighbor" so leave it for end
-#endif
+	setHeap(position, node);
+}
+
+void AStarNodes::setHeap(size_t position, uint32_t node) {
+	heap[position] = node;
+	heapIndexes[node] = static_cast<int32_t>(position);
 }
 
 int_fast32_t AStarNodes::getMapWalkCost(const AStarNode* node, const Position &neighborPos) {
@@ -19,9 +19,26 @@ struct AStarNode {
 	uint16_t x, y;
 };
 
+/**
+ * Nodes of one A* search.
+ *
+ * Open nodes are kept in a binary heap that knows where each node sits, so the
+ * best node is taken and a cheaper parent is applied in O(log n), and nodes are
+ * found by position through a hash index. Instances are pooled per thread and
+ * reused by the next search, the parallel creature think never shares them.
+ */
 class AStarNodes {
 public:
-	AStarNodes(uint32_t x, uint32_t y, int_fast32_t extraCost);
+	struct Release {
+		void operator()(AStarNodes* nodes) const;
+	};
+	using Pointer = std::unique_ptr<AStarNodes, Release>;
+
+	/**
+	 * Takes nodes from the pool of the calling thread, holding only the start node.
+	 * \param maxNodes Nodes the search may create, createOpenNode fails past it.
+	 */
+	static Pointer acquire(uint32_t x, uint32_t y, int_fast32_t extraCost, int32_t maxNodes);
 
 	bool createOpenNode(AStarNode* parent, uint32_t x, uint32_t y, int_fast32_t f, int_fast32_t heuristic, int_fast32_t extraCost);
 	AStarNode* getBestNode();
@@ -30,24 +47,53 @@ public:
 	int32_t getClosedNodes() const;
 	AStarNode* getNodeByPosition(uint32_t x, uint32_t y);
 
+	/**
+	 * \returns Nodes closed by every search of the calling thread.
+	 */
+	static uint64_t getThreadClosedNodes();
+
 	static int_fast32_t getMapWalkCost(const AStarNode* node, const Position &neighborPos);
 	static int_fast32_t getTileWalkCost(const std::shared_ptr<Creature> &creature, const std::shared_ptr<Tile> &tile);
 
-private:
-	static constexpr int32_t MAX_NODES = 512;
+	// Step costs, shared with the searches that have to agree with this one
 	static constexpr int32_t MAP_NORMALWALKCOST = 10;
 	static constexpr int32_t MAP_PREFERDIAGONALWALKCOST = 14;
 	static constexpr int32_t MAP_DIAGONALWALKCOST = 25;
 
-#if defined(__SSE2__)
-	alignas(16) uint32_t nodesTable[MAX_NODES] {};
-	alignas(64) int32_t calculatedNodes[MAX_NODES] {};
-	AStarNode nodes[MAX_NODES];
-#else
-	AStarNode nodes[MAX_NODES];
-	uint32_t nodesTable[MAX_NODES];
-#endif
-	int32_t closedNodes;
-	int32_t curNode;
-	bool openNodes[MAX_NODES];
+private:
+	static constexpr int32_t CLOSED = -1;
+
+	struct IndexSlot {
+		uint32_t key;
+		uint32_t node;
+		// Slots of older searches are empty, the table is never cleared
+		uint32_t search;
+	};
+
+	AStarNodes() = default;
+
+	void reset(uint32_t x, uint32_t y, int_fast32_t extraCost, int32_t maxNodes);
+	uint32_t addNode(AStarNode* parent, uint32_t x, uint32_t y, int_fast32_t f, int_fast32_t heuristic, int_fast32_t extraCost);
+
+	bool isBetter(uint32_t node, uint32_t other) const;
+	void pushHeap(uint32_t node);
+	void removeHeap(uint32_t node);
+	void siftUp(size_t position);
+	void siftDown(size_t position);
+	void setHeap(size_t position, uint32_t node);
+
+	uint32_t hashPosition(uint32_t key) const {
+		return (key * 0x9E3779B1u) >> indexShift;
+	}
+
+	std::vector<AStarNode> nodes;
+	// Index of each node in the heap, CLOSED when it left the open list
+	std::vector<int32_t> heapIndexes;
+	std::vector<uint32_t> heap;
+	std::vector<IndexSlot> positionIndex;
+	uint32_t indexMask = 0;
+	uint32_t indexShift = 32;
+	uint32_t search = 0;
+	int32_t maxNodes = 0;
+	int32_t closedNodes = 0;
 };
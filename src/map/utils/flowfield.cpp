@@ -0,0 +1,216 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "map/utils/flowfield.hpp"
+
+#include "creatures/creature.hpp"
+#include "items/tile.hpp"
+#include "map/map.hpp"
+#include "utils/tools.hpp"
+
+namespace {
+	constexpr std::array<std::pair<int32_t, int32_t>, 8> NEIGHBORS = { {
+		{ -1, 0 },
+		{ 0, 1 },
+		{ 1, 0 },
+		{ 0, -1 },
+		{ -1, -1 },
+		{ 1, -1 },
+		{ 1, 1 },
+		{ -1, 1 },
+	} };
+
+	// What no monster walks through, pushing items or not
+	constexpr uint32_t BLOCKING_FLAGS = TILESTATE_PROTECTIONZONE | TILESTATE_FLOORCHANGE | TILESTATE_TELEPORT | TILESTATE_BLOCKSOLID | TILESTATE_IMMOVABLEBLOCKSOLID | TILESTATE_NOFIELDBLOCKPATH | TILESTATE_IMMOVABLENOFIELDBLOCKPATH;
+
+	bool isPassable(const std::shared_ptr<Tile> &tile) {
+		return tile && tile->getGround() && !tile->hasFlag(BLOCKING_FLAGS);
+	}
+}
+
+FlowField::FlowField(Map &map, const Position &newOrigin, int64_t newCreationTime) :
+	origin(newOrigin), creationTime(newCreationTime) {
+	costs.fill(UNREACHABLE);
+
+	enum class Cell : uint8_t {
+		Unknown,
+		Passable,
+		Blocked,
+	};
+	std::array<Cell, SIZE * SIZE> cells {};
+
+	using QueueEntry = std::pair<uint16_t, uint16_t>;
+	std::vector<QueueEntry> storage;
+	storage.reserve(SIZE * SIZE);
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue(std::greater<>(), std::move(storage));
+
+	// The chased creature stands on its tile, it is where the flood starts whatever blocks it
+	constexpr uint16_t center = RADIUS * SIZE + RADIUS;
+	costs[center] = 0;
+	cells[center] = Cell::Passable;
+	queue.emplace(0, center);
+
+	while (!queue.empty()) {
+		const auto [cost, index] = queue.top();
+		queue.pop();
+		if (cost != costs[index]) {
+			continue;
+		}
+
+		const int32_t x = index % SIZE;
+		const int32_t y = index / SIZE;
+		for (const auto &[dx, dy] : NEIGHBORS) {
+			const int32_t nx = x + dx;
+			const int32_t ny = y + dy;
+			if (nx < 0 || ny < 0 || nx >= SIZE || ny >= SIZE) {
+				continue;
+			}
+
+			const auto neighbor = static_cast<uint16_t>(ny * SIZE + nx);
+			const auto newCost = static_cast<uint16_t>(cost + (dx != 0 && dy != 0 ? DIAGONAL_COST : NORMAL_COST));
+			if (newCost >= costs[neighbor]) {
+				continue;
+			}
+
+			auto &cell = cells[neighbor];
+			if (cell == Cell::Unknown) {
+				const uint16_t tileX = origin.x + nx - RADIUS;
+				const uint16_t tileY = origin.y + ny - RADIUS;
+				// The bitmaps reject walls and stairs without creating their tiles
+				if (map.isBlocking(tileX, tileY, origin.z, TILE_BLOCK_PATH) || map.isBlocking(tileX, tileY, origin.z, TILE_BLOCK_SOLID)) {
+					cell = Cell::Blocked;
+				} else {
+					cell = isPassable(map.getTile(tileX, tileY, origin.z)) ? Cell::Passable : Cell::Blocked;
+				}
+			}
+			if (cell == Cell::Blocked) {
+				continue;
+			}
+
+			costs[neighbor] = newCost;
+			queue.emplace(newCost, neighbor);
+		}
+	}
+}
+
+uint16_t FlowField::getCost(const Position &pos) const {
+	const int32_t x = Position::getOffsetX(pos, origin) + RADIUS;
+	const int32_t y = Position::getOffsetY(pos, origin) + RADIUS;
+	if (pos.z != origin.z || x < 0 || y < 0 || x >= SIZE || y >= SIZE) {
+		return UNREACHABLE;
+	}
+	return costs[y * SIZE + x];
+}
+
+bool FlowField::getPath(Map &map, const std::shared_ptr<Creature> &creature, std::vector<Direction> &dirList) const {
+	return getPath(creature->getPosition(), dirList, [&map, &creature](const Position &pos) {
+		return map.canWalkTo(creature, pos) != nullptr;
+	});
+}
+
+bool FlowField::getPath(const Position &startPos, std::vector<Direction> &dirList, const std::function<bool(const Position &)> &canWalk) const {
+	Position pos = startPos;
+	uint16_t cost = getCost(pos);
+	if (cost == UNREACHABLE) {
+		return false;
+	}
+
+	const auto startSize = dirList.size();
+	while (std::max(Position::getDistanceX(pos, origin), Position::getDistanceY(pos, origin)) > 1) {
+		// Cheaper neighbors first, the creature takes the first one it can walk to
+		std::array<std::pair<uint16_t, Position>, NEIGHBORS.size()> candidates;
+		size_t count = 0;
+		for (const auto &[dx, dy] : NEIGHBORS) {
+			const Position neighbor(pos.x + dx, pos.y + dy, pos.z);
+			const auto neighborCost = getCost(neighbor);
+			if (neighborCost < cost) {
+				candidates[count++] = { neighborCost, neighbor };
+			}
+		}
+		std::sort(candidates.begin(), candidates.begin() + count, [](const auto &a, const auto &b) { return a.first < b.first; });
+
+		const auto it = std::find_if(candidates.begin(), candidates.begin() + count, [&canWalk](const auto &candidate) {
+			return canWalk(candidate.second);
+		});
+		if (it == candidates.begin() + count) {
+			dirList.resize(startSize);
+			return false;
+		}
+
+		dirList.emplace_back(getDirectionTo(pos, it->second));
+		cost = it->first;
+		pos = it->second;
+	}
+	return true;
+}
+
+std::shared_ptr<const FlowField> FlowFields::get(Map &map, const std::shared_ptr<Creature> &target) {
+	return get(map, target->getID(), target->getPosition(), OTSYS_TIME());
+}
+
+std::shared_ptr<const FlowField> FlowFields::get(Map &map, uint32_t creatureId, const Position &position, int64_t now) {
+	if (auto last = lastExpiry.load(std::memory_order_relaxed); now - last >= EXPIRY_TIME && lastExpiry.compare_exchange_strong(last, now)) {
+		expire(now);
+	}
+
+	std::shared_ptr<Entry> entry;
+	entries.lazy_emplace_l(
+		creatureId,
+		[&entry](const auto &value) { entry = value.second; },
+		[&entry, creatureId](const auto &ctor) {
+			entry = std::make_shared<Entry>();
+			ctor(creatureId, entry);
+		}
+	);
+
+	// Followers of the same creature wait here for the field instead of building their own
+	std::scoped_lock lock(entry->mutex);
+	entry->lastUse = now;
+	const auto &field = entry->field;
+	if (field && field->getOrigin() == position && now - field->getCreationTime() < EVENT_CREATURE_THINK_INTERVAL) {
+		return field;
+	}
+
+	if (entry->requestPosition != position || now - entry->requestTime >= EVENT_CREATURE_THINK_INTERVAL) {
+		entry->requestPosition = position;
+		entry->requestTime = now;
+		return nullptr;
+	}
+
+	entry->field = std::make_shared<const FlowField>(map, position, now);
+	return entry->field;
+}
+
+void FlowFields::erase(uint32_t creatureId) {
+	entries.erase(creatureId);
+}
+
+size_t FlowFields::expire(int64_t now) {
+	// An entry whose field is being built is in use
+	const auto isExpired = [now](const std::shared_ptr<Entry> &entry) {
+		const std::unique_lock lock(entry->mutex, std::try_to_lock);
+		return lock.owns_lock() && now - entry->lastUse >= EXPIRY_TIME;
+	};
+
+	std::vector<uint32_t> expired;
+	entries.for_each([&expired, &isExpired](const auto &value) {
+		if (isExpired(value.second)) {
+			expired.emplace_back(value.first);
+		}
+	});
+
+	// Checked again, a follower may have asked for it in between
+	size_t erased = 0;
+	for (const auto creatureId : expired) {
+		if (entries.erase_if(creatureId, [&isExpired](const auto &value) { return isExpired(value.second); })) {
+			++erased;
+		}
+	}
+	return erased;
+}
@@ -0,0 +1,110 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "game/movement/position.hpp"
+#include "map/map_const.hpp"
+#include "map/utils/astarnodes.hpp"
+
+class Creature;
+class Map;
+
+/**
+ * Walking cost from every tile around a creature to it, flooded once and read by
+ * every creature chasing it.
+ *
+ * The flood only knows what blocks any monster (walls, protection zones, floor
+ * changes), followers check their own steps while walking down the field.
+ */
+class FlowField {
+public:
+	// Monsters chase what they see, with room to walk around what is in the way
+	static constexpr int32_t RADIUS = MAP_MAX_VIEW_PORT_X + 3;
+	static constexpr int32_t SIZE = RADIUS * 2 + 1;
+	static constexpr uint16_t UNREACHABLE = std::numeric_limits<uint16_t>::max();
+
+	FlowField(Map &map, const Position &newOrigin, int64_t newCreationTime);
+
+	const Position &getOrigin() const {
+		return origin;
+	}
+	int64_t getCreationTime() const {
+		return creationTime;
+	}
+
+	uint16_t getCost(const Position &pos) const;
+
+	/**
+	 * Walks down the field until the creature stands next to the origin.
+	 * \returns false if the creature can not get there through the field.
+	 */
+	bool getPath(Map &map, const std::shared_ptr<Creature> &creature, std::vector<Direction> &dirList) const;
+
+	/**
+	 * Walks down the field from startPos, taking the cheapest step canWalk accepts.
+	 * \returns false if the origin can not be reached that way.
+	 */
+	bool getPath(const Position &startPos, std::vector<Direction> &dirList, const std::function<bool(const Position &)> &canWalk) const;
+
+	// Same costs as AStarNodes::getMapWalkCost
+	static constexpr uint16_t NORMAL_COST = AStarNodes::MAP_NORMALWALKCOST;
+	static constexpr uint16_t DIAGONAL_COST = AStarNodes::MAP_NORMALWALKCOST + AStarNodes::MAP_DIAGONALWALKCOST;
+
+private:
+	Position origin;
+	int64_t creationTime;
+	std::array<uint16_t, SIZE * SIZE> costs;
+};
+
+/**
+ * Flow fields toward the creatures being chased.
+ *
+ * A field is built once a second follower asks for the same position of the
+ * chased creature, a single follower is faster with its own search. It is used
+ * until the creature moves or for one think interval, and dropped once nobody
+ * asked for it during EXPIRY_TIME.
+ */
+class FlowFields {
+public:
+	// Milliseconds, ten think intervals
+	static constexpr int64_t EXPIRY_TIME = 10'000;
+
+	/**
+	 * \returns The field toward the creature, nullptr if the follower should search its own path.
+	 */
+	std::shared_ptr<const FlowField> get(Map &map, const std::shared_ptr<Creature> &target);
+	std::shared_ptr<const FlowField> get(Map &map, uint32_t creatureId, const Position &position, int64_t now);
+
+	void erase(uint32_t creatureId);
+
+	/**
+	 * Drops the entries nobody asked for since now - EXPIRY_TIME.
+	 * \returns The number of dropped entries.
+	 */
+	size_t expire(int64_t now);
+
+	size_t size() const {
+		return entries.size();
+	}
+
+private:
+	struct Entry {
+		std::mutex mutex;
+		std::shared_ptr<const FlowField> field;
+		// First request since the creature moved, answered without field
+		Position requestPosition;
+		int64_t requestTime = 0;
+		int64_t lastUse = 0;
+	};
+
+	phmap::parallel_flat_hash_map_m<uint32_t, std::shared_ptr<Entry>> entries;
+	// Expiry runs from get, at most once per EXPIRY_TIME
+	std::atomic<int64_t> lastExpiry = 0;
+};
@@ -10,13 +10,16 @@
 #include "map/utils/mapsector.hpp"
 
 #include "creatures/creature.hpp"
+#include "utils/tools.hpp"
 
 bool MapSector::newSector = false;
 
 void MapSector::addCreature(const std::shared_ptr<Creature> &c) {
+	updateCreatureVersion();
 	creature_list.emplace_back(c);
 	if (c->getPlayer()) {
 		player_list.emplace_back(c);
+		lastPlayerVisit = OTSYS_TIME();
 	} else if (c->getMonster()) {
 		monster_list.emplace_back(c);
 	} else if (c->getNpc()) {
@@ -31,6 +34,7 @@ void MapSector::removeCreature(const std::shared_ptr<Creature> &c) {
 		return;
 	}
 
+	updateCreatureVersion();
 	assert(iter != creature_list.end());
 	*iter = creature_list.back();
 	creature_list.pop_back();
@@ -45,6 +49,7 @@ void MapSector::removeCreature(const std::shared_ptr<Creature> &c) {
 		assert(iter != player_list.end());
 		*iter = player_list.back();
 		player_list.pop_back();
+		lastPlayerVisit = OTSYS_TIME();
 	} else if (c->getMonster()) {
 		iter = std::ranges::find(monster_list, c);
 		if (iter == monster_list.end()) {
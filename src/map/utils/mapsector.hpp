@@ -15,45 +15,128 @@ class Creature;
 class Tile;
 struct BasicTile;
 
+using TileHandle = uint32_t;
+using BasicTileHandle = uint32_t;
+
+/**
+ * What a cell blocks for every creature, kept by Floor in one bitmap per kind.
+ */
+enum TileBlock_t : uint8_t {
+	TILE_BLOCK_NONE = 0,
+	// No ground, or an item that no creature moves through
+	TILE_BLOCK_SOLID = 1 << 0,
+	// Never entered by pathfinding: no ground, floor change or teleport
+	TILE_BLOCK_PATH = 1 << 1,
+	TILE_BLOCK_PROJECTILE = 1 << 2,
+
+	// A cell without tile
+	TILE_BLOCK_EMPTY = TILE_BLOCK_SOLID | TILE_BLOCK_PATH,
+};
+
+/**
+ * One floor of a sector. Cells only hold 32 bit handles into the tile arenas
+ * owned by MapCache, so an empty cell costs 8 bytes and reads never lock.
+ * Writers must hold the floor mutex.
+ */
 struct Floor {
 	explicit Floor(uint8_t z) :
-		z(z) { }
-
-	std::shared_ptr<Tile> getTile(uint16_t x, uint16_t y) const {
-		std::shared_lock<std::shared_mutex> sl(mutex);
-		return tiles[x & SECTOR_MASK][y & SECTOR_MASK].first;
+		z(z) {
+		for (auto &word : blocks[getLayer(TILE_BLOCK_SOLID)]) {
+			word.store(~uint64_t(0), std::memory_order_relaxed);
+		}
+		for (auto &word : blocks[getLayer(TILE_BLOCK_PATH)]) {
+			word.store(~uint64_t(0), std::memory_order_relaxed);
+		}
 	}
 
-	void setTile(uint16_t x, uint16_t y, std::shared_ptr<Tile> tile) {
-		tiles[x & SECTOR_MASK][y & SECTOR_MASK].first = std::move(tile);
+	TileHandle getTile(uint16_t x, uint16_t y) const {
+		return tiles[index(x, y)].load(std::memory_order_acquire);
 	}
 
-	std::shared_ptr<BasicTile> getTileCache(uint16_t x, uint16_t y) const {
-		std::shared_lock<std::shared_mutex> sl(mutex);
-		return tiles[x & SECTOR_MASK][y & SECTOR_MASK].second;
+	void setTile(uint16_t x, uint16_t y, TileHandle tile) {
+		tiles[index(x, y)].store(tile, std::memory_order_release);
 	}
 
-	void setTileCache(uint16_t x, uint16_t y, const std::shared_ptr<BasicTile> &newTile) {
-		tiles[x & SECTOR_MASK][y & SECTOR_MASK].second = newTile;
+	BasicTileHandle getTileCache(uint16_t x, uint16_t y) const {
+		return tileCache[index(x, y)].load(std::memory_order_acquire);
 	}
 
-	const auto &getTiles() const {
-		std::shared_lock<std::shared_mutex> sl(mutex);
-		return tiles;
+	void setTileCache(uint16_t x, uint16_t y, BasicTileHandle newTile) {
+		tileCache[index(x, y)].store(newTile, std::memory_order_release);
 	}
 
 	uint8_t getZ() const {
 		return z;
 	}
 
+	bool isBlocking(uint16_t x, uint16_t y, TileBlock_t block) const {
+		const auto cell = index(x, y);
+		return (blocks[getLayer(block)][cell / 64].load(std::memory_order_relaxed) >> (cell % 64) & 1) != 0;
+	}
+
+	/**
+	 * \returns One bit per cell of the row, from x = 0 in the lowest bit.
+	 */
+	uint64_t getBlockingRow(uint16_t y, TileBlock_t block) const {
+		const auto cell = index(0, y);
+		return blocks[getLayer(block)][cell / 64].load(std::memory_order_relaxed) >> (cell % 64) & ROW_MASK;
+	}
+
+	uint8_t getBlocks(uint16_t x, uint16_t y) const {
+		uint8_t result = TILE_BLOCK_NONE;
+		for (uint8_t layer = 0; layer < BLOCK_LAYERS; ++layer) {
+			result |= isBlocking(x, y, static_cast<TileBlock_t>(1 << layer)) ? 1 << layer : 0;
+		}
+		return result;
+	}
+
+	void setBlocks(uint16_t x, uint16_t y, uint8_t cellBlocks) {
+		const auto cell = index(x, y);
+		const auto bit = uint64_t(1) << (cell % 64);
+		bool walkChanged = false;
+		for (uint8_t layer = 0; layer < BLOCK_LAYERS; ++layer) {
+			auto &word = blocks[layer][cell / 64];
+			const auto previous = cellBlocks & (1 << layer) ? word.fetch_or(bit, std::memory_order_relaxed) : word.fetch_and(~bit, std::memory_order_relaxed);
+			const bool changed = ((previous & bit) != 0) != ((cellBlocks & (1 << layer)) != 0);
+			walkChanged |= changed && (1 << layer) != TILE_BLOCK_PROJECTILE;
+		}
+		if (walkChanged) {
+			walkVersion.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	/**
+	 * Bumped whenever a solid or path bit changes, lets caches built from them
+	 * know they are stale.
+	 */
+	uint32_t getWalkVersion() const {
+		return walkVersion.load(std::memory_order_acquire);
+	}
+
 	auto &getMutex() const {
 		return mutex;
 	}
 
 private:
-	std::pair<std::shared_ptr<Tile>, std::shared_ptr<BasicTile>> tiles[SECTOR_SIZE][SECTOR_SIZE] = {};
+	static constexpr uint8_t BLOCK_LAYERS = 3;
+	static_assert(SECTOR_SIZE < 64 && 64 % SECTOR_SIZE == 0, "a row of the block bitmaps must fit in one word");
+	static constexpr uint64_t ROW_MASK = (uint64_t(1) << SECTOR_SIZE) - 1;
+
+	static size_t index(uint16_t x, uint16_t y) {
+		return (y & SECTOR_MASK) * SECTOR_SIZE + (x & SECTOR_MASK);
+	}
+
+	static uint8_t getLayer(TileBlock_t block) {
+		return static_cast<uint8_t>(std::countr_zero(static_cast<uint8_t>(block)));
+	}
 
-	mutable std::shared_mutex mutex;
+	alignas(64) std::array<std::atomic<TileHandle>, SECTOR_SIZE * SECTOR_SIZE> tiles {};
+	alignas(64) std::array<std::atomic<BasicTileHandle>, SECTOR_SIZE * SECTOR_SIZE> tileCache {};
+	// Kept up to date by MapCache for cached cells and by Tile once it is placed
+	std::array<std::array<std::atomic<uint64_t>, SECTOR_SIZE * SECTOR_SIZE / 64>, BLOCK_LAYERS> blocks {};
+	std::atomic<uint32_t> walkVersion = 0;
+
+	mutable std::mutex mutex;
 
 	uint8_t z { 0 };
 };
@@ -67,47 +150,89 @@ public:
 	MapSector(const MapSector &&) = delete;
 	MapSector &operator=(const MapSector &&) = delete;
 
-	std::shared_ptr<Floor> createFloor(uint32_t z) {
+	Floor* createFloor(uint32_t z) {
 		if (z >= MAP_MAX_LAYERS) {
 			g_logger().error("Attempt to create floor on invalid coordinate: {}", z);
 			return nullptr;
 		}
+
+		if (const auto floor = floors[z].load(std::memory_order_acquire)) {
+			return floor;
+		}
+
 		std::scoped_lock lock(floors_mutex);
-		if (!floors[z]) {
-			floors[z] = std::make_shared<Floor>(static_cast<uint8_t>(z));
+		if (!ownedFloors[z]) {
+			ownedFloors[z] = std::make_unique<Floor>(static_cast<uint8_t>(z));
+			floors[z].store(ownedFloors[z].get(), std::memory_order_release);
 		}
-		return floors[z];
+		return ownedFloors[z].get();
 	}
 
-	std::shared_ptr<Floor> getFloor(uint8_t z) {
+	Floor* getFloor(uint8_t z) const {
 		if (z >= MAP_MAX_LAYERS) {
 			g_logger().error("Attempt to get floor on invalid coordinate: {}", z);
 			return nullptr;
 		}
-		std::scoped_lock lock(floors_mutex);
-		return floors[z];
+		return floors[z].load(std::memory_order_acquire);
 	}
 
 	void addCreature(const std::shared_ptr<Creature> &c);
 
 	void removeCreature(const std::shared_ptr<Creature> &c);
 
+	/**
+	 * @return Time in milliseconds a player last entered or left the sector, or when the sector was created.
+	 */
+	int64_t getLastPlayerVisit() const {
+		return lastPlayerVisit;
+	}
+
+	/**
+	 * @return Counter bumped whenever a creature enters, leaves or moves within the sector.
+	 */
+	uint32_t getCreatureVersion() const {
+		return creatureVersion;
+	}
+
+	void updateCreatureVersion() {
+		++creatureVersion;
+	}
+
+	/**
+	 * @return Players whose view reaches into the sector. The list is replaced,
+	 * not changed, by later subscriptions, so it stays valid while held.
+	 */
+	std::shared_ptr<const std::vector<std::shared_ptr<Creature>>> getSubscribers() const {
+		static const auto noSubscribers = std::make_shared<const std::vector<std::shared_ptr<Creature>>>();
+		return subscriber_list ? subscriber_list : noSubscribers;
+	}
+
 private:
 	static bool newSector;
 
 	MapSector* sectorS = nullptr;
 	MapSector* sectorE = nullptr;
 
+	// Position in the sector grid, (x / SECTOR_SIZE, y / SECTOR_SIZE)
+	uint16_t sectorX = 0;
+	uint16_t sectorY = 0;
+	int64_t lastPlayerVisit = 0;
+	uint32_t creatureVersion = 0;
+
 	std::vector<std::shared_ptr<Creature>> creature_list;
 	std::vector<std::shared_ptr<Creature>> player_list;
 	std::vector<std::shared_ptr<Creature>> monster_list;
 	std::vector<std::shared_ptr<Creature>> npc_list;
+	// Players whose view reaches into the sector, kept by Spectators::updateSubscriptions.
+	// Replaced rather than changed, lookups borrow the list they read.
+	// Only subscribed and read on the dispatcher thread, like the spectator cache
+	std::shared_ptr<const std::vector<std::shared_ptr<Creature>>> subscriber_list;
 
 	mutable std::mutex floors_mutex;
 
-	std::shared_ptr<Floor> floors[MAP_MAX_LAYERS] = {};
-
-	uint32_t floorBits = 0;
+	// Floors are created once and never removed, readers don't need the mutex
+	std::array<std::atomic<Floor*>, MAP_MAX_LAYERS> floors {};
+	std::array<std::unique_ptr<Floor>, MAP_MAX_LAYERS> ownedFloors {};
 
 	friend class Spectators;
 	friend class MapCache;
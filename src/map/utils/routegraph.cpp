@@ -0,0 +1,338 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "map/utils/routegraph.hpp"
+
+#include "map/mapcache.hpp"
+#include "map/utils/astarnodes.hpp"
+#include "utils/tools.hpp"
+
+namespace {
+	constexpr uint16_t UNREACHABLE = std::numeric_limits<uint16_t>::max();
+	static_assert(SECTOR_SIZE * SECTOR_SIZE <= std::numeric_limits<uint8_t>::max() + 1, "cells of a cluster are indexed by uint8_t");
+
+	constexpr std::array<std::pair<int32_t, int32_t>, 8> NEIGHBORS = { {
+		{ -1, 0 },
+		{ 0, 1 },
+		{ 1, 0 },
+		{ 0, -1 },
+		{ -1, -1 },
+		{ 1, -1 },
+		{ 1, 1 },
+		{ -1, 1 },
+	} };
+
+	uint64_t getKey(const Position &pos) {
+		return static_cast<uint64_t>(pos.x) << 24 | static_cast<uint64_t>(pos.y) << 8 | pos.z;
+	}
+
+	uint16_t getBase(uint16_t coordinate) {
+		return coordinate & ~static_cast<uint16_t>(SECTOR_MASK);
+	}
+
+	uint8_t getCell(const Position &pos) {
+		return static_cast<uint8_t>((pos.y & SECTOR_MASK) * SECTOR_SIZE + (pos.x & SECTOR_MASK));
+	}
+
+	Position getCellPosition(uint8_t cell) {
+		return Position(cell % SECTOR_SIZE, cell / SECTOR_SIZE, 0);
+	}
+
+	bool isSameCluster(const Position &a, const Position &b) {
+		return a.z == b.z && getBase(a.x) == getBase(b.x) && getBase(a.y) == getBase(b.y);
+	}
+
+	uint32_t getEstimate(const Position &pos, const Position &target) {
+		// Diagonal steps cost more than two straight ones, the straight distance never overestimates
+		return (Position::getDistanceX(pos, target) + Position::getDistanceY(pos, target)) * AStarNodes::MAP_NORMALWALKCOST;
+	}
+}
+
+RouteGraph::LocalSearch::LocalSearch(const Walkable &walkable, uint8_t source) {
+	costs.fill(UNREACHABLE);
+	parents.fill(source);
+
+	// Dial's buckets, every step costs less than the ring size
+	constexpr size_t BUCKETS = 32;
+	static_assert(AStarNodes::MAP_DIAGONALWALKCOST < BUCKETS && AStarNodes::MAP_NORMALWALKCOST < BUCKETS);
+	thread_local std::array<std::vector<uint8_t>, BUCKETS> buckets;
+
+	costs[source] = 0;
+	buckets[0].emplace_back(source);
+	size_t pending = 1;
+	for (uint16_t cost = 0; pending > 0; ++cost) {
+		auto &bucket = buckets[cost % BUCKETS];
+		for (size_t i = 0; i < bucket.size(); ++i) {
+			const auto cell = bucket[i];
+			--pending;
+			if (cost != costs[cell]) {
+				continue;
+			}
+
+			const int32_t x = cell % SECTOR_SIZE;
+			const int32_t y = cell / SECTOR_SIZE;
+			for (const auto &[dx, dy] : NEIGHBORS) {
+				const int32_t nx = x + dx;
+				const int32_t ny = y + dy;
+				if (nx < 0 || ny < 0 || nx >= SECTOR_SIZE || ny >= SECTOR_SIZE) {
+					continue;
+				}
+
+				const auto neighbor = static_cast<uint8_t>(ny * SECTOR_SIZE + nx);
+				if (!walkable[neighbor]) {
+					continue;
+				}
+
+				const auto newCost = static_cast<uint16_t>(cost + (dx != 0 && dy != 0 ? AStarNodes::MAP_DIAGONALWALKCOST : AStarNodes::MAP_NORMALWALKCOST));
+				if (newCost < costs[neighbor]) {
+					costs[neighbor] = newCost;
+					parents[neighbor] = cell;
+					buckets[newCost % BUCKETS].emplace_back(neighbor);
+					++pending;
+				}
+			}
+		}
+		bucket.clear();
+	}
+}
+
+void RouteGraph::LocalSearch::appendPathTo(uint8_t from, std::vector<Direction> &dirList) const {
+	for (auto cell = from; parents[cell] != cell; cell = parents[cell]) {
+		dirList.emplace_back(getDirectionTo(getCellPosition(cell), getCellPosition(parents[cell])));
+	}
+}
+
+void RouteGraph::LocalSearch::appendPathFrom(uint8_t to, std::vector<Direction> &dirList) const {
+	const auto startSize = dirList.size();
+	for (auto cell = to; parents[cell] != cell; cell = parents[cell]) {
+		dirList.emplace_back(getDirectionTo(getCellPosition(parents[cell]), getCellPosition(cell)));
+	}
+	std::reverse(dirList.begin() + startSize, dirList.end());
+}
+
+RouteGraph::Walkable RouteGraph::getWalkable(const MapCache &map, uint16_t baseX, uint16_t baseY, uint8_t z) {
+	Walkable walkable;
+	const auto sector = map.getMapSector(baseX, baseY);
+	const auto floor = sector && z < MAP_MAX_LAYERS ? sector->getFloor(z) : nullptr;
+	if (!floor) {
+		return walkable;
+	}
+
+	// Cells without solid or path blocks, a bitmap word per row
+	constexpr uint64_t rowMask = (uint64_t(1) << SECTOR_SIZE) - 1;
+	for (int32_t y = 0; y < SECTOR_SIZE; ++y) {
+		const auto blocked = floor->getBlockingRow(baseY + y, TILE_BLOCK_SOLID) | floor->getBlockingRow(baseY + y, TILE_BLOCK_PATH);
+		walkable |= Walkable(~blocked & rowMask) << (y * SECTOR_SIZE);
+	}
+	return walkable;
+}
+
+std::array<uint32_t, 5> RouteGraph::getVersions(const MapCache &map, uint16_t baseX, uint16_t baseY, uint8_t z) {
+	std::array<uint32_t, 5> versions {};
+	versions[0] = map.getWalkVersion(baseX, baseY, z);
+	if (baseX >= SECTOR_SIZE) {
+		versions[1] = map.getWalkVersion(baseX - SECTOR_SIZE, baseY, z);
+	}
+	if (baseX + SECTOR_SIZE <= std::numeric_limits<uint16_t>::max()) {
+		versions[2] = map.getWalkVersion(baseX + SECTOR_SIZE, baseY, z);
+	}
+	if (baseY >= SECTOR_SIZE) {
+		versions[3] = map.getWalkVersion(baseX, baseY - SECTOR_SIZE, z);
+	}
+	if (baseY + SECTOR_SIZE <= std::numeric_limits<uint16_t>::max()) {
+		versions[4] = map.getWalkVersion(baseX, baseY + SECTOR_SIZE, z);
+	}
+	return versions;
+}
+
+std::shared_ptr<RouteGraph::Cluster> RouteGraph::buildCluster(const MapCache &map, uint16_t baseX, uint16_t baseY, uint8_t z) {
+	auto cluster = std::make_shared<Cluster>();
+	cluster->versions = getVersions(map, baseX, baseY, z);
+
+	const auto walkable = getWalkable(map, baseX, baseY, z);
+	const auto addBorder = [&](int32_t dx, int32_t dy) {
+		const int32_t neighborX = baseX + dx * SECTOR_SIZE;
+		const int32_t neighborY = baseY + dy * SECTOR_SIZE;
+		if (neighborX < 0 || neighborY < 0 || neighborX > std::numeric_limits<uint16_t>::max() || neighborY > std::numeric_limits<uint16_t>::max()) {
+			return;
+		}
+
+		const auto neighborWalkable = getWalkable(map, neighborX, neighborY, z);
+		const auto getBorderCell = [dx, dy](int32_t step) {
+			// Own cell of the border, the neighbor one is on the opposite side of its own cluster
+			const int32_t x = dx < 0 ? 0 : dx > 0 ? SECTOR_SIZE - 1 : step;
+			const int32_t y = dy < 0 ? 0 : dy > 0 ? SECTOR_SIZE - 1 : step;
+			return std::pair(x, y);
+		};
+
+		// One entrance in the middle of every open stretch of the border
+		int32_t runStart = -1;
+		for (int32_t step = 0; step <= SECTOR_SIZE; ++step) {
+			bool open = false;
+			if (step < SECTOR_SIZE) {
+				const auto [x, y] = getBorderCell(step);
+				const int32_t peerX = dx != 0 ? SECTOR_SIZE - 1 - x : x;
+				const int32_t peerY = dy != 0 ? SECTOR_SIZE - 1 - y : y;
+				open = walkable[y * SECTOR_SIZE + x] && neighborWalkable[peerY * SECTOR_SIZE + peerX];
+			}
+
+			if (open && runStart < 0) {
+				runStart = step;
+			} else if (!open && runStart >= 0) {
+				const auto [x, y] = getBorderCell((runStart + step - 1) / 2);
+				const Position position(baseX + x, baseY + y, z);
+				cluster->entrances.emplace_back(Entrance { position, Position(position.x + dx, position.y + dy, z) });
+				runStart = -1;
+			}
+		}
+	};
+
+	addBorder(-1, 0);
+	addBorder(1, 0);
+	addBorder(0, -1);
+	addBorder(0, 1);
+
+	const auto count = cluster->entrances.size();
+	cluster->costs.resize(count * count, UNREACHABLE);
+	for (size_t from = 0; from < count; ++from) {
+		const LocalSearch search(walkable, getCell(cluster->entrances[from].position));
+		for (size_t to = 0; to < count; ++to) {
+			cluster->costs[from * count + to] = search.costs[getCell(cluster->entrances[to].position)];
+		}
+	}
+	return cluster;
+}
+
+std::shared_ptr<const RouteGraph::Cluster> RouteGraph::getCluster(const MapCache &map, const Position &pos) {
+	const uint16_t baseX = getBase(pos.x);
+	const uint16_t baseY = getBase(pos.y);
+	auto &cluster = clusters[getKey(Position(baseX, baseY, pos.z))];
+	if (!cluster || cluster->versions != getVersions(map, baseX, baseY, pos.z)) {
+		cluster = buildCluster(map, baseX, baseY, pos.z);
+	}
+	return cluster;
+}
+
+bool RouteGraph::getPath(const MapCache &map, const Position &start, const Position &target, std::vector<Direction> &dirList) {
+	if (start.z != target.z || start.z >= MAP_MAX_LAYERS || std::max(Position::getDistanceX(start, target), Position::getDistanceY(start, target)) > MAX_DISTANCE) {
+		return false;
+	}
+	if (start == target) {
+		return true;
+	}
+
+	std::scoped_lock lock(mutex);
+
+	const auto startCluster = getCluster(map, start);
+	const LocalSearch startSearch(getWalkable(map, getBase(start.x), getBase(start.y), start.z), getCell(start));
+
+	// Walking costs are the same both ways, a search from the target gives the cost to reach it.
+	// The walker stands on the start whatever blocks it, so it is walkable from there.
+	auto targetWalkable = getWalkable(map, getBase(target.x), getBase(target.y), target.z);
+	if (isSameCluster(start, target)) {
+		targetWalkable.set(getCell(start));
+	}
+	const LocalSearch targetSearch(targetWalkable, getCell(target));
+
+	struct Node {
+		uint32_t cost;
+		Position parent;
+	};
+	phmap::flat_hash_map<uint64_t, Node> nodes;
+
+	using QueueEntry = std::pair<uint32_t, Position>;
+	const auto compare = [](const QueueEntry &a, const QueueEntry &b) { return a.first > b.first; };
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, decltype(compare)> queue(compare);
+
+	const auto relax = [&](const Position &pos, const Position &parent, uint32_t cost) {
+		const auto [it, inserted] = nodes.try_emplace(getKey(pos), Node { cost, parent });
+		if (!inserted) {
+			if (cost >= it->second.cost) {
+				return;
+			}
+			it->second = { cost, parent };
+		}
+		queue.emplace(cost + getEstimate(pos, target), pos);
+	};
+
+	relax(start, start, 0);
+	size_t expanded = 0;
+	bool found = false;
+	while (!queue.empty() && expanded < MAX_EXPANDED_NODES) {
+		const auto [estimate, pos] = queue.top();
+		queue.pop();
+		const auto cost = nodes[getKey(pos)].cost;
+		if (estimate != cost + getEstimate(pos, target)) {
+			continue;
+		}
+		if (pos == target) {
+			found = true;
+			break;
+		}
+		++expanded;
+
+		const auto cluster = pos == start ? startCluster : getCluster(map, pos);
+		const auto &entrances = cluster->entrances;
+		if (pos == start) {
+			for (const auto &entrance : entrances) {
+				if (const auto entranceCost = startSearch.costs[getCell(entrance.position)]; entranceCost != UNREACHABLE) {
+					relax(entrance.position, pos, cost + entranceCost);
+				}
+			}
+		}
+		if (isSameCluster(pos, target) && targetSearch.costs[getCell(pos)] != UNREACHABLE) {
+			relax(target, pos, cost + targetSearch.costs[getCell(pos)]);
+		}
+
+		const auto it = std::ranges::find_if(entrances, [&pos](const Entrance &entrance) { return entrance.position == pos; });
+		if (it == entrances.end()) {
+			continue;
+		}
+
+		const auto from = static_cast<size_t>(it - entrances.begin());
+		relax(it->peer, pos, cost + AStarNodes::MAP_NORMALWALKCOST);
+		for (size_t to = 0; to < entrances.size(); ++to) {
+			if (const auto entranceCost = cluster->costs[from * entrances.size() + to]; to != from && entranceCost != UNREACHABLE) {
+				relax(entrances[to].position, pos, cost + entranceCost);
+			}
+		}
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	std::vector<Position> waypoints;
+	for (Position pos = target; pos != start; pos = nodes[getKey(pos)].parent) {
+		waypoints.emplace_back(pos);
+	}
+	waypoints.emplace_back(start);
+	std::ranges::reverse(waypoints);
+
+	// Refinement, a step over each border and a local search through each cluster crossed
+	for (size_t i = 1; i < waypoints.size(); ++i) {
+		const auto &from = waypoints[i - 1];
+		const auto &to = waypoints[i];
+		if (!isSameCluster(from, to)) {
+			dirList.emplace_back(getDirectionTo(from, to));
+		} else if (to == target) {
+			targetSearch.appendPathTo(getCell(from), dirList);
+		} else if (from == start) {
+			startSearch.appendPathFrom(getCell(to), dirList);
+		} else {
+			LocalSearch(getWalkable(map, getBase(from.x), getBase(from.y), from.z), getCell(from)).appendPathFrom(getCell(to), dirList);
+		}
+	}
+	return true;
+}
+
+size_t RouteGraph::size() const {
+	std::scoped_lock lock(mutex);
+	return clusters.size();
+}
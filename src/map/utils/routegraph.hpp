@@ -0,0 +1,88 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "game/movement/position.hpp"
+#include "map/map_const.hpp"
+
+class MapCache;
+
+/**
+ * Hierarchical (HPA*) routes across a floor, for walks longer than the A*
+ * search reaches.
+ *
+ * Every sector floor is a cluster. Clusters are linked through entrances, the
+ * middle of each open stretch of their shared border, and keep the walking
+ * cost between their own entrances. A route is searched over entrances and
+ * refined by walking each cluster on its own.
+ *
+ * Clusters are built on first use from the solid and path bitmaps of the
+ * floors, and rebuilt once their floor or a neighbor reports a new walk
+ * version. Creatures and anything else queryAdd checks are left to the walker.
+ */
+class RouteGraph {
+public:
+	// Longer routes are left to scripted waypoints
+	static constexpr int32_t MAX_DISTANCE = 1024;
+
+	/**
+	 * Appends the steps from start to target, both on the same floor.
+	 * \returns false if there is no route, dirList is left untouched.
+	 */
+	bool getPath(const MapCache &map, const Position &start, const Position &target, std::vector<Direction> &dirList);
+
+	/**
+	 * \returns The number of clusters built so far.
+	 */
+	size_t size() const;
+
+private:
+	static constexpr size_t MAX_EXPANDED_NODES = 16'384;
+
+	struct Entrance {
+		Position position;
+		// Cell across the border, an entrance of the neighbor cluster
+		Position peer;
+	};
+
+	using Walkable = std::bitset<SECTOR_SIZE * SECTOR_SIZE>;
+
+	/**
+	 * Dijkstra from one cell over the walkable cells of a cluster.
+	 */
+	struct LocalSearch {
+		LocalSearch(const Walkable &walkable, uint8_t source);
+
+		// Steps from the cell to the source
+		void appendPathTo(uint8_t from, std::vector<Direction> &dirList) const;
+		// Steps from the source to the cell
+		void appendPathFrom(uint8_t to, std::vector<Direction> &dirList) const;
+
+		std::array<uint16_t, SECTOR_SIZE * SECTOR_SIZE> costs;
+		// Cell each cell is reached from, the source points to itself
+		std::array<uint8_t, SECTOR_SIZE * SECTOR_SIZE> parents;
+	};
+
+	struct Cluster {
+		// Walk versions of the floor and of its west, east, north and south neighbors when built
+		std::array<uint32_t, 5> versions {};
+		std::vector<Entrance> entrances;
+		// Cost between two entrances, row major, uint16_t max when only reachable through other clusters
+		std::vector<uint16_t> costs;
+	};
+
+	std::shared_ptr<const Cluster> getCluster(const MapCache &map, const Position &pos);
+	static std::shared_ptr<Cluster> buildCluster(const MapCache &map, uint16_t baseX, uint16_t baseY, uint8_t z);
+	static Walkable getWalkable(const MapCache &map, uint16_t baseX, uint16_t baseY, uint8_t z);
+	static std::array<uint32_t, 5> getVersions(const MapCache &map, uint16_t baseX, uint16_t baseY, uint8_t z);
+
+	mutable std::mutex mutex;
+	phmap::flat_hash_map<uint64_t, std::shared_ptr<const Cluster>> clusters;
+};
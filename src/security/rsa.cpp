@@ -105,6 +105,29 @@ void RSA::decrypt(char* msg) const {
 	mpz_clear(m);
 }
 
+void RSA::encrypt(char* msg) const {
+	mpz_t m;
+	mpz_t c;
+	mpz_t e;
+	mpz_init2(m, 1024);
+	mpz_init2(c, 1024);
+	mpz_init_set_ui(e, 65537);
+
+	mpz_import(m, 128, 1, 1, 0, 0, msg);
+
+	// c = m^e mod n
+	mpz_powm(c, m, e, n);
+
+	const size_t count = (mpz_sizeinbase(c, 2) + 7) / 8;
+	std::fill(msg, msg + (128 - count), 0);
+
+	mpz_export(msg + (128 - count), nullptr, 1, 1, 0, 0, c);
+
+	mpz_clear(m);
+	mpz_clear(c);
+	mpz_clear(e);
+}
+
 std::string RSA::base64Decrypt(const std::string &input) const {
 	auto posOfCharacter = [](const uint8_t chr) -> uint16_t {
 		if (chr >= 'A' && chr <= 'Z') {
@@ -0,0 +1,147 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "security/xtea.hpp"
+
+namespace {
+	constexpr uint32_t DELTA = 0x61C88647;
+	constexpr size_t ROUNDS = 32;
+	constexpr size_t BLOCK_SIZE = 8;
+
+	// Sum and key word of each half round, in the order they are applied
+	using RoundKeys = std::array<std::array<uint32_t, 2>, ROUNDS>;
+
+	RoundKeys getRoundKeys(const XTEA::Key &key, bool encrypt) {
+		RoundKeys roundKeys;
+		uint32_t sum = encrypt ? 0 : 0xC6EF3720;
+		for (auto &roundKey : roundKeys) {
+			if (encrypt) {
+				roundKey[0] = sum + key[sum & 3];
+				sum -= DELTA;
+				roundKey[1] = sum + key[(sum >> 11) & 3];
+			} else {
+				roundKey[0] = sum + key[(sum >> 11) & 3];
+				sum += DELTA;
+				roundKey[1] = sum + key[sum & 3];
+			}
+		}
+		return roundKeys;
+	}
+
+	template <bool Encrypt>
+	void transformScalar(uint8_t* buffer, size_t length, const RoundKeys &roundKeys) {
+		for (size_t pos = 0; pos + BLOCK_SIZE <= length; pos += BLOCK_SIZE) {
+			uint32_t v0;
+			uint32_t v1;
+			std::memcpy(&v0, buffer + pos, 4);
+			std::memcpy(&v1, buffer + pos + 4, 4);
+
+			for (const auto &roundKey : roundKeys) {
+				if constexpr (Encrypt) {
+					v0 += ((v1 << 4 ^ v1 >> 5) + v1) ^ roundKey[0];
+					v1 += ((v0 << 4 ^ v0 >> 5) + v0) ^ roundKey[1];
+				} else {
+					v1 -= ((v0 << 4 ^ v0 >> 5) + v0) ^ roundKey[0];
+					v0 -= ((v1 << 4 ^ v1 >> 5) + v1) ^ roundKey[1];
+				}
+			}
+
+			std::memcpy(buffer + pos, &v0, 4);
+			std::memcpy(buffer + pos + 4, &v1, 4);
+		}
+	}
+
+#if defined(SIMD_DISPATCH)
+	// Swapping the middle words turns two blocks into their v0 and v1 pairs, and back
+	constexpr int SWAP_MIDDLE = _MM_SHUFFLE(3, 1, 2, 0);
+
+	template <bool Encrypt>
+	SIMD_TARGET("sse2")
+	size_t transformSSE2(uint8_t* buffer, size_t length, const RoundKeys &roundKeys) {
+		constexpr size_t STRIDE = 4 * BLOCK_SIZE;
+		size_t pos = 0;
+		for (; pos + STRIDE <= length; pos += STRIDE) {
+			const auto first = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + pos)), SWAP_MIDDLE);
+			const auto second = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + pos + 16)), SWAP_MIDDLE);
+			auto v0 = _mm_unpacklo_epi64(first, second);
+			auto v1 = _mm_unpackhi_epi64(first, second);
+
+			for (const auto &roundKey : roundKeys) {
+				const auto key0 = _mm_set1_epi32(static_cast<int32_t>(roundKey[0]));
+				const auto key1 = _mm_set1_epi32(static_cast<int32_t>(roundKey[1]));
+				if constexpr (Encrypt) {
+					v0 = _mm_add_epi32(v0, _mm_xor_si128(_mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v1, 4), _mm_srli_epi32(v1, 5)), v1), key0));
+					v1 = _mm_add_epi32(v1, _mm_xor_si128(_mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v0, 4), _mm_srli_epi32(v0, 5)), v0), key1));
+				} else {
+					v1 = _mm_sub_epi32(v1, _mm_xor_si128(_mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v0, 4), _mm_srli_epi32(v0, 5)), v0), key0));
+					v0 = _mm_sub_epi32(v0, _mm_xor_si128(_mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v1, 4), _mm_srli_epi32(v1, 5)), v1), key1));
+				}
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + pos), _mm_shuffle_epi32(_mm_unpacklo_epi64(v0, v1), SWAP_MIDDLE));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + pos + 16), _mm_shuffle_epi32(_mm_unpackhi_epi64(v0, v1), SWAP_MIDDLE));
+		}
+		return pos;
+	}
+
+	// Same as SSE2, each 128-bit half of the registers holding its own blocks
+	template <bool Encrypt>
+	SIMD_TARGET("avx2")
+	size_t transformAVX2(uint8_t* buffer, size_t length, const RoundKeys &roundKeys) {
+		constexpr size_t STRIDE = 8 * BLOCK_SIZE;
+		size_t pos = 0;
+		for (; pos + STRIDE <= length; pos += STRIDE) {
+			const auto first = _mm256_shuffle_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + pos)), SWAP_MIDDLE);
+			const auto second = _mm256_shuffle_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + pos + 32)), SWAP_MIDDLE);
+			auto v0 = _mm256_unpacklo_epi64(first, second);
+			auto v1 = _mm256_unpackhi_epi64(first, second);
+
+			for (const auto &roundKey : roundKeys) {
+				const auto key0 = _mm256_set1_epi32(static_cast<int32_t>(roundKey[0]));
+				const auto key1 = _mm256_set1_epi32(static_cast<int32_t>(roundKey[1]));
+				if constexpr (Encrypt) {
+					v0 = _mm256_add_epi32(v0, _mm256_xor_si256(_mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v1, 4), _mm256_srli_epi32(v1, 5)), v1), key0));
+					v1 = _mm256_add_epi32(v1, _mm256_xor_si256(_mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v0, 4), _mm256_srli_epi32(v0, 5)), v0), key1));
+				} else {
+					v1 = _mm256_sub_epi32(v1, _mm256_xor_si256(_mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v0, 4), _mm256_srli_epi32(v0, 5)), v0), key0));
+					v0 = _mm256_sub_epi32(v0, _mm256_xor_si256(_mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v1, 4), _mm256_srli_epi32(v1, 5)), v1), key1));
+				}
+			}
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer + pos), _mm256_shuffle_epi32(_mm256_unpacklo_epi64(v0, v1), SWAP_MIDDLE));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer + pos + 32), _mm256_shuffle_epi32(_mm256_unpackhi_epi64(v0, v1), SWAP_MIDDLE));
+		}
+		return pos;
+	}
+#endif
+
+	template <bool Encrypt>
+	void transform(uint8_t* buffer, size_t length, const XTEA::Key &key, [[maybe_unused]] SimdLevel level) {
+		const auto roundKeys = getRoundKeys(key, Encrypt);
+
+		size_t done = 0;
+#if defined(SIMD_DISPATCH)
+		if (level == SimdLevel::AVX2) {
+			done = transformAVX2<Encrypt>(buffer, length, roundKeys);
+		}
+		if (level >= SimdLevel::SSE2) {
+			done += transformSSE2<Encrypt>(buffer + done, length - done, roundKeys);
+		}
+#endif
+		transformScalar<Encrypt>(buffer + done, length - done, roundKeys);
+	}
+}
+
+void XTEA::encrypt(uint8_t* buffer, size_t length, const Key &key, SimdLevel level) {
+	transform<true>(buffer, length, key, level);
+}
+
+void XTEA::decrypt(uint8_t* buffer, size_t length, const Key &key, SimdLevel level) {
+	transform<false>(buffer, length, key, level);
+}
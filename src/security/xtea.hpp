@@ -0,0 +1,27 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "utils/simd.hpp"
+
+/**
+ * XTEA in ECB mode, as the client expects it.
+ *
+ * Blocks are independent, so the SSE2 and AVX2 kernels run 4 and 8 of them
+ * in lanes and leave the tail to the scalar one. The kernel defaults to the
+ * widest one the CPU supports.
+ */
+namespace XTEA {
+	using Key = std::array<uint32_t, 4>;
+
+	// length must be a multiple of 8
+	void encrypt(uint8_t* buffer, size_t length, const Key &key, SimdLevel level = getSimdLevel());
+	void decrypt(uint8_t* buffer, size_t length, const Key &key, SimdLevel level = getSimdLevel());
+}
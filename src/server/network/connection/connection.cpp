@@ -73,7 +73,7 @@ void Connection::close(bool force) {
 		g_dispatcher().addEvent([protocol = protocol] { protocol->release(); }, __FUNCTION__, std::chrono::milliseconds(CONNECTION_WRITE_TIMEOUT * 1000).count());
 	}
 
-	if (messageQueue.empty() || force) {
+	if ((messageQueue.empty() && writeBatch.empty()) || force) {
 		closeSocket();
 	}
 }
@@ -318,7 +318,7 @@ void Connection::send(const OutputMessage_ptr &outputMessage) {
 		return;
 	}
 
-	bool noPendingWrite = messageQueue.empty();
+	bool noPendingWrite = messageQueue.empty() && writeBatch.empty();
 	messageQueue.emplace_back(outputMessage);
 
 	if (noPendingWrite) {
@@ -345,12 +345,22 @@ void Connection::internalWorker() {
 		return;
 	}
 
-	const auto &outputMessage = messageQueue.front();
-	lock.unlock();
-	protocol->onSendMessage(outputMessage);
-	lock.lock();
+	// Everything queued so far goes out in one write, measured once encoded:
+	// header, padding and compression change the size of every message
+	size_t batchSize = 0;
+	do {
+		auto outputMessage = std::move(messageQueue.front());
+		messageQueue.pop_front();
+		// Pending in the batch, messages queued meanwhile wait for this write
+		writeBatch.emplace_back(outputMessage);
 
-	internalSend(outputMessage);
+		lock.unlock();
+		protocol->onSendMessage(outputMessage);
+		lock.lock();
+		batchSize += outputMessage->getLength();
+	} while (!messageQueue.empty() && batchSize < CONNECTION_WRITE_BATCH_SIZE);
+
+	internalSend();
 }
 
 uint32_t Connection::getIP() {
@@ -369,12 +379,17 @@ uint32_t Connection::getIP() {
 	return ip;
 }
 
-void Connection::internalSend(const OutputMessage_ptr &outputMessage) {
+void Connection::internalSend() {
 	writeTimer.expires_from_now(std::chrono::seconds(CONNECTION_WRITE_TIMEOUT));
 	writeTimer.async_wait([self = std::weak_ptr<Connection>(shared_from_this())](const std::error_code &error) { Connection::handleTimeout(self, error); });
 
+	writeBuffers.clear();
+	for (const auto &outputMessage : writeBatch) {
+		writeBuffers.emplace_back(outputMessage->getOutputBuffer(), outputMessage->getLength());
+	}
+
 	try {
-		asio::async_write(socket, asio::buffer(outputMessage->getOutputBuffer(), outputMessage->getLength()), [self = shared_from_this()](const std::error_code &error, std::size_t N) { self->onWriteOperation(error); });
+		asio::async_write(socket, writeBuffers, [self = shared_from_this()](const std::error_code &error, std::size_t N) { self->onWriteOperation(error); });
 	} catch (const std::system_error &e) {
 		g_logger().error("[Connection::internalSend] - Exception in async_write: {}", e.what());
 		close(FORCE_CLOSE);
@@ -388,18 +403,16 @@ void Connection::onWriteOperation(const std::error_code &error) {
 	if (error) {
 		g_logger().error("[Connection::onWriteOperation] - Write error: {}", error.message());
 		messageQueue.clear();
+		writeBatch.clear();
 		close(FORCE_CLOSE);
 		return;
 	}
 
-	messageQueue.pop_front();
+	writeBatch.clear();
 
 	if (!messageQueue.empty()) {
-		const auto &outputMessage = messageQueue.front();
 		lock.unlock();
-		protocol->onSendMessage(outputMessage);
-		lock.lock();
-		internalSend(outputMessage);
+		internalWorker();
 	} else if (connectionState == CONNECTION_STATE_CLOSED) {
 		closeSocket();
 	}
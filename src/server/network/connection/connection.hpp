@@ -15,6 +15,8 @@
 
 static constexpr int32_t CONNECTION_WRITE_TIMEOUT = 30;
 static constexpr int32_t CONNECTION_READ_TIMEOUT = 30;
+// Encoded bytes after which no more queued messages join a write, the message crossing it is the last one
+static constexpr size_t CONNECTION_WRITE_BATCH_SIZE = 64 * 1024;
 
 class Protocol;
 using Protocol_ptr = std::shared_ptr<Protocol>;
@@ -81,7 +83,7 @@ private:
 
 	void closeSocket();
 	void internalWorker();
-	void internalSend(const OutputMessage_ptr &outputMessage);
+	void internalSend();
 
 	asio::ip::tcp::socket &getSocket() {
 		return socket;
@@ -92,7 +94,11 @@ private:
 
 	std::recursive_mutex connectionLock;
 
-	std::list<OutputMessage_ptr> messageQueue;
+	// Messages waiting for the next write
+	std::deque<OutputMessage_ptr> messageQueue;
+	// Messages of the write in flight and their buffers, gathered into one writev
+	std::vector<OutputMessage_ptr> writeBatch;
+	std::vector<asio::const_buffer> writeBuffers;
 
 	ConstServicePort_ptr service_port;
 	Protocol_ptr protocol;
@@ -0,0 +1,25 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "server/network/message/broadcastmessage.hpp"
+
+BroadcastMessage::BroadcastMessage(Encoder encoder) :
+	encoder(std::move(encoder)) { }
+
+const NetworkMessage &BroadcastMessage::get(bool oldProtocol, uint8_t variant) {
+	for (const auto &entry : messages) {
+		if (entry.oldProtocol == oldProtocol && entry.variant == variant) {
+			return *entry.message;
+		}
+	}
+
+	auto message = std::make_unique<NetworkMessage>();
+	encoder(*message, oldProtocol, variant);
+	return *messages.emplace_back(oldProtocol, variant, std::move(message)).message;
+}
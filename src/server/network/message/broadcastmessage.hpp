@@ -0,0 +1,49 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "server/network/message/networkmessage.hpp"
+
+/**
+ * A packet sent as is to many clients. It is encoded once for each protocol
+ * variant that asks for it, every client gets a copy of the same bytes.
+ */
+class BroadcastMessage {
+public:
+	// Writes the packet for the old or the current protocol. The variant is
+	// for packets that also differ in one small value, such as a stack position.
+	using Encoder = std::function<void(NetworkMessage &msg, bool oldProtocol, uint8_t variant)>;
+
+	explicit BroadcastMessage(Encoder encoder);
+
+	/**
+	 * @return The packet for the protocol and variant, empty if there is
+	 * nothing to send to such clients.
+	 */
+	const NetworkMessage &get(bool oldProtocol, uint8_t variant = 0);
+
+	/**
+	 * @return How many packets were encoded so far.
+	 */
+	size_t size() const {
+		return messages.size();
+	}
+
+private:
+	struct Entry {
+		bool oldProtocol;
+		uint8_t variant;
+		std::unique_ptr<NetworkMessage> message;
+	};
+
+	Encoder encoder;
+	// Seldom more than two, the protocols in use times the variants seen
+	std::vector<Entry> messages;
+};
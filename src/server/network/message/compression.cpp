@@ -0,0 +1,187 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "server/network/message/compression.hpp"
+
+#include "config/configmanager.hpp"
+#include "server/network/message/outputmessage.hpp"
+
+namespace {
+	// Raw deflate, as the client expects it
+	constexpr int32_t WINDOW_BITS = -15;
+
+	// Room for the sync flush marker and whatever a level switch flushes
+	constexpr size_t FLUSH_MARGIN = 16;
+
+	std::atomic<uint64_t> compressedCount = 0;
+	std::atomic<uint64_t> skippedCount = 0;
+	std::atomic<uint64_t> bytesIn = 0;
+	std::atomic<uint64_t> bytesOut = 0;
+	std::atomic<uint64_t> nanoseconds = 0;
+
+	struct StreamDeleter {
+		void operator()(z_stream* stream) const {
+			deflateEnd(stream);
+			delete stream;
+		}
+	};
+
+	using Stream = std::unique_ptr<z_stream, StreamDeleter>;
+
+	Stream createStream(int32_t level, int32_t memLevel) {
+		auto stream = std::make_unique<z_stream>();
+		if (deflateInit2(stream.get(), level, Z_DEFLATED, WINDOW_BITS, memLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+			g_logger().error("[Compressor] - Zlib deflateInit2 error: {}", stream->msg ? stream->msg : "unknown error");
+			return nullptr;
+		}
+		return Stream(stream.release());
+	}
+
+	// Switches the level between messages, anything it flushes goes to the output first
+	void setLevel(z_stream &stream, int32_t &currentLevel, int32_t level, std::span<uint8_t> output) {
+		stream.next_in = nullptr;
+		stream.avail_in = 0;
+		stream.next_out = output.data();
+		stream.avail_out = static_cast<uInt>(output.size());
+		if (level != currentLevel && deflateParams(&stream, level, Z_DEFAULT_STRATEGY) == Z_OK) {
+			currentLevel = level;
+		}
+	}
+
+	class ZlibCompressor final : public Compressor {
+	public:
+		explicit ZlibCompressor(const CompressionSettings &settings) :
+			Compressor(settings) { }
+
+	protected:
+		size_t deflate(const uint8_t* data, size_t size, int32_t level, std::span<uint8_t> output) override {
+			// Deflate state is large, threads share one among their connections
+			static thread_local Stream stream = createStream(Z_DEFAULT_COMPRESSION, 9);
+			static thread_local int32_t streamLevel = Z_DEFAULT_COMPRESSION;
+			if (!stream) {
+				return 0;
+			}
+
+			setLevel(*stream, streamLevel, level, output);
+			stream->next_in = const_cast<Bytef*>(data);
+			stream->avail_in = static_cast<uInt>(size);
+
+			const auto ret = ::deflate(stream.get(), Z_FINISH);
+			const auto totalSize = output.size() - stream->avail_out;
+			deflateReset(stream.get());
+			return ret == Z_STREAM_END ? totalSize : 0;
+		}
+
+		bool keepsWindow() const override {
+			return false;
+		}
+	};
+
+	class ZlibStreamCompressor final : public Compressor {
+	public:
+		ZlibStreamCompressor(const CompressionSettings &settings, Stream initStream) :
+			Compressor(settings), stream(std::move(initStream)), level(settings.level) { }
+
+	protected:
+		size_t deflate(const uint8_t* data, size_t size, int32_t newLevel, std::span<uint8_t> output) override {
+			setLevel(*stream, level, newLevel, output);
+			stream->next_in = const_cast<Bytef*>(data);
+			stream->avail_in = static_cast<uInt>(size);
+
+			// The sync flush ends the message on a byte boundary without closing the stream
+			if (::deflate(stream.get(), Z_SYNC_FLUSH) != Z_OK || stream->avail_in != 0 || stream->avail_out == 0) {
+				return 0;
+			}
+			return output.size() - stream->avail_out;
+		}
+
+		bool keepsWindow() const override {
+			return true;
+		}
+
+	private:
+		Stream stream;
+		int32_t level;
+	};
+}
+
+CompressionSettings CompressionSettings::fromConfig() {
+	CompressionSettings settings;
+	if (g_configManager().getString(COMPRESSION_BACKEND) == "zlib-stream") {
+		settings.backend = CompressionBackend::ZlibStream;
+	}
+	settings.level = std::min<int32_t>(g_configManager().getNumber(COMPRESSION_LEVEL), Z_BEST_COMPRESSION);
+	settings.bulkSize = std::max<int32_t>(0, g_configManager().getNumber(COMPRESSION_BULK_SIZE));
+	settings.bulkLevel = std::clamp<int32_t>(g_configManager().getNumber(COMPRESSION_BULK_LEVEL), Z_BEST_SPEED, Z_BEST_COMPRESSION);
+	settings.minSize = std::max<int32_t>(0, g_configManager().getNumber(COMPRESSION_MIN_SIZE));
+	return settings;
+}
+
+std::unique_ptr<Compressor> Compressor::create(const CompressionSettings &settings) {
+	if (settings.backend == CompressionBackend::ZlibStream && settings.level > 0) {
+		// Half the default hash memory, as every connection keeps its own
+		if (auto stream = createStream(settings.level, 8)) {
+			return std::make_unique<ZlibStreamCompressor>(settings, std::move(stream));
+		}
+	}
+	return std::make_unique<ZlibCompressor>(settings);
+}
+
+Compressor::Compressor(const CompressionSettings &settings) :
+	settings(settings) { }
+
+bool Compressor::compress(OutputMessage &msg) {
+	const size_t size = msg.getLength();
+	if (failed || settings.level <= 0 || size < settings.minSize) {
+		return false;
+	}
+
+	if (size > NETWORKMESSAGE_MAXSIZE) {
+		g_logger().error("[Compressor::compress] - Exceded NetworkMessage max size: {}, actually size: {}", NETWORKMESSAGE_MAXSIZE, size);
+		return false;
+	}
+
+	static thread_local std::vector<uint8_t> output;
+	output.resize(compressBound(static_cast<uLong>(size)) + FLUSH_MARGIN);
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto level = size >= settings.bulkSize ? settings.bulkLevel : settings.level;
+	const auto compressedSize = deflate(msg.getOutputBuffer(), size, level, output);
+	nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+	bytesIn.fetch_add(size, std::memory_order_relaxed);
+
+	const bool fits = compressedSize > 0 && compressedSize + NetworkMessage::INITIAL_BUFFER_POSITION < MAX_BODY_LENGTH;
+	if (keepsWindow() && !fits) {
+		g_logger().error("[Compressor::compress] - Deflate window lost, compression disabled for the connection");
+		failed = true;
+	}
+
+	if (!fits || (!keepsWindow() && compressedSize >= size)) {
+		skippedCount.fetch_add(1, std::memory_order_relaxed);
+		bytesOut.fetch_add(size, std::memory_order_relaxed);
+		return false;
+	}
+
+	compressedCount.fetch_add(1, std::memory_order_relaxed);
+	bytesOut.fetch_add(compressedSize, std::memory_order_relaxed);
+
+	msg.reset();
+	msg.addBytes(reinterpret_cast<const char*>(output.data()), compressedSize);
+	return true;
+}
+
+CompressionStats Compressor::getStats() {
+	return {
+		.compressed = compressedCount.load(std::memory_order_relaxed),
+		.skipped = skippedCount.load(std::memory_order_relaxed),
+		.bytesIn = bytesIn.load(std::memory_order_relaxed),
+		.bytesOut = bytesOut.load(std::memory_order_relaxed),
+		.nanoseconds = nanoseconds.load(std::memory_order_relaxed),
+	};
+}
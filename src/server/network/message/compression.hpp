@@ -0,0 +1,92 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+class OutputMessage;
+
+enum class CompressionBackend : uint8_t {
+	// Every message deflated on its own, with a stream shared by the thread
+	Zlib,
+	// One deflate window per connection, kept across its messages
+	ZlibStream,
+};
+
+struct CompressionSettings {
+	CompressionBackend backend = CompressionBackend::Zlib;
+	// zlib level of regular messages, 0 disables compression
+	int32_t level = 6;
+	// Messages from this size on, such as the map description on login or
+	// teleport, use their own level
+	size_t bulkSize = 4096;
+	int32_t bulkLevel = 6;
+	// Smaller messages are sent as they are
+	size_t minSize = 128;
+
+	static CompressionSettings fromConfig();
+};
+
+struct CompressionStats {
+	uint64_t compressed = 0;
+	// Messages sent as they are since deflating did not shrink them
+	uint64_t skipped = 0;
+	uint64_t bytesIn = 0;
+	uint64_t bytesOut = 0;
+	uint64_t nanoseconds = 0;
+};
+
+/**
+ * Deflates the outgoing messages of one connection.
+ *
+ * A compressed message keeps nothing but the raw deflate stream, the caller
+ * flags it in its checksum header.
+ */
+class Compressor {
+public:
+	virtual ~Compressor() = default;
+
+	// non-copyable
+	Compressor(const Compressor &) = delete;
+	Compressor &operator=(const Compressor &) = delete;
+
+	/**
+	 * \returns A compressor for the backend of the settings, the per message
+	 * one if the stream cannot be set up.
+	 */
+	static std::unique_ptr<Compressor> create(const CompressionSettings &settings);
+
+	/**
+	 * Replaces the message with its compressed bytes.
+	 * \returns false if the message is left as it is, to be sent uncompressed.
+	 */
+	bool compress(OutputMessage &msg);
+
+	/**
+	 * \returns Counters of every message given to a compressor so far.
+	 */
+	static CompressionStats getStats();
+
+protected:
+	explicit Compressor(const CompressionSettings &settings);
+
+	/**
+	 * Deflates the data into output, large enough for any outcome.
+	 * \returns The compressed size, 0 if it failed.
+	 */
+	virtual size_t deflate(const uint8_t* data, size_t size, int32_t level, std::span<uint8_t> output) = 0;
+
+	// Whether the client's inflate window already holds the data once deflated,
+	// such messages can only be sent compressed
+	virtual bool keepsWindow() const = 0;
+
+private:
+	const CompressionSettings settings;
+	// A message the client will not see went through the window
+	bool failed = false;
+};
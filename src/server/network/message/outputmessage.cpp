@@ -30,6 +30,7 @@ void OutputMessagePool::scheduleSendAll() {
 void OutputMessagePool::sendAll() {
 	// dispatcher thread
 	for (const auto &protocol : bufferedProtocols) {
+		protocol->flushPendingUpdates();
 		auto &msg = protocol->getCurrentBuffer();
 		if (msg) {
 			protocol->send(std::move(msg));
@@ -13,6 +13,7 @@
 #include "server/network/connection/connection.hpp"
 #include "server/network/message/outputmessage.hpp"
 #include "security/rsa.hpp"
+#include "security/xtea.hpp"
 #include "game/scheduling/dispatcher.hpp"
 #include "utils/tools.hpp"
 
@@ -21,7 +22,7 @@ Protocol::Protocol(const Connection_ptr &initConnection) :
 
 void Protocol::onSendMessage(const OutputMessage_ptr &msg) {
 	if (!rawMessages) {
-		const uint32_t sendMessageChecksum = msg->getLength() >= 128 && compression(*msg) ? (1U << 31) : 0;
+		const uint32_t sendMessageChecksum = compression(*msg) ? (1U << 31) : 0;
 
 		if (!encryptionEnabled) {
 			msg->writeMessageLength();
@@ -126,66 +127,6 @@ void Protocol::disconnect() const {
 	}
 }
 
-void Protocol::XTEA_transform(uint8_t* buffer, size_t messageLength, bool encrypt) const {
-	constexpr uint32_t delta = 0x61C88647;
-	size_t readPos = 0;
-	const std::array<uint32_t, 4> newKey = key;
-
-	std::array<std::array<uint32_t, 2>, 32> precachedControlSum;
-	uint32_t sum = encrypt ? 0 : 0xC6EF3720;
-
-	// Precompute control sums
-	if (encrypt) {
-		for (size_t i = 0; i < 32; ++i) {
-			precachedControlSum[i][0] = sum + newKey[sum & 3];
-			sum -= delta;
-			precachedControlSum[i][1] = sum + newKey[(sum >> 11) & 3];
-		}
-	} else {
-		for (size_t i = 0; i < 32; ++i) {
-			precachedControlSum[i][0] = sum + newKey[(sum >> 11) & 3];
-			sum += delta;
-			precachedControlSum[i][1] = sum + newKey[sum & 3];
-		}
-	}
-
-	while (readPos < messageLength) {
-		std::array<uint8_t, 8> tempBuffer;
-		std::ranges::copy_n(buffer + readPos, 8, tempBuffer.begin());
-
-		// Convert bytes to uint32_t considering little-endian order
-		std::array<uint8_t, 4> bytes0;
-		std::array<uint8_t, 4> bytes1;
-		std::copy_n(tempBuffer.begin(), 4, bytes0.begin());
-		std::copy_n(tempBuffer.begin() + 4, 4, bytes1.begin());
-
-		uint32_t vData0 = std::bit_cast<uint32_t>(bytes0);
-		uint32_t vData1 = std::bit_cast<uint32_t>(bytes1);
-
-		if (encrypt) {
-			for (size_t i = 0; i < 32; ++i) {
-				vData0 += ((vData1 << 4 ^ vData1 >> 5) + vData1) ^ precachedControlSum[i][0];
-				vData1 += ((vData0 << 4 ^ vData0 >> 5) + vData0) ^ precachedControlSum[i][1];
-			}
-		} else {
-			for (size_t i = 0; i < 32; ++i) {
-				vData1 -= ((vData0 << 4 ^ vData0 >> 5) + vData0) ^ precachedControlSum[i][0];
-				vData0 -= ((vData1 << 4 ^ vData1 >> 5) + vData1) ^ precachedControlSum[i][1];
-			}
-		}
-
-		// Convert vData back to bytes
-		bytes0 = std::bit_cast<std::array<uint8_t, 4>>(vData0);
-		bytes1 = std::bit_cast<std::array<uint8_t, 4>>(vData1);
-
-		// Copy transformed bytes back to buffer
-		std::copy_n(bytes0.begin(), 4, buffer + readPos);
-		std::copy_n(bytes1.begin(), 4, buffer + readPos + 4);
-
-		readPos += 8;
-	}
-}
-
 void Protocol::XTEA_encrypt(OutputMessage &outputMessage) const {
 	// Ensure the message length is a multiple of 8
 	size_t paddingBytes = outputMessage.getLength() % 8;
@@ -196,7 +137,7 @@ void Protocol::XTEA_encrypt(OutputMessage &outputMessage) const {
 	uint8_t* buffer = outputMessage.getOutputBuffer();
 	size_t messageLength = outputMessage.getLength();
 
-	XTEA_transform(buffer, messageLength, true);
+	XTEA::encrypt(buffer, messageLength, key);
 }
 
 bool Protocol::XTEA_decrypt(NetworkMessage &msg) const {
@@ -213,7 +154,7 @@ bool Protocol::XTEA_decrypt(NetworkMessage &msg) const {
 
 	size_t messageLength = msgLength;
 
-	XTEA_transform(buffer, messageLength, false);
+	XTEA::decrypt(buffer, messageLength, key);
 
 	uint8_t paddingSize = msg.getByte();
 	uint16_t innerLength = messageLength - paddingSize;
@@ -253,60 +194,14 @@ uint32_t Protocol::getIP() const {
 	return 0;
 }
 
-bool Protocol::compression(OutputMessage &outputMessage) const {
+bool Protocol::compression(OutputMessage &outputMessage) {
 	if (checksumMethod != CHECKSUM_METHOD_SEQUENCE) {
 		return false;
 	}
 
-	static thread_local auto compress_ptr = std::make_unique<ZStream>();
-	static const auto &compress = compress_ptr;
-
-	if (!compress->stream) {
-		return false;
-	}
-
-	const auto outputMessageSize = outputMessage.getLength();
-	if (outputMessageSize > NETWORKMESSAGE_MAXSIZE) {
-		g_logger().error("[NetworkMessage::compression] - Exceded NetworkMessage max size: {}, actually size: {}", NETWORKMESSAGE_MAXSIZE, outputMessageSize);
-		return false;
-	}
-
-	compress->stream->next_in = outputMessage.getOutputBuffer();
-	compress->stream->avail_in = outputMessageSize;
-	compress->stream->next_out = reinterpret_cast<Bytef*>(compress->buffer.data());
-	compress->stream->avail_out = NETWORKMESSAGE_MAXSIZE;
-
-	const int32_t ret = deflate(compress->stream.get(), Z_FINISH);
-	if (ret != Z_OK && ret != Z_STREAM_END) {
-		return false;
-	}
-
-	const auto totalSize = compress->stream->total_out;
-	deflateReset(compress->stream.get());
-
-	if (totalSize == 0) {
-		return false;
-	}
-
-	outputMessage.reset();
-	outputMessage.addBytes(compress->buffer.data(), totalSize);
-
-	return true;
-}
-
-Protocol::ZStream::ZStream() noexcept {
-	const int32_t compressionLevel = g_configManager().getNumber(COMPRESSION_LEVEL);
-	if (compressionLevel <= 0) {
-		return;
+	if (!compressor) {
+		compressor = Compressor::create(CompressionSettings::fromConfig());
 	}
 
-	stream = std::make_unique<z_stream>();
-	stream->zalloc = nullptr;
-	stream->zfree = nullptr;
-	stream->opaque = nullptr;
-
-	if (deflateInit2(stream.get(), compressionLevel, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
-		stream.reset();
-		g_logger().error("[Protocol::enableCompression()] - Zlib deflateInit2 error: {}", (stream->msg ? stream->msg : " unknown error"));
-	}
+	return compressor->compress(outputMessage);
 }
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "server/network/message/compression.hpp"
 #include "server/server_definitions.hpp"
 
 class OutputMessage;
@@ -36,6 +37,8 @@ public:
 	bool sendRecvMessageCallback(NetworkMessage &msg);
 	virtual void onRecvFirstMessage(NetworkMessage &msg) = 0;
 	virtual void sendLoginChallenge() { }
+	// Writes updates held back during the dispatcher cycle, right before the output buffer is sent
+	virtual void flushPendingUpdates() { }
 
 	bool isConnectionExpired() const;
 
@@ -75,23 +78,13 @@ protected:
 	virtual void release() { }
 
 private:
-	struct ZStream {
-		ZStream() noexcept;
-
-		~ZStream() {
-			deflateEnd(stream.get());
-		}
-
-		std::unique_ptr<z_stream> stream;
-		std::array<char, NETWORKMESSAGE_MAXSIZE> buffer {};
-	};
-
-	void XTEA_transform(uint8_t* buffer, size_t messageLength, bool encrypt) const;
 	void XTEA_encrypt(OutputMessage &msg) const;
 	bool XTEA_decrypt(NetworkMessage &msg) const;
-	bool compression(OutputMessage &msg) const;
+	bool compression(OutputMessage &msg);
 
 	OutputMessage_ptr outputBuffer;
+	// Created on the first message worth compressing
+	std::unique_ptr<Compressor> compressor;
 
 	const ConnectionWeak_ptr connectionPtr;
 	std::array<uint32_t, 4> key = {};
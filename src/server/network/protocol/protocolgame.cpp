@@ -40,8 +40,10 @@
 #include "io/ioprey.hpp"
 #include "items/items_classification.hpp"
 #include "items/weapons/weapons.hpp"
+#include "lib/metrics/metrics.hpp"
 #include "lua/creature/creatureevent.hpp"
 #include "lua/modules/modules.hpp"
+#include "server/network/message/broadcastmessage.hpp"
 #include "server/network/message/outputmessage.hpp"
 #include "utils/tools.hpp"
 #include "creatures/players/vocations/vocation.hpp"
@@ -524,9 +526,70 @@ void ProtocolGame::release() {
 	}
 
 	OutputMessagePool::getInstance().removeProtocolFromAutosend(shared_from_this());
+	pendingCreatureUpdates.clear();
+	pendingCreatureUpdateIndex.clear();
 	Protocol::release();
 }
 
+ProtocolGame::PendingCreatureUpdate* ProtocolGame::queueCreatureUpdate(const std::shared_ptr<Creature> &creature, CreatureUpdate_t field) {
+	// Updates written by the flush itself, or from outside the dispatcher, go out right away
+	if (flushingCreatureUpdates || !player || g_dispatcher().context().isAsync() || !g_configManager().getBoolean(COALESCE_CREATURE_UPDATES)) {
+		return nullptr;
+	}
+
+	const auto [it, inserted] = pendingCreatureUpdateIndex.try_emplace(creature->getID(), pendingCreatureUpdates.size());
+	if (inserted) {
+		pendingCreatureUpdates.emplace_back().creature = creature;
+	}
+
+	auto &update = pendingCreatureUpdates[it->second];
+	update.fields |= field;
+	return &update;
+}
+
+void ProtocolGame::flushPendingUpdates() {
+	// dispatcher thread
+	if (pendingCreatureUpdates.empty()) {
+		return;
+	}
+
+	flushingCreatureUpdates = true;
+	for (const auto &update : pendingCreatureUpdates) {
+		const auto &creature = update.creature;
+		// The client may have dropped the creature since it changed, it can't update unknown ones
+		if (!player || !knownCreatureSet.contains(creature->getID())) {
+			continue;
+		}
+
+		// The checks of each packet run again, the creature may have gone out of sight meanwhile
+		if (update.fields & CREATURE_UPDATE_HEALTH) {
+			sendCreatureHealth(creature);
+		}
+		if (update.fields & CREATURE_UPDATE_SPEED) {
+			sendChangeSpeed(creature, update.speed);
+		}
+		if (update.fields & CREATURE_UPDATE_LIGHT) {
+			sendCreatureLight(creature);
+		}
+		if (update.fields & CREATURE_UPDATE_SKULL) {
+			sendCreatureSkull(creature);
+		}
+		if (update.fields & CREATURE_UPDATE_ICONS) {
+			sendCreatureIcon(creature);
+		}
+		if (update.fields & CREATURE_UPDATE_OUTFIT) {
+			sendCreatureOutfit(creature, update.outfit);
+		}
+		if (update.fields & CREATURE_UPDATE_SQUARE) {
+			sendCreatureSquare(creature, update.squareColor);
+		}
+	}
+	flushingCreatureUpdates = false;
+
+	pendingCreatureUpdates.clear();
+	pendingCreatureUpdateIndex.clear();
+}
+
 void ProtocolGame::login(const std::string &name, uint32_t accountId, OperatingSystem_t operatingSystem) {
 	// OTCV8 features
 	if (otclientV8 > 0) {
@@ -967,7 +1030,7 @@ void ProtocolGame::disconnectClient(const std::string &message) const {
 	disconnect();
 }
 
-void ProtocolGame::writeToOutputBuffer(NetworkMessage &msg) {
+void ProtocolGame::writeToOutputBuffer(const NetworkMessage &msg) {
 	if (g_dispatcher().context().isAsync()) {
 		g_dispatcher().addEvent([self = getThis(), msg] {
 			self->getOutputBuffer(msg.getLength())->append(msg);
@@ -978,6 +1041,13 @@ void ProtocolGame::writeToOutputBuffer(NetworkMessage &msg) {
 	}
 }
 
+void ProtocolGame::sendBroadcast(BroadcastMessage &message, uint8_t variant /* = 0*/) {
+	const auto &msg = message.get(oldProtocol, variant);
+	if (msg.getLength() > 0) {
+		writeToOutputBuffer(msg);
+	}
+}
+
 void ProtocolGame::parsePacket(NetworkMessage &msg) {
 	if (!acceptPackets || g_game().getGameState() == GAME_STATE_SHUTDOWN || msg.getLength() <= 0) {
 		return;
@@ -1064,6 +1134,15 @@ void ProtocolGame::parsePacketFromDispatcher(NetworkMessage &msg, uint8_t recvby
 		return;
 	}
 
+	static const auto opcodeNames = [] {
+		std::array<std::string, 256> names;
+		for (size_t opcode = 0; opcode < names.size(); ++opcode) {
+			names[opcode] = fmt::format("0x{:02X}", opcode);
+		}
+		return names;
+	}();
+	metrics::packet_latency measure(opcodeNames[recvbyte]);
+
 	switch (recvbyte) {
 		case 0x14:
 			logout(true, false);
@@ -1474,6 +1553,29 @@ void ProtocolGame::GetTileDescription(const std::shared_ptr<Tile> &tile, Network
 		msg.add<uint16_t>(0x00); // Env effects
 	}
 
+	// The player's own tile keeps a slot for the player, it is always written item by item
+	if (tile->getPosition() != player->getPosition()) {
+		if (const auto* cachedItems = getCachedTileItems(tile)) {
+			const auto addCachedItems = [&msg, cachedItems](size_t first, size_t last) {
+				const size_t begin = first == 0 ? 0 : cachedItems->ends[first - 1];
+				const size_t end = last == 0 ? 0 : cachedItems->ends[last - 1];
+				if (end > begin) {
+					msg.addBytes(reinterpret_cast<const char*>(cachedItems->bytes.data() + begin), end - begin);
+				}
+			};
+
+			int32_t count = cachedItems->topCount;
+			addCachedItems(0, count);
+			if (count == 10 || !AddTileCreatures(tile, msg, count)) {
+				return;
+			}
+
+			const auto last = std::min<size_t>(cachedItems->ends.size(), cachedItems->topCount + (10 - count));
+			addCachedItems(cachedItems->topCount, last);
+			return;
+		}
+	}
+
 	int32_t count;
 	std::shared_ptr<Item> ground = tile->getGround();
 	if (ground) {
@@ -1497,42 +1599,105 @@ void ProtocolGame::GetTileDescription(const std::shared_ptr<Tile> &tile, Network
 		}
 	}
 
-	const CreatureVector* creatures = tile->getCreatures();
-	if (creatures) {
-		bool playerAdded = false;
-		for (auto creature : std::ranges::reverse_view(*creatures)) {
-			if (!player->canSeeCreature(creature)) {
-				continue;
-			}
-
-			if (tile->getPosition() == player->getPosition() && count == 9 && !playerAdded) {
-				creature = player;
-			}
-
-			if (creature->getID() == player->getID()) {
-				playerAdded = true;
-			}
+	if (!AddTileCreatures(tile, msg, count)) {
+		return;
+	}
 
-			bool known;
-			uint32_t removedKnown;
-			checkCreatureAsKnown(creature->getID(), known, removedKnown);
-			AddCreature(msg, creature, known, removedKnown);
+	if (items) {
+		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
+			AddItem(msg, *it);
 
 			if (++count == 10) {
 				return;
 			}
 		}
 	}
+}
+
+bool ProtocolGame::AddTileCreatures(const std::shared_ptr<Tile> &tile, NetworkMessage &msg, int32_t &count) {
+	const CreatureVector* creatures = tile->getCreatures();
+	if (!creatures) {
+		return true;
+	}
+
+	bool playerAdded = false;
+	for (auto creature : std::ranges::reverse_view(*creatures)) {
+		if (!player->canSeeCreature(creature)) {
+			continue;
+		}
+
+		if (tile->getPosition() == player->getPosition() && count == 9 && !playerAdded) {
+			creature = player;
+		}
+
+		if (creature->getID() == player->getID()) {
+			playerAdded = true;
+		}
 
+		bool known;
+		uint32_t removedKnown;
+		checkCreatureAsKnown(creature->getID(), known, removedKnown);
+		AddCreature(msg, creature, known, removedKnown);
+
+		if (++count == 10) {
+			return false;
+		}
+	}
+	return true;
+}
+
+const TileDescriptionCache::Variant* ProtocolGame::getCachedTileItems(const std::shared_ptr<Tile> &tile) {
+	auto &cache = tile->getDescriptionCache();
+	if (!cache) {
+		cache = std::make_shared<TileDescriptionCache>();
+	}
+
+	auto &variant = cache->variants[(oldProtocol ? 1 : 0) | (isOTCR ? 2 : 0)];
+	if (variant.built && variant.version == tile->getItemVersion()) {
+		return variant.dynamic ? nullptr : &variant;
+	}
+
+	variant = {};
+	variant.version = tile->getItemVersion();
+	variant.built = true;
+
+	// Items of tiles on the map are written the same way for every player
+	static thread_local NetworkMessage itemsMsg;
+	itemsMsg.reset();
+
+	const auto addItem = [this, &variant](const std::shared_ptr<Item> &item) {
+		const ItemType &it = Item::items[item->getID()];
+		variant.dynamic |= it.expire || it.expireStop || it.clockExpire;
+		AddItem(itemsMsg, item);
+		variant.ends.emplace_back(itemsMsg.getLength());
+	};
+
+	if (const auto &ground = tile->getGround()) {
+		addItem(ground);
+	}
+
+	const TileItemVector* items = tile->getItemList();
 	if (items) {
-		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
-			AddItem(msg, *it);
+		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end && variant.ends.size() < 10; ++it) {
+			addItem(*it);
+		}
+	}
+	variant.topCount = static_cast<uint8_t>(variant.ends.size());
 
-			if (++count == 10) {
-				return;
-			}
+	if (items && variant.topCount < 10) {
+		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end && variant.ends.size() < 10; ++it) {
+			addItem(*it);
 		}
 	}
+
+	if (variant.dynamic) {
+		variant.ends.clear();
+		return nullptr;
+	}
+
+	const auto* bytes = itemsMsg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+	variant.bytes.assign(bytes, bytes + itemsMsg.getLength());
+	return &variant;
 }
 
 void ProtocolGame::GetMapDescription(int32_t x, int32_t y, int32_t z, int32_t width, int32_t height, NetworkMessage &msg) {
@@ -1583,45 +1748,19 @@ void ProtocolGame::GetFloorDescription(NetworkMessage &msg, int32_t x, int32_t y
 }
 
 void ProtocolGame::checkCreatureAsKnown(uint32_t id, bool &known, uint32_t &removedKnown) {
-	if (auto [creatureKnown, creatureInserted] = knownCreatureSet.insert(id);
-	    !creatureInserted) {
-		known = true;
-		return;
-	}
-	known = false;
-	if (knownCreatureSet.size() > 1300) {
-		// Look for a creature to remove
-		for (auto it = knownCreatureSet.begin(), end = knownCreatureSet.end(); it != end; ++it) {
-			if (*it == id) {
-				continue;
-			}
-			// We need to protect party players from removing
-			const auto &creature = g_game().getCreatureByID(*it);
-			const auto &checkPlayer = creature ? creature->getPlayer() : nullptr;
-			if (checkPlayer) {
-				if (player->getParty() != checkPlayer->getParty() && !canSee(creature)) {
-					removedKnown = *it;
-					knownCreatureSet.erase(it);
-					return;
-				}
-			} else if (!canSee(creature)) {
-				removedKnown = *it;
-				knownCreatureSet.erase(it);
-				return;
-			}
+	using Eviction = decltype(knownCreatureSet)::Eviction;
+	const auto [inserted, evicted] = knownCreatureSet.insert(id, [this](uint32_t knownId) {
+		const auto &creature = g_game().getCreatureByID(knownId);
+		// We need to protect party players from removing
+		const auto &checkPlayer = creature ? creature->getPlayer() : nullptr;
+		if (checkPlayer && player->getParty() && player->getParty() == checkPlayer->getParty()) {
+			return Eviction::KEEP;
 		}
+		return canSee(creature) ? Eviction::FALLBACK : Eviction::ALLOW;
+	});
 
-		// Bad situation. Let's just remove anyone.
-		auto it = knownCreatureSet.begin();
-		if (*it == id) {
-			++it;
-		}
-
-		removedKnown = *it;
-		knownCreatureSet.erase(it);
-	} else {
-		removedKnown = 0;
-	}
+	known = !inserted;
+	removedKnown = evicted.value_or(0);
 }
 
 bool ProtocolGame::canSee(const std::shared_ptr<Creature> &c) const {
@@ -3368,6 +3507,11 @@ void ProtocolGame::sendCreatureOutfit(const std::shared_ptr<Creature> &creature,
 		return;
 	}
 
+	if (auto* pending = queueCreatureUpdate(creature, CREATURE_UPDATE_OUTFIT)) {
+		pending->outfit = outfit;
+		return;
+	}
+
 	Outfit_t newOutfit = outfit;
 	if (player->isWearingSupportOutfit()) {
 		player->setCurrentMount(0);
@@ -3383,7 +3527,7 @@ void ProtocolGame::sendCreatureOutfit(const std::shared_ptr<Creature> &creature,
 }
 
 void ProtocolGame::sendCreatureLight(const std::shared_ptr<Creature> &creature) {
-	if (!canSee(creature)) {
+	if (!canSee(creature) || queueCreatureUpdate(creature, CREATURE_UPDATE_LIGHT)) {
 		return;
 	}
 
@@ -3410,7 +3554,7 @@ void ProtocolGame::addCreatureIcon(NetworkMessage &msg, const std::shared_ptr<Cr
 }
 
 void ProtocolGame::sendCreatureIcon(const std::shared_ptr<Creature> &creature) {
-	if (!creature || !player || oldProtocol) {
+	if (!creature || !player || oldProtocol || queueCreatureUpdate(creature, CREATURE_UPDATE_ICONS)) {
 		return;
 	}
 
@@ -3492,7 +3636,7 @@ void ProtocolGame::sendCreatureSkull(const std::shared_ptr<Creature> &creature)
 		return;
 	}
 
-	if (!canSee(creature)) {
+	if (!canSee(creature) || queueCreatureUpdate(creature, CREATURE_UPDATE_SKULL)) {
 		return;
 	}
 
@@ -3528,6 +3672,11 @@ void ProtocolGame::sendCreatureSquare(const std::shared_ptr<Creature> &creature,
 		return;
 	}
 
+	if (auto* pending = queueCreatureUpdate(creature, CREATURE_UPDATE_SQUARE)) {
+		pending->squareColor = color;
+		return;
+	}
+
 	NetworkMessage msg;
 	msg.addByte(0x93);
 	msg.add<uint32_t>(creature->getID());
@@ -6513,8 +6662,7 @@ void ProtocolGame::sendCreatureTurn(const std::shared_ptr<Creature> &creature, u
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos /* = nullptr*/) {
-	NetworkMessage msg;
+void ProtocolGame::AddCreatureSay(NetworkMessage &msg, const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position &pos, bool oldProtocol) {
 	msg.addByte(0xAA);
 
 	static uint32_t statementId = 0;
@@ -6539,13 +6687,13 @@ void ProtocolGame::sendCreatureSay(const std::shared_ptr<Creature> &creature, Sp
 		msg.addByte(type);
 	}
 
-	if (pos) {
-		msg.addPosition(*pos);
-	} else {
-		msg.addPosition(creature->getPosition());
-	}
-
+	msg.addPosition(pos);
 	msg.addString(text);
+}
+
+void ProtocolGame::sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos /* = nullptr*/) {
+	NetworkMessage msg;
+	AddCreatureSay(msg, creature, type, text, pos ? *pos : creature->getPosition(), oldProtocol);
 	writeToOutputBuffer(msg);
 }
 
@@ -6627,6 +6775,11 @@ void ProtocolGame::sendCancelTarget() {
 }
 
 void ProtocolGame::sendChangeSpeed(const std::shared_ptr<Creature> &creature, uint16_t speed) {
+	if (auto* pending = queueCreatureUpdate(creature, CREATURE_UPDATE_SPEED)) {
+		pending->speed = speed;
+		return;
+	}
+
 	NetworkMessage msg;
 	msg.addByte(0x8F);
 	msg.add<uint32_t>(creature->getID());
@@ -6664,11 +6817,10 @@ void ProtocolGame::sendPingBack() {
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendDistanceShoot(const Position &from, const Position &to, uint16_t type) {
+void ProtocolGame::AddDistanceShoot(NetworkMessage &msg, const Position &from, const Position &to, uint16_t type, bool oldProtocol) {
 	if (oldProtocol && type > 0xFF) {
 		return;
 	}
-	NetworkMessage msg;
 	if (oldProtocol) {
 		msg.addByte(0x85);
 		msg.addPosition(from);
@@ -6683,6 +6835,14 @@ void ProtocolGame::sendDistanceShoot(const Position &from, const Position &to, u
 		msg.addByte(static_cast<uint8_t>(static_cast<int8_t>(static_cast<int32_t>(to.y) - static_cast<int32_t>(from.y))));
 		msg.addByte(MAGIC_EFFECTS_END_LOOP);
 	}
+}
+
+void ProtocolGame::sendDistanceShoot(const Position &from, const Position &to, uint16_t type) {
+	if (oldProtocol && type > 0xFF) {
+		return;
+	}
+	NetworkMessage msg;
+	AddDistanceShoot(msg, from, to, type, oldProtocol);
 	writeToOutputBuffer(msg);
 }
 
@@ -6731,12 +6891,10 @@ void ProtocolGame::sendRestingStatus(uint8_t protection) {
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendMagicEffect(const Position &pos, uint16_t type) {
-	if (!canSee(pos) || (oldProtocol && type > 0xFF)) {
+void ProtocolGame::AddMagicEffect(NetworkMessage &msg, const Position &pos, uint16_t type, bool oldProtocol) {
+	if (oldProtocol && type > 0xFF) {
 		return;
 	}
-
-	NetworkMessage msg;
 	if (oldProtocol) {
 		msg.addByte(0x83);
 		msg.addPosition(pos);
@@ -6748,6 +6906,15 @@ void ProtocolGame::sendMagicEffect(const Position &pos, uint16_t type) {
 		msg.add<uint16_t>(type);
 		msg.addByte(MAGIC_EFFECTS_END_LOOP);
 	}
+}
+
+void ProtocolGame::sendMagicEffect(const Position &pos, uint16_t type) {
+	if (!canSee(pos) || (oldProtocol && type > 0xFF)) {
+		return;
+	}
+
+	NetworkMessage msg;
+	AddMagicEffect(msg, pos, type, oldProtocol);
 	writeToOutputBuffer(msg);
 }
 
@@ -6766,20 +6933,23 @@ void ProtocolGame::removeMagicEffect(const Position &pos, uint16_t type) {
 	writeToOutputBuffer(msg);
 }
 
-void ProtocolGame::sendCreatureHealth(const std::shared_ptr<Creature> &creature) {
+void ProtocolGame::AddCreatureHealth(NetworkMessage &msg, const std::shared_ptr<Creature> &creature) {
 	if (creature->isHealthHidden()) {
 		return;
 	}
 
-	NetworkMessage msg;
 	msg.addByte(0x8C);
 	msg.add<uint32_t>(creature->getID());
-	if (creature->isHealthHidden()) {
-		msg.addByte(0x00);
-	} else {
-		msg.addByte(static_cast<uint8_t>(std::min<double>(100, std::ceil((static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100))));
+	msg.addByte(static_cast<uint8_t>(std::min<double>(100, std::ceil((static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100))));
+}
+
+void ProtocolGame::sendCreatureHealth(const std::shared_ptr<Creature> &creature) {
+	if (creature->isHealthHidden() || queueCreatureUpdate(creature, CREATURE_UPDATE_HEALTH)) {
+		return;
 	}
 
+	NetworkMessage msg;
+	AddCreatureHealth(msg, creature);
 	writeToOutputBuffer(msg);
 }
 
@@ -7201,7 +7371,14 @@ void ProtocolGame::sendAddCreature(const std::shared_ptr<Creature> &creature, co
 	}
 }
 
-void ProtocolGame::sendMoveCreature(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport) {
+void ProtocolGame::AddCreatureStep(NetworkMessage &msg, const Position &oldPos, uint8_t oldStackPos, const Position &newPos) {
+	msg.addByte(0x6D);
+	msg.addPosition(oldPos);
+	msg.addByte(oldStackPos);
+	msg.addPosition(newPos);
+}
+
+void ProtocolGame::sendMoveCreature(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport, BroadcastMessage* step /* = nullptr*/) {
 	if (creature == player) {
 		if (oldStackPos >= 10) {
 			sendMapDescription(newPos);
@@ -7248,12 +7425,11 @@ void ProtocolGame::sendMoveCreature(const std::shared_ptr<Creature> &creature, c
 		if (teleport || (oldPos.z == MAP_INIT_SURFACE_LAYER && newPos.z >= MAP_INIT_SURFACE_LAYER + 1) || oldStackPos >= 10) {
 			sendRemoveTileThing(oldPos, oldStackPos);
 			sendAddCreature(creature, newPos, newStackPos, false);
+		} else if (step) {
+			sendBroadcast(*step, static_cast<uint8_t>(oldStackPos));
 		} else {
 			NetworkMessage msg;
-			msg.addByte(0x6D);
-			msg.addPosition(oldPos);
-			msg.addByte(static_cast<uint8_t>(oldStackPos));
-			msg.addPosition(newPos);
+			AddCreatureStep(msg, oldPos, static_cast<uint8_t>(oldStackPos), newPos);
 			writeToOutputBuffer(msg);
 		}
 	} else if (canSee(oldPos)) {
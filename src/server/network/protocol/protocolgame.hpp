@@ -9,8 +9,11 @@
 
 #pragma once
 
+#include "creatures/creatures_definitions.hpp"
 #include "server/network/protocol/protocol.hpp"
+#include "server/network/protocol/tiledescriptioncache.hpp"
 #include "game/movement/position.hpp"
+#include "utils/lru_set.hpp"
 #include "utils/utils_definitions.hpp"
 
 enum class PlayerIcon : uint8_t;
@@ -33,6 +36,7 @@ enum class SourceEffect_t : uint8_t;
 enum class HouseAuctionType : uint8_t;
 
 class NetworkMessage;
+class BroadcastMessage;
 class Player;
 class VIPGroup;
 class Game;
@@ -108,6 +112,13 @@ public:
 	void AddItem(NetworkMessage &msg, const std::shared_ptr<Item> &item);
 	void AddItem(NetworkMessage &msg, uint16_t id, uint8_t count, uint8_t tier) const;
 
+	// Packets that are the same for every client of a protocol, encoded once for a BroadcastMessage
+	static void AddMagicEffect(NetworkMessage &msg, const Position &pos, uint16_t type, bool oldProtocol);
+	static void AddDistanceShoot(NetworkMessage &msg, const Position &from, const Position &to, uint16_t type, bool oldProtocol);
+	static void AddCreatureHealth(NetworkMessage &msg, const std::shared_ptr<Creature> &creature);
+	static void AddCreatureSay(NetworkMessage &msg, const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position &pos, bool oldProtocol);
+	static void AddCreatureStep(NetworkMessage &msg, const Position &oldPos, uint8_t oldStackPos, const Position &newPos);
+
 	uint16_t getVersion() const {
 		return version;
 	}
@@ -118,9 +129,11 @@ private:
 	}
 	void connect(const std::string &playerName, OperatingSystem_t operatingSystem);
 	void disconnectClient(const std::string &message) const;
-	void writeToOutputBuffer(NetworkMessage &msg);
+	void writeToOutputBuffer(const NetworkMessage &msg);
+	void sendBroadcast(BroadcastMessage &message, uint8_t variant = 0);
 
 	void release() override;
+	void flushPendingUpdates() override;
 
 	void checkCreatureAsKnown(uint32_t id, bool &known, uint32_t &removedKnown);
 
@@ -435,7 +448,8 @@ private:
 	void sendUpdateTile(const std::shared_ptr<Tile> &tile, const Position &pos);
 
 	void sendAddCreature(const std::shared_ptr<Creature> &creature, const Position &pos, int32_t stackpos, bool isLogin);
-	void sendMoveCreature(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport);
+	// step, when given, holds the plain one step move packet shared by the spectators
+	void sendMoveCreature(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport, BroadcastMessage* step = nullptr);
 
 	// containers
 	void sendAddContainerItem(uint8_t cid, uint16_t slot, const std::shared_ptr<Item> &item);
@@ -468,6 +482,10 @@ private:
 	// Help functions
 	// translate a tile to clientreadable format
 	void GetTileDescription(const std::shared_ptr<Tile> &tile, NetworkMessage &msg);
+	// adds the creatures of a tile, false once the tile is full
+	bool AddTileCreatures(const std::shared_ptr<Tile> &tile, NetworkMessage &msg, int32_t &count);
+	// items of a tile written for this protocol variant, nullptr if they must be written live
+	const TileDescriptionCache::Variant* getCachedTileItems(const std::shared_ptr<Tile> &tile);
 
 	// translate a floor to clientreadable format
 	void GetFloorDescription(NetworkMessage &msg, int32_t x, int32_t y, int32_t z, int32_t width, int32_t height, int32_t offset, int32_t &skip);
@@ -534,8 +552,42 @@ private:
 	friend class PlayerWheel;
 	friend class PlayerVIP;
 	friend class PlayerAttachedEffects;
+	friend struct ProtocolGameTest;
+
+	// Creatures the client holds in its cache, it can't keep more than 1300.
+	// Up to 128 of the oldest ones are checked for one that left the screen, then the first
+	// visible one outside the party is evicted.
+	LRUSet<uint32_t> knownCreatureSet { 1300, 128 };
+
+	// Creature state changes are collected during a dispatcher cycle and sent
+	// once per creature and field when the output buffer is flushed
+	enum CreatureUpdate_t : uint8_t {
+		CREATURE_UPDATE_HEALTH = 1 << 0,
+		CREATURE_UPDATE_SPEED = 1 << 1,
+		CREATURE_UPDATE_LIGHT = 1 << 2,
+		CREATURE_UPDATE_SKULL = 1 << 3,
+		CREATURE_UPDATE_ICONS = 1 << 4,
+		CREATURE_UPDATE_OUTFIT = 1 << 5,
+		CREATURE_UPDATE_SQUARE = 1 << 6,
+	};
+
+	struct PendingCreatureUpdate {
+		std::shared_ptr<Creature> creature;
+		uint8_t fields = 0;
+		uint16_t speed = 0;
+		SquareColor_t squareColor = SQ_COLOR_BLACK;
+		Outfit_t outfit {};
+	};
+
+	/**
+	 * @return The pending update of the creature with the field marked, or nullptr if it must be sent right away.
+	 */
+	PendingCreatureUpdate* queueCreatureUpdate(const std::shared_ptr<Creature> &creature, CreatureUpdate_t field);
+
+	std::vector<PendingCreatureUpdate> pendingCreatureUpdates;
+	phmap::flat_hash_map<uint32_t, size_t> pendingCreatureUpdateIndex;
+	bool flushingCreatureUpdates = false;
 
-	std::unordered_set<uint32_t> knownCreatureSet;
 	std::shared_ptr<Player> player = nullptr;
 
 	uint32_t eventConnect = 0;
@@ -0,0 +1,37 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+/**
+ * Items of a tile as ProtocolGame::GetTileDescription writes them, kept by
+ * the tile for each protocol variant until its item version changes.
+ *
+ * Creatures are not part of it, they are written live between the top and
+ * the down items.
+ */
+struct TileDescriptionCache {
+	// Old protocol and OTCR client combinations
+	static constexpr size_t VARIANTS = 4;
+
+	struct Variant {
+		// Tile item version the bytes were written for
+		uint32_t version = 0;
+		bool built = false;
+		// Items whose bytes change over time, such as decay timers, are written live
+		bool dynamic = false;
+		// Ground and top items first, then down items, at most 10 of each
+		std::vector<uint8_t> bytes;
+		// End of each item within bytes
+		std::vector<uint16_t> ends;
+		uint8_t topCount = 0;
+	};
+
+	std::array<Variant, VARIANTS> variants;
+};
@@ -24,6 +24,29 @@ ServiceManager::~ServiceManager() {
 
 void ServiceManager::die() {
 	io_service.stop();
+	for (const auto &shard : shards) {
+		shard->stop();
+	}
+}
+
+void ServiceManager::createShards() {
+	if (!shards.empty()) {
+		return;
+	}
+
+	const auto count = std::max<int32_t>(1, g_configManager().getNumber(NETWORK_THREADS));
+	for (int32_t i = 1; i < count; ++i) {
+		auto &shard = shards.emplace_back(std::make_unique<asio::io_service>());
+		shardWork.emplace_back(asio::make_work_guard(*shard));
+	}
+}
+
+asio::io_service &ServiceManager::getShard() {
+	createShards();
+
+	// Every socket, its timers and its handlers stay on the shard it was accepted into
+	const auto index = nextShard.fetch_add(1, std::memory_order_relaxed) % (shards.size() + 1);
+	return index == 0 ? io_service : *shards[index - 1];
 }
 
 void ServiceManager::run() {
@@ -34,7 +57,20 @@ void ServiceManager::run() {
 
 	assert(!running);
 	running = true;
+
+	createShards();
+	g_logger().info("Running network with {} thread(s).", shards.size() + 1);
+	for (const auto &shard : shards) {
+		shardThreads.emplace_back([&shard = *shard] { shard.run(); });
+	}
+
 	io_service.run();
+
+	shardWork.clear();
+	for (auto &thread : shardThreads) {
+		thread.join();
+	}
+	shardThreads.clear();
 }
 
 void ServiceManager::stop() {
@@ -87,7 +123,7 @@ void ServicePort::accept() {
 		return;
 	}
 
-	auto connection = ConnectionManager::getInstance().createConnection(io_service, shared_from_this());
+	auto connection = ConnectionManager::getInstance().createConnection(manager.getShard(), shared_from_this());
 	acceptor->async_accept(connection->getSocket(), [self = shared_from_this(), connection](const std::error_code &error) { self->onAccept(connection, error); });
 }
 
@@ -14,6 +14,7 @@
 #include "server/signals.hpp"
 
 class Protocol;
+class ServiceManager;
 
 class ServiceBase {
 public:
@@ -49,8 +50,8 @@ public:
 
 class ServicePort : public std::enable_shared_from_this<ServicePort> {
 public:
-	explicit ServicePort(asio::io_service &init_io_service) :
-		io_service(init_io_service) { }
+	ServicePort(asio::io_service &init_io_service, ServiceManager &init_manager) :
+		io_service(init_io_service), manager(init_manager) { }
 	~ServicePort();
 
 	// non-copyable
@@ -73,6 +74,7 @@ private:
 	void accept();
 
 	asio::io_service &io_service;
+	ServiceManager &manager;
 	std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
 	std::vector<Service_ptr> services;
 
@@ -99,12 +101,33 @@ public:
 		return acceptors.empty() == false;
 	}
 
+	/**
+	 * Picks the io_service a new connection runs on, round robin over the
+	 * networkThreads shards. The first shard is the one run() drives, the
+	 * others get a thread each once running.
+	 *
+	 * A connection is read and written on its own shard only. The dispatcher
+	 * reaches it through Connection::send, which queues under connectionLock and
+	 * posts the write to the executor of the socket, and shard threads hand game
+	 * work over with g_dispatcher().addEvent, which takes events from any thread.
+	 */
+	asio::io_service &getShard();
+
 private:
+	using WorkGuard = asio::executor_work_guard<asio::io_service::executor_type>;
+
 	void die();
+	void createShards();
 
 	phmap::flat_hash_map<uint16_t, ServicePort_ptr> acceptors;
 
 	asio::io_service io_service;
+	// Shards other than io_service, with the work keeping them running until die()
+	std::vector<std::unique_ptr<asio::io_service>> shards;
+	std::vector<WorkGuard> shardWork;
+	std::vector<std::thread> shardThreads;
+	std::atomic<size_t> nextShard = 0;
+
 	Signals signals { io_service };
 	asio::high_resolution_timer death_timer { io_service };
 	bool running = false;
@@ -124,7 +147,7 @@ bool ServiceManager::add(uint16_t port) {
 	const auto foundServicePort = acceptors.find(port);
 
 	if (foundServicePort == acceptors.end()) {
-		service_port = std::make_shared<ServicePort>(io_service);
+		service_port = std::make_shared<ServicePort>(io_service, *this);
 		service_port->open(port);
 		acceptors[port] = service_port;
 	} else {
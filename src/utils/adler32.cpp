@@ -0,0 +1,124 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "utils/adler32.hpp"
+
+namespace {
+	constexpr uint32_t MOD_ADLER = 65521;
+	// Most bytes summed before b could overflow 32 bits
+	constexpr size_t NMAX = 5552;
+
+	void updateScalar(uint32_t &a, uint32_t &b, const uint8_t* data, size_t length) {
+		while (length > 0) {
+			size_t chunk = std::min(length, NMAX);
+			length -= chunk;
+			while (chunk-- > 0) {
+				a += *data++;
+				b += a;
+			}
+			a %= MOD_ADLER;
+			b %= MOD_ADLER;
+		}
+	}
+
+#if defined(SIMD_DISPATCH)
+	// Over a block of n bytes: b += n * a + sum((n - i) * data[i]), a += sum(data[i])
+	// Lanes keep the byte sums, the byte sums of the blocks before and the weighted sums.
+
+	SIMD_TARGET("sse2")
+	uint32_t horizontalSum(__m128i sum) {
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		return static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+	}
+
+	SIMD_TARGET("sse2")
+	size_t updateSSE2(uint32_t &a, uint32_t &b, const uint8_t* data, size_t length) {
+		constexpr size_t BLOCK = 16;
+		const auto zero = _mm_setzero_si128();
+		const auto weightsLow = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+		const auto weightsHigh = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+
+		size_t done = 0;
+		while (length - done >= BLOCK) {
+			const size_t blocks = std::min(length - done, NMAX) / BLOCK;
+			auto byteSum = zero;
+			auto previousSum = zero;
+			auto weightedSum = zero;
+			for (size_t i = 0; i < blocks; ++i) {
+				const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + done));
+				previousSum = _mm_add_epi32(previousSum, byteSum);
+				byteSum = _mm_add_epi32(byteSum, _mm_sad_epu8(bytes, zero));
+				weightedSum = _mm_add_epi32(weightedSum, _mm_madd_epi16(_mm_unpacklo_epi8(bytes, zero), weightsLow));
+				weightedSum = _mm_add_epi32(weightedSum, _mm_madd_epi16(_mm_unpackhi_epi8(bytes, zero), weightsHigh));
+				done += BLOCK;
+			}
+
+			b = static_cast<uint32_t>((b + uint64_t { a } * blocks * BLOCK + uint64_t { horizontalSum(previousSum) } * BLOCK + horizontalSum(weightedSum)) % MOD_ADLER);
+			a = (a + horizontalSum(byteSum)) % MOD_ADLER;
+		}
+		return done;
+	}
+
+	SIMD_TARGET("avx2")
+	uint32_t horizontalSum(__m256i sum) {
+		auto half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+		half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+		return static_cast<uint32_t>(_mm_cvtsi128_si32(half));
+	}
+
+	SIMD_TARGET("avx2")
+	size_t updateAVX2(uint32_t &a, uint32_t &b, const uint8_t* data, size_t length) {
+		constexpr size_t BLOCK = 32;
+		const auto zero = _mm256_setzero_si256();
+		const auto ones = _mm256_set1_epi16(1);
+		const auto weights = _mm256_setr_epi8(
+			32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+			16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1
+		);
+
+		size_t done = 0;
+		while (length - done >= BLOCK) {
+			const size_t blocks = std::min(length - done, NMAX) / BLOCK;
+			auto byteSum = zero;
+			auto previousSum = zero;
+			auto weightedSum = zero;
+			for (size_t i = 0; i < blocks; ++i) {
+				const auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + done));
+				previousSum = _mm256_add_epi32(previousSum, byteSum);
+				byteSum = _mm256_add_epi32(byteSum, _mm256_sad_epu8(bytes, zero));
+				weightedSum = _mm256_add_epi32(weightedSum, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, weights), ones));
+				done += BLOCK;
+			}
+
+			b = static_cast<uint32_t>((b + uint64_t { a } * blocks * BLOCK + uint64_t { horizontalSum(previousSum) } * BLOCK + horizontalSum(weightedSum)) % MOD_ADLER);
+			a = (a + horizontalSum(byteSum)) % MOD_ADLER;
+		}
+		return done;
+	}
+#endif
+}
+
+uint32_t Adler32::checksum(const uint8_t* data, size_t length, [[maybe_unused]] SimdLevel level) {
+	uint32_t a = 1;
+	uint32_t b = 0;
+
+	size_t done = 0;
+#if defined(SIMD_DISPATCH)
+	if (level == SimdLevel::AVX2) {
+		done = updateAVX2(a, b, data, length);
+	} else if (level == SimdLevel::SSE2) {
+		done = updateSSE2(a, b, data, length);
+	}
+#endif
+	updateScalar(a, b, data + done, length - done);
+
+	return (b << 16) | a;
+}
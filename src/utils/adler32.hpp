@@ -0,0 +1,19 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "utils/simd.hpp"
+
+namespace Adler32 {
+	/**
+	 * Adler-32 of the data, with the widest kernel the CPU supports by default.
+	 */
+	uint32_t checksum(const uint8_t* data, size_t length, SimdLevel level = getSimdLevel());
+}
@@ -0,0 +1,301 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Epoch based reclamation shared by every HandleArena.
+ *
+ * Readers pin the current epoch with a Guard while they use a slot. The epoch only
+ * advances once every pinned thread has seen it, so a slot released during epoch E
+ * can no longer be reached by any reader once the epoch is E + 2.
+ */
+class ArenaEpoch {
+	struct Record;
+
+public:
+	/**
+	 * @brief Pins the calling thread for its lifetime, guards may be nested.
+	 */
+	class Guard {
+	public:
+		Guard() :
+			record(localRecord()) {
+			if (record.depth++ == 0) {
+				record.epoch.store(global.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+			}
+		}
+
+		~Guard() {
+			if (--record.depth == 0) {
+				record.epoch.store(0, std::memory_order_release);
+			}
+		}
+
+		Guard(const Guard &) = delete;
+		Guard &operator=(const Guard &) = delete;
+
+	private:
+		Record &record;
+	};
+
+	static uint64_t current() {
+		return global.load(std::memory_order_seq_cst);
+	}
+
+	/**
+	 * @brief Moves to the next epoch if every pinned thread is in the current one.
+	 * @return The epoch after the attempt.
+	 */
+	static uint64_t tryAdvance() {
+		std::scoped_lock lock(registryMutex);
+		auto epoch = global.load(std::memory_order_seq_cst);
+		for (const auto &record : records) {
+			const auto pinned = record.epoch.load(std::memory_order_seq_cst);
+			if (pinned != 0 && pinned != epoch) {
+				return epoch;
+			}
+		}
+
+		global.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+		return global.load(std::memory_order_seq_cst);
+	}
+
+private:
+	struct Record {
+		// 0 while the thread is not pinned
+		std::atomic_uint64_t epoch = 0;
+		// Only touched by the owning thread
+		uint32_t depth = 0;
+		bool used = false;
+	};
+
+	// Gives the record back when its thread exits
+	struct LocalRecord {
+		LocalRecord() {
+			std::scoped_lock lock(registryMutex);
+			for (auto &free : records) {
+				if (!free.used) {
+					record = &free;
+					break;
+				}
+			}
+			if (!record) {
+				record = &records.emplace_back();
+			}
+			record->used = true;
+		}
+
+		~LocalRecord() {
+			std::scoped_lock lock(registryMutex);
+			record->used = false;
+		}
+
+		Record* record = nullptr;
+	};
+
+	static Record &localRecord() {
+		static thread_local LocalRecord local;
+		return *local.record;
+	}
+
+	static inline std::atomic_uint64_t global = 1;
+	static inline std::mutex registryMutex;
+	// Records never move, a thread keeps its own until it exits
+	static inline std::deque<Record> records;
+};
+
+/**
+ * @brief Chunked storage addressed by 32 bit handles, with lock-free reads.
+ *
+ * Slots never move, chunks are allocated on demand and kept until the arena is
+ * destroyed, so a published handle can be read from any thread without locking.
+ * Handle 0 is reserved and means "no value".
+ *
+ * Writers are serialized by an internal mutex. Released slots are not reused
+ * right away: collect() recycles them once no ArenaEpoch::Guard taken before
+ * the release is still alive, release() does it too every COLLECT_BATCH
+ * releases, and reclaim() recycles all of them when no
+ * reader can be running at all. Readers that may race with a release must
+ * hold a ReadGuard from before they load the handle until they are done with the slot.
+ */
+template <typename T, uint8_t CHUNK_BITS = 12>
+class HandleArena {
+public:
+	using Handle = uint32_t;
+	using ReadGuard = ArenaEpoch::Guard;
+	static constexpr Handle NONE = 0;
+	static constexpr size_t CHUNK_SIZE = size_t { 1 } << CHUNK_BITS;
+	static constexpr size_t MAX_CHUNKS = 1 << 14;
+
+	HandleArena() = default;
+
+	~HandleArena() {
+		for (auto &chunk : chunks) {
+			delete chunk.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Ensures that we don't accidentally copy it
+	HandleArena(const HandleArena &) = delete;
+	HandleArena &operator=(const HandleArena &) = delete;
+
+	/**
+	 * @return The handle of the stored value, or NONE if the arena is full.
+	 */
+	Handle allocate(T value) {
+		std::scoped_lock lock(mutex);
+
+		Handle handle;
+		if (!freeHandles.empty()) {
+			handle = freeHandles.back();
+			freeHandles.pop_back();
+		} else {
+			handle = nextHandle;
+			const auto chunkIndex = handle >> CHUNK_BITS;
+			if (chunkIndex >= MAX_CHUNKS) {
+				return NONE;
+			}
+
+			if (!chunks[chunkIndex].load(std::memory_order_relaxed)) {
+				chunks[chunkIndex].store(new Chunk(), std::memory_order_release);
+			}
+			++nextHandle;
+		}
+
+		slot(handle) = std::move(value);
+		++live;
+		return handle;
+	}
+
+	/**
+	 * @brief Reads a slot, the handle must have been published after allocate().
+	 */
+	const T &get(Handle handle) const {
+		return chunks[handle >> CHUNK_BITS].load(std::memory_order_acquire)->slots[handle & (CHUNK_SIZE - 1)];
+	}
+
+	/**
+	 * @brief Marks a slot as unused, it keeps its value until no reader can still hold the handle.
+	 * The handle must already be unreachable for new readers.
+	 */
+	void release(Handle handle) {
+		if (handle == NONE) {
+			return;
+		}
+
+		// Orders the unlinking of the handle before reading the epoch it is retired in
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::scoped_lock lock(mutex);
+		retiredHandles.emplace_back(ArenaEpoch::current(), handle);
+		--live;
+
+		// Recycles as releases pile up, a load replacing many values doesn't wait for the next collect()
+		if (retiredHandles.size() >= nextCollect) {
+			collectRetired();
+			nextCollect = retiredHandles.size() + COLLECT_BATCH;
+		}
+	}
+
+	/**
+	 * @brief Resets the released slots and makes them available again.
+	 * Must only be called while no reader can be running.
+	 * @return The number of recycled slots.
+	 */
+	size_t reclaim() {
+		std::scoped_lock lock(mutex);
+		for (const auto &[epoch, handle] : retiredHandles) {
+			recycle(handle);
+		}
+
+		const auto reclaimed = retiredHandles.size();
+		retiredHandles.clear();
+		return reclaimed;
+	}
+
+	/**
+	 * @brief Recycles the released slots no reader can reach anymore, safe to call at any time.
+	 * @return The number of recycled slots.
+	 */
+	size_t collect() {
+		std::scoped_lock lock(mutex);
+		return collectRetired();
+	}
+
+	/**
+	 * @return The number of slots holding a value.
+	 */
+	[[nodiscard]] size_t size() const {
+		std::scoped_lock lock(mutex);
+		return live;
+	}
+
+	/**
+	 * @return Bytes used by the allocated chunks and the bookkeeping, not counting what the values point to.
+	 */
+	[[nodiscard]] size_t memoryUsage() const {
+		std::scoped_lock lock(mutex);
+		const auto allocatedChunks = (nextHandle + CHUNK_SIZE - 1) >> CHUNK_BITS;
+		const auto bookkeeping = freeHandles.capacity() * sizeof(Handle) + retiredHandles.capacity() * sizeof(RetiredHandle);
+		return sizeof(*this) + allocatedChunks * sizeof(Chunk) + bookkeeping;
+	}
+
+private:
+	struct Chunk {
+		std::array<T, CHUNK_SIZE> slots {};
+	};
+
+	static constexpr size_t COLLECT_BATCH = 1024;
+
+	// The epoch the handle was released in
+	using RetiredHandle = std::pair<uint64_t, Handle>;
+
+	T &slot(Handle handle) {
+		return chunks[handle >> CHUNK_BITS].load(std::memory_order_relaxed)->slots[handle & (CHUNK_SIZE - 1)];
+	}
+
+	void recycle(Handle handle) {
+		slot(handle) = T {};
+		freeHandles.emplace_back(handle);
+	}
+
+	size_t collectRetired() {
+		const auto epoch = ArenaEpoch::tryAdvance();
+		const auto reclaimed = std::erase_if(retiredHandles, [this, epoch](const RetiredHandle &retired) {
+			if (retired.first + 2 > epoch) {
+				return false;
+			}
+			recycle(retired.second);
+			return true;
+		});
+		return reclaimed;
+	}
+
+	std::array<std::atomic<Chunk*>, MAX_CHUNKS> chunks {};
+
+	mutable std::mutex mutex;
+	std::vector<Handle> freeHandles;
+	// Released, waiting for the readers that may still hold them
+	std::vector<RetiredHandle> retiredHandles;
+	// Size of retiredHandles that makes release() collect
+	size_t nextCollect = COLLECT_BATCH;
+	// Handle 0 is never handed out
+	Handle nextHandle = 1;
+	size_t live = 0;
+};
@@ -0,0 +1,162 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t Capacity = 56>
+class InlineFunction;
+
+template <typename T>
+inline constexpr bool is_std_function_v = false;
+
+template <typename T>
+inline constexpr bool is_std_function_v<std::function<T>> = true;
+
+/**
+ * @brief Move-only replacement for std::function with a small inline buffer.
+ *
+ * Callables up to `Capacity` bytes that are nothrow move constructible are
+ * stored in place, so wrapping a typical lambda (a few ids, a weak_ptr and
+ * `this`) never touches the heap. Bigger callables fall back to a single
+ * heap allocation.
+ *
+ * Like std::function, operator() is const and an empty instance compares
+ * equal to nullptr.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+public:
+	InlineFunction() noexcept = default;
+
+	InlineFunction(std::nullptr_t) noexcept { }
+
+	template <typename F, typename Callable = std::decay_t<F>>
+		requires(!std::is_same_v<Callable, InlineFunction> && std::is_invocable_r_v<R, Callable &, Args...>)
+	InlineFunction(F &&f) {
+		// Empty std::function and null pointers result in an empty InlineFunction
+		if constexpr (std::is_pointer_v<std::remove_reference_t<F>> || std::is_member_pointer_v<Callable> || is_std_function_v<Callable>) {
+			if (!f) {
+				return;
+			}
+		}
+
+		if constexpr (storedInline<Callable>) {
+			std::construct_at(reinterpret_cast<Callable*>(storage), std::forward<F>(f));
+		} else {
+			*reinterpret_cast<Callable**>(storage) = new Callable(std::forward<F>(f));
+		}
+		vtable = &vtableFor<Callable>;
+	}
+
+	InlineFunction(InlineFunction &&other) noexcept {
+		moveFrom(other);
+	}
+
+	InlineFunction &operator=(InlineFunction &&other) noexcept {
+		if (this != &other) {
+			reset();
+			moveFrom(other);
+		}
+		return *this;
+	}
+
+	InlineFunction &operator=(std::nullptr_t) noexcept {
+		reset();
+		return *this;
+	}
+
+	// Ensures that we don't accidentally copy it
+	InlineFunction(const InlineFunction &) = delete;
+	InlineFunction &operator=(const InlineFunction &) = delete;
+
+	~InlineFunction() {
+		reset();
+	}
+
+	R operator()(Args... args) const {
+		return vtable->invoke(storage, std::forward<Args>(args)...);
+	}
+
+	explicit operator bool() const noexcept {
+		return vtable != nullptr;
+	}
+
+	bool operator==(std::nullptr_t) const noexcept {
+		return vtable == nullptr;
+	}
+
+	void reset() noexcept {
+		if (vtable) {
+			vtable->destroy(storage);
+			vtable = nullptr;
+		}
+	}
+
+private:
+	struct VTable {
+		R (*invoke)(std::byte* storage, Args &&... args);
+		void (*move)(std::byte* to, std::byte* from) noexcept;
+		void (*destroy)(std::byte* storage) noexcept;
+	};
+
+	template <typename F>
+	static constexpr bool storedInline = sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+
+	template <typename F>
+	static F* target(std::byte* storage) noexcept {
+		if constexpr (storedInline<F>) {
+			return std::launder(reinterpret_cast<F*>(storage));
+		} else {
+			return *reinterpret_cast<F**>(storage);
+		}
+	}
+
+	template <typename F>
+	static constexpr VTable vtableFor {
+		[](std::byte* storage, Args &&... args) -> R {
+			if constexpr (std::is_void_v<R>) {
+				std::invoke(*target<F>(storage), std::forward<Args>(args)...);
+			} else {
+				return std::invoke(*target<F>(storage), std::forward<Args>(args)...);
+			}
+		},
+		[](std::byte* to, std::byte* from) noexcept {
+			if constexpr (storedInline<F>) {
+				std::construct_at(reinterpret_cast<F*>(to), std::move(*target<F>(from)));
+				std::destroy_at(target<F>(from));
+			} else {
+				*reinterpret_cast<F**>(to) = target<F>(from);
+			}
+		},
+		[](std::byte* storage) noexcept {
+			if constexpr (storedInline<F>) {
+				std::destroy_at(target<F>(storage));
+			} else {
+				delete target<F>(storage);
+			}
+		}
+	};
+
+	void moveFrom(InlineFunction &other) noexcept {
+		if (other.vtable) {
+			other.vtable->move(storage, other.storage);
+			vtable = std::exchange(other.vtable, nullptr);
+		}
+	}
+
+	alignas(std::max_align_t) mutable std::byte storage[Capacity];
+	const VTable* vtable = nullptr;
+};
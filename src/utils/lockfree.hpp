@@ -11,6 +11,9 @@
 
 #include <atomic_queue/atomic_queue.h>
 
+#include <mutex>
+#include <vector>
+
 template <typename T, size_t CAPACITY>
 struct LockfreeFreeList {
 	using FreeList = atomic_queue::AtomicQueue2<T*, CAPACITY>;
@@ -66,3 +69,80 @@ public:
 		::operator delete(p);
 	}
 };
+
+/**
+ * @brief Bounded lock-free queue with a locked overflow, for many producers and one consumer.
+ *
+ * Producers push into an atomic_queue ring without locking. When the ring is
+ * full, values spill into a mutex protected vector, and keep doing so until the
+ * consumer drains it, so the order of every producer is preserved.
+ * The consumer drains what was queued when the drain started without blocking
+ * producers, so constant producers can't keep it looping.
+ *
+ * @tparam T Value type, must be default constructible and movable.
+ */
+template <typename T>
+class LockfreeMPSCQueue {
+public:
+	explicit LockfreeMPSCQueue(uint32_t capacity) :
+		queue(capacity) { }
+
+	// Ensures that we don't accidentally copy it
+	LockfreeMPSCQueue(const LockfreeMPSCQueue &) = delete;
+	LockfreeMPSCQueue &operator=(const LockfreeMPSCQueue &) = delete;
+
+	template <typename U>
+	void push(U &&value) {
+		if (!hasOverflow.load(std::memory_order_acquire) && queue.try_push(std::forward<U>(value))) {
+			return;
+		}
+
+		std::scoped_lock lock(overflowMutex);
+		overflow.emplace_back(std::forward<U>(value));
+		hasOverflow.store(true, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Moves the values queued when it is called into the consumer callback, in push order.
+	 *
+	 * Values pushed while draining are left for the next drain. The overflow is
+	 * only taken if it existed at the start, newer ring values would otherwise
+	 * stay behind values pushed after them.
+	 * @return The number of values drained.
+	 */
+	template <typename F>
+	size_t drain(F &&f) {
+		const bool hadOverflow = hasOverflow.load(std::memory_order_acquire);
+		const size_t pending = queue.was_size();
+
+		size_t drained = 0;
+		T value;
+		while (drained < pending && queue.try_pop(value)) {
+			f(std::move(value));
+			++drained;
+		}
+
+		if (hadOverflow) {
+			std::scoped_lock lock(overflowMutex);
+			for (auto &spilled : overflow) {
+				f(std::move(spilled));
+			}
+			drained += overflow.size();
+			overflow.clear();
+			hasOverflow.store(false, std::memory_order_release);
+		}
+
+		return drained;
+	}
+
+	[[nodiscard]] bool empty() const {
+		return queue.was_empty() && !hasOverflow.load(std::memory_order_acquire);
+	}
+
+private:
+	atomic_queue::AtomicQueueB2<T> queue;
+
+	std::mutex overflowMutex;
+	std::vector<T> overflow;
+	std::atomic_bool hasOverflow = false;
+};
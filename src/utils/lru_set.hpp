@@ -0,0 +1,236 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <parallel_hashmap/phmap.h>
+
+/**
+ * @brief Fixed capacity set that keeps its keys in least recently used order.
+ *
+ * Keys live in a node array linked by index, so nothing is allocated once the
+ * set reached its capacity; a flat hash maps each key to its node. Lookups,
+ * touches and evictions are O(1).
+ *
+ * When the set is full, insert() asks a predicate whether the oldest keys may
+ * be dropped. Probed keys that aren't dropped are moved to the front, so the
+ * next eviction resumes where this one stopped instead of rescanning them.
+ * Keys the predicate would only drop as a fallback are taken once maxProbes
+ * keys were probed without finding one it allows. Without any, probing goes
+ * on until every key was asked once, then the oldest one is dropped anyway.
+ */
+template <typename Key, typename Hash = phmap::Hash<Key>>
+class LRUSet {
+public:
+	enum class Eviction : uint8_t {
+		KEEP,
+		// Dropped only if no probed key may be
+		FALLBACK,
+		ALLOW,
+	};
+
+	struct InsertResult {
+		bool inserted = false;
+		std::optional<Key> evicted;
+	};
+
+	explicit LRUSet(uint32_t capacity, uint32_t maxProbes = 32) :
+		capacity(capacity), maxProbes(maxProbes) { }
+
+	size_t size() const {
+		return index.size();
+	}
+
+	bool empty() const {
+		return index.empty();
+	}
+
+	bool contains(const Key &key) const {
+		return index.contains(key);
+	}
+
+	/**
+	 * @brief Marks a key as the most recently used one.
+	 * @return false if the key isn't in the set.
+	 */
+	bool touch(const Key &key) {
+		auto it = index.find(key);
+		if (it == index.end()) {
+			return false;
+		}
+
+		moveToFront(it->second);
+		return true;
+	}
+
+	/**
+	 * @brief Inserts or touches a key, evicting an old one if the set is full.
+	 *
+	 * @param canEvict Called with candidate keys, oldest first, returns whether
+	 * the key may be dropped, as a bool or an Eviction. It must not modify the set.
+	 */
+	template <typename Predicate>
+	InsertResult insert(const Key &key, Predicate &&canEvict) {
+		if (touch(key)) {
+			return {};
+		}
+
+		InsertResult result { true, std::nullopt };
+		if (index.size() >= capacity && tail != NONE) {
+			result.evicted = evict(canEvict);
+		}
+
+		uint32_t node;
+		if (freeHead != NONE) {
+			node = freeHead;
+			freeHead = nodes[node].next;
+			nodes[node].key = key;
+		} else {
+			node = static_cast<uint32_t>(nodes.size());
+			nodes.push_back({ key, NONE, NONE });
+		}
+
+		linkFront(node);
+		index.emplace(key, node);
+		return result;
+	}
+
+	InsertResult insert(const Key &key) {
+		return insert(key, [](const Key &) { return true; });
+	}
+
+	bool erase(const Key &key) {
+		auto it = index.find(key);
+		if (it == index.end()) {
+			return false;
+		}
+
+		release(it->second);
+		index.erase(it);
+		return true;
+	}
+
+	void clear() {
+		index.clear();
+		nodes.clear();
+		head = tail = freeHead = NONE;
+	}
+
+	/**
+	 * @return The least recently used key, if any.
+	 */
+	std::optional<Key> oldest() const {
+		if (tail == NONE) {
+			return std::nullopt;
+		}
+		return nodes[tail].key;
+	}
+
+private:
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	struct Node {
+		Key key;
+		uint32_t prev;
+		uint32_t next;
+	};
+
+	static Eviction toEviction(bool allowed) {
+		return allowed ? Eviction::ALLOW : Eviction::KEEP;
+	}
+	static Eviction toEviction(Eviction eviction) {
+		return eviction;
+	}
+
+	template <typename Predicate>
+	Key evict(Predicate &canEvict) {
+		uint32_t fallback = NONE;
+		const auto size = static_cast<uint32_t>(index.size());
+		for (uint32_t probes = 0; probes < size; ++probes) {
+			if (probes == maxProbes && fallback != NONE) {
+				return evictNode(fallback);
+			}
+
+			// Past maxProbes every probed key was kept, the first one that may go does
+			const uint32_t node = tail;
+			const Eviction eviction = toEviction(canEvict(std::as_const(nodes[node].key)));
+			if (eviction == Eviction::ALLOW || (eviction == Eviction::FALLBACK && probes >= maxProbes)) {
+				return evictNode(node);
+			}
+			if (eviction == Eviction::FALLBACK && fallback == NONE) {
+				fallback = node;
+			}
+			moveToFront(node);
+		}
+
+		// Every key was asked and none may be dropped, the keys are back in their order
+		return evictNode(fallback != NONE ? fallback : tail);
+	}
+
+	Key evictNode(uint32_t node) {
+		Key key = nodes[node].key;
+		index.erase(key);
+		release(node);
+		return key;
+	}
+
+	void release(uint32_t node) {
+		unlink(node);
+		nodes[node].next = freeHead;
+		freeHead = node;
+	}
+
+	void moveToFront(uint32_t node) {
+		if (node == head) {
+			return;
+		}
+		unlink(node);
+		linkFront(node);
+	}
+
+	void linkFront(uint32_t node) {
+		nodes[node].prev = NONE;
+		nodes[node].next = head;
+		if (head != NONE) {
+			nodes[head].prev = node;
+		} else {
+			tail = node;
+		}
+		head = node;
+	}
+
+	void unlink(uint32_t node) {
+		const uint32_t prev = nodes[node].prev;
+		const uint32_t next = nodes[node].next;
+		if (prev != NONE) {
+			nodes[prev].next = next;
+		} else {
+			head = next;
+		}
+		if (next != NONE) {
+			nodes[next].prev = prev;
+		} else {
+			tail = prev;
+		}
+	}
+
+	phmap::flat_hash_map<Key, uint32_t, Hash> index;
+	std::vector<Node> nodes;
+	uint32_t head = NONE;
+	uint32_t tail = NONE;
+	uint32_t freeHead = NONE;
+	uint32_t capacity;
+	uint32_t maxProbes;
+};
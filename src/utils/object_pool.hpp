@@ -57,6 +57,22 @@ public:
 		return nullptr;
 	}
 
+	/**
+	 * @brief Allocates an object together with its `std::shared_ptr` control block.
+	 *
+	 * Unlike allocateShared, the object and the control block share a single
+	 * pooled block, which goes back to the free list when the last reference
+	 * is released. No heap allocation happens once the pool is warm.
+	 *
+	 * @tparam Args The types of the arguments used to construct the object.
+	 * @param args The arguments forwarded to the constructor of the object.
+	 * @return A `std::shared_ptr` managing the allocated object.
+	 */
+	template <typename... Args>
+	static std::shared_ptr<T> makeShared(Args &&... args) {
+		return std::allocate_shared<T>(allocator, std::forward<Args>(args)...);
+	}
+
 	static void clear() {
 		allocator.clear();
 	}
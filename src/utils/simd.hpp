@@ -9,6 +9,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string_view>
+
 // #define __DISABLE_VECTORIZATION__ 1
 
 #if defined(__DISABLE_VECTORIZATION__)
@@ -64,3 +67,56 @@ __forceinline unsigned int mm_ctz(unsigned int value) {
 #else
 	#define mm_ctz __builtin_ctz
 #endif
+
+// Kernels built for a wider instruction set than the portable baseline the
+// build targets, called only once getSimdLevel() reports it is available
+#if !defined(__DISABLE_VECTORIZATION__) && (defined(__x86_64__) || defined(_M_X64))
+	#define SIMD_DISPATCH 1
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#define SIMD_TARGET(isa)
+	#else
+		#define SIMD_TARGET(isa) __attribute__((target(isa)))
+	#endif
+#endif
+
+enum class SimdLevel : uint8_t {
+	Scalar,
+	SSE2,
+	AVX2,
+};
+
+/**
+ * Widest instruction set the CPU (and OS) supports, detected once.
+ */
+inline SimdLevel getSimdLevel() {
+#if defined(SIMD_DISPATCH)
+	static const SimdLevel level = [] {
+	#ifdef _MSC_VER
+		int info[4] {};
+		__cpuid(info, 1);
+		// AVX registers saved by the OS
+		const bool avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		return avx && (info[1] & (1 << 5)) != 0 ? SimdLevel::AVX2 : SimdLevel::SSE2;
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE2;
+	#endif
+	}();
+	return level;
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+inline std::string_view getSimdLevelName(SimdLevel level) {
+	switch (level) {
+		case SimdLevel::SSE2:
+			return "sse2";
+		case SimdLevel::AVX2:
+			return "avx2";
+		default:
+			return "scalar";
+	}
+}
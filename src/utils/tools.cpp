@@ -13,6 +13,7 @@
 #include "enums/object_category.hpp"
 #include "items/item.hpp"
 #include "lua/lua_definitions.hpp"
+#include "utils/adler32.hpp"
 #include "utils/const.hpp"
 #include "config/configmanager.hpp"
 #include "game/movement/position.hpp"
@@ -1017,24 +1018,7 @@ uint32_t adlerChecksum(const uint8_t* data, size_t length) {
 		return 0;
 	}
 
-	constexpr uint16_t adler = 65521;
-
-	uint32_t a = 1, b = 0;
-
-	while (length > 0) {
-		size_t tmp = length > 5552 ? 5552 : length;
-		length -= tmp;
-
-		do {
-			a += *data++;
-			b += a;
-		} while (--tmp);
-
-		a %= adler;
-		b %= adler;
-	}
-
-	return (b << 16) | a;
+	return Adler32::checksum(data, length);
 }
 
 std::string ucfirst(std::string str) {
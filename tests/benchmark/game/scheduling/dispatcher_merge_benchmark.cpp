@@ -0,0 +1,119 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "game/scheduling/dispatcher.hpp"
+#include "utils/lockfree.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t MERGES = 2'000;
+	constexpr size_t TASKS_PER_PUSH_BURST = 16;
+	constexpr std::string_view CONTEXT = "Benchmark::mergeEvents";
+
+	// Per-thread storage as it was before the lock-free queues
+	struct LockedThreadTasks {
+		std::vector<Task> tasks;
+		std::mutex mutex;
+
+		void push(Task &&task) {
+			std::scoped_lock lock(mutex);
+			tasks.emplace_back(std::move(task));
+		}
+
+		void drainInto(std::vector<Task> &merged) {
+			std::scoped_lock lock(mutex);
+			if (tasks.size() > merged.size()) {
+				merged.swap(tasks);
+			}
+			merged.insert(merged.end(), std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+			tasks.clear();
+		}
+	};
+
+	struct LockfreeThreadTasks {
+		LockfreeMPSCQueue<Task> tasks { 2048 };
+
+		void push(Task &&task) {
+			tasks.push(std::move(task));
+		}
+
+		void drainInto(std::vector<Task> &merged) {
+			tasks.drain([&merged](Task &&task) { merged.emplace_back(std::move(task)); });
+		}
+	};
+
+	/**
+	 * Producers keep pushing tasks into their own storage while the consumer
+	 * merges every thread, like Dispatcher::mergeEvents does once per cycle.
+	 */
+	template <typename ThreadTasks>
+	void benchmarkMerge(std::string_view name, size_t threadCount) {
+		std::vector<std::unique_ptr<ThreadTasks>> threads;
+		for (size_t i = 0; i < threadCount; ++i) {
+			threads.emplace_back(std::make_unique<ThreadTasks>());
+		}
+
+		std::atomic_bool running = true;
+		std::vector<std::thread> producers;
+		for (size_t i = 0; i < threadCount; ++i) {
+			producers.emplace_back([&running, &thread = *threads[i]] {
+				while (running.load(std::memory_order_relaxed)) {
+					for (size_t j = 0; j < TASKS_PER_PUSH_BURST; ++j) {
+						thread.push(Task(0, [] { }, CONTEXT));
+					}
+					std::this_thread::yield();
+				}
+			});
+		}
+
+		std::vector<Task> merged;
+		merged.reserve(2000);
+		std::vector<double> latencies;
+		latencies.reserve(MERGES);
+		size_t mergedTasks = 0;
+
+		for (size_t merge = 0; merge < MERGES; ++merge) {
+			const auto start = std::chrono::steady_clock::now();
+			for (const auto &thread : threads) {
+				thread->drainInto(merged);
+			}
+			latencies.emplace_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+			mergedTasks += merged.size();
+			merged.clear();
+		}
+
+		running = false;
+		for (auto &producer : producers) {
+			producer.join();
+		}
+
+		std::ranges::sort(latencies);
+		const auto average = std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size();
+		fmt::print(
+			"[{}] {} threads: merge avg {:.2f} us, p99 {:.2f} us, max {:.2f} us, {} tasks merged\n",
+			name, threadCount, average, latencies[latencies.size() * 99 / 100], latencies.back(), mergedTasks
+		);
+
+		expect(gt(mergedTasks, 0u));
+	}
+}
+
+suite<"benchmark"> dispatcherMergeBenchmark = [] {
+	test("Dispatcher::mergeEvents latency with 8 threads") = [] {
+		benchmarkMerge<LockedThreadTasks>("mutex", 8);
+		benchmarkMerge<LockfreeThreadTasks>("lockfree", 8);
+	};
+
+	test("Dispatcher::mergeEvents latency with 16 threads") = [] {
+		benchmarkMerge<LockedThreadTasks>("mutex", 16);
+		benchmarkMerge<LockfreeThreadTasks>("lockfree", 16);
+	};
+
+	test("Dispatcher::mergeEvents latency with 64 threads") = [] {
+		benchmarkMerge<LockedThreadTasks>("mutex", 64);
+		benchmarkMerge<LockfreeThreadTasks>("lockfree", 64);
+	};
+};
@@ -0,0 +1,113 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "game/scheduling/dispatcher.hpp"
+#include "utils/tools.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr size_t PENDING_EVENTS = 200'000;
+	constexpr std::string_view CONTEXT = "Benchmark::scheduledTasks";
+
+	struct TaskTimeCompare {
+		bool operator()(const std::shared_ptr<Task> &a, const std::shared_ptr<Task> &b) const {
+			return a->getTime() < b->getTime();
+		}
+	};
+
+	std::vector<uint32_t> generateDelays(size_t count) {
+		std::mt19937 generator(PENDING_EVENTS);
+		// Mostly walk/decay sized delays, with a tail of long Lua timers
+		std::uniform_int_distribution<uint32_t> shortDelay(SCHEDULER_MINTICKS, 2'000);
+		std::uniform_int_distribution<uint32_t> longDelay(2'000, 600'000);
+
+		std::vector<uint32_t> delays(count);
+		for (auto &delay : delays) {
+			delay = generator() % 4 == 0 ? longDelay(generator) : shortDelay(generator);
+		}
+		return delays;
+	}
+
+	std::vector<std::shared_ptr<Task>> generateTasks(const std::vector<uint32_t> &delays) {
+		std::vector<std::shared_ptr<Task>> tasks;
+		tasks.reserve(delays.size());
+		for (const auto delay : delays) {
+			tasks.emplace_back(std::make_shared<Task>([] { }, CONTEXT, delay, false, false));
+		}
+		return tasks;
+	}
+
+	void report(std::string_view name, std::string_view operation, Benchmark &bm, size_t operations) {
+		const auto ms = bm.duration();
+		fmt::print("[{}] {}: {:.3f} ms ({:.1f} ns/op)\n", name, operation, ms, ms * 1'000'000.0 / operations);
+	}
+}
+
+suite<"benchmark"> timingWheelBenchmark = [] {
+	UPDATE_OTSYS_TIME();
+	const auto delays = generateDelays(PENDING_EVENTS);
+
+	test("Dispatcher::scheduledTasks btree_multiset with 200k pending events") = [&delays] {
+		auto tasks = generateTasks(delays);
+		phmap::btree_multiset<std::shared_ptr<Task>, TaskTimeCompare> scheduled;
+		phmap::flat_hash_map<uint64_t, std::shared_ptr<Task>> refs;
+
+		Benchmark bm;
+		for (const auto &task : tasks) {
+			scheduled.insert(task);
+			refs.emplace(task->getId(), task);
+		}
+		report("btree", "schedule", bm, tasks.size());
+
+		// Canceling only flags the task, it stays in the tree until it expires
+		bm.start();
+		for (size_t i = 0; i < tasks.size(); i += 2) {
+			refs.erase(tasks[i]->getId());
+		}
+		report("btree", "cancel", bm, tasks.size() / 2);
+
+		bm.start();
+		size_t expired = 0;
+		while (!scheduled.empty()) {
+			scheduled.erase(scheduled.begin());
+			++expired;
+		}
+		report("btree", "expire", bm, expired);
+
+		expect(eq(expired, tasks.size()));
+	};
+
+	test("Dispatcher::scheduledTasks TimingWheel with 200k pending events") = [&delays] {
+		auto tasks = generateTasks(delays);
+		TimingWheel<Task> scheduled { SCHEDULER_MINTICKS };
+		phmap::flat_hash_map<uint64_t, std::shared_ptr<Task>> refs;
+		scheduled.reset(OTSYS_TIME());
+
+		Benchmark bm;
+		for (const auto &task : tasks) {
+			scheduled.insert(task);
+			refs.emplace(task->getId(), task);
+		}
+		report("wheel", "schedule", bm, tasks.size());
+
+		bm.start();
+		for (size_t i = 0; i < tasks.size(); i += 2) {
+			scheduled.erase(tasks[i].get());
+			refs.erase(tasks[i]->getId());
+		}
+		report("wheel", "cancel", bm, tasks.size() / 2);
+
+		bm.start();
+		size_t expired = 0;
+		auto now = OTSYS_TIME();
+		while (!scheduled.empty()) {
+			now = std::max(now + SCHEDULER_MINTICKS, scheduled.nextExpiration());
+			scheduled.advance(now, [&expired](const std::shared_ptr<Task> &) { ++expired; });
+		}
+		report("wheel", "expire", bm, expired);
+
+		expect(eq(expired, tasks.size() - (tasks.size() + 1) / 2));
+	};
+};
@@ -0,0 +1,55 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "items/test_items.hpp"
+#include "lib/thread/thread_pool.hpp"
+#include "map/map.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr std::string_view DEFAULT_MAP = "data-otservbr-global/world/otservbr.otbm";
+	constexpr std::array<uint32_t, 3> LOADER_THREADS = { 1, 4, 16 };
+
+	// The map is downloaded on the first boot, CANARY_BENCHMARK_MAP points to another copy
+	std::filesystem::path mapPath() {
+		const auto* path = std::getenv("CANARY_BENCHMARK_MAP");
+		return path ? std::filesystem::path(path) : std::filesystem::path(DEFAULT_MAP);
+	}
+}
+
+suite<"benchmark"> mapLoadBenchmark = [] {
+	test("IOMap::loadMap of data-otservbr-global") = [] {
+		const auto path = mapPath();
+		if (!std::filesystem::exists(path)) {
+			fmt::print("[map load] {} not found, skipped (set CANARY_BENCHMARK_MAP)\n", path.string());
+			return;
+		}
+		tests::TestItems::install();
+
+		fmt::print(
+			"[map load] {} ({:.2f} MB), thread pool of {} threads, only the test item types loaded\n",
+			path.string(), std::filesystem::file_size(path) / 1048576.0, g_threadPool().get_thread_count()
+		);
+
+		size_t expectedTiles = 0;
+		for (const auto threads : LOADER_THREADS) {
+			const auto map = std::make_unique<Map>();
+
+			Benchmark bm;
+			map->load(path.string(), Position(), threads);
+			const auto duration = bm.duration();
+
+			const auto stats = map->getMemoryStats();
+			fmt::print("[map load] {:>2} threads: {:.0f} ms, {} tiles from {} templates\n", threads, duration, stats.cachedTiles, stats.basicTiles);
+
+			// Every thread count must build the same map
+			if (expectedTiles == 0) {
+				expectedTiles = stats.cachedTiles;
+			}
+			expect(eq(stats.cachedTiles, expectedTiles));
+		}
+		expect(gt(expectedTiles, 0u));
+	};
+};
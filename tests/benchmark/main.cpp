@@ -0,0 +1,19 @@
+#include <boost/ut.hpp>
+#include "config/configmanager.hpp"
+#include "database/database.hpp"
+#include "lib/di/container.hpp"
+#include "lib/logging/in_memory_logger.hpp"
+
+using namespace boost::ut;
+
+int main() {
+	di::extension::injector<> injector {};
+	InMemoryLogger::install(injector);
+	DI::setTestContainer(&injector);
+
+	(void)g_logger();
+	(void)g_configManager();
+	(void)g_database();
+
+	return cfg<>.run();
+}
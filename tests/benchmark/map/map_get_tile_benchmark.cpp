@@ -0,0 +1,189 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "items/tile.hpp"
+#include "map/map.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	// Footprint of the otservbr-global map, the .otbm itself is downloaded at runtime
+	constexpr uint16_t MAP_START_X = 31'744;
+	constexpr uint16_t MAP_START_Y = 30'976;
+	constexpr uint16_t MAP_WIDTH = 3'072;
+	constexpr uint16_t MAP_HEIGHT = 2'560;
+
+	// Area players walk around in, its tiles are materialized before measuring
+	constexpr uint16_t HOT_START_X = 32'256;
+	constexpr uint16_t HOT_START_Y = 32'000;
+	constexpr uint16_t HOT_SIZE = 512;
+
+	constexpr size_t LOOKUPS = 20'000'000;
+
+	// Share of cells holding a tile, per floor
+	uint8_t floorDensity(uint8_t z) {
+		if (z == MAP_INIT_SURFACE_LAYER) {
+			return 70;
+		}
+		return z >= 6 && z <= 8 ? 30 : 8;
+	}
+
+	std::vector<std::shared_ptr<BasicTile>> createTemplates() {
+		std::vector<std::shared_ptr<BasicTile>> templates;
+		for (uint32_t flags : { TILESTATE_NONE, TILESTATE_PROTECTIONZONE, TILESTATE_NOLOGOUT, TILESTATE_PVPZONE }) {
+			auto tile = std::make_shared<BasicTile>();
+			tile->flags = flags;
+			tile->type = TILESTATE_FLOORCHANGE;
+			templates.emplace_back(std::move(tile));
+		}
+		return templates;
+	}
+
+	// Storage as it was before the dense grid, kept to compare lookups
+	struct LegacyFloor {
+		std::shared_ptr<Tile> getTile(uint16_t x, uint16_t y) const {
+			std::shared_lock<std::shared_mutex> sl(mutex);
+			return tiles[x & SECTOR_MASK][y & SECTOR_MASK].first;
+		}
+
+		std::shared_ptr<BasicTile> getTileCache(uint16_t x, uint16_t y) const {
+			std::shared_lock<std::shared_mutex> sl(mutex);
+			return tiles[x & SECTOR_MASK][y & SECTOR_MASK].second;
+		}
+
+		std::pair<std::shared_ptr<Tile>, std::shared_ptr<BasicTile>> tiles[SECTOR_SIZE][SECTOR_SIZE] = {};
+		mutable std::shared_mutex mutex;
+	};
+
+	struct LegacySector {
+		std::shared_ptr<LegacyFloor> getFloor(uint8_t z) {
+			std::scoped_lock lock(floorsMutex);
+			return floors[z];
+		}
+
+		std::mutex floorsMutex;
+		std::shared_ptr<LegacyFloor> floors[MAP_MAX_LAYERS] = {};
+	};
+
+	struct LegacyMap {
+		std::shared_ptr<Tile> getTile(uint16_t x, uint16_t y, uint8_t z) {
+			const auto it = sectors.find(x / SECTOR_SIZE | y / SECTOR_SIZE << 16);
+			if (it == sectors.end()) {
+				return nullptr;
+			}
+
+			const auto &floor = it->second.getFloor(z);
+			if (!floor) {
+				return nullptr;
+			}
+
+			// The cache was checked first, like getOrCreateTileFromCache did
+			if (floor->getTileCache(x, y)) {
+				return nullptr;
+			}
+			return floor->getTile(x, y);
+		}
+
+		void setTile(uint16_t x, uint16_t y, uint8_t z, std::shared_ptr<Tile> tile) {
+			auto &floor = sectors[x / SECTOR_SIZE | y / SECTOR_SIZE << 16].floors[z];
+			if (!floor) {
+				floor = std::make_shared<LegacyFloor>();
+			}
+			floor->tiles[x & SECTOR_MASK][y & SECTOR_MASK].first = std::move(tile);
+		}
+
+		std::unordered_map<uint32_t, LegacySector> sectors;
+	};
+
+	std::vector<Position> generateLookups() {
+		std::mt19937 generator(LOOKUPS);
+		std::uniform_int_distribution<uint16_t> hotOffset(0, HOT_SIZE - 1);
+		std::uniform_int_distribution<uint16_t> mapX(MAP_START_X, MAP_START_X + MAP_WIDTH - 1);
+		std::uniform_int_distribution<uint16_t> mapY(MAP_START_Y, MAP_START_Y + MAP_HEIGHT - 1);
+
+		// Mostly lookups around players, like spectators and pathfinding do, plus some far away misses
+		std::vector<Position> positions(1 << 16);
+		for (auto &position : positions) {
+			if (generator() % 8 != 0) {
+				position = Position(HOT_START_X + hotOffset(generator), HOT_START_Y + hotOffset(generator), MAP_INIT_SURFACE_LAYER);
+			} else {
+				position = Position(mapX(generator), mapY(generator), static_cast<uint8_t>(generator() % MAP_MAX_LAYERS));
+			}
+		}
+		return positions;
+	}
+
+	void report(std::string_view name, std::string_view operation, Benchmark &bm, size_t operations) {
+		const auto ms = bm.duration();
+		fmt::print("[{}] {}: {:.3f} ms ({:.1f} ns/op)\n", name, operation, ms, ms * 1'000'000.0 / operations);
+	}
+}
+
+suite<"benchmark"> mapGetTileBenchmark = [] {
+	test("Map::getTile on an otservbr-global sized map") = [] {
+		const auto map = std::make_unique<Map>();
+		const auto templates = createTemplates();
+		std::mt19937 generator(MAP_WIDTH);
+
+		Benchmark bm;
+		size_t cells = 0;
+		for (uint8_t z = 0; z < MAP_MAX_LAYERS; ++z) {
+			const auto density = floorDensity(z);
+			for (uint16_t y = MAP_START_Y; y < MAP_START_Y + MAP_HEIGHT; ++y) {
+				for (uint16_t x = MAP_START_X; x < MAP_START_X + MAP_WIDTH; ++x) {
+					if (generator() % 100 < density) {
+						map->setBasicTile(x, y, z, templates[generator() % templates.size()]);
+						++cells;
+					}
+				}
+			}
+		}
+		map->flush();
+		report("grid", "load", bm, cells);
+
+		// Materializes the area players are in
+		LegacyMap legacy;
+		for (uint16_t y = HOT_START_Y; y < HOT_START_Y + HOT_SIZE; ++y) {
+			for (uint16_t x = HOT_START_X; x < HOT_START_X + HOT_SIZE; ++x) {
+				legacy.setTile(x, y, MAP_INIT_SURFACE_LAYER, map->getTile(x, y, MAP_INIT_SURFACE_LAYER));
+			}
+		}
+
+		const auto stats = map->getMemoryStats();
+		fmt::print(
+			"[grid] memory: {} sectors, {} floors, {} tiles, {} cached tiles, index {:.2f} MB, arenas {:.2f} MB\n",
+			stats.sectors, stats.floors, stats.tiles, stats.cachedTiles, stats.sectorBytes / 1048576.0, stats.arenaBytes / 1048576.0
+		);
+		fmt::print(
+			"[legacy] memory: {:.2f} MB for the same floors\n",
+			(stats.floors * (sizeof(LegacyFloor) + 16) + stats.sectors * (sizeof(LegacySector) + 32)) / 1048576.0
+		);
+
+		const auto lookups = generateLookups();
+		const auto mask = lookups.size() - 1;
+
+		size_t found = 0;
+		bm.start();
+		for (size_t i = 0; i < LOOKUPS; ++i) {
+			const auto &position = lookups[i & mask];
+			if (map->getTile(position.x, position.y, position.z)) {
+				++found;
+			}
+		}
+		report("grid", "getTile", bm, LOOKUPS);
+
+		size_t legacyFound = 0;
+		bm.start();
+		for (size_t i = 0; i < LOOKUPS; ++i) {
+			const auto &position = lookups[i & mask];
+			if (legacy.getTile(position.x, position.y, position.z)) {
+				++legacyFound;
+			}
+		}
+		report("legacy", "getTile", bm, LOOKUPS);
+
+		expect(gt(found, 0u));
+		expect(le(legacyFound, found));
+	};
+};
@@ -0,0 +1,291 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "config/configmanager.hpp"
+#include "creatures/creature.hpp"
+#include "items/test_items.hpp"
+#include "items/tile.hpp"
+#include "map/map.hpp"
+#include "map/utils/astarnodes.hpp"
+#include "map/utils/flowfield.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr std::string_view DEFAULT_MAP = "data-otservbr-global/world/otservbr.otbm";
+
+	// Thais, where most of the otservbr-global monsters and npcs walk around
+	constexpr uint16_t AREA_START_X = 32'200;
+	constexpr uint16_t AREA_START_Y = 32'100;
+	constexpr uint16_t AREA_SIZE = 400;
+	constexpr uint8_t AREA_Z = MAP_INIT_SURFACE_LAYER;
+
+	constexpr size_t QUERIES_PER_DISTANCE = 2'000;
+	constexpr size_t ROUNDS = 10;
+	// Monsters around a player, one chase each
+	constexpr size_t FOLLOWERS = 8;
+	constexpr int32_t FOLLOW_DISTANCE = 7;
+
+	struct QuerySet {
+		std::string_view name;
+		int32_t distance;
+		int32_t maxSearchDist;
+		std::vector<std::pair<Position, Position>> queries;
+	};
+
+	std::filesystem::path mapPath() {
+		const auto* path = std::getenv("CANARY_BENCHMARK_MAP");
+		return path ? std::filesystem::path(path) : std::filesystem::path(DEFAULT_MAP);
+	}
+
+	// Pathfinding limits are read from the config, the benchmark runs with the defaults
+	void loadConfig() {
+		const auto path = std::filesystem::temp_directory_path() / "canary_pathfinding_benchmark.lua";
+		std::ofstream(path) << "pathfindingMaxNodes = 512\npathfindingMaxExpandedNodes = 100\n";
+		g_configManager().setConfigFileLua(path.string());
+		g_configManager().load();
+		std::filesystem::remove(path);
+	}
+
+	// Walls of random length on a grass field, when the real map is not around.
+	// Only the routes, which read the block bitmaps, get a ground: the A*
+	// queries keep running on the bare tiles they always measured.
+	void generateTerrain(Map &map, bool withGround = false) {
+		auto ground = std::make_shared<BasicTile>();
+		if (withGround) {
+			ground->ground = std::make_shared<BasicItem>();
+			ground->ground->id = tests::TestItems::GROUND;
+		}
+		std::mt19937 generator(AREA_SIZE);
+
+		std::vector<bool> walls(AREA_SIZE * AREA_SIZE);
+		for (int i = 0; i < AREA_SIZE * AREA_SIZE / 64; ++i) {
+			const auto horizontal = generator() % 2 == 0;
+			const auto length = 3 + generator() % 12;
+			auto x = generator() % AREA_SIZE;
+			auto y = generator() % AREA_SIZE;
+			for (uint32_t step = 0; step < length && x < AREA_SIZE && y < AREA_SIZE; ++step) {
+				walls[y * AREA_SIZE + x] = true;
+				(horizontal ? x : y) += 1;
+			}
+		}
+
+		for (uint16_t y = 0; y < AREA_SIZE; ++y) {
+			for (uint16_t x = 0; x < AREA_SIZE; ++x) {
+				if (!walls[y * AREA_SIZE + x]) {
+					map.setBasicTile(AREA_START_X + x, AREA_START_Y + y, AREA_Z, ground);
+				}
+			}
+		}
+		map.flush();
+	}
+
+	uint32_t getPathCost(const std::vector<Direction> &dirList) {
+		uint32_t cost = 0;
+		for (const auto dir : dirList) {
+			cost += (dir & DIRECTION_DIAGONAL_MASK) != 0 ? FlowField::DIAGONAL_COST : FlowField::NORMAL_COST;
+		}
+		return cost;
+	}
+
+	// Pairs of tiles at the given distance, both walkable for a query without creature
+	std::vector<std::pair<Position, Position>> generateQueries(const std::function<bool(const Position &)> &isWalkable, int32_t distance, size_t count = QUERIES_PER_DISTANCE) {
+		std::mt19937 generator(distance);
+		std::uniform_int_distribution<int32_t> coordinate(distance, AREA_SIZE - distance - 1);
+		std::uniform_int_distribution<int32_t> offset(-distance, distance);
+
+		std::vector<std::pair<Position, Position>> queries;
+		while (queries.size() < count) {
+			const Position start(AREA_START_X + coordinate(generator), AREA_START_Y + coordinate(generator), AREA_Z);
+			Position target = start;
+			if (generator() % 2 == 0) {
+				target.x += generator() % 2 == 0 ? distance : -distance;
+				target.y += offset(generator);
+			} else {
+				target.x += offset(generator);
+				target.y += generator() % 2 == 0 ? distance : -distance;
+			}
+
+			if (isWalkable(start) && isWalkable(target)) {
+				queries.emplace_back(start, target);
+			}
+		}
+		return queries;
+	}
+}
+
+suite<"benchmark"> pathfindingBenchmark = [] {
+	test("Map::getPathMatching canonical queries") = [] {
+		loadConfig();
+		tests::TestItems::install();
+
+		const auto map = std::make_unique<Map>();
+		const auto path = mapPath();
+		if (std::filesystem::exists(path)) {
+			fmt::print("[pathfinding] {}, only the test item types loaded: every tile is walkable\n", path.string());
+			map->load(path.string());
+		} else {
+			fmt::print("[pathfinding] {} not found, using generated terrain (set CANARY_BENCHMARK_MAP)\n", path.string());
+			generateTerrain(*map);
+		}
+
+		// Monster chase on screen, a chase across the screen and a route bounded like npcs use
+		std::array<QuerySet, 3> sets = {
+			QuerySet { "chase 5 sqm", 5, 0, {} },
+			QuerySet { "chase 12 sqm", 12, 0, {} },
+			QuerySet { "route 40 sqm", 40, 60, {} },
+		};
+
+		for (auto &set : sets) {
+			set.queries = generateQueries([&map](const Position &pos) { return map->getTile(pos) != nullptr; }, set.distance);
+
+			FindPathParams fpp;
+			fpp.clearSight = false;
+			fpp.maxSearchDist = set.maxSearchDist;
+			fpp.maxTargetDist = 1;
+
+			size_t found = 0;
+			size_t steps = 0;
+			std::vector<Direction> dirList;
+			const auto closedNodes = AStarNodes::getThreadClosedNodes();
+
+			Benchmark bm;
+			for (size_t round = 0; round < ROUNDS; ++round) {
+				for (const auto &[start, target] : set.queries) {
+					dirList.clear();
+					if (map->getPathMatching(start, dirList, FrozenPathingConditionCall(target), fpp)) {
+						++found;
+						steps += dirList.size();
+					}
+				}
+			}
+			const auto ms = bm.duration();
+
+			const auto queries = set.queries.size() * ROUNDS;
+			fmt::print(
+				"[pathfinding] {}: {:.1f} ns/query, {:.1f} nodes expanded/query, {:.1f}% found, {:.1f} steps/path\n",
+				set.name, ms * 1'000'000.0 / queries, static_cast<double>(AStarNodes::getThreadClosedNodes() - closedNodes) / queries,
+				found * 100.0 / queries, found ? static_cast<double>(steps) / found : 0.0
+			);
+			expect(gt(found, 0u));
+		}
+	};
+
+	test("Map::getRoute long routes") = [] {
+		tests::TestItems::install();
+		const auto map = std::make_unique<Map>();
+		const auto path = mapPath();
+		if (std::filesystem::exists(path)) {
+			fmt::print("[route] {}, only the test item types loaded: only missing tiles block\n", path.string());
+			map->load(path.string());
+		} else {
+			fmt::print("[route] {} not found, using generated terrain (set CANARY_BENCHMARK_MAP)\n", path.string());
+			generateTerrain(*map, true);
+		}
+
+		// Routes only read the block bitmaps, the tiles are never created
+		const auto isWalkable = [&map](const Position &pos) {
+			return !map->isBlocking(pos.x, pos.y, pos.z, TILE_BLOCK_SOLID);
+		};
+
+		FindPathParams fpp;
+		fpp.minTargetDist = 0;
+		fpp.maxTargetDist = 0;
+
+		for (const int32_t distance : { 100, 190 }) {
+			const auto queries = generateQueries(isWalkable, distance, QUERIES_PER_DISTANCE / 10);
+
+			// The first round builds the clusters, the second one reads them
+			for (const std::string_view round : { "cold", "warm" }) {
+				size_t found = 0;
+				size_t steps = 0;
+				std::vector<Direction> dirList;
+
+				Benchmark bm;
+				for (const auto &[start, target] : queries) {
+					dirList.clear();
+					if (map->getRoute(start, target, dirList, fpp)) {
+						++found;
+						steps += dirList.size();
+					}
+				}
+				const auto ms = bm.duration();
+
+				fmt::print(
+					"[route] {} sqm, {}: {:.1f} us/query, {:.1f}% found, {:.1f} steps/path\n",
+					distance, round, ms * 1'000.0 / queries.size(), found * 100.0 / queries.size(), found ? static_cast<double>(steps) / found : 0.0
+				);
+				expect(gt(found, 0u));
+			}
+		}
+	};
+
+	test("FlowField against one A* search per follower") = [] {
+		loadConfig();
+		tests::TestItems::install();
+
+		// The field only floods tiles with a ground, the real map would need its item types
+		const auto map = std::make_unique<Map>();
+		generateTerrain(*map, true);
+
+		const auto isWalkable = [&map](const Position &pos) {
+			return !map->isBlocking(pos.x, pos.y, pos.z, TILE_BLOCK_SOLID);
+		};
+		// Every query is a follower, the ones of a group chase the target of the first one
+		auto queries = generateQueries(isWalkable, FOLLOW_DISTANCE, QUERIES_PER_DISTANCE / 10 * FOLLOWERS);
+		for (size_t group = 0; group < queries.size(); group += FOLLOWERS) {
+			for (size_t i = group + 1; i < std::min(group + FOLLOWERS, queries.size()); ++i) {
+				// Same offset from the shared target, where that one is walkable
+				auto &[start, target] = queries[i];
+				const Position moved(queries[group].second.x + start.x - target.x, queries[group].second.y + start.y - target.y, AREA_Z);
+				start = isWalkable(moved) ? moved : queries[group].first;
+				target = queries[group].second;
+			}
+		}
+
+		FindPathParams fpp;
+		fpp.clearSight = false;
+		fpp.minTargetDist = 1;
+		fpp.maxTargetDist = 1;
+
+		size_t searchFound = 0;
+		size_t searchCost = 0;
+		std::vector<Direction> dirList;
+		Benchmark searchBm;
+		for (size_t group = 0; group + FOLLOWERS <= queries.size(); group += FOLLOWERS) {
+			for (size_t i = group; i < group + FOLLOWERS; ++i) {
+				dirList.clear();
+				if (map->getPathMatching(queries[i].first, dirList, FrozenPathingConditionCall(queries[i].second), fpp)) {
+					++searchFound;
+					searchCost += getPathCost(dirList);
+				}
+			}
+		}
+		const auto searchMs = searchBm.duration();
+
+		size_t flowFound = 0;
+		size_t flowCost = 0;
+		Benchmark flowBm;
+		for (size_t group = 0; group + FOLLOWERS <= queries.size(); group += FOLLOWERS) {
+			const auto &target = queries[group].second;
+			const FlowField field(*map, target, 0);
+			for (size_t i = group; i < group + FOLLOWERS; ++i) {
+				dirList.clear();
+				if (field.getPath(queries[i].first, dirList, isWalkable)) {
+					++flowFound;
+					flowCost += getPathCost(dirList);
+				}
+			}
+		}
+		const auto flowMs = flowBm.duration();
+
+		const auto groups = queries.size() / FOLLOWERS;
+		fmt::print(
+			"[flowfield] {} followers: A* {:.1f} us/target, {:.1f}% found, {:.1f} cost/path; field {:.1f} us/target, {:.1f}% found, {:.1f} cost/path\n",
+			FOLLOWERS, searchMs * 1'000.0 / groups, searchFound * 100.0 / queries.size(), searchFound ? static_cast<double>(searchCost) / searchFound : 0.0,
+			flowMs * 1'000.0 / groups, flowFound * 100.0 / queries.size(), flowFound ? static_cast<double>(flowCost) / flowFound : 0.0
+		);
+		expect(gt(flowFound, 0u));
+	};
+};
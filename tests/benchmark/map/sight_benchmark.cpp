@@ -0,0 +1,102 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "items/test_items.hpp"
+#include "map/map.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr std::string_view DEFAULT_MAP = "data-otservbr-global/world/otservbr.otbm";
+
+	// Thais, same area as the pathfinding benchmark
+	constexpr uint16_t AREA_START_X = 32'200;
+	constexpr uint16_t AREA_START_Y = 32'100;
+	constexpr uint16_t AREA_SIZE = 400;
+	constexpr uint8_t AREA_Z = MAP_INIT_SURFACE_LAYER;
+
+	constexpr size_t QUERIES = 20'000;
+	constexpr size_t ROUNDS = 20;
+
+	std::filesystem::path mapPath() {
+		const auto* path = std::getenv("CANARY_BENCHMARK_MAP");
+		return path ? std::filesystem::path(path) : std::filesystem::path(DEFAULT_MAP);
+	}
+
+	// A grass field with holes, when the real map is not around
+	void generateTerrain(Map &map) {
+		auto ground = std::make_shared<BasicTile>();
+		std::mt19937 generator(AREA_SIZE);
+		for (uint16_t y = 0; y < AREA_SIZE; ++y) {
+			for (uint16_t x = 0; x < AREA_SIZE; ++x) {
+				if (generator() % 16 != 0) {
+					map.setBasicTile(AREA_START_X + x, AREA_START_Y + y, AREA_Z, ground);
+				}
+			}
+		}
+		map.flush();
+	}
+
+	// Spell and distance attack ranges, horizontal, vertical and diagonal lines alike
+	std::vector<std::pair<Position, Position>> generateQueries() {
+		std::mt19937 generator(QUERIES);
+		std::uniform_int_distribution<int32_t> coordinate(MAP_MAX_VIEW_PORT_X, AREA_SIZE - MAP_MAX_VIEW_PORT_X - 1);
+		std::uniform_int_distribution<int32_t> offset(-MAP_MAX_VIEW_PORT_X, MAP_MAX_VIEW_PORT_X);
+
+		std::vector<std::pair<Position, Position>> queries;
+		queries.reserve(QUERIES);
+		while (queries.size() < QUERIES) {
+			const Position from(AREA_START_X + coordinate(generator), AREA_START_Y + coordinate(generator), AREA_Z);
+			Position to = from;
+			switch (generator() % 3) {
+				case 0:
+					to.x += offset(generator);
+					break;
+				case 1:
+					to.y += offset(generator);
+					break;
+				default:
+					to.x += offset(generator);
+					to.y += offset(generator);
+					break;
+			}
+			queries.emplace_back(from, to);
+		}
+		return queries;
+	}
+}
+
+suite<"benchmark"> sightBenchmark = [] {
+	test("Map::isSightClear on screen lines") = [] {
+		tests::TestItems::install();
+		const auto map = std::make_unique<Map>();
+		const auto path = mapPath();
+		if (std::filesystem::exists(path)) {
+			fmt::print("[sight] {}, only the test item types loaded: no tile blocks projectiles\n", path.string());
+			map->load(path.string());
+		} else {
+			fmt::print("[sight] {} not found, using generated terrain (set CANARY_BENCHMARK_MAP)\n", path.string());
+			generateTerrain(*map);
+		}
+
+		const auto queries = generateQueries();
+		for (const bool floorCheck : { false, true }) {
+			size_t clear = 0;
+			Benchmark bm;
+			for (size_t round = 0; round < ROUNDS; ++round) {
+				for (const auto &[from, to] : queries) {
+					clear += map->isSightClear(from, to, floorCheck) ? 1 : 0;
+				}
+			}
+			const auto ms = bm.duration();
+
+			const auto total = queries.size() * ROUNDS;
+			fmt::print(
+				"[sight] floorCheck={}: {:.1f} ns/query, {:.1f}% clear\n",
+				floorCheck, ms * 1'000'000.0 / total, clear * 100.0 / total
+			);
+			expect(gt(clear, 0u));
+		}
+	};
+};
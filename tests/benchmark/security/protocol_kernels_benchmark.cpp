@@ -0,0 +1,76 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "security/xtea.hpp"
+#include "utils/adler32.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	// A full output message, the multiple of 8 XTEA expects
+	constexpr size_t MESSAGE_SIZE = 65'496;
+	constexpr size_t XTEA_ROUNDS = 200;
+	constexpr size_t ADLER_ROUNDS = 5'000;
+	constexpr XTEA::Key KEY = { 0x12345678, 0x9ABCDEF0, 0x0BADF00D, 0xDEADBEEF };
+
+	std::vector<uint8_t> makeMessage() {
+		std::mt19937 generator(MESSAGE_SIZE);
+		std::vector<uint8_t> message(MESSAGE_SIZE);
+		std::ranges::generate(message, [&generator] { return static_cast<uint8_t>(generator()); });
+		return message;
+	}
+
+	std::vector<SimdLevel> getLevels() {
+		std::vector<SimdLevel> levels;
+		for (const auto level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+			if (level <= getSimdLevel()) {
+				levels.emplace_back(level);
+			}
+		}
+		return levels;
+	}
+
+	void report(std::string_view kernel, SimdLevel level, double ms, size_t bytes, double scalarMs) {
+		fmt::print(
+			"[{}] {}: {:.2f} GB/s ({:.1f}x scalar)\n",
+			kernel, getSimdLevelName(level), bytes / (ms * 1'000'000.0), scalarMs / ms
+		);
+	}
+}
+
+suite<"benchmark"> protocolKernelsBenchmark = [] {
+	fmt::print("[kernels] CPU supports {}\n", getSimdLevelName(getSimdLevel()));
+
+	test("XTEA::encrypt over full messages") = [] {
+		auto message = makeMessage();
+		double scalarMs = 0;
+		for (const auto level : getLevels()) {
+			Benchmark bm;
+			for (size_t round = 0; round < XTEA_ROUNDS; ++round) {
+				XTEA::encrypt(message.data(), message.size(), KEY, level);
+			}
+			const auto ms = bm.duration();
+			scalarMs = level == SimdLevel::Scalar ? ms : scalarMs;
+			report("xtea", level, ms, MESSAGE_SIZE * XTEA_ROUNDS, scalarMs);
+		}
+		expect(message != makeMessage());
+	};
+
+	test("Adler32::checksum over full messages") = [] {
+		const auto message = makeMessage();
+		const auto expected = Adler32::checksum(message.data(), message.size(), SimdLevel::Scalar);
+		double scalarMs = 0;
+		for (const auto level : getLevels()) {
+			uint32_t mismatches = 0;
+			Benchmark bm;
+			for (size_t round = 0; round < ADLER_ROUNDS; ++round) {
+				mismatches += Adler32::checksum(message.data(), message.size(), level) != expected ? 1 : 0;
+			}
+			const auto ms = bm.duration();
+			scalarMs = level == SimdLevel::Scalar ? ms : scalarMs;
+			report("adler32", level, ms, MESSAGE_SIZE * ADLER_ROUNDS, scalarMs);
+			expect(eq(0u, mismatches));
+		}
+	};
+};
@@ -0,0 +1,125 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "utils/lru_set.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	// Limit of the client creature cache, see ProtocolGame::knownCreatureSet
+	constexpr uint32_t KNOWN_LIMIT = 1'300;
+	constexpr uint32_t EVICTION_PROBES = 128;
+	constexpr uint32_t SIGHTINGS = 5'000;
+	// Creatures seen in the last VISIBLE_WINDOW sightings are still on screen
+	constexpr uint32_t VISIBLE_WINDOW = 1'250;
+	// Creatures already on screen that are sent again per new sighting
+	constexpr uint32_t RESIGHTINGS = 8;
+	constexpr size_t ROUNDS = 20;
+
+	struct Sighting {
+		uint32_t id;
+		uint32_t tick;
+	};
+
+	// Ids are handed out in sighting order, on a busy street every step shows a new creature
+	std::vector<Sighting> makeSightings() {
+		std::mt19937 generator(SIGHTINGS);
+		std::vector<Sighting> sightings;
+		sightings.reserve(SIGHTINGS * (RESIGHTINGS + 1));
+		for (uint32_t tick = 1; tick <= SIGHTINGS; ++tick) {
+			sightings.push_back({ tick, tick });
+			for (uint32_t i = 0; i < RESIGHTINGS; ++i) {
+				const auto back = std::min(tick, VISIBLE_WINDOW);
+				sightings.push_back({ tick - static_cast<uint32_t>(generator() % back), tick });
+			}
+		}
+		return sightings;
+	}
+
+	// Known creature set as it was before the LRU, kept to compare evictions
+	struct LegacyKnownSet {
+		template <typename Predicate>
+		uint32_t check(uint32_t id, Predicate &&canEvict) {
+			if (!set.insert(id).second) {
+				return 0;
+			}
+			if (set.size() <= KNOWN_LIMIT) {
+				return 0;
+			}
+			for (auto it = set.begin(); it != set.end(); ++it) {
+				if (*it != id && canEvict(*it)) {
+					const auto removed = *it;
+					set.erase(it);
+					return removed;
+				}
+			}
+			auto it = set.begin();
+			if (*it == id) {
+				++it;
+			}
+			const auto removed = *it;
+			set.erase(it);
+			return removed;
+		}
+
+		std::unordered_set<uint32_t> set;
+	};
+
+	struct Result {
+		double ms = 0;
+		uint64_t probes = 0;
+		uint64_t evictions = 0;
+		uint64_t visibleEvictions = 0;
+	};
+
+	template <typename Check>
+	Result run(const std::vector<Sighting> &sightings, Check &&check) {
+		Result result;
+		Benchmark bm;
+		for (size_t round = 0; round < ROUNDS; ++round) {
+			for (const auto &[id, tick] : sightings) {
+				const auto isVisible = [tick](uint32_t known) { return known + VISIBLE_WINDOW > tick; };
+				const auto removed = check(round, id, [&](uint32_t known) {
+					++result.probes;
+					return !isVisible(known);
+				});
+				if (removed != 0) {
+					++result.evictions;
+					result.visibleEvictions += isVisible(removed) ? 1 : 0;
+				}
+			}
+		}
+		result.ms = bm.duration();
+		return result;
+	}
+
+	void report(std::string_view name, const Result &result) {
+		fmt::print(
+			"[known creatures] {}: {:.2f} ms, {} probes, {} evictions ({} of visible creatures)\n",
+			name, result.ms, result.probes, result.evictions, result.visibleEvictions
+		);
+	}
+}
+
+suite<"benchmark"> lruSetBenchmark = [] {
+	test("LRUSet against a scanned set for 5k creature sightings") = [] {
+		const auto sightings = makeSightings();
+
+		std::vector<LegacyKnownSet> legacySets(ROUNDS);
+		const auto legacy = run(sightings, [&legacySets](size_t round, uint32_t id, auto &&canEvict) {
+			return legacySets[round].check(id, canEvict);
+		});
+		report("unordered_set scan", legacy);
+
+		std::vector<LRUSet<uint32_t>> lruSets(ROUNDS, LRUSet<uint32_t>(KNOWN_LIMIT, EVICTION_PROBES));
+		const auto lru = run(sightings, [&lruSets](size_t round, uint32_t id, auto &&canEvict) {
+			return lruSets[round].insert(id, canEvict).evicted.value_or(0);
+		});
+		report("LRUSet", lru);
+
+		expect(eq(lru.evictions, legacy.evictions));
+		expect(lru.probes < legacy.probes);
+		expect(eq(lru.visibleEvictions, 0u));
+	};
+};
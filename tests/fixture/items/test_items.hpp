@@ -0,0 +1,64 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+#pragma once
+
+#include "items/item.hpp"
+
+namespace tests {
+	/**
+	 * A few item types registered in place of appearances.dat, for the tests building tiles.
+	 * Ids without a type here read as type 0, which blocks nothing.
+	 */
+	struct TestItems {
+		static constexpr uint16_t GROUND = 1;
+		// Blocks creatures, paths and projectiles, never moves
+		static constexpr uint16_t WALL = 2;
+		// Blocks creatures but can be pushed away
+		static constexpr uint16_t BOX = 3;
+		// Takes whoever steps on it to the floor above
+		static constexpr uint16_t STAIRS = 4;
+		// Shows the outfit or monster kept in its custom attributes
+		static constexpr uint16_t PODIUM = 5;
+		static constexpr uint16_t LAST = PODIUM;
+
+		static void install() {
+			auto &items = Item::items.getItems();
+			items.clear();
+			items.resize(LAST + 1);
+
+			auto &ground = add(items, GROUND, "grass");
+			ground.group = ITEM_GROUP_GROUND;
+
+			auto &wall = add(items, WALL, "stone wall");
+			wall.blockSolid = true;
+			wall.blockPathFind = true;
+			wall.blockProjectile = true;
+			wall.alwaysOnTopOrder = 2;
+
+			auto &box = add(items, BOX, "box");
+			box.blockSolid = true;
+			box.movable = true;
+
+			auto &stairs = add(items, STAIRS, "stairs");
+			stairs.floorChange = TILESTATE_FLOORCHANGE_NORTH;
+			stairs.alwaysOnTopOrder = 1;
+
+			auto &podium = add(items, PODIUM, "podium");
+			podium.isPodium = true;
+		}
+
+	private:
+		static ItemType &add(std::vector<ItemType> &items, uint16_t id, std::string name) {
+			auto &it = items[id];
+			it.id = id;
+			it.name = std::move(name);
+			return it;
+		}
+	};
+}
@@ -0,0 +1,64 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "game/scheduling/dispatcher.hpp"
+#include "lib/logging/in_memory_logger.hpp"
+#include "lib/thread/thread_pool.hpp"
+
+using namespace boost::ut;
+
+suite<"scheduling"> dispatcherTest = [] {
+	test("Dispatcher::asyncWait runs every item once and returns after all of them") = [] {
+		di::extension::injector<> injector {};
+		DI::setTestContainer(&InMemoryLogger::install(injector));
+
+		ThreadPool threadPool(injector.create<Logger &>(), 4);
+		Dispatcher dispatcher(threadPool);
+
+		// Runs inline and teaches the dispatcher that items are expensive, so the next loop goes parallel
+		dispatcher.asyncWait(32, [](size_t) { std::this_thread::sleep_for(std::chrono::microseconds(200)); });
+		expect(eq(dispatcher.getParallelStats(TaskGroup::GenericParallel).runs.load(), 0u));
+
+		constexpr size_t size = 2'000;
+		std::vector<std::atomic_uint8_t> hits(size);
+		std::atomic_size_t finished = 0;
+		dispatcher.asyncWait(size, [&hits, &finished](size_t i) {
+			hits[i].fetch_add(1);
+			// Late items must still be waited for
+			std::this_thread::sleep_for(std::chrono::microseconds(20));
+			finished.fetch_add(1);
+		});
+
+		expect(eq(finished.load(), size));
+		expect(std::ranges::all_of(hits, [](const auto &hit) { return hit.load() == 1; }));
+		expect(eq(dispatcher.getParallelStats(TaskGroup::GenericParallel).runs.load(), 1u));
+		expect(eq(dispatcher.getParallelStats(TaskGroup::GenericParallel).items.load(), size));
+	};
+
+	test("Dispatcher takes events from more threads than the pool has") = [] {
+		di::extension::injector<> injector {};
+		DI::setTestContainer(&InMemoryLogger::install(injector));
+
+		ThreadPool threadPool(injector.create<Logger &>(), 2);
+		Dispatcher dispatcher(threadPool);
+
+		// Like the network shard threads, none of them is a pool thread
+		constexpr size_t count = 8;
+		std::array<int16_t, count> ids {};
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < count; ++i) {
+			threads.emplace_back([&dispatcher, &id = ids[i]] {
+				id = ThreadPool::getThreadId();
+				dispatcher.addEvent([] { }, "DispatcherTest::addEvent");
+				dispatcher.scheduleEvent(100, [] { }, "DispatcherTest::scheduleEvent");
+			});
+		}
+		for (auto &thread : threads) {
+			thread.join();
+		}
+
+		std::ranges::sort(ids);
+		expect(std::ranges::adjacent_find(ids) == ids.end());
+	};
+};
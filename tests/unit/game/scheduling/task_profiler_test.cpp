@@ -0,0 +1,60 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "game/scheduling/task_profiler.hpp"
+
+using namespace boost::ut;
+
+suite<"scheduling"> taskProfilerTest = [] {
+	test("LatencyHistogram buckets keep the relative error under 12.5%") = [] {
+		for (uint64_t value : { 0ull, 1ull, 7ull, 8ull, 9ull, 100ull, 1'234ull, 50'000ull, 3'999'999ull, LatencyHistogram::MAX_VALUE }) {
+			const auto index = LatencyHistogram::bucketIndex(value);
+			expect(lt(index, LatencyHistogram::BUCKETS));
+
+			const auto highest = LatencyHistogram::bucketHighestValue(index);
+			expect(ge(highest, value));
+			expect(le(static_cast<double>(highest - value), value / 8.0)) << "value" << value;
+		}
+	};
+
+	test("LatencyHistogram reports percentiles, average and max") = [] {
+		LatencyHistogram histogram;
+		for (uint64_t value = 1; value <= 1'000; ++value) {
+			histogram.record(value);
+		}
+
+		expect(eq(histogram.getCount(), 1'000u));
+		expect(eq(histogram.getMax(), 1'000u));
+		expect(eq(histogram.getAverage(), 500u));
+
+		const auto p50 = histogram.getPercentile(50);
+		expect(ge(p50, 500u) and le(p50, 563u));
+		expect(eq(histogram.getPercentile(100), 1'000u));
+
+		histogram.reset();
+		expect(eq(histogram.getCount(), 0u));
+		expect(eq(histogram.getPercentile(99), 0u));
+	};
+
+	test("TaskProfiler groups tasks by context and logs the slowest ones") = [] {
+		TaskProfiler profiler(std::chrono::milliseconds(50));
+		// Profiling is opt-in, the dispatcher doesn't time tasks until it is enabled
+		expect(!profiler.isEnabled());
+
+		for (int i = 0; i < 100; ++i) {
+			profiler.record("Test::fastTask", 10, 5);
+		}
+		profiler.record("Test::slowTask", 2'000, 25'000);
+
+		const auto report = profiler.report(10);
+		expect(report.find("Test::fastTask: 100 runs") != std::string::npos) << report;
+		expect(report.find("Test::slowTask: 1 runs") != std::string::npos) << report;
+		expect(report.find("Test::slowTask: exec 25.00, delay 2.00") != std::string::npos) << report;
+		// The slowest total comes first
+		expect(report.find("Test::slowTask") < report.find("Test::fastTask")) << report;
+
+		profiler.reset();
+		expect(profiler.report(10).find("runs") == std::string::npos);
+	};
+};
@@ -0,0 +1,108 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "game/scheduling/timing_wheel.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	struct WheelNode {
+		int64_t time = 0;
+		int32_t id = 0;
+		TimingWheelHook<WheelNode> timingWheelHook;
+
+		[[nodiscard]] int64_t getTime() const {
+			return time;
+		}
+	};
+
+	std::shared_ptr<WheelNode> makeNode(int64_t time, int32_t id) {
+		auto node = std::make_shared<WheelNode>();
+		node->time = time;
+		node->id = id;
+		return node;
+	}
+}
+
+suite<"scheduling"> timingWheelTest = [] {
+	constexpr int64_t start = 1'000'000;
+
+	test("TimingWheel expires nodes in time order") = [] {
+		TimingWheel<WheelNode> wheel { 50 };
+		wheel.reset(start);
+
+		const std::vector<int64_t> delays { 700, 10, 49, 50, 51, 3'200, 10, 250'000, 0 };
+		for (size_t i = 0; i < delays.size(); ++i) {
+			wheel.insert(makeNode(start + delays[i], static_cast<int32_t>(i)));
+		}
+		expect(eq(wheel.size(), delays.size()));
+
+		std::vector<int32_t> fired;
+		wheel.advance(start + 300'000, [&fired](const std::shared_ptr<WheelNode> &node) {
+			fired.emplace_back(node->id);
+		});
+
+		// Equal times keep insertion order
+		const std::vector<int32_t> expected { 8, 1, 6, 2, 3, 4, 0, 5, 7 };
+		expect(eq(fired, expected));
+		expect(wheel.empty());
+	};
+
+	test("TimingWheel does not expire nodes before their time") = [] {
+		TimingWheel<WheelNode> wheel { 50 };
+		wheel.reset(start);
+		wheel.insert(makeNode(start + 120, 1));
+
+		size_t fired = 0;
+		const auto count = [&fired](const std::shared_ptr<WheelNode> &) { ++fired; };
+
+		wheel.advance(start + 119, count);
+		expect(eq(fired, 0u));
+		expect(le(wheel.nextExpiration(), start + 120));
+
+		wheel.advance(start + 120, count);
+		expect(eq(fired, 1u));
+	};
+
+	test("TimingWheel erase removes pending and ready nodes") = [] {
+		TimingWheel<WheelNode> wheel { 50 };
+		wheel.reset(start);
+
+		const auto farNode = makeNode(start + 90'000, 1);
+		const auto nearNode = makeNode(start + 30, 2);
+		wheel.insert(farNode);
+		wheel.insert(nearNode);
+
+		// nearNode reaches the ready heap but is not due yet
+		wheel.advance(start + 10, [](const std::shared_ptr<WheelNode> &) { });
+
+		expect(wheel.erase(farNode.get()));
+		expect(wheel.erase(nearNode.get()));
+		expect(!wheel.erase(nearNode.get()));
+		expect(wheel.empty());
+
+		size_t fired = 0;
+		wheel.advance(start + 100'000, [&fired](const std::shared_ptr<WheelNode> &) { ++fired; });
+		expect(eq(fired, 0u));
+	};
+
+	test("TimingWheel defers nodes inserted while advancing") = [] {
+		TimingWheel<WheelNode> wheel { 50 };
+		wheel.reset(start);
+		wheel.insert(makeNode(start, 1));
+
+		size_t fired = 0;
+		const auto rearm = [&wheel, &fired](const std::shared_ptr<WheelNode> &node) {
+			++fired;
+			wheel.insert(node);
+		};
+
+		wheel.advance(start, rearm);
+		expect(eq(fired, 1u));
+		expect(eq(wheel.size(), 1u));
+
+		wheel.advance(start, rearm);
+		expect(eq(fired, 2u));
+	};
+};
@@ -0,0 +1,65 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "game/scheduling/work_stealing.hpp"
+
+using namespace boost::ut;
+
+suite<"scheduling"> workStealingTest = [] {
+	test("WorkStealingRanges pops its own range in chunks") = [] {
+		WorkStealingRanges ranges { 2, 10 };
+		uint32_t begin = 0, end = 0;
+
+		expect(ranges.pop(0, 3, begin, end));
+		expect(eq(begin, 0u) and eq(end, 3u));
+		expect(ranges.pop(0, 3, begin, end));
+		expect(eq(begin, 3u) and eq(end, 5u));
+		expect(!ranges.pop(0, 3, begin, end));
+
+		expect(ranges.pop(1, 10, begin, end));
+		expect(eq(begin, 5u) and eq(end, 10u));
+	};
+
+	test("WorkStealingRanges steals the back half of another range") = [] {
+		WorkStealingRanges ranges { 2, 8 };
+		uint32_t begin = 0, end = 0;
+
+		expect(ranges.pop(0, 4, begin, end));
+		expect(ranges.steal(0));
+		expect(ranges.pop(0, 4, begin, end));
+		expect(eq(begin, 6u) and eq(end, 8u));
+
+		expect(ranges.pop(1, 4, begin, end));
+		expect(eq(begin, 4u) and eq(end, 6u));
+		expect(!ranges.steal(0));
+	};
+
+	test("WorkStealingRanges runs every index once when a participant never shows up") = [] {
+		constexpr uint32_t size = 20'000;
+		constexpr size_t participants = 4;
+		WorkStealingRanges ranges { participants, size };
+		std::vector<std::atomic_uint8_t> hits(size);
+
+		std::vector<std::thread> threads;
+		// The last participant never runs, its range must be stolen
+		for (size_t participant = 0; participant < participants - 1; ++participant) {
+			threads.emplace_back([&ranges, &hits, participant] {
+				uint32_t begin = 0, end = 0;
+				do {
+					while (ranges.pop(participant, 16, begin, end)) {
+						for (auto i = begin; i < end; ++i) {
+							hits[i].fetch_add(1);
+						}
+					}
+				} while (ranges.steal(participant));
+			});
+		}
+
+		for (auto &thread : threads) {
+			thread.join();
+		}
+
+		expect(std::ranges::all_of(hits, [](const auto &hit) { return hit.load() == 1; }));
+	};
+};
@@ -0,0 +1,102 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "io/iomap_snapshot.hpp"
+#include "items/test_items.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	std::shared_ptr<BasicItem> makeItem(uint16_t id, std::string text = {}) {
+		auto item = std::make_shared<BasicItem>();
+		item->id = id;
+		item->text = std::move(text);
+		return item;
+	}
+
+	std::filesystem::path snapshotPath(std::string_view name) {
+		return std::filesystem::temp_directory_path() / fmt::format("canary_{}_{}.snapshot", name, std::chrono::steady_clock::now().time_since_epoch().count());
+	}
+}
+
+suite<"io"> mapSnapshotTest = [] {
+	test("IOMapSnapshot restores the tiles written by MapSnapshotWriter") = [] {
+		tests::TestItems::install();
+
+		const auto chest = makeItem(2000);
+		chest->items.emplace_back(makeItem(3031));
+		chest->items.emplace_back(makeItem(2817, "a letter"));
+
+		auto tile = std::make_shared<BasicTile>();
+		tile->ground = makeItem(102);
+		tile->items.emplace_back(chest);
+		tile->flags = TILESTATE_PROTECTIONZONE;
+
+		auto house = std::make_shared<BasicTile>();
+		house->ground = tile->ground;
+		house->houseId = 7;
+
+		MapSnapshotWriter writer;
+		for (uint16_t x = 100; x < 164; ++x) {
+			writer.addTile(x, 200, 7, tile);
+		}
+		writer.addTile(100, 201, 7, house);
+		writer.addHouse(7);
+
+		Map source;
+		source.towns.getOrCreateTown(1)->setName("Thais");
+		source.waypoints["temple"] = Position(100, 200, 7);
+
+		const auto path = snapshotPath("roundtrip");
+		expect(writer.save(source, path, 42));
+
+		Map map;
+		expect(IOMapSnapshot::load(&map, path, 42));
+		std::filesystem::remove(path);
+
+		const auto stats = map.getMemoryStats();
+		expect(eq(stats.cachedTiles, 65u));
+		expect(eq(stats.basicTiles, 2u));
+		expect(map.houses.getHouse(7) != nullptr);
+		expect(eq(map.towns.getTown(1)->getName(), std::string("Thais")));
+		expect(map.waypoints.at("temple") == Position(100, 200, 7));
+	};
+
+	test("IOMapSnapshot ignores a snapshot of other sources") = [] {
+		tests::TestItems::install();
+
+		MapSnapshotWriter writer;
+		writer.addTile(100, 200, 7, std::make_shared<BasicTile>());
+
+		Map source;
+		const auto path = snapshotPath("stale");
+		expect(writer.save(source, path, 1));
+
+		Map map;
+		expect(!IOMapSnapshot::load(&map, path, 2));
+		expect(eq(map.getMemoryStats().cachedTiles, 0u));
+		std::filesystem::remove(path);
+	};
+
+	test("IOMapSnapshot rejects a truncated snapshot") = [] {
+		tests::TestItems::install();
+
+		MapSnapshotWriter writer;
+		auto tile = std::make_shared<BasicTile>();
+		tile->ground = makeItem(102);
+		for (uint16_t x = 100; x < 200; ++x) {
+			writer.addTile(x, 200, 7, tile);
+		}
+
+		Map source;
+		const auto path = snapshotPath("truncated");
+		expect(writer.save(source, path, 1));
+		std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+
+		Map map;
+		expect(!IOMapSnapshot::load(&map, path, 1));
+		expect(eq(map.getMemoryStats().cachedTiles, 0u));
+		std::filesystem::remove(path);
+	};
+};
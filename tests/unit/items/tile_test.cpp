@@ -0,0 +1,101 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "items/test_items.hpp"
+#include "items/tile.hpp"
+#include "map/map.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr uint16_t TILE_X = 1'000;
+	constexpr uint16_t TILE_Y = 1'000;
+	constexpr uint8_t TILE_Z = 7;
+
+	std::unique_ptr<Map> createMap() {
+		tests::TestItems::install();
+		auto map = std::make_unique<Map>();
+		auto basicTile = std::make_shared<BasicTile>();
+		basicTile->ground = std::make_shared<BasicItem>();
+		basicTile->ground->id = tests::TestItems::GROUND;
+		map->setBasicTile(TILE_X, TILE_Y, TILE_Z, basicTile);
+		map->flush();
+		return map;
+	}
+
+	uint8_t getCellBlocks(const Map &map) {
+		return map.getMapSector(TILE_X, TILE_Y)->getFloor(TILE_Z)->getBlocks(TILE_X, TILE_Y);
+	}
+
+	// What the same tile would block if it were loaded with these items
+	uint8_t getTemplateBlocks(std::initializer_list<uint16_t> itemIds) {
+		BasicTile basicTile;
+		basicTile.ground = std::make_shared<BasicItem>();
+		basicTile.ground->id = tests::TestItems::GROUND;
+		for (const auto id : itemIds) {
+			auto &item = basicTile.items.emplace_back(std::make_shared<BasicItem>());
+			item->id = id;
+		}
+		return MapCache::getBlocks(basicTile);
+	}
+}
+
+suite<"items"> tileTest = [] {
+	test("Tile updates the block bitmaps as blocking items come and go") = [] {
+		const auto map = createMap();
+		const auto tile = map->getTile(TILE_X, TILE_Y, TILE_Z);
+		expect(eq(getCellBlocks(*map), TILE_BLOCK_NONE));
+		const auto version = map->getWalkVersion(TILE_X, TILE_Y, TILE_Z);
+
+		const auto wall = Item::CreateItem(tests::TestItems::WALL);
+		tile->addThing(wall);
+		expect(eq(getCellBlocks(*map), TILE_BLOCK_SOLID | TILE_BLOCK_PROJECTILE));
+		expect(eq(getCellBlocks(*map), getTemplateBlocks({ tests::TestItems::WALL })));
+		expect(map->isBlocking(TILE_X, TILE_Y, TILE_Z, TILE_BLOCK_SOLID));
+		expect(eq(map->getWalkVersion(TILE_X, TILE_Y, TILE_Z), version + 1));
+
+		tile->removeThing(wall, 1);
+		expect(eq(getCellBlocks(*map), TILE_BLOCK_NONE));
+		expect(!map->isBlocking(TILE_X, TILE_Y, TILE_Z, TILE_BLOCK_SOLID));
+		expect(eq(map->getWalkVersion(TILE_X, TILE_Y, TILE_Z), version + 2));
+	};
+
+	test("Tile leaves the walk version alone for items monsters push away") = [] {
+		const auto map = createMap();
+		const auto tile = map->getTile(TILE_X, TILE_Y, TILE_Z);
+		const auto version = map->getWalkVersion(TILE_X, TILE_Y, TILE_Z);
+
+		const auto box = Item::CreateItem(tests::TestItems::BOX);
+		tile->addThing(box);
+		expect(eq(getCellBlocks(*map), TILE_BLOCK_NONE));
+		expect(eq(getCellBlocks(*map), getTemplateBlocks({ tests::TestItems::BOX })));
+		expect(eq(map->getWalkVersion(TILE_X, TILE_Y, TILE_Z), version));
+		expect(tile->hasFlag(TILESTATE_BLOCKSOLID));
+	};
+
+	test("Tile updates the block bitmaps when an item transforms") = [] {
+		const auto map = createMap();
+		const auto tile = map->getTile(TILE_X, TILE_Y, TILE_Z);
+		const auto version = map->getWalkVersion(TILE_X, TILE_Y, TILE_Z);
+
+		const auto item = Item::CreateItem(tests::TestItems::BOX);
+		tile->addThing(item);
+
+		tile->updateThing(item, tests::TestItems::WALL, 0);
+		expect(eq(getCellBlocks(*map), getTemplateBlocks({ tests::TestItems::WALL })));
+		const auto wallVersion = map->getWalkVersion(TILE_X, TILE_Y, TILE_Z);
+		expect(gt(wallVersion, version));
+
+		// Solid gone, path blocked instead
+		tile->updateThing(item, tests::TestItems::STAIRS, 0);
+		expect(eq(getCellBlocks(*map), TILE_BLOCK_PATH));
+		expect(eq(getCellBlocks(*map), getTemplateBlocks({ tests::TestItems::STAIRS })));
+		const auto stairsVersion = map->getWalkVersion(TILE_X, TILE_Y, TILE_Z);
+		expect(gt(stairsVersion, wallVersion));
+
+		tile->updateThing(item, tests::TestItems::BOX, 0);
+		expect(eq(getCellBlocks(*map), TILE_BLOCK_NONE));
+		expect(gt(map->getWalkVersion(TILE_X, TILE_Y, TILE_Z), stairsVersion));
+	};
+};
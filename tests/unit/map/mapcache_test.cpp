@@ -0,0 +1,64 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "items/test_items.hpp"
+#include "items/tile.hpp"
+#include "map/map.hpp"
+#include "utils/tools.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr uint16_t TILE_X = 1'000;
+	constexpr uint16_t TILE_Y = 1'000;
+	constexpr uint8_t TILE_Z = 7;
+
+	std::unique_ptr<Map> createMap() {
+		tests::TestItems::install();
+		auto map = std::make_unique<Map>();
+		auto basicTile = std::make_shared<BasicTile>();
+		basicTile->flags = TILESTATE_PROTECTIONZONE;
+		map->setBasicTile(TILE_X, TILE_Y, TILE_Z, basicTile);
+		map->flush();
+		// Eviction reads the time cached by the dispatcher, which sectors are stamped with at creation
+		UPDATE_OTSYS_TIME();
+		return map;
+	}
+}
+
+suite<"map"> mapCacheTest = [] {
+	test("MapCache evicts unchanged tiles of idle sectors back to their template") = [] {
+		const auto map = createMap();
+		expect(map->getTile(TILE_X, TILE_Y, TILE_Z) != nullptr);
+		expect(eq(map->getMemoryStats().tiles, 1u));
+		expect(eq(map->getMemoryStats().cachedTiles, 0u));
+
+		expect(eq(map->evictIdleTiles(0), 1u));
+		expect(map->getLoadedTile(TILE_X, TILE_Y, TILE_Z) == nullptr);
+		expect(eq(map->getMemoryStats().tiles, 0u));
+		expect(eq(map->getMemoryStats().cachedTiles, 1u));
+
+		// The tile comes back from its template
+		const auto tile = map->getTile(TILE_X, TILE_Y, TILE_Z);
+		expect(tile != nullptr);
+		expect(tile->hasFlag(TILESTATE_PROTECTIONZONE));
+		expect(eq(map->getMemoryStats().tiles, 1u));
+	};
+
+	test("MapCache keeps tiles that are still referenced") = [] {
+		const auto map = createMap();
+		const auto tile = map->getTile(TILE_X, TILE_Y, TILE_Z);
+
+		expect(eq(map->evictIdleTiles(0), 0u));
+		expect(map->getLoadedTile(TILE_X, TILE_Y, TILE_Z) == tile);
+	};
+
+	test("MapCache doesn't treat sectors nobody visited as idle right away") = [] {
+		const auto map = createMap();
+		expect(map->getTile(TILE_X, TILE_Y, TILE_Z) != nullptr);
+
+		expect(eq(map->evictIdleTiles(60'000), 0u));
+		expect(eq(map->getMemoryStats().tiles, 1u));
+	};
+};
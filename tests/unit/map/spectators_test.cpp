@@ -0,0 +1,207 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "creatures/players/player.hpp"
+#include "game/game.hpp"
+#include "items/test_items.hpp"
+#include "items/tile.hpp"
+#include "map/spectators.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	// Spectators reads the game map, every test keeps to its own part of it
+	std::shared_ptr<Tile> createTile(const Position &pos) {
+		tests::TestItems::install();
+		auto &map = g_game().map;
+		auto basicTile = std::make_shared<BasicTile>();
+		basicTile->ground = std::make_shared<BasicItem>();
+		basicTile->ground->id = tests::TestItems::GROUND;
+		map.setBasicTile(pos.x, pos.y, pos.z, basicTile);
+		map.flush();
+		return map.getTile(pos);
+	}
+
+	std::shared_ptr<Player> placePlayer(const Position &pos) {
+		auto player = std::make_shared<Player>();
+		createTile(pos)->internalAddThing(player);
+		g_game().map.getMapSector(pos.x, pos.y)->addCreature(player);
+		return player;
+	}
+
+	void removePlayer(const std::shared_ptr<Player> &player) {
+		const auto pos = player->getPosition();
+		g_game().map.getMapSector(pos.x, pos.y)->removeCreature(player);
+		player->getTile()->removeThing(player, 0);
+	}
+
+	void movePlayer(const std::shared_ptr<Player> &player, const Position &newPos) {
+		const auto oldPos = player->getPosition();
+		removePlayer(player);
+		createTile(newPos)->internalAddThing(player);
+		g_game().map.getMapSector(newPos.x, newPos.y)->addCreature(player);
+		Spectators::updateSubscriptions(player, &oldPos, &newPos);
+	}
+
+	// The players the sectors around centerPos hold, as found before subscriptions
+	std::vector<Creature*> scanPlayers(const Position &centerPos) {
+		std::vector<Creature*> players;
+		for (const auto &creature : Spectators().find<Creature>(centerPos, true, 0, 0, 0, 0, false).filter<Player>()) {
+			players.emplace_back(creature.get());
+		}
+		std::ranges::sort(players);
+		return players;
+	}
+
+	std::vector<Creature*> sorted(const Spectators &spectators) {
+		std::vector<Creature*> creatures;
+		for (const auto &creature : spectators) {
+			creatures.emplace_back(creature.get());
+		}
+		std::ranges::sort(creatures);
+		return creatures;
+	}
+
+	bool isSubscriber(const Position &pos, const std::shared_ptr<Player> &player) {
+		const auto list = g_game().map.getMapSector(pos.x, pos.y)->getSubscribers();
+		return std::ranges::find(*list, player) != list->end();
+	}
+}
+
+suite<"map"> spectatorsTest = [] {
+	test("Spectators cache is read again once a creature of a sector it read changes") = [] {
+		const Position center(30'000, 30'000, 7);
+		createTile(center);
+		Spectators::clearCache();
+		const auto stats = Spectators::getCacheStats();
+
+		expect(Spectators().find<Creature>(center).empty());
+		expect(Spectators().find<Creature>(center).empty());
+		expect(eq(Spectators::getCacheStats().misses, stats.misses + 1));
+		expect(eq(Spectators::getCacheStats().hits, stats.hits + 1));
+
+		const auto player = placePlayer(Position(center.x + 3, center.y, center.z));
+		expect(eq(Spectators().find<Creature>(center).size(), 1u));
+		expect(eq(Spectators::getCacheStats().misses, stats.misses + 2));
+		expect(eq(Spectators().find<Creature>(center).size(), 1u));
+		expect(eq(Spectators::getCacheStats().hits, stats.hits + 2));
+
+		// Out of view, in a sector the lookup never read
+		const auto farPlayer = placePlayer(Position(center.x + 10 * SECTOR_SIZE, center.y, center.z));
+		expect(eq(Spectators().find<Creature>(center).size(), 1u));
+		expect(eq(Spectators::getCacheStats().hits, stats.hits + 3));
+
+		removePlayer(player);
+		expect(Spectators().find<Creature>(center).empty());
+		expect(eq(Spectators::getCacheStats().misses, stats.misses + 3));
+
+		removePlayer(farPlayer);
+	};
+
+	test("Spectators cache evicts one entry at a time, sparing the ones still read") = [] {
+		Spectators::clearCache();
+		const auto position = [](size_t index) {
+			return Position(static_cast<uint16_t>(20'000 + index % 256), static_cast<uint16_t>(20'000 + index / 256), 7);
+		};
+		for (size_t i = 0; i < Spectators::MAX_CACHE_ENTRIES; ++i) {
+			Spectators().find<Creature>(position(i));
+		}
+		expect(eq(Spectators::getCacheStats().entries, Spectators::MAX_CACHE_ENTRIES));
+
+		// Read again, the first entry gets another round
+		Spectators().find<Creature>(position(0));
+		const auto stats = Spectators::getCacheStats();
+
+		Spectators().find<Creature>(position(Spectators::MAX_CACHE_ENTRIES));
+		expect(eq(Spectators::getCacheStats().entries, Spectators::MAX_CACHE_ENTRIES));
+		expect(eq(Spectators::getCacheStats().evictions, stats.evictions + 1));
+
+		Spectators().find<Creature>(position(0));
+		expect(eq(Spectators::getCacheStats().hits, stats.hits + 1));
+		Spectators().find<Creature>(position(1));
+		expect(eq(Spectators::getCacheStats().misses, stats.misses + 2));
+
+		Spectators::clearCache();
+	};
+
+	test("Spectators::updateSubscriptions follows a player from sector to sector") = [] {
+		const Position start(36'000, 36'000, 7);
+		const auto player = placePlayer(start);
+		Spectators::updateSubscriptions(player, nullptr, &start);
+		expect(isSubscriber(start, player));
+		expect(Spectators().find<Player>(start, true).contains(player));
+
+		const Position destination(start.x + 200, start.y, start.z);
+		movePlayer(player, destination);
+		expect(!isSubscriber(start, player));
+		expect(isSubscriber(destination, player));
+		expect(Spectators().find<Player>(start, true).empty());
+		expect(Spectators().find<Player>(destination, true).contains(player));
+
+		Spectators::updateSubscriptions(player, &destination, nullptr);
+		expect(!isSubscriber(destination, player));
+		removePlayer(player);
+	};
+
+	test("Sectors created after a player subscribed have that player") = [] {
+		const Position pos(40'000, 40'000, 7);
+		const auto player = placePlayer(pos);
+		Spectators::updateSubscriptions(player, nullptr, &pos);
+
+		const Position nearby(pos.x + SECTOR_SIZE, pos.y, pos.z);
+		const Position faraway(pos.x + 5 * SECTOR_SIZE, pos.y, pos.z);
+		expect(g_game().map.getMapSector(nearby.x, nearby.y) == nullptr);
+		expect(g_game().map.getMapSector(faraway.x, faraway.y) == nullptr);
+		createTile(nearby);
+		createTile(faraway);
+
+		expect(isSubscriber(nearby, player));
+		expect(!isSubscriber(faraway, player));
+		expect(Spectators().find<Player>(nearby, true).contains(player));
+		expect(Spectators().find<Player>(faraway, true).empty());
+
+		// Left like any other sector
+		Spectators::updateSubscriptions(player, &pos, nullptr);
+		expect(!isSubscriber(nearby, player));
+		removePlayer(player);
+	};
+
+	test("Spectators borrows the subscribers of a sector when all of them see the position") = [] {
+		const Position center(44'000, 44'000, 7);
+		createTile(center);
+		std::vector<std::shared_ptr<Player>> players;
+		for (const auto &offset : { std::pair { 3, 0 }, std::pair { -5, 4 }, std::pair { 15, 0 }, std::pair { 0, -16 } }) {
+			const Position pos(center.x + offset.first, center.y + offset.second, center.z);
+			players.emplace_back(placePlayer(pos));
+			Spectators::updateSubscriptions(players.back(), nullptr, &pos);
+		}
+
+		// Two of them are subscribed to the sector without seeing the position
+		const auto subscribers = g_game().map.getMapSector(center.x, center.y)->getSubscribers();
+		expect(eq(subscribers->size(), 4u));
+		const auto filtered = Spectators().find<Player>(center, true);
+		expect(eq(filtered.size(), 2u));
+		expect(sorted(filtered) == scanPlayers(center));
+
+		for (const auto &player : { players[2], players[3] }) {
+			const auto pos = player->getPosition();
+			Spectators::updateSubscriptions(player, &pos, nullptr);
+			removePlayer(player);
+		}
+		const auto borrowed = Spectators().find<Player>(center, true);
+		expect(&borrowed.data() == g_game().map.getMapSector(center.x, center.y)->getSubscribers().get());
+		expect(sorted(borrowed) == scanPlayers(center));
+
+		// The borrowed list stays as it was while the sector moves on
+		const auto pos = players[0]->getPosition();
+		Spectators::updateSubscriptions(players[0], &pos, nullptr);
+		expect(eq(borrowed.size(), 2u));
+		expect(eq(g_game().map.getMapSector(center.x, center.y)->getSubscribers()->size(), 1u));
+
+		removePlayer(players[0]);
+		const auto lastPos = players[1]->getPosition();
+		Spectators::updateSubscriptions(players[1], &lastPos, nullptr);
+		removePlayer(players[1]);
+	};
+};
@@ -0,0 +1,69 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "map/utils/astarnodes.hpp"
+
+using namespace boost::ut;
+
+suite<"map"> astarNodesTest = [] {
+	test("AStarNodes returns the cheapest open node, oldest first on ties") = [] {
+		const auto nodes = AStarNodes::acquire(100, 100, 0, 16);
+		auto* start = nodes->getBestNode();
+		expect(nodes->createOpenNode(start, 101, 100, 30, 10, 0));
+		expect(nodes->createOpenNode(start, 99, 100, 10, 5, 0));
+		expect(nodes->createOpenNode(start, 100, 101, 5, 10, 0));
+		nodes->closeNode(start);
+
+		auto* best = nodes->getBestNode();
+		expect(eq(best->x, 99) and eq(best->y, 100));
+		nodes->closeNode(best);
+
+		best = nodes->getBestNode();
+		expect(eq(best->x, 100) and eq(best->y, 101));
+		nodes->closeNode(best);
+
+		best = nodes->getBestNode();
+		expect(eq(best->x, 101));
+		nodes->closeNode(best);
+
+		expect(nodes->getBestNode() == nullptr);
+		expect(eq(nodes->getClosedNodes(), 4));
+	};
+
+	test("AStarNodes moves a node up when a cheaper parent is found") = [] {
+		const auto nodes = AStarNodes::acquire(100, 100, 0, 16);
+		auto* start = nodes->getBestNode();
+		expect(nodes->createOpenNode(start, 101, 100, 50, 0, 0));
+		expect(nodes->createOpenNode(start, 99, 100, 20, 0, 0));
+
+		auto* expensive = nodes->getNodeByPosition(101, 100);
+		expensive->f = 10;
+		nodes->openNode(expensive);
+		nodes->closeNode(start);
+		expect(nodes->getBestNode() == expensive);
+
+		// Reopening a closed node puts it back in the open list
+		nodes->closeNode(expensive);
+		expect(eq(nodes->getClosedNodes(), 2));
+		nodes->openNode(start);
+		expect(eq(nodes->getClosedNodes(), 1));
+		expect(nodes->getBestNode() == start);
+	};
+
+	test("AStarNodes honours the node limit and starts clean when reused") = [] {
+		{
+			const auto nodes = AStarNodes::acquire(100, 100, 0, 3);
+			auto* start = nodes->getBestNode();
+			expect(nodes->createOpenNode(start, 101, 100, 10, 0, 0));
+			expect(nodes->createOpenNode(start, 102, 100, 10, 0, 0));
+			expect(!nodes->createOpenNode(start, 103, 100, 10, 0, 0));
+			expect(nodes->getNodeByPosition(102, 100) != nullptr);
+		}
+
+		const auto nodes = AStarNodes::acquire(200, 200, 0, 3);
+		expect(nodes->getNodeByPosition(102, 100) == nullptr);
+		expect(nodes->getNodeByPosition(200, 200) == nodes->getBestNode());
+		expect(eq(nodes->getClosedNodes(), 0));
+	};
+};
@@ -0,0 +1,169 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "config/configmanager.hpp"
+#include "creatures/creature.hpp"
+#include "creatures/creatures_definitions.hpp"
+#include "items/test_items.hpp"
+#include "map/map.hpp"
+#include "map/utils/flowfield.hpp"
+#include "utils/tools.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr uint16_t AREA_X = 1'000;
+	constexpr uint16_t AREA_Y = 1'000;
+	constexpr uint16_t AREA_SIZE = 40;
+	constexpr uint8_t AREA_Z = 7;
+	// The chased creature behind a wall, followers walk around either end
+	const Position TARGET(AREA_X + 20, AREA_Y + 20, AREA_Z);
+	constexpr uint16_t WALL_X = AREA_X + 16;
+	constexpr uint16_t WALL_FROM_Y = AREA_Y + 14;
+	constexpr uint16_t WALL_TO_Y = AREA_Y + 26;
+
+	// The A* search runs on its configured limits
+	void loadConfig() {
+		const auto path = std::filesystem::temp_directory_path() / "canary_flowfield_test.lua";
+		std::ofstream(path) << "pathfindingMaxNodes = 4096\npathfindingMaxExpandedNodes = 2000\n";
+		g_configManager().setConfigFileLua(path.string());
+		g_configManager().load();
+		std::filesystem::remove(path);
+	}
+
+	// Walls are missing tiles, which block the flood and the A* search without creature alike
+	std::unique_ptr<Map> createMap(const std::function<bool(uint16_t, uint16_t)> &isWall) {
+		loadConfig();
+		tests::TestItems::install();
+
+		auto map = std::make_unique<Map>();
+		auto ground = std::make_shared<BasicTile>();
+		ground->ground = std::make_shared<BasicItem>();
+		ground->ground->id = tests::TestItems::GROUND;
+		for (uint16_t y = AREA_Y; y < AREA_Y + AREA_SIZE; ++y) {
+			for (uint16_t x = AREA_X; x < AREA_X + AREA_SIZE; ++x) {
+				if (!isWall(x, y)) {
+					map->setBasicTile(x, y, AREA_Z, ground);
+				}
+			}
+		}
+		map->flush();
+		return map;
+	}
+
+	bool isWallSegment(uint16_t x, uint16_t y) {
+		return x == WALL_X && y >= WALL_FROM_Y && y <= WALL_TO_Y;
+	}
+
+	uint32_t getPathCost(const std::vector<Direction> &dirList) {
+		uint32_t cost = 0;
+		for (const auto dir : dirList) {
+			cost += (dir & DIRECTION_DIAGONAL_MASK) != 0 ? FlowField::DIAGONAL_COST : FlowField::NORMAL_COST;
+		}
+		return cost;
+	}
+
+	Position walk(Position pos, const std::vector<Direction> &dirList) {
+		for (const auto dir : dirList) {
+			pos = getNextPosition(dir, pos);
+		}
+		return pos;
+	}
+
+	bool isNextTo(const Position &pos, const Position &target) {
+		return pos.z == target.z && std::max(Position::getDistanceX(pos, target), Position::getDistanceY(pos, target)) == 1;
+	}
+}
+
+suite<"map"> flowFieldTest = [] {
+	test("FlowField paths cost no more than the A* paths to the same target") = [] {
+		const auto map = createMap(isWallSegment);
+		const FlowField field(*map, TARGET, 0);
+		const auto canWalk = [&map](const Position &pos) {
+			return !map->isBlocking(pos.x, pos.y, pos.z, TILE_BLOCK_SOLID);
+		};
+
+		FindPathParams fpp;
+		fpp.clearSight = false;
+		fpp.minTargetDist = 1;
+		fpp.maxTargetDist = 1;
+
+		// Around the wall, along it and in the open
+		for (const Position start : { Position(AREA_X + 10, AREA_Y + 20, AREA_Z), Position(AREA_X + 12, AREA_Y + 15, AREA_Z), Position(AREA_X + 28, AREA_Y + 9, AREA_Z), Position(AREA_X + 21, AREA_Y + 33, AREA_Z) }) {
+			std::vector<Direction> flowPath;
+			expect(field.getPath(start, flowPath, canWalk));
+			std::vector<Direction> searchPath;
+			expect(map->getPathMatching(start, searchPath, FrozenPathingConditionCall(TARGET), fpp));
+
+			expect(isNextTo(walk(start, flowPath), TARGET));
+			expect(isNextTo(walk(start, searchPath), TARGET));
+			// Both are shortest paths, but to a side of the target the A* search may not have picked
+			expect(le(getPathCost(flowPath), getPathCost(searchPath) + FlowField::DIAGONAL_COST - FlowField::NORMAL_COST));
+		}
+	};
+
+	test("FlowField has no path to a walled in target") = [] {
+		const auto map = createMap([](uint16_t x, uint16_t y) {
+			return std::max(std::abs(x - TARGET.x), std::abs(y - TARGET.y)) == 2;
+		});
+		const FlowField field(*map, TARGET, 0);
+
+		const Position start(AREA_X + 10, AREA_Y + 20, AREA_Z);
+		expect(eq(field.getCost(start), FlowField::UNREACHABLE));
+		std::vector<Direction> dirList;
+		expect(!field.getPath(start, dirList, [](const Position &) { return true; }));
+		expect(dirList.empty());
+	};
+
+	test("FlowField gives up when every cheaper step is taken") = [] {
+		const auto map = createMap([](uint16_t, uint16_t) { return false; });
+		const FlowField field(*map, TARGET, 0);
+
+		// Another follower stands on the straight line, the diagonals around it cost more than standing still
+		const Position start(TARGET.x - 5, TARGET.y, AREA_Z);
+		const Position occupied(TARGET.x - 4, TARGET.y, AREA_Z);
+		std::vector<Direction> dirList { DIRECTION_NORTH };
+		expect(!field.getPath(start, dirList, [&occupied](const Position &pos) { return pos != occupied; }));
+		expect(eq(dirList.size(), 1u));
+
+		expect(field.getPath(start, dirList, [](const Position &) { return true; }));
+		expect(eq(dirList.size(), 5u));
+		expect(isNextTo(walk(start, { dirList.begin() + 1, dirList.end() }), TARGET));
+	};
+
+	test("FlowFields builds a field on the second request and drops the unused ones") = [] {
+		const auto map = createMap([](uint16_t, uint16_t) { return false; });
+		FlowFields fields;
+		constexpr int64_t now = 100'000;
+
+		// A single follower searches on its own
+		expect(fields.get(*map, 1, TARGET, now) == nullptr);
+		const auto field = fields.get(*map, 1, TARGET, now + 1);
+		expect(field != nullptr);
+		expect(fields.get(*map, 1, TARGET, now + 2) == field);
+		expect(eq(fields.size(), 1u));
+
+		// The creature moved, the next request starts over
+		const Position moved(TARGET.x + 1, TARGET.y, AREA_Z);
+		expect(fields.get(*map, 1, moved, now + 3) == nullptr);
+
+		expect(eq(fields.expire(now + 2 + FlowFields::EXPIRY_TIME), 0u));
+		expect(eq(fields.expire(now + 3 + FlowFields::EXPIRY_TIME), 1u));
+		expect(eq(fields.size(), 0u));
+	};
+
+	test("FlowFields expires unused fields while answering requests") = [] {
+		const auto map = createMap([](uint16_t, uint16_t) { return false; });
+		FlowFields fields;
+		constexpr int64_t now = 100'000;
+
+		expect(fields.get(*map, 1, TARGET, now) == nullptr);
+		expect(fields.get(*map, 1, TARGET, now + 1) != nullptr);
+		expect(eq(fields.size(), 1u));
+
+		expect(fields.get(*map, 2, TARGET, now + 1 + FlowFields::EXPIRY_TIME) == nullptr);
+		expect(eq(fields.size(), 1u));
+		expect(eq(fields.expire(now + 1 + FlowFields::EXPIRY_TIME), 0u));
+	};
+};
@@ -0,0 +1,43 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "map/utils/mapsector.hpp"
+
+using namespace boost::ut;
+
+suite<"map"> mapSectorTest = [] {
+	test("Floor cells block like a missing tile until set") = [] {
+		const auto floor = std::make_unique<Floor>(7);
+		expect(floor->isBlocking(3, 5, TILE_BLOCK_SOLID));
+		expect(floor->isBlocking(3, 5, TILE_BLOCK_PATH));
+		expect(!floor->isBlocking(3, 5, TILE_BLOCK_PROJECTILE));
+		expect(eq(floor->getBlocks(3, 5), TILE_BLOCK_EMPTY));
+	};
+
+	test("Floor::setBlocks only changes its own cell") = [] {
+		const auto floor = std::make_unique<Floor>(7);
+		floor->setBlocks(3, 5, TILE_BLOCK_PROJECTILE);
+		expect(eq(floor->getBlocks(3, 5), TILE_BLOCK_PROJECTILE));
+		expect(eq(floor->getBlocks(4, 5), TILE_BLOCK_EMPTY));
+		expect(eq(floor->getBlocks(3, 4), TILE_BLOCK_EMPTY));
+
+		floor->setBlocks(3, 5, TILE_BLOCK_NONE);
+		expect(eq(floor->getBlocks(3, 5), TILE_BLOCK_NONE));
+	};
+
+	test("Floor::getBlockingRow maps x to the bit of the same rank") = [] {
+		const auto floor = std::make_unique<Floor>(7);
+		for (uint16_t x = 0; x < SECTOR_SIZE; ++x) {
+			floor->setBlocks(x, 9, TILE_BLOCK_NONE);
+		}
+		expect(eq(floor->getBlockingRow(9, TILE_BLOCK_SOLID), 0u));
+
+		// Sector relative, the same cell of any sector
+		floor->setBlocks(SECTOR_SIZE * 10 + 2, 9, TILE_BLOCK_SOLID);
+		floor->setBlocks(SECTOR_SIZE - 1, 9, TILE_BLOCK_SOLID | TILE_BLOCK_PROJECTILE);
+		expect(eq(floor->getBlockingRow(9, TILE_BLOCK_SOLID), (uint64_t(1) << 2) | (uint64_t(1) << (SECTOR_SIZE - 1))));
+		expect(eq(floor->getBlockingRow(9, TILE_BLOCK_PROJECTILE), uint64_t(1) << (SECTOR_SIZE - 1)));
+		expect(eq(floor->getBlockingRow(8, TILE_BLOCK_PROJECTILE), 0u));
+	};
+};
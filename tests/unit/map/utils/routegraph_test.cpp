@@ -0,0 +1,136 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "creatures/creatures_definitions.hpp"
+#include "items/test_items.hpp"
+#include "map/map.hpp"
+#include "map/utils/routegraph.hpp"
+#include "utils/tools.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr uint16_t AREA_X = 1'000;
+	constexpr uint16_t AREA_Y = 1'000;
+	constexpr uint16_t AREA_SIZE = 96;
+	constexpr uint8_t AREA_Z = 7;
+	// A wall across the area with a single gap
+	constexpr uint16_t WALL_X = AREA_X + 40;
+	constexpr uint16_t GAP_Y = AREA_Y + 90;
+
+	std::shared_ptr<BasicTile> makeGround() {
+		auto tile = std::make_shared<BasicTile>();
+		tile->ground = std::make_shared<BasicItem>();
+		tile->ground->id = tests::TestItems::GROUND;
+		return tile;
+	}
+
+	void fillArea(Map &map) {
+		tests::TestItems::install();
+		const auto ground = makeGround();
+		for (uint16_t y = AREA_Y; y < AREA_Y + AREA_SIZE; ++y) {
+			for (uint16_t x = AREA_X; x < AREA_X + AREA_SIZE; ++x) {
+				if (x != WALL_X || y == GAP_Y) {
+					map.setBasicTile(x, y, AREA_Z, ground);
+				}
+			}
+		}
+		map.flush();
+	}
+
+	// Where the steps lead, nullopt once one of them leaves the walkable cells
+	std::optional<Position> walk(const Map &map, Position pos, const std::vector<Direction> &dirList) {
+		for (const auto dir : dirList) {
+			pos = getNextPosition(dir, pos);
+			if (map.isBlocking(pos.x, pos.y, pos.z, TILE_BLOCK_SOLID)) {
+				return std::nullopt;
+			}
+		}
+		return pos;
+	}
+}
+
+suite<"map"> routeGraphTest = [] {
+	test("RouteGraph finds a route through the only gap of a wall") = [] {
+		const auto map = std::make_unique<Map>();
+		fillArea(*map);
+
+		RouteGraph graph;
+		const Position start(AREA_X + 2, AREA_Y + 2, AREA_Z);
+		const Position target(AREA_X + 90, AREA_Y + 4, AREA_Z);
+		std::vector<Direction> dirList;
+		expect(graph.getPath(*map, start, target, dirList));
+
+		const auto end = walk(*map, start, dirList);
+		expect(end.has_value() and end == target);
+		// Down to the gap and back up
+		expect(ge(dirList.size(), 88u + 86u));
+	};
+
+	test("RouteGraph rebuilds clusters whose walkability changed") = [] {
+		const auto map = std::make_unique<Map>();
+		fillArea(*map);
+
+		RouteGraph graph;
+		const Position start(AREA_X + 2, AREA_Y + 2, AREA_Z);
+		const Position target(AREA_X + 90, AREA_Y + 4, AREA_Z);
+		std::vector<Direction> dirList;
+		expect(graph.getPath(*map, start, target, dirList));
+
+		// Closing the gap
+		map->setBasicTile(WALL_X, GAP_Y, AREA_Z, nullptr);
+		dirList.clear();
+		expect(!graph.getPath(*map, start, target, dirList));
+		expect(dirList.empty());
+
+		// Opening another one, next to the start
+		map->setBasicTile(WALL_X, AREA_Y + 3, AREA_Z, makeGround());
+		expect(graph.getPath(*map, start, target, dirList));
+		expect(walk(*map, start, dirList) == target);
+		expect(lt(dirList.size(), 120u));
+	};
+
+	test("RouteGraph stays on one floor") = [] {
+		const auto map = std::make_unique<Map>();
+		fillArea(*map);
+
+		RouteGraph graph;
+		std::vector<Direction> dirList;
+		expect(!graph.getPath(*map, Position(AREA_X, AREA_Y, AREA_Z), Position(AREA_X + 5, AREA_Y, AREA_Z - 1), dirList));
+		expect(graph.getPath(*map, Position(AREA_X, AREA_Y, AREA_Z), Position(AREA_X, AREA_Y, AREA_Z), dirList));
+		expect(dirList.empty());
+	};
+
+	test("Map::getRoute stops in range of the target") = [] {
+		const auto map = std::make_unique<Map>();
+		fillArea(*map);
+
+		const Position start(AREA_X + 2, AREA_Y + 2, AREA_Z);
+		const Position target(AREA_X + 30, AREA_Y + 2, AREA_Z);
+		FindPathParams fpp;
+		fpp.minTargetDist = 2;
+		fpp.maxTargetDist = 4;
+
+		std::vector<Direction> dirList;
+		expect(map->getRoute(start, target, dirList, fpp));
+		const auto end = walk(*map, start, dirList);
+		expect(end.has_value() and Position::getDiagonalDistance(*end, target) == 4);
+	};
+
+	test("Map::getRoute refuses to end closer to the target than minTargetDist") = [] {
+		const auto map = std::make_unique<Map>();
+		fillArea(*map);
+
+		// Already too close, the route could only get closer
+		const Position start(AREA_X + 2, AREA_Y + 2, AREA_Z);
+		const Position target(AREA_X + 3, AREA_Y + 2, AREA_Z);
+		FindPathParams fpp;
+		fpp.minTargetDist = 3;
+		fpp.maxTargetDist = 5;
+
+		std::vector<Direction> dirList;
+		expect(!map->getRoute(start, target, dirList, fpp));
+		expect(dirList.empty());
+	};
+};
@@ -29,4 +29,25 @@ suite<"security"> rsaTest = [] {
 			eq(std::string { "error" }, logger.logs[0].level) and eq(std::string { "File key.pem not found or have problem on loading... Setting standard rsa key\n" }, logger.logs[0].message)
 		);
 	};
+
+	test("RSA::encrypt is reversed by RSA::decrypt") = [] {
+		di::extension::injector<> injector {};
+		DI::setTestContainer(&InMemoryLogger::install(injector));
+
+		auto &rsa = DI::create<RSA &>();
+		rsa.start();
+
+		// Leading zero keeps the block below the modulus, like the client login block
+		std::array<char, 128> block {};
+		for (size_t i = 1; i < block.size(); ++i) {
+			block[i] = static_cast<char>(i * 7);
+		}
+
+		auto message = block;
+		rsa.encrypt(message.data());
+		expect(message != block);
+
+		rsa.decrypt(message.data());
+		expect(message == block);
+	};
 };
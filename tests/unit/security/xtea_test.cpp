@@ -0,0 +1,52 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "security/xtea.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	constexpr XTEA::Key KEY = { 0x12345678, 0x9ABCDEF0, 0x0BADF00D, 0xDEADBEEF };
+
+	std::vector<uint8_t> makeData(size_t length) {
+		std::mt19937 generator(static_cast<uint32_t>(length));
+		std::vector<uint8_t> data(length);
+		std::ranges::generate(data, [&generator] { return static_cast<uint8_t>(generator()); });
+		return data;
+	}
+}
+
+suite<"security"> xteaTest = [] {
+	test("XTEA kernels encrypt like the scalar one") = [] {
+		for (const size_t length : { 8u, 24u, 32u, 40u, 64u, 72u, 136u, 65'496u }) {
+			const auto data = makeData(length);
+			auto expected = data;
+			XTEA::encrypt(expected.data(), length, KEY, SimdLevel::Scalar);
+			expect(expected != data);
+
+			for (const auto level : { SimdLevel::SSE2, SimdLevel::AVX2 }) {
+				if (level > getSimdLevel()) {
+					continue;
+				}
+				auto encrypted = data;
+				XTEA::encrypt(encrypted.data(), length, KEY, level);
+				expect(encrypted == expected) << getSimdLevelName(level) << length;
+			}
+		}
+	};
+
+	test("XTEA::decrypt reverts XTEA::encrypt") = [] {
+		for (const size_t length : { 8u, 64u, 1'000u }) {
+			const auto data = makeData(length);
+			auto buffer = data;
+			XTEA::encrypt(buffer.data(), length, KEY);
+			XTEA::decrypt(buffer.data(), length, KEY, SimdLevel::Scalar);
+			expect(buffer == data) << length;
+
+			XTEA::encrypt(buffer.data(), length, KEY, SimdLevel::Scalar);
+			XTEA::decrypt(buffer.data(), length, KEY);
+			expect(buffer == data) << length;
+		}
+	};
+};
@@ -0,0 +1,50 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "server/network/message/broadcastmessage.hpp"
+
+using namespace boost::ut;
+
+suite<"networkmessage"> broadcastMessageTest = [] {
+	test("BroadcastMessage encodes each protocol variant once") = [] {
+		size_t encoded = 0;
+		BroadcastMessage message([&encoded](NetworkMessage &msg, bool oldProtocol, uint8_t variant) {
+			++encoded;
+			msg.addByte(oldProtocol ? 0x01 : 0x02);
+			msg.addByte(variant);
+		});
+
+		for (int i = 0; i < 10; ++i) {
+			expect(eq(message.get(false).getLength(), 2));
+			expect(eq(message.get(true).getLength(), 2));
+		}
+		expect(eq(encoded, 2u));
+
+		expect(eq(message.get(false).getBuffer()[NetworkMessage::INITIAL_BUFFER_POSITION], 0x02));
+		expect(eq(message.get(true).getBuffer()[NetworkMessage::INITIAL_BUFFER_POSITION], 0x01));
+	};
+
+	test("BroadcastMessage keeps variants apart") = [] {
+		BroadcastMessage message([](NetworkMessage &msg, bool, uint8_t variant) {
+			msg.addByte(variant);
+		});
+
+		const auto* first = &message.get(false, 1);
+		const auto* second = &message.get(false, 2);
+		expect(first != second);
+		expect(&message.get(false, 1) == first);
+		expect(eq(message.size(), 2u));
+	};
+
+	test("BroadcastMessage leaves nothing to send when the encoder skips a protocol") = [] {
+		BroadcastMessage message([](NetworkMessage &msg, bool oldProtocol, uint8_t) {
+			if (!oldProtocol) {
+				msg.addByte(0x83);
+			}
+		});
+
+		expect(eq(message.get(true).getLength(), 0));
+		expect(eq(message.get(false).getLength(), 1));
+	};
+};
@@ -0,0 +1,122 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "server/network/message/compression.hpp"
+#include "server/network/message/outputmessage.hpp"
+
+using namespace boost::ut;
+
+namespace {
+	// Map description like bytes, repetitive enough to shrink
+	std::string makePayload(size_t size, uint32_t seed) {
+		std::mt19937 generator(seed);
+		std::string payload;
+		while (payload.size() < size) {
+			payload += fmt::format("tile {} ground 4526 item {};", generator() % 64, generator() % 8);
+		}
+		payload.resize(size);
+		return payload;
+	}
+
+	std::shared_ptr<OutputMessage> makeMessage(const std::string &payload) {
+		auto msg = std::make_shared<OutputMessage>();
+		msg->addBytes(payload.data(), payload.size());
+		return msg;
+	}
+
+	std::string getBytes(OutputMessage &msg) {
+		return { reinterpret_cast<const char*>(msg.getOutputBuffer()), msg.getLength() };
+	}
+
+	// Inflates one message, keeping the window when the stream is reused
+	std::string inflateMessage(z_stream &stream, const std::string &compressed) {
+		std::string output(NETWORKMESSAGE_MAXSIZE, '\0');
+		stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+		stream.avail_in = static_cast<uInt>(compressed.size());
+		stream.next_out = reinterpret_cast<Bytef*>(output.data());
+		stream.avail_out = static_cast<uInt>(output.size());
+		inflate(&stream, Z_SYNC_FLUSH);
+		output.resize(output.size() - stream.avail_out);
+		return output;
+	}
+}
+
+suite<"server"> compressionTest = [] {
+	test("Compressor deflates each message on its own") = [] {
+		const auto compressor = Compressor::create({});
+		for (const auto size : { 200u, 5'000u, 60'000u }) {
+			const auto payload = makePayload(size, size);
+			const auto msg = makeMessage(payload);
+			expect(compressor->compress(*msg));
+			expect(lt(msg->getLength(), payload.size()));
+
+			z_stream stream {};
+			inflateInit2(&stream, -15);
+			expect(inflateMessage(stream, getBytes(*msg)) == payload) << size;
+			inflateEnd(&stream);
+		}
+	};
+
+	test("Compressor leaves small and incompressible messages as they are") = [] {
+		const auto compressor = Compressor::create({});
+		const auto small = makePayload(100, 1);
+		const auto smallMsg = makeMessage(small);
+		expect(!compressor->compress(*smallMsg));
+		expect(getBytes(*smallMsg) == small);
+
+		std::string noise(1'000, '\0');
+		std::mt19937 generator(2);
+		std::ranges::generate(noise, [&generator] { return static_cast<char>(generator()); });
+		const auto noiseMsg = makeMessage(noise);
+		const auto before = Compressor::getStats();
+		expect(!compressor->compress(*noiseMsg));
+		expect(getBytes(*noiseMsg) == noise);
+		expect(eq(before.skipped + 1, Compressor::getStats().skipped));
+
+		CompressionSettings disabled;
+		disabled.level = 0;
+		const auto payloadMsg = makeMessage(makePayload(1'000, 3));
+		expect(!Compressor::create(disabled)->compress(*payloadMsg));
+	};
+
+	test("Compressor keeps the window across messages of a stream") = [] {
+		CompressionSettings settings;
+		settings.backend = CompressionBackend::ZlibStream;
+		settings.bulkSize = 2'000;
+		settings.bulkLevel = 1;
+		const auto compressor = Compressor::create(settings);
+
+		z_stream stream {};
+		inflateInit2(&stream, -15);
+		const auto repeated = makePayload(1'000, 4);
+		size_t firstSize = 0;
+		// Levels switch between regular and bulk messages along the stream
+		for (const auto &payload : { repeated, makePayload(3'000, 5), repeated, makePayload(500, 6) }) {
+			const auto msg = makeMessage(payload);
+			expect(compressor->compress(*msg));
+			const auto compressed = getBytes(*msg);
+			firstSize = firstSize == 0 ? compressed.size() : firstSize;
+			expect(inflateMessage(stream, compressed) == payload);
+		}
+		inflateEnd(&stream);
+
+		// The repeated payload is mostly back references into the window
+		const auto msg = makeMessage(repeated);
+		expect(compressor->compress(*msg));
+		expect(lt(msg->getLength() * 4, firstSize));
+	};
+
+	test("Compressor::getStats counts the bytes in and out") = [] {
+		const auto before = Compressor::getStats();
+		const auto payload = makePayload(4'000, 7);
+		const auto msg = makeMessage(payload);
+		expect(Compressor::create({})->compress(*msg));
+
+		const auto after = Compressor::getStats();
+		expect(eq(before.compressed + 1, after.compressed));
+		expect(eq(before.bytesIn + payload.size(), after.bytesIn));
+		expect(eq(before.bytesOut + msg->getLength(), after.bytesOut));
+		expect(ge(after.nanoseconds, before.nanoseconds));
+	};
+};
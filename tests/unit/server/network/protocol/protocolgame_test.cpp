@@ -0,0 +1,186 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "config/configmanager.hpp"
+#include "creatures/players/player.hpp"
+#include "items/test_items.hpp"
+#include "items/tile.hpp"
+#include "map/map.hpp"
+#include "server/network/protocol/protocolgame.hpp"
+
+using namespace boost::ut;
+
+// Writes tile descriptions as a client of each protocol variant would get them
+struct ProtocolGameTest {
+	static std::vector<uint8_t> getTileDescription(ProtocolGame &protocol, uint8_t variant, const std::shared_ptr<Player> &viewer, const std::shared_ptr<Tile> &tile) {
+		protocol.player = viewer;
+		protocol.oldProtocol = (variant & 1) != 0;
+		protocol.isOTCR = (variant & 2) != 0;
+
+		NetworkMessage msg;
+		protocol.GetTileDescription(tile, msg);
+		const auto* bytes = msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+		return { bytes, bytes + msg.getLength() };
+	}
+
+	static void setPlayer(ProtocolGame &protocol, const std::shared_ptr<Player> &player) {
+		protocol.player = player;
+	}
+
+	static void addKnownCreature(ProtocolGame &protocol, uint32_t id) {
+		protocol.knownCreatureSet.insert(id);
+	}
+
+	static void sendHealthAndSpeed(ProtocolGame &protocol, const std::shared_ptr<Creature> &creature, uint16_t speed) {
+		protocol.sendCreatureHealth(creature);
+		protocol.sendChangeSpeed(creature, speed);
+	}
+
+	static void flushPendingUpdates(ProtocolGame &protocol) {
+		protocol.flushPendingUpdates();
+	}
+
+	// What was written for the client since the last call
+	static std::vector<uint8_t> takeOutput(ProtocolGame &protocol) {
+		auto &buffer = protocol.getCurrentBuffer();
+		if (!buffer) {
+			return {};
+		}
+
+		const auto* bytes = buffer->getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+		std::vector<uint8_t> output(bytes, bytes + buffer->getLength());
+		buffer.reset();
+		return output;
+	}
+};
+
+namespace {
+	const Position TILE_POS(1'000, 1'000, 7);
+
+	std::unique_ptr<Map> createMap() {
+		tests::TestItems::install();
+		auto map = std::make_unique<Map>();
+		auto basicTile = std::make_shared<BasicTile>();
+		basicTile->ground = std::make_shared<BasicItem>();
+		basicTile->ground->id = tests::TestItems::GROUND;
+		map->setBasicTile(TILE_POS.x, TILE_POS.y, TILE_POS.z, basicTile);
+		map->flush();
+		return map;
+	}
+
+	void loadConfig() {
+		const auto path = std::filesystem::temp_directory_path() / "canary_protocolgame_test.lua";
+		std::ofstream(path) << "coalesceCreatureUpdates = true\n";
+		g_configManager().setConfigFileLua(path.string());
+		g_configManager().load();
+		std::filesystem::remove(path);
+	}
+
+	std::shared_ptr<Player> createPlayer(uint32_t guid) {
+		auto player = std::make_shared<Player>();
+		player->setGUID(guid);
+		player->setID();
+		return player;
+	}
+
+	// A player at pos, on a tile of its own so that the described tile has no creatures
+	std::shared_ptr<Player> createViewer(const Position &pos) {
+		auto viewer = std::make_shared<Player>();
+		std::make_shared<DynamicTile>(pos)->internalAddThing(viewer);
+		return viewer;
+	}
+
+	// A viewer standing on the tile gets its items written live, any other one gets the cached bytes
+	struct Viewers {
+		std::shared_ptr<ProtocolGame> protocol = std::make_shared<ProtocolGame>(nullptr);
+		std::shared_ptr<Player> standing = createViewer(TILE_POS);
+		std::shared_ptr<Player> away = createViewer(Position(TILE_POS.x + 5, TILE_POS.y, TILE_POS.z));
+
+		std::vector<uint8_t> getLive(uint8_t variant, const std::shared_ptr<Tile> &tile) const {
+			return ProtocolGameTest::getTileDescription(*protocol, variant, standing, tile);
+		}
+
+		std::vector<uint8_t> getCached(uint8_t variant, const std::shared_ptr<Tile> &tile) const {
+			return ProtocolGameTest::getTileDescription(*protocol, variant, away, tile);
+		}
+	};
+}
+
+suite<"networkmessage"> protocolGameTest = [] {
+	test("ProtocolGame writes the cached items of a tile as it writes them live") = [] {
+		const auto map = createMap();
+		const auto tile = map->getTile(TILE_POS);
+		for (const auto id : { tests::TestItems::WALL, tests::TestItems::BOX, tests::TestItems::PODIUM }) {
+			tile->addThing(Item::CreateItem(id));
+		}
+
+		const Viewers viewers;
+		for (uint8_t variant = 0; variant < TileDescriptionCache::VARIANTS; ++variant) {
+			const auto live = viewers.getLive(variant, tile);
+			expect(!live.empty());
+			// Built, then read back
+			expect(viewers.getCached(variant, tile) == live);
+			expect(viewers.getCached(variant, tile) == live);
+		}
+	};
+
+	test("ProtocolGame rebuilds the cached items of a tile once an item attribute changes") = [] {
+		const auto map = createMap();
+		const auto tile = map->getTile(TILE_POS);
+		const auto podium = Item::CreateItem(tests::TestItems::PODIUM);
+		tile->addThing(podium);
+
+		const Viewers viewers;
+		const auto before = viewers.getCached(0, tile);
+		auto version = tile->getItemVersion();
+
+		podium->setCustomAttribute("LookTypeEx", static_cast<int64_t>(1'234));
+		expect(gt(tile->getItemVersion(), version));
+		const auto after = viewers.getCached(0, tile);
+		expect(after != before);
+		expect(after == viewers.getLive(0, tile));
+
+		version = tile->getItemVersion();
+		expect(podium->removeCustomAttribute("LookTypeEx"));
+		expect(gt(tile->getItemVersion(), version));
+		expect(viewers.getCached(0, tile) == before);
+
+		// OTCR clients also get the shader
+		const auto otcrBefore = viewers.getCached(2, tile);
+		podium->setShader("Outline");
+		expect(viewers.getCached(2, tile) != otcrBefore);
+		expect(viewers.getCached(2, tile) == viewers.getLive(2, tile));
+		podium->setShader("");
+		expect(viewers.getCached(2, tile) == otcrBefore);
+	};
+
+	test("ProtocolGame sends one packet per creature and field a cycle, with the latest value") = [] {
+		loadConfig();
+		const auto protocol = std::make_shared<ProtocolGame>(nullptr);
+		ProtocolGameTest::setPlayer(*protocol, createPlayer(1));
+		const auto known = createPlayer(2);
+		const auto unknown = createPlayer(3);
+		ProtocolGameTest::addKnownCreature(*protocol, known->getID());
+
+		for (const uint16_t speed : { 200, 220, 240 }) {
+			ProtocolGameTest::sendHealthAndSpeed(*protocol, known, speed);
+			ProtocolGameTest::sendHealthAndSpeed(*protocol, unknown, speed);
+		}
+		expect(ProtocolGameTest::takeOutput(*protocol).empty());
+
+		// The client never got the unknown creature, nothing is sent for it
+		ProtocolGameTest::flushPendingUpdates(*protocol);
+		NetworkMessage expected;
+		ProtocolGame::AddCreatureHealth(expected, known);
+		expected.addByte(0x8F);
+		expected.add<uint32_t>(known->getID());
+		expected.add<uint16_t>(known->getBaseSpeed());
+		expected.add<uint16_t>(240);
+		const auto* bytes = expected.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+		expect(ProtocolGameTest::takeOutput(*protocol) == std::vector<uint8_t>(bytes, bytes + expected.getLength()));
+
+		ProtocolGameTest::flushPendingUpdates(*protocol);
+		expect(ProtocolGameTest::takeOutput(*protocol).empty());
+	};
+};
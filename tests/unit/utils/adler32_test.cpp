@@ -0,0 +1,36 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "utils/adler32.hpp"
+
+using namespace boost::ut;
+
+suite<"utils"> adler32Test = [] {
+	test("Adler32::checksum matches the reference value") = [] {
+		constexpr std::string_view text = "Wikipedia";
+		for (const auto level : { SimdLevel::Scalar, getSimdLevel() }) {
+			expect(eq(0x11E60398u, Adler32::checksum(reinterpret_cast<const uint8_t*>(text.data()), text.size(), level)));
+		}
+		expect(eq(1u, Adler32::checksum(nullptr, 0)));
+	};
+
+	test("Adler32 kernels agree with the scalar one") = [] {
+		std::vector<uint8_t> data(70'000);
+		std::mt19937 generator(data.size());
+		std::ranges::generate(data, [&generator] { return static_cast<uint8_t>(generator()); });
+		// Worst case for the sums kept between reductions
+		const std::vector<uint8_t> saturated(70'000, 0xFF);
+
+		for (const size_t length : { 1u, 15u, 16u, 33u, 5'551u, 5'552u, 5'553u, 11'104u, 65'500u, 70'000u }) {
+			for (const auto &buffer : { data, saturated }) {
+				const auto expected = Adler32::checksum(buffer.data(), length, SimdLevel::Scalar);
+				for (const auto level : { SimdLevel::SSE2, SimdLevel::AVX2 }) {
+					if (level <= getSimdLevel()) {
+						expect(eq(expected, Adler32::checksum(buffer.data(), length, level))) << getSimdLevelName(level) << length;
+					}
+				}
+			}
+		}
+	};
+};
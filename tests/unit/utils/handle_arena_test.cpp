@@ -0,0 +1,110 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "utils/handle_arena.hpp"
+
+using namespace boost::ut;
+
+suite<"utils"> handleArenaTest = [] {
+	test("HandleArena never hands out the reserved handle") = [] {
+		HandleArena<int, 2> arena;
+		for (int i = 1; i <= 10; ++i) {
+			const auto handle = arena.allocate(i);
+			expect(neq(handle, HandleArena<int, 2>::NONE));
+			expect(eq(arena.get(handle), i));
+		}
+		expect(eq(arena.size(), 10u));
+	};
+
+	test("HandleArena keeps released slots readable until reclaim") = [] {
+		HandleArena<std::string> arena;
+		const auto handle = arena.allocate("tile");
+		arena.release(handle);
+
+		expect(eq(arena.size(), 0u));
+		expect(eq(arena.get(handle), std::string("tile")));
+
+		expect(eq(arena.reclaim(), 1u));
+		expect(arena.get(handle).empty());
+		expect(eq(arena.allocate("other"), handle));
+	};
+
+	test("HandleArena collect waits for the readers pinned before the release") = [] {
+		HandleArena<int> arena;
+		const auto handle = arena.allocate(1);
+
+		auto collectAll = [&arena] {
+			size_t reclaimed = 0;
+			for (int i = 0; i < 3; ++i) {
+				reclaimed += arena.collect();
+			}
+			return reclaimed;
+		};
+
+		{
+			HandleArena<int>::ReadGuard guard;
+			arena.release(handle);
+			expect(eq(collectAll(), 0u));
+			expect(eq(arena.get(handle), 1));
+			expect(neq(arena.allocate(2), handle));
+		}
+
+		expect(eq(collectAll(), 1u));
+		expect(eq(arena.get(handle), 0));
+		expect(eq(arena.allocate(3), handle));
+	};
+
+	test("HandleArena recycles released slots as they pile up") = [] {
+		HandleArena<int> arena;
+		HandleArena<int>::Handle maxHandle = 0;
+		for (int i = 1; i <= 10'000; ++i) {
+			const auto handle = arena.allocate(i);
+			maxHandle = std::max(maxHandle, handle);
+			arena.release(handle);
+		}
+		expect(lt(maxHandle, 10'000u));
+	};
+
+	test("HandleArena readers never see a recycled slot while slots are replaced") = [] {
+		using Arena = HandleArena<std::shared_ptr<const uint32_t>, 4>;
+		Arena arena;
+		std::atomic<Arena::Handle> published = arena.allocate(std::make_shared<const uint32_t>(0));
+		std::atomic_bool done = false;
+		std::atomic_size_t emptyReads = 0;
+
+		std::vector<std::jthread> readers;
+		for (int i = 0; i < 3; ++i) {
+			readers.emplace_back([&] {
+				while (!done.load(std::memory_order_relaxed)) {
+					Arena::ReadGuard guard;
+					const auto value = arena.get(published.load(std::memory_order_acquire));
+					if (!value) {
+						++emptyReads;
+					}
+				}
+			});
+		}
+
+		Arena::Handle maxHandle = 0;
+		for (uint32_t i = 1; i <= 20'000; ++i) {
+			const auto handle = arena.allocate(std::make_shared<const uint32_t>(i));
+			maxHandle = std::max(maxHandle, handle);
+			const auto old = published.exchange(handle, std::memory_order_acq_rel);
+			arena.release(old);
+			if (i % 16 == 0) {
+				arena.collect();
+			}
+		}
+		done = true;
+		readers.clear();
+		expect(eq(emptyReads.load(), 0u));
+		expect(lt(maxHandle, 20'000u));
+
+		// Without readers the remaining slots are recycled, the next value reuses one of them
+		for (int i = 0; i < 3; ++i) {
+			arena.collect();
+		}
+		expect(le(arena.allocate(nullptr), maxHandle));
+	};
+};
@@ -0,0 +1,53 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "utils/inline_function.hpp"
+
+using namespace boost::ut;
+
+suite<"utils"> inlineFunctionTest = [] {
+	test("InlineFunction is empty by default and from empty std::function") = [] {
+		InlineFunction<void(void)> empty;
+		expect(empty == nullptr);
+
+		const std::function<void(void)> emptyStd;
+		InlineFunction<void(void)> fromStd(emptyStd);
+		expect(fromStd == nullptr);
+	};
+
+	test("InlineFunction keeps captures alive and moves them") = [] {
+		auto counter = std::make_shared<int>(0);
+		InlineFunction<void(void)> f([counter] { ++*counter; });
+		expect(eq(counter.use_count(), 2));
+
+		auto moved = std::move(f);
+		expect(f == nullptr);
+		expect(eq(counter.use_count(), 2));
+
+		moved();
+		expect(eq(*counter, 1));
+
+		moved = nullptr;
+		expect(eq(counter.use_count(), 1));
+	};
+
+	test("InlineFunction accepts callables bigger than its buffer") = [] {
+		std::array<int, 64> values {};
+		values.back() = 42;
+
+		InlineFunction<int(int)> f([values](int add) { return values.back() + add; });
+		auto moved = std::move(f);
+		expect(eq(moved(1), 43));
+	};
+
+	test("InlineFunction discards return values of void signatures") = [] {
+		bool called = false;
+		InlineFunction<void(void)> f([&called] {
+			called = true;
+			return 1;
+		});
+		f();
+		expect(called);
+	};
+};
@@ -0,0 +1,89 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "utils/lockfree.hpp"
+
+using namespace boost::ut;
+
+suite<"utils"> lockfreeQueueTest = [] {
+	test("LockfreeMPSCQueue drains values in push order") = [] {
+		LockfreeMPSCQueue<int> queue(8);
+		for (int i = 0; i < 5; ++i) {
+			queue.push(i);
+		}
+
+		std::vector<int> drained;
+		expect(eq(queue.drain([&drained](int &&value) { drained.emplace_back(value); }), 5u));
+		expect(eq(drained, std::vector<int> { 0, 1, 2, 3, 4 }));
+		expect(queue.empty());
+	};
+
+	test("LockfreeMPSCQueue spills into the overflow when full and keeps the order") = [] {
+		LockfreeMPSCQueue<int> queue(4);
+		for (int i = 0; i < 100; ++i) {
+			queue.push(i);
+		}
+
+		std::vector<int> drained;
+		expect(eq(queue.drain([&drained](int &&value) { drained.emplace_back(value); }), 100u));
+		expect(eq(drained.size(), 100u));
+		expect(std::ranges::is_sorted(drained));
+		expect(queue.empty());
+
+		// The ring is used again once the overflow was drained
+		queue.push(7);
+		drained.clear();
+		queue.drain([&drained](int &&value) { drained.emplace_back(value); });
+		expect(eq(drained, std::vector<int> { 7 }));
+	};
+
+	test("LockfreeMPSCQueue leaves values pushed while draining for the next drain") = [] {
+		LockfreeMPSCQueue<int> queue(64);
+		for (int i = 0; i < 3; ++i) {
+			queue.push(i);
+		}
+
+		// A producer that keeps up with the consumer must not keep the drain going
+		std::vector<int> drained;
+		const auto consumeAndPush = [&queue, &drained](int &&value) {
+			drained.emplace_back(value);
+			queue.push(value + 10);
+		};
+		expect(eq(queue.drain(consumeAndPush), 3u));
+		expect(eq(drained, std::vector<int> { 0, 1, 2 }));
+
+		drained.clear();
+		expect(eq(queue.drain([&drained](int &&value) { drained.emplace_back(value); }), 3u));
+		expect(eq(drained, std::vector<int> { 10, 11, 12 }));
+	};
+
+	test("LockfreeMPSCQueue loses nothing with concurrent producers") = [] {
+		constexpr int producers = 4;
+		constexpr int perProducer = 10'000;
+		LockfreeMPSCQueue<int> queue(64);
+
+		std::vector<std::thread> threads;
+		for (int p = 0; p < producers; ++p) {
+			threads.emplace_back([&queue, p] {
+				for (int i = 0; i < perProducer; ++i) {
+					queue.push(p * perProducer + i);
+				}
+			});
+		}
+
+		std::vector<int> drained;
+		const auto consume = [&drained](int &&value) { drained.emplace_back(value); };
+		while (drained.size() < static_cast<size_t>(producers * perProducer)) {
+			queue.drain(consume);
+		}
+
+		for (auto &thread : threads) {
+			thread.join();
+		}
+
+		std::ranges::sort(drained);
+		expect(eq(drained.size(), static_cast<size_t>(producers * perProducer)));
+		expect(std::ranges::adjacent_find(drained) == drained.end());
+	};
+};
@@ -0,0 +1,120 @@
+#include "pch.hpp"
+
+#include <boost/ut.hpp>
+
+#include "utils/lru_set.hpp"
+
+using namespace boost::ut;
+
+suite<"utils"> lruSetTest = [] {
+	test("LRUSet reports whether a key was already known") = [] {
+		LRUSet<uint32_t> set(4);
+		expect(set.insert(1).inserted);
+		expect(!set.insert(1).inserted);
+		expect(set.contains(1));
+		expect(eq(set.size(), 1u));
+	};
+
+	test("LRUSet evicts the least recently used key when full") = [] {
+		LRUSet<uint32_t> set(3);
+		set.insert(1);
+		set.insert(2);
+		set.insert(3);
+		set.touch(1);
+
+		const auto result = set.insert(4);
+		expect(result.inserted);
+		expect(result.evicted.has_value() && *result.evicted == 2u);
+		expect(!set.contains(2));
+		expect(eq(set.size(), 3u));
+		expect(eq(set.oldest().value_or(0), 3u));
+	};
+
+	test("LRUSet skips keys the predicate keeps") = [] {
+		LRUSet<uint32_t> set(3);
+		set.insert(1);
+		set.insert(2);
+		set.insert(3);
+
+		const auto result = set.insert(4, [](uint32_t key) { return key != 1; });
+		expect(result.evicted.has_value() && *result.evicted == 2u);
+		expect(set.contains(1));
+		// The kept key was moved to the front, the next eviction doesn't probe it again
+		expect(eq(set.oldest().value_or(0), 3u));
+	};
+
+	test("LRUSet asks every key once before dropping the oldest one") = [] {
+		LRUSet<uint32_t> set(4, 2);
+		for (uint32_t key = 1; key <= 4; ++key) {
+			set.insert(key);
+		}
+
+		uint32_t probes = 0;
+		const auto result = set.insert(5, [&probes](uint32_t) {
+			++probes;
+			return false;
+		});
+		expect(eq(probes, 4u));
+		expect(result.evicted.has_value() && *result.evicted == 1u);
+		expect(set.contains(2) && set.contains(3) && set.contains(4) && set.contains(5));
+	};
+
+	test("LRUSet probes past the bound for a key it may drop") = [] {
+		LRUSet<uint32_t> set(4, 2);
+		for (uint32_t key = 1; key <= 4; ++key) {
+			set.insert(key);
+		}
+
+		const auto result = set.insert(5, [](uint32_t key) { return key == 4; });
+		expect(result.evicted.has_value() && *result.evicted == 4u);
+		expect(set.contains(1) && set.contains(2) && set.contains(3));
+	};
+
+	test("LRUSet drops the first fallback key once the bound is reached") = [] {
+		using Eviction = LRUSet<uint32_t>::Eviction;
+		LRUSet<uint32_t> set(4, 2);
+		for (uint32_t key = 1; key <= 4; ++key) {
+			set.insert(key);
+		}
+
+		uint32_t probes = 0;
+		const auto result = set.insert(5, [&probes](uint32_t key) {
+			++probes;
+			if (key == 4) {
+				return Eviction::ALLOW;
+			}
+			return key == 2 ? Eviction::FALLBACK : Eviction::KEEP;
+		});
+		// Key 4 is past the bound, never asked
+		expect(eq(probes, 2u));
+		expect(result.evicted.has_value() && *result.evicted == 2u);
+		expect(set.contains(1) && set.contains(3) && set.contains(4));
+	};
+
+	test("LRUSet takes a fallback key found past the bound") = [] {
+		using Eviction = LRUSet<uint32_t>::Eviction;
+		LRUSet<uint32_t> set(4, 2);
+		for (uint32_t key = 1; key <= 4; ++key) {
+			set.insert(key);
+		}
+
+		const auto result = set.insert(5, [](uint32_t key) {
+			return key >= 3 ? Eviction::FALLBACK : Eviction::KEEP;
+		});
+		expect(result.evicted.has_value() && *result.evicted == 3u);
+		expect(set.contains(1) && set.contains(2) && set.contains(4));
+	};
+
+	test("LRUSet reuses the nodes of erased keys") = [] {
+		LRUSet<uint32_t> set(2);
+		set.insert(1);
+		set.insert(2);
+		expect(set.erase(1));
+		expect(!set.erase(1));
+
+		const auto result = set.insert(3);
+		expect(!result.evicted.has_value());
+		expect(set.contains(2) && set.contains(3));
+		expect(eq(set.oldest().value_or(0), 2u));
+	};
+};
@@ -0,0 +1,478 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "pch.hpp"
+
+#include "bot.hpp"
+
+#include "core.hpp"
+#include "creatures/creatures_definitions.hpp"
+#include "map_description.hpp"
+#include "security/rsa.hpp"
+#include "server/network/message/outputmessage.hpp"
+#include "utils/tools.hpp"
+#include "utils/utils_definitions.hpp"
+
+namespace {
+	constexpr size_t RSA_BLOCK_SIZE = 128;
+	constexpr std::chrono::seconds LOGIN_TIMEOUT { 30 };
+	// Players that don't answer pings are removed after a minute
+	constexpr std::chrono::seconds KEEP_ALIVE_INTERVAL { 10 };
+	// Echoes not seen by then were dropped, muted or out of the screen
+	constexpr std::chrono::seconds ECHO_TIMEOUT { 10 };
+	// Time the server gets to process the logout before the socket is closed
+	constexpr std::chrono::seconds LOGOUT_GRACE { 2 };
+
+	template <typename T>
+	T read(const uint8_t* data) {
+		T value;
+		std::memcpy(&value, data, sizeof(T));
+		return value;
+	}
+}
+
+Bot::Bot(asio::io_context &context, const LoadSettings &settings, LoadStats &stats, BotRegistry &registry, uint32_t index) :
+	socket(context), actionTimer(context), sayTimer(context), keepAliveTimer(context),
+	settings(settings), stats(stats), registry(registry), index(index), generator(std::random_device {}()) {
+	std::ranges::generate(key, [this] { return static_cast<uint32_t>(generator()); });
+	inflated.resize(NETWORKMESSAGE_MAXSIZE);
+	inflateInit2(&inflateStream, -MAX_WBITS);
+}
+
+Bot::~Bot() {
+	inflateEnd(&inflateStream);
+}
+
+void Bot::start(std::chrono::milliseconds delay) {
+	actionTimer.expires_after(delay);
+	actionTimer.async_wait([self = shared_from_this()](const std::error_code &error) {
+		if (!error) {
+			self->connect();
+		}
+	});
+}
+
+void Bot::stop() {
+	asio::post(socket.get_executor(), [self = shared_from_this()] {
+		if (self->state != State::Online) {
+			self->close();
+			return;
+		}
+
+		self->stats.online--;
+		self->state = State::LoggingOut;
+		self->actionTimer.cancel();
+		self->sayTimer.cancel();
+
+		auto msg = OutputMessagePool::getOutputMessage();
+		msg->addByte(0x14);
+		self->sendPacket(msg);
+
+		self->keepAliveTimer.expires_after(LOGOUT_GRACE);
+		self->keepAliveTimer.async_wait([self](const std::error_code &) {
+			self->close();
+		});
+	});
+}
+
+void Bot::connect() {
+	loginStart = std::chrono::steady_clock::now();
+	const auto address = asio::ip::make_address(settings.host);
+	socket.async_connect({ address, settings.port }, [self = shared_from_this()](const std::error_code &error) {
+		if (error) {
+			self->fail(fmt::format("connect: {}", error.message()));
+			return;
+		}
+
+		self->socket.set_option(asio::ip::tcp::no_delay(true));
+		self->readHeader();
+	});
+
+	keepAliveTimer.expires_after(LOGIN_TIMEOUT);
+	keepAliveTimer.async_wait([self = shared_from_this()](const std::error_code &error) {
+		if (!error && self->state != State::Online && self->state != State::Closed) {
+			self->fail("login timed out");
+		}
+	});
+}
+
+void Bot::readHeader() {
+	asio::async_read(socket, asio::buffer(readBuffer.data(), HEADER_LENGTH), [self = shared_from_this()](const std::error_code &error, size_t) {
+		if (error) {
+			self->fail(fmt::format("read: {}", error.message()));
+			return;
+		}
+
+		// The header counts the blocks of 8 bytes behind the checksum
+		const auto size = read<uint16_t>(self->readBuffer.data()) * XTEA_MULTIPLE + CHECKSUM_LENGTH;
+		if (size > self->readBuffer.size()) {
+			self->fail("oversized message");
+			return;
+		}
+		self->readBody(static_cast<uint16_t>(size));
+	});
+}
+
+void Bot::readBody(uint16_t size) {
+	readSize = size;
+	asio::async_read(socket, asio::buffer(readBuffer.data(), size), [self = shared_from_this()](const std::error_code &error, size_t) {
+		if (error) {
+			self->fail(fmt::format("read: {}", error.message()));
+			return;
+		}
+
+		self->stats.wireBytesIn += HEADER_LENGTH + self->readSize;
+		self->stats.messagesIn++;
+		if (self->state == State::Connecting) {
+			self->onChallenge();
+		} else {
+			self->onMessage();
+		}
+
+		if (self->state != State::Closed) {
+			self->readHeader();
+		}
+	});
+}
+
+void Bot::onChallenge() {
+	// checksum, 0x01, 0x1F, timestamp, random number
+	if (readSize < 12 || readBuffer[5] != 0x1F) {
+		fail("unexpected login challenge");
+		return;
+	}
+
+	state = State::Challenged;
+	sendLogin(read<uint32_t>(readBuffer.data() + 6), readBuffer[10]);
+}
+
+void Bot::onMessage() {
+	const auto checksum = read<uint32_t>(readBuffer.data());
+	uint8_t* encrypted = readBuffer.data() + CHECKSUM_LENGTH;
+	const size_t length = readSize - CHECKSUM_LENGTH;
+	if (length == 0) {
+		return;
+	}
+
+	XTEA::decrypt(encrypted, length, key);
+	const uint8_t padding = encrypted[0];
+	if (padding >= length) {
+		fail("invalid message padding");
+		return;
+	}
+
+	const uint8_t* payload = encrypted + 1;
+	const size_t payloadSize = length - 1 - padding;
+	if ((checksum & (1U << 31)) == 0) {
+		stats.payloadBytesIn += payloadSize;
+		onPayload({ payload, payloadSize });
+		return;
+	}
+
+	if (!inflatePayload(payload, payloadSize)) {
+		fail("inflate failed");
+	}
+}
+
+bool Bot::inflatePayload(const uint8_t* data, size_t size) {
+	inflateStream.next_in = const_cast<Bytef*>(data);
+	inflateStream.avail_in = static_cast<uInt>(size);
+	inflateStream.next_out = inflated.data();
+	inflateStream.avail_out = static_cast<uInt>(inflated.size());
+
+	// The server either finishes every message or keeps one stream per connection
+	const int result = inflate(&inflateStream, Z_SYNC_FLUSH);
+	if (result != Z_OK && result != Z_STREAM_END) {
+		return false;
+	}
+
+	const size_t inflatedSize = inflated.size() - inflateStream.avail_out;
+	if (result == Z_STREAM_END) {
+		inflateReset(&inflateStream);
+	}
+
+	stats.payloadBytesIn += inflatedSize;
+	onPayload({ inflated.data(), inflatedSize });
+	return true;
+}
+
+void Bot::onPayload(std::span<const uint8_t> payload) {
+	if (payload.empty()) {
+		return;
+	}
+
+	if (state == State::Online) {
+		// Teleports and floor changes, or a login burst that didn't fit one message
+		if (payload[0] == 0x64) {
+			readMapDescription(payload, false);
+		}
+		checkEchoes(payload);
+		return;
+	}
+
+	switch (payload[0]) {
+		case 0x14:
+		case 0x16: {
+			// Login error or waiting list, followed by the reason
+			std::string reason = "login refused";
+			if (payload.size() >= 3) {
+				const auto length = std::min<size_t>(read<uint16_t>(payload.data() + 1), payload.size() - 3);
+				reason.assign(reinterpret_cast<const char*>(payload.data() + 3), length);
+			}
+			fail(reason);
+			return;
+		}
+		case 0x17: {
+			// The login packet starts with our own creature id
+			if (payload.size() < 5) {
+				return;
+			}
+			creatureId = read<uint32_t>(payload.data() + 1);
+			state = State::Online;
+			registry.add(creatureId);
+			stats.online++;
+			stats.loginLatency.add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - loginStart));
+
+			keepAliveTimer.cancel();
+			scheduleAction();
+			scheduleSay();
+			scheduleKeepAlive();
+			readMapDescription(payload, true);
+			return;
+		}
+		default:
+			return;
+	}
+}
+
+void Bot::checkEchoes(std::span<const uint8_t> payload) {
+	const auto now = std::chrono::steady_clock::now();
+	while (!pendingEchoes.empty()) {
+		const auto &echo = pendingEchoes.front();
+		const auto found = std::ranges::search(payload, echo.marker, std::equal_to<> {}, {}, [](char c) { return static_cast<uint8_t>(c); });
+		if (!found.empty()) {
+			stats.tickLatency.add(std::chrono::duration_cast<std::chrono::microseconds>(now - echo.sentAt));
+			pendingEchoes.pop_front();
+			continue;
+		}
+
+		if (now - echo.sentAt > ECHO_TIMEOUT) {
+			stats.tickSamplesLost++;
+			pendingEchoes.pop_front();
+			continue;
+		}
+		break;
+	}
+}
+
+void Bot::readMapDescription(std::span<const uint8_t> payload, bool afterLogin) {
+	if (settings.appearancesFile.empty()) {
+		return;
+	}
+
+	PacketReader reader(payload);
+	if (afterLogin && (!reader.skipLoginPackets() || reader.peekOpcode() != 0x64)) {
+		// Sent in a message of its own
+		return;
+	}
+
+	MapDescription description;
+	// Our own character stands in the middle of it
+	if (!reader.readMapDescription(description) || std::ranges::find(description.creatureIds, creatureId) == description.creatureIds.end()) {
+		stats.mapDescriptionsUnread++;
+		return;
+	}
+
+	stats.mapDescriptions++;
+	stats.mapTiles += description.tiles;
+	stats.mapCreatures += description.creatureIds.size();
+}
+
+void Bot::sendLogin(uint32_t timestamp, uint8_t random) {
+	auto msg = OutputMessagePool::getOutputMessage();
+	// Protocol id, skipped by the server
+	msg->addByte(0x0A);
+	msg->addByte(0x00);
+	msg->add<uint16_t>(CLIENTOS_NEW_WINDOWS);
+	msg->add<uint16_t>(CLIENT_VERSION);
+	msg->add<uint32_t>(CLIENT_VERSION);
+	msg->addString(fmt::format("{}.{:02}", CLIENT_VERSION_UPPER, CLIENT_VERSION_LOWER));
+	// Assets hash
+	msg->addString("");
+	// Game preview state
+	msg->addByte(0x00);
+
+	NetworkMessage login;
+	// RSA check byte, the block is left below the modulus
+	login.addByte(0x00);
+	for (const uint32_t part : key) {
+		login.add<uint32_t>(part);
+	}
+	// Gamemaster flag
+	login.addByte(0x00);
+	login.addString(settings.getAccountEmail(index) + "\n" + settings.password);
+	login.addString(settings.getCharacterName(index));
+	login.add<uint32_t>(timestamp);
+	login.addByte(random);
+
+	std::array<char, RSA_BLOCK_SIZE> block {};
+	std::memcpy(block.data(), login.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION, std::min<size_t>(login.getLength(), RSA_BLOCK_SIZE));
+	g_RSA().encrypt(block.data());
+	msg->addBytes(block.data(), block.size());
+
+	// The first message isn't encrypted but its length is still counted in blocks
+	if (const auto remainder = msg->getLength() % XTEA_MULTIPLE; remainder != 0) {
+		msg->addPaddingBytes(XTEA_MULTIPLE - remainder);
+	}
+	msg->addCryptoHeader(true, adlerChecksum(msg->getOutputBuffer(), msg->getLength()));
+
+	state = State::LoggingIn;
+	stats.packetsOut[0x0A]++;
+	write({ msg->getOutputBuffer(), msg->getOutputBuffer() + msg->getLength() });
+}
+
+void Bot::sendPacket(const std::shared_ptr<OutputMessage> &msg) {
+	stats.packetsOut[msg->getOutputBuffer()[0]]++;
+
+	// Same framing as Protocol::onSendMessage, the client checksums with the sequence number
+	msg->writePaddingAmount();
+	XTEA::encrypt(msg->getOutputBuffer(), msg->getLength(), key);
+	msg->addCryptoHeader(true, ++sequence);
+	write({ msg->getOutputBuffer(), msg->getOutputBuffer() + msg->getLength() });
+}
+
+void Bot::write(std::vector<uint8_t> frame) {
+	stats.wireBytesOut += frame.size();
+	writeQueue.emplace_back(std::move(frame));
+	if (writeQueue.size() == 1) {
+		writeNext();
+	}
+}
+
+void Bot::writeNext() {
+	asio::async_write(socket, asio::buffer(writeQueue.front()), [self = shared_from_this()](const std::error_code &error, size_t) {
+		if (error) {
+			self->fail(fmt::format("write: {}", error.message()));
+			return;
+		}
+
+		self->writeQueue.pop_front();
+		if (!self->writeQueue.empty()) {
+			self->writeNext();
+		}
+	});
+}
+
+void Bot::scheduleAction() {
+	// Jitter keeps the bots from acting in lockstep
+	const auto jitter = std::chrono::milliseconds(generator() % (settings.actionInterval.count() / 2 + 1));
+	actionTimer.expires_after(settings.actionInterval + jitter);
+	actionTimer.async_wait([self = shared_from_this()](const std::error_code &error) {
+		if (!error && self->state == State::Online) {
+			self->act();
+			self->scheduleAction();
+		}
+	});
+}
+
+void Bot::scheduleSay() {
+	sayTimer.expires_after(settings.sayInterval);
+	sayTimer.async_wait([self = shared_from_this()](const std::error_code &error) {
+		if (!error && self->state == State::Online) {
+			self->say();
+			self->scheduleSay();
+		}
+	});
+}
+
+void Bot::scheduleKeepAlive() {
+	keepAliveTimer.expires_after(KEEP_ALIVE_INTERVAL);
+	keepAliveTimer.async_wait([self = shared_from_this()](const std::error_code &error) {
+		if (!error && self->state == State::Online) {
+			// Answers the pings of the server, whether or not we saw them
+			auto msg = OutputMessagePool::getOutputMessage();
+			msg->addByte(0x1E);
+			self->sendPacket(msg);
+			self->scheduleKeepAlive();
+		}
+	});
+}
+
+void Bot::act() {
+	auto msg = OutputMessagePool::getOutputMessage();
+	const auto roll = generator() % 100;
+	if (roll < 60) {
+		// Walk north, east, south or west, or diagonally
+		static constexpr std::array<uint8_t, 8> walks = { 0x65, 0x66, 0x67, 0x68, 0x6A, 0x6B, 0x6C, 0x6D };
+		msg->addByte(walks[generator() % walks.size()]);
+	} else if (roll < 75) {
+		msg->addByte(static_cast<uint8_t>(0x6F + generator() % 4));
+	} else if (roll < 90) {
+		const auto target = registry.getRandom(generator, creatureId);
+		if (target == 0) {
+			return;
+		}
+		msg->addByte(0xA1);
+		msg->add<uint32_t>(target);
+		msg->add<uint32_t>(target);
+	} else {
+		if (settings.useItemId == 0) {
+			return;
+		}
+		msg->addByte(0x82);
+		// Inventory slot
+		msg->add<uint16_t>(0xFFFF);
+		msg->add<uint16_t>(settings.useItemSlot);
+		msg->addByte(0);
+		msg->add<uint16_t>(settings.useItemId);
+		msg->addByte(0);
+		msg->addByte(0);
+	}
+	sendPacket(msg);
+}
+
+void Bot::say() {
+	PendingEcho echo { fmt::format("lg{}#{}", creatureId, ++sayCount), std::chrono::steady_clock::now() };
+
+	auto msg = OutputMessagePool::getOutputMessage();
+	msg->addByte(0x96);
+	msg->addByte(TALKTYPE_SAY);
+	msg->addString(echo.marker);
+	sendPacket(msg);
+
+	pendingEchoes.emplace_back(std::move(echo));
+}
+
+void Bot::fail(const std::string &reason) {
+	// The server closes the connection once we logged out
+	if (state != State::Closed && state != State::LoggingOut) {
+		stats.failed++;
+		stats.addFailure(reason);
+	}
+	close();
+}
+
+void Bot::close() {
+	if (state == State::Closed) {
+		return;
+	}
+
+	if (state == State::Online) {
+		stats.online--;
+	}
+	state = State::Closed;
+
+	actionTimer.cancel();
+	sayTimer.cancel();
+	keepAliveTimer.cancel();
+
+	std::error_code error;
+	socket.shutdown(asio::ip::tcp::socket::shutdown_both, error);
+	socket.close(error);
+}
@@ -0,0 +1,107 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "security/xtea.hpp"
+#include "server/server_definitions.hpp"
+
+#include <zlib.h>
+
+#include "load_generator.hpp"
+
+class OutputMessage;
+
+/**
+ * @brief Scripted game client speaking the protocol of the real one.
+ *
+ * It goes through the login challenge, RSA and XTEA like the client, then
+ * walks, turns, talks, attacks other bots and uses items on a timer. Server
+ * messages are decrypted and inflated but not parsed packet by packet: the
+ * bot only looks for its own character id and for the speech it sent, whose
+ * echo gives the server tick latency. Map descriptions are read through, with
+ * the item types of appearances.dat, when one was given.
+ */
+class Bot : public std::enable_shared_from_this<Bot> {
+public:
+	Bot(asio::io_context &context, const LoadSettings &settings, LoadStats &stats, BotRegistry &registry, uint32_t index);
+	~Bot();
+
+	// non-copyable
+	Bot(const Bot &) = delete;
+	Bot &operator=(const Bot &) = delete;
+
+	void start(std::chrono::milliseconds delay);
+	void stop();
+
+private:
+	enum class State : uint8_t {
+		Connecting,
+		Challenged,
+		LoggingIn,
+		Online,
+		LoggingOut,
+		Closed,
+	};
+
+	struct PendingEcho {
+		std::string marker;
+		std::chrono::steady_clock::time_point sentAt;
+	};
+
+	void connect();
+	void readHeader();
+	void readBody(uint16_t size);
+	void onChallenge();
+	void onMessage();
+	bool inflatePayload(const uint8_t* data, size_t size);
+	void onPayload(std::span<const uint8_t> payload);
+	void checkEchoes(std::span<const uint8_t> payload);
+	void readMapDescription(std::span<const uint8_t> payload, bool afterLogin);
+
+	void sendLogin(uint32_t timestamp, uint8_t random);
+	void sendPacket(const std::shared_ptr<OutputMessage> &msg);
+	void write(std::vector<uint8_t> frame);
+	void writeNext();
+
+	void scheduleAction();
+	void scheduleSay();
+	void scheduleKeepAlive();
+	void act();
+	void say();
+
+	void fail(const std::string &reason);
+	void close();
+
+	asio::ip::tcp::socket socket;
+	asio::steady_timer actionTimer;
+	asio::steady_timer sayTimer;
+	asio::steady_timer keepAliveTimer;
+
+	const LoadSettings &settings;
+	LoadStats &stats;
+	BotRegistry &registry;
+	const uint32_t index;
+
+	State state = State::Connecting;
+	std::mt19937 generator;
+	XTEA::Key key {};
+	uint32_t sequence = 0;
+	uint32_t creatureId = 0;
+	uint32_t sayCount = 0;
+	std::chrono::steady_clock::time_point loginStart;
+
+	std::array<uint8_t, NETWORKMESSAGE_MAXSIZE> readBuffer {};
+	uint16_t readSize = 0;
+	std::vector<uint8_t> inflated;
+	z_stream inflateStream {};
+
+	std::deque<std::vector<uint8_t>> writeQueue;
+	std::deque<PendingEcho> pendingEchoes;
+};
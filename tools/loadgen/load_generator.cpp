@@ -0,0 +1,415 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "pch.hpp"
+
+#include "load_generator.hpp"
+
+#include "bot.hpp"
+#include "database/database.hpp"
+#include "map/map_const.hpp"
+#include "utils/tools.hpp"
+
+namespace {
+	constexpr std::chrono::seconds PROGRESS_INTERVAL { 10 };
+
+	template <typename T>
+	bool parseNumber(std::string_view value, T &output) {
+		const auto result = std::from_chars(value.data(), value.data() + value.size(), output);
+		return result.ec == std::errc() && result.ptr == value.data() + value.size();
+	}
+
+	double percentile(const std::vector<uint32_t> &sorted, double rank) {
+		const auto position = static_cast<size_t>(rank * static_cast<double>(sorted.size() - 1));
+		return sorted[position] / 1000.0;
+	}
+
+	// "http://host:port/path", only plain http is needed to reach a local exporter
+	std::string httpGet(const std::string &url) {
+		std::string_view rest = url;
+		if (rest.starts_with("http://")) {
+			rest.remove_prefix(7);
+		}
+
+		const auto pathStart = rest.find('/');
+		const std::string path = pathStart == std::string_view::npos ? "/metrics" : std::string(rest.substr(pathStart));
+		const auto hostPort = rest.substr(0, pathStart);
+		const auto colon = hostPort.find(':');
+		const std::string host(hostPort.substr(0, colon));
+		const std::string port = colon == std::string_view::npos ? "80" : std::string(hostPort.substr(colon + 1));
+
+		asio::io_context context;
+		asio::ip::tcp::resolver resolver(context);
+		asio::ip::tcp::socket socket(context);
+		asio::connect(socket, resolver.resolve(host, port));
+
+		const auto request = fmt::format("GET {} HTTP/1.0\r\nHost: {}\r\nConnection: close\r\n\r\n", path, host);
+		asio::write(socket, asio::buffer(request));
+
+		std::string response;
+		std::error_code error;
+		asio::read(socket, asio::dynamic_buffer(response), error);
+		if (error && error != asio::error::eof) {
+			throw std::system_error(error);
+		}
+
+		const auto bodyStart = response.find("\r\n\r\n");
+		return bodyStart == std::string::npos ? std::string {} : response.substr(bodyStart + 4);
+	}
+}
+
+std::optional<LoadSettings> LoadSettings::parse(int argc, char* argv[]) {
+	LoadSettings settings;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view argument = argv[i];
+		if (argument == "--help" || argument == "-h") {
+			return std::nullopt;
+		}
+		if (argument == "--seed") {
+			settings.seed = true;
+			continue;
+		}
+
+		const auto separator = argument.find('=');
+		if (!argument.starts_with("--") || separator == std::string_view::npos) {
+			fmt::print(stderr, "Unknown argument: {}\n", argument);
+			return std::nullopt;
+		}
+
+		const auto name = argument.substr(2, separator - 2);
+		const auto value = argument.substr(separator + 1);
+		uint32_t number = 0;
+		const bool isNumber = parseNumber(value, number);
+
+		bool valid = true;
+		if (name == "host") {
+			settings.host = value;
+		} else if (name == "port") {
+			valid = isNumber && number <= UINT16_MAX;
+			settings.port = static_cast<uint16_t>(number);
+		} else if (name == "bots") {
+			valid = isNumber && number > 0;
+			settings.bots = number;
+		} else if (name == "threads") {
+			valid = isNumber && number > 0;
+			settings.threads = number;
+		} else if (name == "duration") {
+			valid = isNumber;
+			settings.duration = std::chrono::seconds(number);
+		} else if (name == "ramp-up") {
+			valid = isNumber;
+			settings.rampUp = std::chrono::milliseconds(number);
+		} else if (name == "key") {
+			settings.keyFile = value;
+		} else if (name == "account-prefix") {
+			settings.accountPrefix = value;
+		} else if (name == "name-prefix") {
+			settings.namePrefix = value;
+		} else if (name == "password") {
+			settings.password = value;
+		} else if (name == "action-interval") {
+			valid = isNumber && number > 0;
+			settings.actionInterval = std::chrono::milliseconds(number);
+		} else if (name == "say-interval") {
+			valid = isNumber && number > 0;
+			settings.sayInterval = std::chrono::milliseconds(number);
+		} else if (name == "use-item") {
+			valid = isNumber && number <= UINT16_MAX;
+			settings.useItemId = static_cast<uint16_t>(number);
+		} else if (name == "use-slot") {
+			valid = isNumber && number <= UINT8_MAX;
+			settings.useItemSlot = static_cast<uint8_t>(number);
+		} else if (name == "metrics-url") {
+			settings.metricsUrl = value;
+		} else if (name == "appearances") {
+			settings.appearancesFile = value;
+		} else if (name == "db-host") {
+			settings.dbHost = value;
+		} else if (name == "db-port") {
+			valid = isNumber;
+			settings.dbPort = number;
+		} else if (name == "db-user") {
+			settings.dbUser = value;
+		} else if (name == "db-password") {
+			settings.dbPassword = value;
+		} else if (name == "db-name") {
+			settings.dbName = value;
+		} else if (name == "town") {
+			valid = isNumber;
+			settings.townId = number;
+		} else if (name == "spawn") {
+			// x,y,z
+			std::array<uint32_t, 3> coordinates {};
+			size_t start = 0;
+			for (size_t axis = 0; axis < coordinates.size() && valid; ++axis) {
+				const auto end = std::min(value.find(',', start), value.size());
+				valid = parseNumber(value.substr(start, end - start), coordinates[axis]);
+				start = end + 1;
+			}
+			valid = valid && coordinates[0] <= UINT16_MAX && coordinates[1] <= UINT16_MAX && coordinates[2] <= MAP_MAX_LAYERS - 1;
+			settings.spawnX = static_cast<uint16_t>(coordinates[0]);
+			settings.spawnY = static_cast<uint16_t>(coordinates[1]);
+			settings.spawnZ = static_cast<uint8_t>(coordinates[2]);
+		} else {
+			fmt::print(stderr, "Unknown argument: {}\n", argument);
+			return std::nullopt;
+		}
+
+		if (!valid) {
+			fmt::print(stderr, "Invalid value for --{}: {}\n", name, value);
+			return std::nullopt;
+		}
+	}
+	return settings;
+}
+
+void LoadSettings::printUsage() {
+	fmt::print(
+		"Usage: canary_loadgen [options]\n"
+		"  --host=127.0.0.1         game server address\n"
+		"  --port=7172              game server port\n"
+		"  --bots=100               connections to open\n"
+		"  --threads=4              network threads of the generator\n"
+		"  --duration=60            seconds to keep the load running\n"
+		"  --ramp-up=10             milliseconds between two connections\n"
+		"  --key=key.pem            RSA key of the server\n"
+		"  --account-prefix=loadgen bots use <prefix><n>@loadgen.local\n"
+		"  --name-prefix=Loadgen    bots play \"<prefix> <n>\"\n"
+		"  --password=loadgen       password of the bot accounts\n"
+		"  --action-interval=500    milliseconds between walks, turns, attacks and uses\n"
+		"  --say-interval=3000      milliseconds between two messages, their echo gives the tick latency\n"
+		"  --use-item=0             item id used from the inventory, 0 disables it\n"
+		"  --use-slot=3             inventory slot of that item\n"
+		"  --metrics-url=           Prometheus endpoint, e.g. http://127.0.0.1:9464/metrics\n"
+		"  --appearances=           appearances.dat of the server, to read the map descriptions\n"
+		"  --seed                   create the bot accounts and characters first\n"
+		"  --db-host, --db-port, --db-user, --db-password, --db-name\n"
+		"  --town=1 --spawn=32369,32241,7  home of the seeded characters\n"
+	);
+}
+
+std::string LoadSettings::getAccountEmail(uint32_t index) const {
+	return fmt::format("{}{}@loadgen.local", accountPrefix, index + 1);
+}
+
+std::string LoadSettings::getCharacterName(uint32_t index) const {
+	return fmt::format("{} {}", namePrefix, index + 1);
+}
+
+void LatencySamples::add(std::chrono::microseconds latency) {
+	std::scoped_lock lock(mutex);
+	micros.emplace_back(static_cast<uint32_t>(std::min<int64_t>(latency.count(), UINT32_MAX)));
+}
+
+void LatencySamples::print(std::string_view name) {
+	std::scoped_lock lock(mutex);
+	if (micros.empty()) {
+		fmt::print("  {:<14} no samples\n", name);
+		return;
+	}
+
+	std::ranges::sort(micros);
+	fmt::print(
+		"  {:<14} p50 {:.2f} ms, p90 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms ({} samples)\n",
+		name, percentile(micros, 0.5), percentile(micros, 0.9), percentile(micros, 0.99), micros.back() / 1000.0, micros.size()
+	);
+}
+
+void LoadStats::addFailure(const std::string &reason) {
+	std::scoped_lock lock(failuresMutex);
+	failures[reason]++;
+}
+
+void LoadStats::print(std::chrono::duration<double> elapsed) {
+	const double seconds = std::max(elapsed.count(), 0.001);
+	fmt::print("\nLoad generator report after {:.1f} s\n", seconds);
+	fmt::print("  online         {} bots, {} failed\n", online.load(), failed.load());
+	loginLatency.print("login");
+	tickLatency.print("tick latency");
+	fmt::print("  {:<14} {} echoes not seen\n", "", tickSamplesLost.load());
+
+	const auto online = std::max<uint32_t>(this->online.load(), 1);
+	fmt::print(
+		"  server out     {:.1f} KB/s on the wire, {:.1f} KB/s uncompressed, {:.2f} KB/s per bot, {} messages\n",
+		wireBytesIn / seconds / 1024, payloadBytesIn / seconds / 1024, wireBytesIn / seconds / 1024 / online, messagesIn.load()
+	);
+	fmt::print("  server in      {:.1f} KB/s\n", wireBytesOut / seconds / 1024);
+
+	if (const auto descriptions = mapDescriptions.load(); descriptions > 0 || mapDescriptionsUnread > 0) {
+		const auto read = std::max<uint64_t>(descriptions, 1);
+		fmt::print(
+			"  map            {} descriptions read, {} unread, {:.1f} tiles and {:.1f} creatures each\n",
+			descriptions, mapDescriptionsUnread.load(), static_cast<double>(mapTiles) / read, static_cast<double>(mapCreatures) / read
+		);
+	}
+
+	fmt::print("  packets sent  ");
+	for (size_t opcode = 0; opcode < packetsOut.size(); ++opcode) {
+		if (const auto count = packetsOut[opcode].load(); count > 0) {
+			fmt::print(" 0x{:02X}: {}", opcode, count);
+		}
+	}
+	fmt::print("\n");
+
+	std::scoped_lock lock(failuresMutex);
+	for (const auto &[reason, count] : failures) {
+		fmt::print("  failure        {} x {}\n", count, reason);
+	}
+}
+
+void BotRegistry::add(uint32_t creatureId) {
+	std::scoped_lock lock(mutex);
+	creatureIds.emplace_back(creatureId);
+}
+
+uint32_t BotRegistry::getRandom(std::mt19937 &generator, uint32_t except) {
+	std::scoped_lock lock(mutex);
+	if (creatureIds.size() < 2) {
+		return 0;
+	}
+
+	const auto id = creatureIds[generator() % creatureIds.size()];
+	return id != except ? id : 0;
+}
+
+bool LoadGenerator::seedCharacters() const {
+	auto &db = g_database();
+	if (!db.connect(&settings.dbHost, &settings.dbUser, &settings.dbPassword, &settings.dbName, settings.dbPort, nullptr)) {
+		fmt::print(stderr, "Could not connect to the database {} on {}:{}\n", settings.dbName, settings.dbHost, settings.dbPort);
+		return false;
+	}
+
+	const auto password = db.escapeString(transformToSHA1(settings.password));
+	for (uint32_t index = 0; index < settings.bots; ++index) {
+		const auto accountName = db.escapeString(fmt::format("{}{}", settings.accountPrefix, index + 1));
+		const auto email = db.escapeString(settings.getAccountEmail(index));
+		const auto character = db.escapeString(settings.getCharacterName(index));
+
+		const bool seeded = db.executeQuery(fmt::format(
+								"INSERT INTO `accounts` (`name`, `email`, `password`, `creation`) VALUES ({}, {}, {}, {}) "
+								"ON DUPLICATE KEY UPDATE `email` = VALUES(`email`), `password` = VALUES(`password`)",
+								accountName, email, password, getTimeNow()
+							))
+			&& db.executeQuery(fmt::format(
+				"INSERT INTO `players` (`name`, `account_id`, `level`, `health`, `healthmax`, `cap`, `town_id`, `posx`, `posy`, `posz`, `conditions`) "
+				"SELECT {}, `id`, 8, 185, 185, 470, {}, {}, {}, {}, '' FROM `accounts` WHERE `name` = {} "
+				"ON DUPLICATE KEY UPDATE `town_id` = VALUES(`town_id`), `posx` = VALUES(`posx`), `posy` = VALUES(`posy`), `posz` = VALUES(`posz`)",
+				character, settings.townId, settings.spawnX, settings.spawnY, settings.spawnZ, accountName
+			));
+		if (!seeded) {
+			fmt::print(stderr, "Could not create the character {}\n", settings.getCharacterName(index));
+			return false;
+		}
+	}
+
+	fmt::print("Seeded {} accounts and characters\n", settings.bots);
+	return true;
+}
+
+int LoadGenerator::run() {
+	std::vector<std::unique_ptr<asio::io_context>> contexts;
+	std::vector<asio::executor_work_guard<asio::io_context::executor_type>> guards;
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < settings.threads; ++i) {
+		auto &context = contexts.emplace_back(std::make_unique<asio::io_context>(1));
+		guards.emplace_back(asio::make_work_guard(*context));
+		threads.emplace_back([&context = *context] { context.run(); });
+	}
+
+	std::vector<std::shared_ptr<Bot>> bots;
+	bots.reserve(settings.bots);
+	for (uint32_t index = 0; index < settings.bots; ++index) {
+		// Bots of a thread only run on its io_context, they need no locking
+		auto &context = *contexts[index % contexts.size()];
+		const auto &bot = bots.emplace_back(std::make_shared<Bot>(context, settings, stats, registry, index));
+		asio::post(context, [bot, delay = settings.rampUp * index] { bot->start(delay); });
+	}
+
+	fmt::print("Connecting {} bots to {}:{} over {} threads\n", settings.bots, settings.host, settings.port, settings.threads);
+	const auto start = std::chrono::steady_clock::now();
+	const auto end = start + settings.duration;
+	while (std::chrono::steady_clock::now() < end) {
+		std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(PROGRESS_INTERVAL, end - std::chrono::steady_clock::now()));
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		fmt::print(
+			"[{:.0f} s] {} online, {} failed, {:.1f} KB/s from the server\n",
+			elapsed.count(), stats.online.load(), stats.failed.load(), stats.wireBytesIn / elapsed.count() / 1024
+		);
+	}
+
+	// Measured before logging out, the report describes the load itself
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	stats.print(elapsed);
+	printPacketLatencies();
+
+	for (const auto &bot : bots) {
+		bot->stop();
+	}
+	guards.clear();
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	bots.clear();
+
+	return stats.failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+void LoadGenerator::printPacketLatencies() const {
+	if (settings.metricsUrl.empty()) {
+		return;
+	}
+
+	std::string metrics;
+	try {
+		metrics = httpGet(settings.metricsUrl);
+	} catch (const std::exception &e) {
+		fmt::print(stderr, "Could not read the metrics from {}: {}\n", settings.metricsUrl, e.what());
+		return;
+	}
+
+	// packet_latency*_sum{opcode="0x65",...} 1234.5 and its _count, from ProtocolGame::parsePacketFromDispatcher
+	std::map<std::string, std::pair<double, double>> opcodes;
+	std::istringstream lines(metrics);
+	std::string line;
+	while (std::getline(lines, line)) {
+		if (!line.starts_with("packet_latency")) {
+			continue;
+		}
+
+		const auto labels = line.find('{');
+		const auto opcodeStart = line.find("opcode=\"");
+		const auto valueStart = line.rfind(' ');
+		if (labels == std::string::npos || opcodeStart == std::string::npos || valueStart == std::string::npos) {
+			continue;
+		}
+
+		const std::string_view metric(line.data(), labels);
+		const auto opcodeEnd = line.find('"', opcodeStart + 8);
+		const auto opcode = line.substr(opcodeStart + 8, opcodeEnd - opcodeStart - 8);
+		const double value = std::strtod(line.c_str() + valueStart + 1, nullptr);
+		if (metric.ends_with("_sum")) {
+			opcodes[opcode].first += value;
+		} else if (metric.ends_with("_count")) {
+			opcodes[opcode].second += value;
+		}
+	}
+
+	if (opcodes.empty()) {
+		fmt::print("  no packet_latency metric, is the server built with metrics and the Prometheus exporter enabled?\n");
+		return;
+	}
+
+	fmt::print("  server handling time per opcode, since it started:\n");
+	for (const auto &[opcode, totals] : opcodes) {
+		const auto &[sum, count] = totals;
+		if (count > 0) {
+			fmt::print("    {}: {:.1f} us mean over {:.0f} packets\n", opcode, sum / count, count);
+		}
+	}
+}
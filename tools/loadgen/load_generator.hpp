@@ -0,0 +1,132 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+struct LoadSettings {
+	std::string host = "127.0.0.1";
+	uint16_t port = 7172;
+	uint32_t bots = 100;
+	uint32_t threads = 4;
+	std::chrono::seconds duration { 60 };
+	// Delay between two bots connecting, so logins don't all hit the same dispatcher cycle
+	std::chrono::milliseconds rampUp { 10 };
+	std::string keyFile = "key.pem";
+
+	// Bots log in as "<namePrefix> <n>" on account "<accountPrefix><n>@loadgen.local"
+	std::string accountPrefix = "loadgen";
+	std::string namePrefix = "Loadgen";
+	std::string password = "loadgen";
+
+	std::chrono::milliseconds actionInterval { 500 };
+	std::chrono::milliseconds sayInterval { 3000 };
+	// Item used from the inventory, 0 disables the action
+	uint16_t useItemId = 0;
+	uint8_t useItemSlot = 3;
+
+	// Prometheus endpoint of a server built with metrics, to read the per opcode handling time
+	std::string metricsUrl;
+	// appearances.dat of the server, map descriptions are only read with it
+	std::string appearancesFile;
+
+	// Creates the accounts and characters of the bots before connecting
+	bool seed = false;
+	std::string dbHost = "127.0.0.1";
+	uint32_t dbPort = 3306;
+	std::string dbUser = "root";
+	std::string dbPassword;
+	std::string dbName = "otservbr-global";
+	uint32_t townId = 1;
+	uint16_t spawnX = 32369;
+	uint16_t spawnY = 32241;
+	uint8_t spawnZ = 7;
+
+	static std::optional<LoadSettings> parse(int argc, char* argv[]);
+	static void printUsage();
+
+	std::string getAccountEmail(uint32_t index) const;
+	std::string getCharacterName(uint32_t index) const;
+};
+
+class LatencySamples {
+public:
+	void add(std::chrono::microseconds latency);
+	void print(std::string_view name);
+
+private:
+	std::mutex mutex;
+	std::vector<uint32_t> micros;
+};
+
+struct LoadStats {
+	std::atomic<uint32_t> online = 0;
+	std::atomic<uint32_t> failed = 0;
+
+	// Server outbound traffic, as sent on the wire and once decompressed
+	std::atomic<uint64_t> wireBytesIn = 0;
+	std::atomic<uint64_t> payloadBytesIn = 0;
+	std::atomic<uint64_t> messagesIn = 0;
+	std::atomic<uint64_t> wireBytesOut = 0;
+
+	std::array<std::atomic<uint64_t>, 256> packetsOut {};
+
+	LatencySamples loginLatency;
+	// Time until a bot sees its own speech echoed, it crosses the dispatcher queue and an autosend cycle
+	LatencySamples tickLatency;
+	std::atomic<uint64_t> tickSamplesLost = 0;
+
+	std::atomic<uint64_t> mapDescriptions = 0;
+	std::atomic<uint64_t> mapDescriptionsUnread = 0;
+	std::atomic<uint64_t> mapTiles = 0;
+	std::atomic<uint64_t> mapCreatures = 0;
+
+	void addFailure(const std::string &reason);
+	void print(std::chrono::duration<double> elapsed);
+
+private:
+	std::mutex failuresMutex;
+	std::map<std::string, uint32_t> failures;
+};
+
+// Ids of the characters online, bots attack each other
+class BotRegistry {
+public:
+	void add(uint32_t creatureId);
+	uint32_t getRandom(std::mt19937 &generator, uint32_t except);
+
+private:
+	std::mutex mutex;
+	std::vector<uint32_t> creatureIds;
+};
+
+class LoadGenerator {
+public:
+	explicit LoadGenerator(const LoadSettings &settings) :
+		settings(settings) { }
+
+	bool seedCharacters() const;
+	int run();
+
+private:
+	void printPacketLatencies() const;
+
+	const LoadSettings &settings;
+	LoadStats stats;
+	BotRegistry registry;
+};
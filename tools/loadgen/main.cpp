@@ -0,0 +1,48 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "pch.hpp"
+
+#include "load_generator.hpp"
+
+#include "game/game.hpp"
+#include "security/rsa.hpp"
+
+int main(int argc, char* argv[]) {
+	const auto settings = LoadSettings::parse(argc, argv);
+	if (!settings) {
+		LoadSettings::printUsage();
+		return EXIT_FAILURE;
+	}
+
+	bool keyLoaded = false;
+	try {
+		keyLoaded = g_RSA().loadPEM(settings->keyFile);
+	} catch (const std::system_error &e) {
+		fmt::print(stderr, "Loading RSA key from {} failed with error: {}\n", settings->keyFile, e.what());
+	}
+	if (!keyLoaded) {
+		// Same fallback as the server, which uses the standard key without key.pem
+		fmt::print(stderr, "Could not load {}, using the standard RSA key\n", settings->keyFile);
+		g_RSA().start();
+	}
+
+	// Item types tell how long each item of a map description is
+	if (!settings->appearancesFile.empty() && g_game().loadAppearanceProtobuf(settings->appearancesFile) != ERROR_NONE) {
+		fmt::print(stderr, "Could not load {}\n", settings->appearancesFile);
+		return EXIT_FAILURE;
+	}
+
+	LoadGenerator generator(*settings);
+	if (settings->seed && !generator.seedCharacters()) {
+		return EXIT_FAILURE;
+	}
+
+	return generator.run();
+}
@@ -0,0 +1,265 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#include "pch.hpp"
+
+#include "map_description.hpp"
+
+#include "creatures/creatures_definitions.hpp"
+#include "items/item.hpp"
+#include "map/map_const.hpp"
+
+namespace {
+	constexpr int32_t DESCRIPTION_WIDTH = (MAP_MAX_CLIENT_VIEW_PORT_X + 1) * 2;
+	constexpr int32_t DESCRIPTION_HEIGHT = (MAP_MAX_CLIENT_VIEW_PORT_Y + 1) * 2;
+	// Ends a tile, the low byte counts the empty positions that follow it
+	constexpr uint16_t TILE_END_MARKER = 0xFF00;
+	constexpr uint16_t UNKNOWN_CREATURE_MARKER = 0x61;
+	constexpr uint16_t KNOWN_CREATURE_MARKER = 0x62;
+}
+
+template <typename T>
+bool PacketReader::read(T &value) {
+	if (payload.size() - position < sizeof(T)) {
+		position = payload.size();
+		return false;
+	}
+
+	std::memcpy(&value, payload.data() + position, sizeof(T));
+	position += sizeof(T);
+	return true;
+}
+
+bool PacketReader::skip(size_t count) {
+	if (payload.size() - position < count) {
+		position = payload.size();
+		return false;
+	}
+
+	position += count;
+	return true;
+}
+
+bool PacketReader::skipString() {
+	uint16_t length;
+	return read(length) && skip(length);
+}
+
+bool PacketReader::skipLoginPackets() {
+	uint8_t opcode;
+	if (!read(opcode) || opcode != 0x17) {
+		return false;
+	}
+
+	// Creature id, beat duration, three speed factors and two flags
+	if (!skip(4 + 2 + 3 * 5 + 2)) {
+		return false;
+	}
+	// Store images url, coin packet size and the exiva flag
+	if (!skipString() || !skip(2 + 1)) {
+		return false;
+	}
+
+	while (!atEnd()) {
+		switch (peekOpcode()) {
+			case 0x1A:
+				// Bug report flag
+				skip(2);
+				break;
+			case 0xEF:
+				// Tibia time
+				skip(3);
+				break;
+			case 0x0A:
+			case 0x0F:
+				// Pending state, enter world
+				skip(1);
+				break;
+			default:
+				return true;
+		}
+	}
+	return true;
+}
+
+bool PacketReader::readMapDescription(MapDescription &description) {
+	uint8_t opcode;
+	if (!read(opcode) || opcode != 0x64 || !read(description.center.x) || !read(description.center.y) || !read(description.center.z)) {
+		return false;
+	}
+
+	// Same floors as ProtocolGame::GetMapDescription
+	int32_t startz, endz, zstep;
+	if (description.center.z > MAP_INIT_SURFACE_LAYER) {
+		startz = description.center.z - MAP_LAYER_VIEW_LIMIT;
+		endz = std::min<int32_t>(MAP_MAX_LAYERS - 1, description.center.z + MAP_LAYER_VIEW_LIMIT);
+		zstep = 1;
+	} else {
+		startz = MAP_INIT_SURFACE_LAYER;
+		endz = 0;
+		zstep = -1;
+	}
+
+	int32_t skipTiles = 0;
+	for (int32_t nz = startz; nz != endz + zstep; nz += zstep) {
+		if (!readFloor(description, skipTiles)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool PacketReader::readFloor(MapDescription &description, int32_t &skipTiles) {
+	for (int32_t i = 0; i < DESCRIPTION_WIDTH * DESCRIPTION_HEIGHT; ++i) {
+		if (skipTiles > 0) {
+			--skipTiles;
+			continue;
+		}
+
+		if (!readTile(description, skipTiles)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool PacketReader::readTile(MapDescription &description, int32_t &skipTiles) {
+	// Empty positions in front of the first tile read as a tile without things
+	bool hasThings = false;
+	while (true) {
+		uint16_t marker;
+		if (!read(marker)) {
+			return false;
+		}
+
+		if (marker >= TILE_END_MARKER) {
+			skipTiles = marker & 0xFF;
+			description.tiles += hasThings ? 1 : 0;
+			return true;
+		}
+
+		hasThings = true;
+		if (marker == UNKNOWN_CREATURE_MARKER || marker == KNOWN_CREATURE_MARKER) {
+			uint32_t creatureId;
+			if (!readCreature(marker, creatureId)) {
+				return false;
+			}
+			description.creatureIds.emplace_back(creatureId);
+			continue;
+		}
+
+		// The marker was the item id
+		position -= sizeof(marker);
+		if (!readItem()) {
+			return false;
+		}
+		++description.items;
+	}
+}
+
+bool PacketReader::readItem() {
+	// Same fields as ProtocolGame::AddItem for the items of map tiles
+	uint16_t id;
+	if (!read(id) || id >= Item::items.size() || Item::items[id].id == 0) {
+		return false;
+	}
+
+	const ItemType &it = Item::items[id];
+	if (it.stackable && !skip(1)) {
+		return false;
+	}
+	if ((it.isSplash() || it.isFluidContainer()) && !skip(1)) {
+		return false;
+	}
+
+	if (it.isContainer()) {
+		uint8_t containerType;
+		if (!read(containerType)) {
+			return false;
+		}
+		// Loot and obtain flags, or the quiver ammo count
+		if ((containerType == 9 && !skip(8)) || (containerType == 2 && !skip(4))) {
+			return false;
+		}
+	}
+
+	if (it.isPodium) {
+		uint16_t lookType, lookMount;
+		if (!read(lookType) || !skip(lookType != 0 ? 5 : 2) || !read(lookMount) || !skip(lookMount != 0 ? 4 : 0)) {
+			return false;
+		}
+		// Direction and visibility
+		if (!skip(2)) {
+			return false;
+		}
+	}
+
+	if (it.upgradeClassification > 0 && !skip(1)) {
+		return false;
+	}
+	// Timer, then charges, each with the brand-new flag
+	if ((it.expire || it.expireStop || it.clockExpire) && !skip(5)) {
+		return false;
+	}
+	if (it.wearOut && !skip(5)) {
+		return false;
+	}
+	return !it.isWrapKit || skip(2);
+}
+
+bool PacketReader::readCreature(uint16_t marker, uint32_t &creatureId) {
+	// Same fields as ProtocolGame::AddCreature
+	const bool known = marker == KNOWN_CREATURE_MARKER;
+	if (known) {
+		if (!read(creatureId)) {
+			return false;
+		}
+	} else {
+		uint32_t removedId;
+		uint8_t creatureType;
+		if (!read(removedId) || !read(creatureId) || !read(creatureType)) {
+			return false;
+		}
+		if ((creatureType == CREATURETYPE_SUMMON_PLAYER && !skip(4)) || !skipString()) {
+			return false;
+		}
+	}
+
+	// Health and direction
+	if (!skip(2) || !skipOutfit()) {
+		return false;
+	}
+
+	// Light and speed, then the icons
+	uint8_t iconCount;
+	if (!skip(2 + 2) || !read(iconCount) || !skip(iconCount * 4)) {
+		return false;
+	}
+
+	// Skull and party shield, plus the guild emblem for new creatures
+	if (!skip(known ? 2 : 3)) {
+		return false;
+	}
+
+	uint8_t creatureType;
+	if (!read(creatureType)) {
+		return false;
+	}
+	if ((creatureType == CREATURETYPE_SUMMON_PLAYER && !skip(4)) || (creatureType == CREATURETYPE_PLAYER && !skip(1))) {
+		return false;
+	}
+
+	// Speech bubble, mark, inspection type and walkthrough
+	return skip(4);
+}
+
+bool PacketReader::skipOutfit() {
+	uint16_t lookType, lookMount;
+	return read(lookType) && skip(lookType != 0 ? 5 : 2) && read(lookMount) && skip(lookMount != 0 ? 4 : 0);
+}
@@ -0,0 +1,74 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2024 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.com/
+ */
+
+#pragma once
+
+#include "game/movement/position.hpp"
+
+#include <span>
+#include <vector>
+
+/**
+ * @brief What a bot saw in a map description (0x64).
+ */
+struct MapDescription {
+	// The position of the bot, at the center of the description
+	Position center;
+	uint32_t tiles = 0;
+	uint32_t items = 0;
+	std::vector<uint32_t> creatureIds;
+};
+
+/**
+ * @brief Reads server packets as the client of CLIENT_VERSION on Windows does.
+ *
+ * Only the packets the server sends on login before the map description are
+ * known, reading stops at any other one. Items are told apart by the flags
+ * of appearances.dat, which must be loaded into Item::items first.
+ */
+class PacketReader {
+public:
+	explicit PacketReader(std::span<const uint8_t> payload) :
+		payload(payload) { }
+
+	bool atEnd() const {
+		return position >= payload.size();
+	}
+
+	uint8_t peekOpcode() const {
+		return atEnd() ? 0 : payload[position];
+	}
+
+	/**
+	 * @brief Skips the login packet (0x17) and the small ones the server sends after it.
+	 * @return false if the payload doesn't read as those packets.
+	 */
+	bool skipLoginPackets();
+
+	/**
+	 * @brief Reads a map description, the packet must start at the read position.
+	 * @return false if the description doesn't read as the client would read it.
+	 */
+	bool readMapDescription(MapDescription &description);
+
+private:
+	template <typename T>
+	bool read(T &value);
+	bool skip(size_t count);
+	bool skipString();
+
+	bool readFloor(MapDescription &description, int32_t &skipTiles);
+	bool readTile(MapDescription &description, int32_t &skipTiles);
+	bool readItem();
+	bool readCreature(uint16_t marker, uint32_t &creatureId);
+	bool skipOutfit();
+
+	std::span<const uint8_t> payload;
+	size_t position = 0;
+};